@@ -0,0 +1,243 @@
+/* disk_cache_test.c - Test of the sector cache against a disk image file */
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/* Base.h defines it too. libc first : ProcessorBind.h makes what follows hidden. */
+#undef NULL
+#include <Uefi.h>
+
+#include "disk_cache.h"
+
+#define IMAGE_NAME "disk_cache_test.img"
+#define BLOCK      GRUB_DISK_CACHE_BLOCK_SIZE
+/* Not a multiple of the cache block size, to test the last block */
+#define DISK_SIZE  (BLOCK * 300 + 1536)
+#define NO_FAILURE MAX_UINT64
+
+typedef struct {
+	FILE                  *File;
+	UINT8                 *Image;        /* what was written to File, to check the reads */
+	UINTN                  NbReads;
+	UINTN                  NbBytesRead;
+	UINT64                 FailOffset;   /* a read including this byte fails */
+} TEST_DISK;
+
+static EFI_STATUS
+DiskRead(VOID *Context, UINT64 Offset, UINTN Size, VOID *Buffer)
+{
+	TEST_DISK *Disk = (TEST_DISK *) Context;
+
+	if (Offset + Size > DISK_SIZE)
+		return EFI_INVALID_PARAMETER;
+	if (Disk->FailOffset >= Offset && Disk->FailOffset < Offset + Size)
+		return EFI_DEVICE_ERROR;
+	Disk->NbReads++;
+	Disk->NbBytesRead += Size;
+	if (fseek(Disk->File, (long) Offset, SEEK_SET) != 0 || fread(Buffer, 1, Size, Disk->File) != Size)
+		return EFI_DEVICE_ERROR;
+	return EFI_SUCCESS;
+}
+
+static int
+DiskOpen(TEST_DISK *Disk)
+{
+	UINTN i;
+
+	memset(Disk, 0, sizeof(*Disk));
+	Disk->FailOffset = NO_FAILURE;
+	Disk->Image = (UINT8 *) malloc(DISK_SIZE);
+	if (Disk->Image == NULL)
+		return 0;
+	for (i = 0; i < DISK_SIZE; i++)
+		Disk->Image[i] = (UINT8)((i * 2654435761u) >> 13);
+	Disk->File = fopen(IMAGE_NAME, "w+b");
+	if (Disk->File == NULL)
+		return 0;
+	return fwrite(Disk->Image, 1, DISK_SIZE, Disk->File) == DISK_SIZE && fflush(Disk->File) == 0;
+}
+
+static VOID
+DiskClose(TEST_DISK *Disk)
+{
+	if (Disk->File != NULL)
+		fclose(Disk->File);
+	free(Disk->Image);
+	remove(IMAGE_NAME);
+}
+
+static int
+ReadAndCheck(GRUB_DISK_CACHE *Cache, TEST_DISK *Disk, UINT64 Offset, UINTN Size)
+{
+	static UINT8 Buffer[BLOCK * 80];
+
+	if (Size > sizeof(Buffer))
+		return 0;
+	memset(Buffer, 0xAA, Size);
+	if (EFI_ERROR(GrubDiskCacheRead(Cache, Offset, Size, Buffer)))
+		return 0;
+	return memcmp(Buffer, Disk->Image + Offset, Size) == 0;
+}
+
+/* The same metadata sectors read again and again : one backing read */
+static int
+TestMetadata(TEST_DISK *Disk, GRUB_DISK_CACHE *Cache)
+{
+	UINTN i;
+
+	for (i = 0; i < 100; i++) {
+		if (!ReadAndCheck(Cache, Disk, 65536, 512))
+			return 1;
+		if (!ReadAndCheck(Cache, Disk, 65536 + 1024, 512))
+			return 2;
+	}
+	if (Disk->NbReads != 1)
+		return 3;
+	/* all the sectors of a cache block are read with one request */
+	for (i = 0; i < BLOCK / 512 * 4; i++) {
+		if (!ReadAndCheck(Cache, Disk, 3 * BLOCK + i * 512, 512))
+			return 4;
+	}
+	if (Disk->NbReads != 5)
+		return 5;
+	return 0;
+}
+
+static int
+TestRuns(TEST_DISK *Disk, GRUB_DISK_CACHE *Cache)
+{
+	UINT8 Buffer[16];
+
+	/* A read across several missing blocks, not aligned : one request into the cache */
+	if (!ReadAndCheck(Cache, Disk, BLOCK - 100, 200))
+		return 10;
+	if (Disk->NbReads != 1 || Disk->NbBytesRead != 2 * BLOCK)
+		return 11;
+	/* Large aligned read : read directly, one request, not cached */
+	if (!ReadAndCheck(Cache, Disk, 10 * BLOCK, 64 * BLOCK))
+		return 12;
+	if (Disk->NbReads != 2 || Disk->NbBytesRead != 66 * BLOCK)
+		return 13;
+	if (!ReadAndCheck(Cache, Disk, 20 * BLOCK, 512))
+		return 14;
+	if (Disk->NbReads != 3)
+		return 15;
+	/* Large unaligned read : cached head, direct middle, cached tail. Block 20 is cached. */
+	if (!ReadAndCheck(Cache, Disk, 12 * BLOCK + 10, 20 * BLOCK))
+		return 16;
+	if (Disk->NbReads != 7)
+		return 17;
+	/* Last, partial, block of the disk */
+	if (!ReadAndCheck(Cache, Disk, DISK_SIZE - 1000, 1000))
+		return 18;
+	if (!ReadAndCheck(Cache, Disk, DISK_SIZE - 1536, 10))
+		return 19;
+	if (Disk->NbReads != 8)
+		return 20;
+	/* Outside of the disk : error from the disk */
+	if (!EFI_ERROR(GrubDiskCacheRead(Cache, DISK_SIZE - 8, 16, Buffer)))
+		return 21;
+	return 0;
+}
+
+/*
+ * Blocks 0, 64, 128 and 192 fill the first set, 256 goes there too. Checking whether the next blocks of a request are
+ * cached must not make them the most recently used : here, the request fails before block 64 is used.
+ */
+static int
+TestLru(TEST_DISK *Disk, GRUB_DISK_CACHE *Cache)
+{
+	UINT8 Buffer[BLOCK];
+	static const UINT64 Blocks[] = { 64, 0, 128, 192 };
+	UINTN i;
+
+	for (i = 0; i < sizeof(Blocks) / sizeof(Blocks[0]); i++) {
+		if (!ReadAndCheck(Cache, Disk, Blocks[i] * BLOCK, 512))
+			return 30;
+	}
+	if (Disk->NbReads != 4)
+		return 31;
+	/* block 63, then 64 */
+	Disk->FailOffset = 63 * BLOCK;
+	if (!EFI_ERROR(GrubDiskCacheRead(Cache, 63 * BLOCK + 100, BLOCK, Buffer)))
+		return 32;
+	Disk->FailOffset = NO_FAILURE;
+	/* evicts the least recently used : 64 */
+	if (!ReadAndCheck(Cache, Disk, 256 * BLOCK, 512) || Disk->NbReads != 5)
+		return 33;
+	if (!ReadAndCheck(Cache, Disk, 0, 512) || Disk->NbReads != 5)
+		return 34;
+	if (!ReadAndCheck(Cache, Disk, 64 * BLOCK, 512) || Disk->NbReads != 6)
+		return 35;
+	return 0;
+}
+
+/* Random reads, checked against the image */
+static int
+TestRandom(TEST_DISK *Disk, GRUB_DISK_CACHE *Cache)
+{
+	UINT32 Seed = 12345;
+	UINT64 Offset;
+	UINTN Size, i;
+
+	for (i = 0; i < 5000; i++) {
+		Seed = Seed * 1103515245 + 12345;
+		Offset = (Seed >> 4) % DISK_SIZE;
+		Seed = Seed * 1103515245 + 12345;
+		Size = (i % 10 == 0) ? (Seed >> 8) % (BLOCK * 70) : (Seed >> 8) % 4096;
+		if (Offset + Size > DISK_SIZE)
+			Size = (UINTN)(DISK_SIZE - Offset);
+		if (!ReadAndCheck(Cache, Disk, Offset, Size))
+			return 40;
+	}
+	return 0;
+}
+
+static int
+Run(const char *Name, int (*Test)(TEST_DISK *, GRUB_DISK_CACHE *))
+{
+	TEST_DISK Disk;
+	GRUB_DISK_CACHE *Cache = NULL;
+	int Ret = 100;
+
+	if (DiskOpen(&Disk))
+		Cache = GrubDiskCacheCreate(DiskRead, &Disk, 1, DISK_SIZE);
+	if (Cache != NULL) {
+		Ret = Test(&Disk, Cache);
+		GrubDiskCacheFree(Cache);
+	}
+	DiskClose(&Disk);
+	if (Ret != 0)
+		printf("%s failed at test %d\n", Name, Ret);
+	return Ret;
+}
+
+int
+main(void)
+{
+	int Failed = 0;
+
+	Failed |= Run("TestMetadata", TestMetadata);
+	Failed |= Run("TestRuns", TestRuns);
+	Failed |= Run("TestLru", TestLru);
+	Failed |= Run("TestRandom", TestRandom);
+	if (Failed)
+		return 1;
+	printf("All disk cache tests succeeded\n");
+	return 0;
+}
@@ -0,0 +1,48 @@
+/* uefi_mock.c - The few EDK2 library calls used by disk_cache.c, on top of libc */
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+/* Base.h defines it too. libc first : ProcessorBind.h makes what follows hidden. */
+#undef NULL
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+VOID * EFIAPI
+AllocatePool(UINTN AllocationSize)
+{
+	return malloc(AllocationSize);
+}
+
+VOID * EFIAPI
+AllocateZeroPool(UINTN AllocationSize)
+{
+	return calloc(1, AllocationSize);
+}
+
+VOID EFIAPI
+FreePool(VOID *Buffer)
+{
+	free(Buffer);
+}
+
+VOID * EFIAPI
+CopyMem(VOID *DestinationBuffer, CONST VOID *SourceBuffer, UINTN Length)
+{
+	return memmove(DestinationBuffer, SourceBuffer, Length);
+}
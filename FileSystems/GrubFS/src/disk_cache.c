@@ -0,0 +1,220 @@
+/* disk_cache.c - Sector cache under grub_disk_read */
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <Uefi.h>
+#include <Library/BaseMemoryLib.h>
+#include <Library/MemoryAllocationLib.h>
+
+#include "disk_cache.h"
+
+#define INVALID_BLOCK MAX_UINT64
+
+typedef struct {
+	UINT64                 Block;
+	UINT32                 Stamp;    /* last use, to find the least recently used line of a set */
+	UINT32                 Length;   /* less than GRUB_DISK_CACHE_BLOCK_SIZE for the last block of the disk */
+	UINT8                 *Data;
+} GRUB_DISK_CACHE_LINE;
+
+struct _GRUB_DISK_CACHE {
+	GRUB_DISK_CACHE_READ   Read;
+	VOID                  *Context;
+	UINT32                 MediaId;
+	UINT64                 DiskSize;
+	UINT32                 Clock;
+	UINT8                 *RunBuffer;
+	GRUB_DISK_CACHE_LINE   Lines[GRUB_DISK_CACHE_SETS * GRUB_DISK_CACHE_WAYS];
+};
+
+GRUB_DISK_CACHE *
+GrubDiskCacheCreate(GRUB_DISK_CACHE_READ Read, VOID *Context, UINT32 MediaId, UINT64 DiskSize)
+{
+	GRUB_DISK_CACHE *Cache;
+	UINTN i;
+
+	Cache = (GRUB_DISK_CACHE *) AllocateZeroPool(sizeof(GRUB_DISK_CACHE));
+	if (Cache == NULL)
+		return NULL;
+	Cache->Read = Read;
+	Cache->Context = Context;
+	Cache->MediaId = MediaId;
+	Cache->DiskSize = DiskSize;
+	for (i = 0; i < GRUB_DISK_CACHE_SETS * GRUB_DISK_CACHE_WAYS; i++)
+		Cache->Lines[i].Block = INVALID_BLOCK;
+	return Cache;
+}
+
+VOID
+GrubDiskCacheFree(GRUB_DISK_CACHE *Cache)
+{
+	UINTN i;
+
+	if (Cache == NULL)
+		return;
+	for (i = 0; i < GRUB_DISK_CACHE_SETS * GRUB_DISK_CACHE_WAYS; i++) {
+		if (Cache->Lines[i].Data != NULL)
+			FreePool(Cache->Lines[i].Data);
+	}
+	if (Cache->RunBuffer != NULL)
+		FreePool(Cache->RunBuffer);
+	FreePool(Cache);
+}
+
+UINT32
+GrubDiskCacheMediaId(GRUB_DISK_CACHE *Cache)
+{
+	return Cache->MediaId;
+}
+
+/* The line of Block, without changing the LRU order */
+static GRUB_DISK_CACHE_LINE *
+Find(GRUB_DISK_CACHE *Cache, UINT64 Block)
+{
+	GRUB_DISK_CACHE_LINE *Set = &Cache->Lines[(Block & (GRUB_DISK_CACHE_SETS - 1)) * GRUB_DISK_CACHE_WAYS];
+	UINTN i;
+
+	for (i = 0; i < GRUB_DISK_CACHE_WAYS; i++) {
+		if (Set[i].Block == Block)
+			return &Set[i];
+	}
+	return NULL;
+}
+
+/* The line of Block, which becomes the most recently used of its set */
+static GRUB_DISK_CACHE_LINE *
+Lookup(GRUB_DISK_CACHE *Cache, UINT64 Block)
+{
+	GRUB_DISK_CACHE_LINE *Line = Find(Cache, Block);
+
+	if (Line != NULL)
+		Line->Stamp = ++Cache->Clock;
+	return Line;
+}
+
+/* Copy a block read from the disk into the least recently used line of its set */
+static VOID
+Insert(GRUB_DISK_CACHE *Cache, UINT64 Block, CONST UINT8 *Data, UINT32 Length)
+{
+	GRUB_DISK_CACHE_LINE *Set = &Cache->Lines[(Block & (GRUB_DISK_CACHE_SETS - 1)) * GRUB_DISK_CACHE_WAYS];
+	GRUB_DISK_CACHE_LINE *Line = &Set[0];
+	UINTN i;
+
+	for (i = 0; i < GRUB_DISK_CACHE_WAYS; i++) {
+		if (Set[i].Block == INVALID_BLOCK) {
+			Line = &Set[i];
+			break;
+		}
+		if (Set[i].Stamp < Line->Stamp)
+			Line = &Set[i];
+	}
+	if (Line->Data == NULL) {
+		Line->Data = (UINT8 *) AllocatePool(GRUB_DISK_CACHE_BLOCK_SIZE);
+		if (Line->Data == NULL)
+			return;
+	}
+	CopyMem(Line->Data, Data, Length);
+	Line->Block = Block;
+	Line->Length = Length;
+	Line->Stamp = ++Cache->Clock;
+}
+
+/* A block entirely inside [Start, End[ that is not in the cache */
+static BOOLEAN
+IsMissingAndCovered(GRUB_DISK_CACHE *Cache, UINT64 Block, UINT64 Start, UINT64 End)
+{
+	UINT64 BlockStart = Block * GRUB_DISK_CACHE_BLOCK_SIZE;
+	UINT64 BlockEnd = BlockStart + GRUB_DISK_CACHE_BLOCK_SIZE;
+
+	if (BlockEnd > Cache->DiskSize)
+		BlockEnd = Cache->DiskSize;
+	return BlockStart >= Start && BlockEnd <= End && Find(Cache, Block) == NULL;
+}
+
+EFI_STATUS
+GrubDiskCacheRead(GRUB_DISK_CACHE *Cache, UINT64 Offset, UINTN Size, VOID *Buffer)
+{
+	EFI_STATUS Status;
+	UINT8 *Dest = (UINT8 *) Buffer;
+	UINT64 End = Offset + Size;
+	UINT64 Block, LastBlock, RunStart, RunEnd, CopyStart, CopyEnd;
+	UINTN Run, i;
+	GRUB_DISK_CACHE_LINE *Line;
+
+	if (Size == 0)
+		return EFI_SUCCESS;
+	/* Outside of the disk : let the disk report the error */
+	if (End < Offset || End > Cache->DiskSize)
+		return Cache->Read(Cache->Context, Offset, Size, Buffer);
+	if (Cache->RunBuffer == NULL) {
+		Cache->RunBuffer = (UINT8 *) AllocatePool(GRUB_DISK_CACHE_MAX_RUN * GRUB_DISK_CACHE_BLOCK_SIZE);
+		if (Cache->RunBuffer == NULL)
+			return Cache->Read(Cache->Context, Offset, Size, Buffer);
+	}
+
+	Block = Offset / GRUB_DISK_CACHE_BLOCK_SIZE;
+	LastBlock = (End - 1) / GRUB_DISK_CACHE_BLOCK_SIZE;
+	while (Block <= LastBlock) {
+		Line = Lookup(Cache, Block);
+		if (Line != NULL) {
+			RunStart = Block * GRUB_DISK_CACHE_BLOCK_SIZE;
+			CopyStart = (Offset > RunStart) ? Offset : RunStart;
+			CopyEnd = (End < RunStart + Line->Length) ? End : RunStart + Line->Length;
+			CopyMem(Dest + (CopyStart - Offset), Line->Data + (CopyStart - RunStart), (UINTN)(CopyEnd - CopyStart));
+			Block++;
+			continue;
+		}
+
+		/* At least 2 missing blocks entirely covered by the request : read them directly */
+		Run = 0;
+		while (Block + Run <= LastBlock && IsMissingAndCovered(Cache, Block + Run, Offset, End))
+			Run++;
+		if (Run >= 2) {
+			RunStart = Block * GRUB_DISK_CACHE_BLOCK_SIZE;
+			RunEnd = (Block + Run) * GRUB_DISK_CACHE_BLOCK_SIZE;
+			if (RunEnd > End)
+				RunEnd = End;
+			Status = Cache->Read(Cache->Context, RunStart, (UINTN)(RunEnd - RunStart), Dest + (RunStart - Offset));
+			if (EFI_ERROR(Status))
+				return Status;
+			Block += Run;
+			continue;
+		}
+
+		/* Read the missing blocks into the cache, stopping before blocks that will be read directly */
+		Run = 1;
+		while (Block + Run <= LastBlock && Run < GRUB_DISK_CACHE_MAX_RUN && Find(Cache, Block + Run) == NULL &&
+				!(Block + Run + 1 <= LastBlock && IsMissingAndCovered(Cache, Block + Run, Offset, End) &&
+				  IsMissingAndCovered(Cache, Block + Run + 1, Offset, End)))
+			Run++;
+		RunStart = Block * GRUB_DISK_CACHE_BLOCK_SIZE;
+		RunEnd = (Block + Run) * GRUB_DISK_CACHE_BLOCK_SIZE;
+		if (RunEnd > Cache->DiskSize)
+			RunEnd = Cache->DiskSize;
+		Status = Cache->Read(Cache->Context, RunStart, (UINTN)(RunEnd - RunStart), Cache->RunBuffer);
+		if (EFI_ERROR(Status))
+			return Status;
+		for (i = 0; i < Run; i++) {
+			UINT64 LineStart = RunStart + i * GRUB_DISK_CACHE_BLOCK_SIZE;
+			UINT32 Length = (UINT32)((RunEnd - LineStart < GRUB_DISK_CACHE_BLOCK_SIZE) ? RunEnd - LineStart : GRUB_DISK_CACHE_BLOCK_SIZE);
+			Insert(Cache, Block + i, Cache->RunBuffer + i * GRUB_DISK_CACHE_BLOCK_SIZE, Length);
+		}
+		CopyStart = (Offset > RunStart) ? Offset : RunStart;
+		CopyEnd = (End < RunEnd) ? End : RunEnd;
+		CopyMem(Dest + (CopyStart - Offset), Cache->RunBuffer + (CopyStart - RunStart), (UINTN)(CopyEnd - CopyStart));
+		Block += Run;
+	}
+	return EFI_SUCCESS;
+}
@@ -0,0 +1,43 @@
+/* disk_cache.h - Sector cache under grub_disk_read */
+/*
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 3 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _GRUBFS_DISK_CACHE_H_
+#define _GRUBFS_DISK_CACHE_H_
+
+/*
+ * The disk is read by aligned blocks of GRUB_DISK_CACHE_BLOCK_SIZE bytes, kept in a
+ * set-associative cache of GRUB_DISK_CACHE_SETS * GRUB_DISK_CACHE_WAYS blocks.
+ * Consecutive missing blocks are read with one request. Blocks entirely covered by a
+ * read of at least 2 blocks (file data) are read directly into the caller's buffer
+ * and are not cached, so they don't evict the file system metadata.
+ */
+#define GRUB_DISK_CACHE_BLOCK_SIZE   8192
+#define GRUB_DISK_CACHE_SETS         64
+#define GRUB_DISK_CACHE_WAYS         4
+/* Maximum number of blocks read into the cache with one request */
+#define GRUB_DISK_CACHE_MAX_RUN      32
+
+/* Reads Size bytes at byte Offset of the disk */
+typedef EFI_STATUS (*GRUB_DISK_CACHE_READ) (VOID *Context, UINT64 Offset, UINTN Size, VOID *Buffer);
+
+typedef struct _GRUB_DISK_CACHE GRUB_DISK_CACHE;
+
+extern GRUB_DISK_CACHE *GrubDiskCacheCreate(GRUB_DISK_CACHE_READ Read, VOID *Context, UINT32 MediaId, UINT64 DiskSize);
+extern VOID GrubDiskCacheFree(GRUB_DISK_CACHE *Cache);
+extern UINT32 GrubDiskCacheMediaId(GRUB_DISK_CACHE *Cache);
+extern EFI_STATUS GrubDiskCacheRead(GRUB_DISK_CACHE *Cache, UINT64 Offset, UINTN Size, VOID *Buffer);
+
+#endif /* _GRUBFS_DISK_CACHE_H_ */
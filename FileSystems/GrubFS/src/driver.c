@@ -23,6 +23,7 @@
 #include <Protocol/ComponentName2.h>
 
 #include "driver.h"
+#include "disk_cache.h"
 
 /* We'll try to instantiate a custom protocol as a mutex, so we need a GUID */
 EFI_GUID *MutexGUID = NULL;
@@ -76,6 +77,12 @@ FSGetControllerName2(EFI_COMPONENT_NAME2_PROTOCOL *This,
 
 static VOID
 FreeFsInstance(EFI_FS *Instance) {
+    if (Instance->DiskCache != NULL)
+    {
+        GrubDiskCacheFree(Instance->DiskCache);
+        Instance->DiskCache = NULL;
+    }
+
     if (Instance->DevicePathString != NULL)
     {
         FreePool(Instance->DevicePathString);
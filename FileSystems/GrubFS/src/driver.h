@@ -142,6 +142,7 @@ typedef struct _EFI_FS {
 	EFI_GRUB_FILE         *RootFile;
 	VOID                  *GrubDevice;
 	CHAR16                *DevicePathString;
+	struct _GRUB_DISK_CACHE *DiskCache;
 } EFI_FS;
 
 /* Mirrors a similar construct from GRUB, while EFI-zing it */
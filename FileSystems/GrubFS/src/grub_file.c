@@ -26,6 +26,7 @@
 #include <grub/file.h>
 
 #include "driver.h"
+#include "disk_cache.h"
 
 /* The file system list should only ever contain one element */
 grub_fs_t grub_fs_list = NULL;
@@ -137,6 +138,26 @@ grub_device_iterate(grub_device_iterate_hook_t hook, void *hook_data)
 */
 grub_disk_read_hook_t grub_file_progress_hook = NULL;
 
+static EFI_STATUS
+GrubDiskReadDevice(VOID *Context, UINT64 Offset, UINTN Size, VOID *Buffer)
+{
+	EFI_FS* FileSystem = (EFI_FS *) Context;
+	EFI_BLOCK_IO_MEDIA *Media;
+
+	if (FileSystem->BlockIo2 != NULL)
+	{
+		Media = FileSystem->BlockIo2->Media;
+	} else {
+		Media = FileSystem->BlockIo->Media;
+	}
+	if (FileSystem->DiskIo2 != NULL)
+	{
+		return FileSystem->DiskIo2->ReadDiskEx(FileSystem->DiskIo2, Media->MediaId,
+				Offset, &(FileSystem->DiskIo2Token), Size, Buffer);
+	}
+	return FileSystem->DiskIo->ReadDisk(FileSystem->DiskIo, Media->MediaId, Offset, Size, Buffer);
+}
+
 grub_err_t
 grub_disk_read(grub_disk_t disk, grub_disk_addr_t sector,
 		grub_off_t offset, grub_size_t size, void *buf)
@@ -160,17 +181,23 @@ grub_disk_read(grub_disk_t disk, grub_disk_addr_t sector,
     } else {
       Media = FileSystem->BlockIo->Media;
     }
+	/* The media changed : what is cached is from another disk */
+	if (FileSystem->DiskCache != NULL && GrubDiskCacheMediaId(FileSystem->DiskCache) != Media->MediaId) {
+		GrubDiskCacheFree(FileSystem->DiskCache);
+		FileSystem->DiskCache = NULL;
+	}
+	if (FileSystem->DiskCache == NULL) {
+		FileSystem->DiskCache = GrubDiskCacheCreate(GrubDiskReadDevice, FileSystem, Media->MediaId,
+				MultU64x32(Media->LastBlock + 1, Media->BlockSize));
+	}
 	/* NB: We could get the actual blocksize through FileSystem->BlockIo->Media->BlockSize
 	 * but GRUB uses the fixed GRUB_DISK_SECTOR_SIZE, so we follow suit
 	 */
-    if (FileSystem->DiskIo2 != NULL)
-    {
-      Status = FileSystem->DiskIo2->ReadDiskEx(FileSystem->DiskIo2, Media->MediaId,
-                                               sector * GRUB_DISK_SECTOR_SIZE + offset, &(FileSystem->DiskIo2Token), size, buf);
-    } else {
-        Status = FileSystem->DiskIo->ReadDisk(FileSystem->DiskIo, Media->MediaId,
-			sector * GRUB_DISK_SECTOR_SIZE + offset, size, buf);
-    }
+	if (FileSystem->DiskCache != NULL) {
+		Status = GrubDiskCacheRead(FileSystem->DiskCache, sector * GRUB_DISK_SECTOR_SIZE + offset, size, buf);
+	} else {
+		Status = GrubDiskReadDevice(FileSystem, sector * GRUB_DISK_SECTOR_SIZE + offset, size, buf);
+	}
 
 	if (EFI_ERROR(Status)) {
 		PrintStatusError(Status, L"Could not read block at address %08x", sector);
@@ -61,9 +61,13 @@ const char* fsw_errors[] = {
 
 // functions
 
+static void fsw_blockcache_init(struct fsw_volume *vol);
 static void fsw_blockcache_free(struct fsw_volume *vol);
 
-#define MAX_CACHE_LEVEL (5)
+#define MAX_CACHE_LEVEL (FSW_BCACHE_LEVELS - 1)
+
+/** End of a hash bucket or LRU list. */
+#define BCACHE_NONE ((fsw_u32)~0UL)
 
 
 /**
@@ -101,6 +105,8 @@ fsw_status_t fsw_mount(void *host_data,
     vol->host_table     = host_table;
     vol->fstype_table   = fstype_table;
     vol->host_string_type = host_table->native_string_type;
+    vol->bcache_max     = FSW_BCACHE_MAX_ENTRIES;
+    fsw_blockcache_init(vol);
 
     // let the fs driver mount the file system
     status = vol->fstype_table->volume_mount(vol);
@@ -186,6 +192,216 @@ void fsw_set_blocksize_(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32
     vol->log_blocksize = log_blocksize;
 }
 
+static fsw_u32 fsw_bcache_bucket(struct fsw_volume *vol, fsw_u32 phys_bno)
+{
+  return (fsw_u32)((phys_bno ^ (phys_bno >> 16)) & (vol->bcache_size - 1));
+}
+
+static fsw_u32 fsw_bcache_find(struct fsw_volume *vol, fsw_u32 phys_bno)
+{
+  fsw_u32 i;
+
+  if (vol->bcache_size == 0)
+    return BCACHE_NONE;
+  for (i = vol->bcache_hash[fsw_bcache_bucket(vol, phys_bno)]; i != BCACHE_NONE; i = vol->bcache[i].hash_next) {
+    if (vol->bcache[i].phys_bno == phys_bno)
+      return i;
+  }
+  return BCACHE_NONE;
+}
+
+static void fsw_bcache_hash_insert(struct fsw_volume *vol, fsw_u32 i)
+{
+  fsw_u32 bucket = fsw_bcache_bucket(vol, vol->bcache[i].phys_bno);
+
+  vol->bcache[i].hash_next = vol->bcache_hash[bucket];
+  vol->bcache_hash[bucket] = i;
+}
+
+static void fsw_bcache_hash_remove(struct fsw_volume *vol, fsw_u32 i)
+{
+  fsw_u32 *link = &vol->bcache_hash[fsw_bcache_bucket(vol, vol->bcache[i].phys_bno)];
+
+  while (*link != BCACHE_NONE) {
+    if (*link == i) {
+      *link = vol->bcache[i].hash_next;
+      break;
+    }
+    link = &vol->bcache[*link].hash_next;
+  }
+  vol->bcache[i].hash_next = BCACHE_NONE;
+}
+
+static void fsw_bcache_lru_remove(struct fsw_volume *vol, fsw_u32 i)
+{
+  struct fsw_blockcache *entry = &vol->bcache[i];
+
+  if (entry->lru_prev != BCACHE_NONE)
+    vol->bcache[entry->lru_prev].lru_next = entry->lru_next;
+  else
+    vol->bcache_lru_head[entry->cache_level] = entry->lru_next;
+  if (entry->lru_next != BCACHE_NONE)
+    vol->bcache[entry->lru_next].lru_prev = entry->lru_prev;
+  else
+    vol->bcache_lru_tail[entry->cache_level] = entry->lru_prev;
+  entry->lru_prev = entry->lru_next = BCACHE_NONE;
+}
+
+/**
+ * Insert an unreferenced entry in the LRU list of its level. Empty entries are inserted
+ * at the tail, so they are reused first.
+ */
+
+static void fsw_bcache_lru_insert(struct fsw_volume *vol, fsw_u32 i, int at_tail)
+{
+  struct fsw_blockcache *entry = &vol->bcache[i];
+  fsw_u32 level = entry->cache_level;
+
+  if (at_tail) {
+    entry->lru_prev = vol->bcache_lru_tail[level];
+    entry->lru_next = BCACHE_NONE;
+    if (entry->lru_prev != BCACHE_NONE)
+      vol->bcache[entry->lru_prev].lru_next = i;
+    else
+      vol->bcache_lru_head[level] = i;
+    vol->bcache_lru_tail[level] = i;
+  } else {
+    entry->lru_prev = BCACHE_NONE;
+    entry->lru_next = vol->bcache_lru_head[level];
+    if (entry->lru_next != BCACHE_NONE)
+      vol->bcache[entry->lru_next].lru_prev = i;
+    else
+      vol->bcache_lru_tail[level] = i;
+    vol->bcache_lru_head[level] = i;
+  }
+}
+
+/**
+ * Double the size of the block cache. New entries are empty and go in the level 0 LRU list.
+ */
+
+static fsw_status_t fsw_bcache_grow(struct fsw_volume *vol)
+{
+  fsw_status_t    status;
+  fsw_u32         i, old_bcache_size, new_bcache_size;
+  struct fsw_blockcache *new_bcache = NULL;
+  fsw_u32         *new_hash = NULL;
+
+  if (vol->bcache_size < 16)
+    new_bcache_size = 16;
+  else
+    new_bcache_size = vol->bcache_size << 1;
+  status = fsw_alloc(new_bcache_size * sizeof(struct fsw_blockcache), &new_bcache);
+  if (status)
+    return status;
+  status = fsw_alloc(new_bcache_size * sizeof(fsw_u32), &new_hash);
+  if (status) {
+    fsw_free(new_bcache);
+    return status;
+  }
+  if (vol->bcache_size > 0) {
+    fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
+  }
+  for (i = vol->bcache_size; i < new_bcache_size; i++) {
+    new_bcache[i].refcount = 0;
+    new_bcache[i].cache_level = 0;
+    new_bcache[i].phys_bno = (fsw_u32)FSW_INVALID_BNO;
+    new_bcache[i].data = NULL;
+    new_bcache[i].hash_next = BCACHE_NONE;
+  }
+
+  // switch caches
+  if (vol->bcache != NULL)
+    fsw_free(vol->bcache);
+  if (vol->bcache_hash != NULL)
+    fsw_free(vol->bcache_hash);
+  vol->bcache = new_bcache;
+  vol->bcache_hash = new_hash;
+  old_bcache_size = vol->bcache_size;
+  vol->bcache_size = new_bcache_size;
+
+  // rehash
+  for (i = 0; i < new_bcache_size; i++)
+    new_hash[i] = BCACHE_NONE;
+  for (i = 0; i < new_bcache_size; i++) {
+    if (new_bcache[i].phys_bno != (fsw_u32)FSW_INVALID_BNO)
+      fsw_bcache_hash_insert(vol, i);
+  }
+  for (i = old_bcache_size; i < new_bcache_size; i++)
+    fsw_bcache_lru_insert(vol, i, 1);
+  return FSW_SUCCESS;
+}
+
+/**
+ * Get an entry to put a new block in. The entry is removed from the LRU lists and from the hash,
+ * its phys_bno is FSW_INVALID_BNO. The cache grows up to bcache_max entries, then the least recently
+ * used unreferenced block of the lowest cache level is discarded. If all blocks are in use, the
+ * cache grows anyway.
+ */
+
+static fsw_status_t fsw_bcache_get_entry(struct fsw_volume *vol, fsw_u32 *i_out)
+{
+  fsw_status_t    status;
+  fsw_u32         i, discard_level;
+
+  i = vol->bcache_lru_tail[0];
+  if (i == BCACHE_NONE || vol->bcache[i].phys_bno != (fsw_u32)FSW_INVALID_BNO) {
+    // no empty entry
+    if (vol->bcache_size < vol->bcache_max) {
+      status = fsw_bcache_grow(vol);
+      if (status)
+        return status;
+    }
+    for (discard_level = 0; discard_level <= MAX_CACHE_LEVEL; discard_level++) {
+      i = vol->bcache_lru_tail[discard_level];
+      if (i != BCACHE_NONE)
+        break;
+    }
+    if (i == BCACHE_NONE) {
+      // everything is referenced
+      status = fsw_bcache_grow(vol);
+      if (status)
+        return status;
+      i = vol->bcache_lru_tail[0];
+    }
+  }
+  fsw_bcache_lru_remove(vol, i);
+  if (vol->bcache[i].phys_bno != (fsw_u32)FSW_INVALID_BNO) {
+    fsw_bcache_hash_remove(vol, i);
+    vol->bcache[i].phys_bno = (fsw_u32)FSW_INVALID_BNO;
+  }
+  vol->bcache[i].cache_level = 0;
+
+  if (vol->bcache[i].data == NULL) {
+    status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
+    if (status) {
+      fsw_bcache_lru_insert(vol, i, 1);
+      return status;
+    }
+  }
+  *i_out = i;
+  return FSW_SUCCESS;
+}
+
+/**
+ * Read contiguous physical blocks with a single request if the host driver supports it.
+ */
+
+static fsw_status_t fsw_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u8 *buffer)
+{
+  fsw_status_t    status;
+  fsw_u32         i;
+
+  if (vol->host_table->read_blocks != NULL)
+    return vol->host_table->read_blocks(vol, phys_bno, count, buffer);
+  for (i = 0; i < count; i++) {
+    status = vol->host_table->read_block(vol, phys_bno + i, buffer + i * vol->phys_blocksize);
+    if (status)
+      return status;
+  }
+  return FSW_SUCCESS;
+}
+
 /**
  * Get a block of data from the disk. This function is called by the file system driver
  * or by core functions. It calls through to the host driver's device access routine.
@@ -206,8 +422,7 @@ void fsw_set_blocksize_(struct fsw_volume *vol, fsw_u32 phys_blocksize, fsw_u32
 fsw_status_t fsw_block_get_(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32 cache_level, void **buffer_out)
 {
   fsw_status_t    status;
-  fsw_u32         i, discard_level, new_bcache_size;
-  struct fsw_blockcache *new_bcache = NULL;
+  fsw_u32         i;
   
   // TODO: allow the host driver to do its own caching; just call through if
   //  the appropriate function pointers are set
@@ -216,81 +431,86 @@ fsw_status_t fsw_block_get_(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, fsw_u32
     cache_level = MAX_CACHE_LEVEL;
   
   // check block cache
-  for (i = 0; i < vol->bcache_size; i++) {
-    if (vol->bcache[i].phys_bno == phys_bno) {
-      // cache hit!
-      if (vol->bcache[i].cache_level < cache_level)
-        vol->bcache[i].cache_level = cache_level;  // promote the entry
-      vol->bcache[i].refcount++;
-      *buffer_out = vol->bcache[i].data;
-      return FSW_SUCCESS;
-    }
+  i = fsw_bcache_find(vol, phys_bno);
+  if (i != BCACHE_NONE) {
+    // cache hit!
+    if (vol->bcache[i].refcount == 0)
+      fsw_bcache_lru_remove(vol, i);
+    if (vol->bcache[i].cache_level < cache_level)
+      vol->bcache[i].cache_level = cache_level;  // promote the entry
+    vol->bcache[i].refcount++;
+    *buffer_out = vol->bcache[i].data;
+    return FSW_SUCCESS;
   }
   
-  // find a free entry in the cache table
-  for (i = 0; i < vol->bcache_size; i++) {
-    if (vol->bcache[i].phys_bno == (fsw_u32)FSW_INVALID_BNO)
-      break;
-  }
-  if (i >= vol->bcache_size) {
-    for (discard_level = 0; discard_level <= MAX_CACHE_LEVEL; discard_level++) {
-      for (i = 0; i < vol->bcache_size; i++) {
-        if (vol->bcache[i].refcount == 0 && vol->bcache[i].cache_level <= discard_level)
-          break;
-      }
-      if (i < vol->bcache_size)
-        break;
-    }
-  }
-  if (i >= vol->bcache_size) {
-    // enlarge / create the cache
-    if (vol->bcache_size < 16)
-      new_bcache_size = 16;
-    else
-      new_bcache_size = vol->bcache_size << 1;
-    status = fsw_alloc(new_bcache_size * sizeof(struct fsw_blockcache), &new_bcache);
-    if (status != FSW_SUCCESS) {
-      if (new_bcache) {
-        fsw_free(new_bcache);
-      }
-      return status;
-    }
-    if (vol->bcache_size > 0) {
-      fsw_memcpy(new_bcache, vol->bcache, vol->bcache_size * sizeof(struct fsw_blockcache));
-    }
-    for (i = vol->bcache_size; i < new_bcache_size; i++) {
-      new_bcache[i].refcount = 0;
-      new_bcache[i].cache_level = 0;
-      new_bcache[i].phys_bno = (fsw_u32)FSW_INVALID_BNO;
-      new_bcache[i].data = NULL;
-    }
-    i = vol->bcache_size;
-    
-    // switch caches
-    if (vol->bcache != NULL)
-      fsw_free(vol->bcache);
-    vol->bcache = new_bcache;
-    vol->bcache_size = new_bcache_size;
-  }
-  vol->bcache[i].phys_bno = (fsw_u32)FSW_INVALID_BNO;
+  status = fsw_bcache_get_entry(vol, &i);
+  if (status)
+    return status;
   
   // read the data
-  if (vol->bcache[i].data == NULL) {
-    status = fsw_alloc(vol->phys_blocksize, &vol->bcache[i].data);
-    if (status)
-      return status;
-  }
   status = vol->host_table->read_block(vol, phys_bno, vol->bcache[i].data);
-  if (status)
+  if (status) {
+    fsw_bcache_lru_insert(vol, i, 1);
     return status;
+  }
   
   vol->bcache[i].phys_bno = phys_bno;
   vol->bcache[i].cache_level = cache_level;
   vol->bcache[i].refcount = 1;
+  fsw_bcache_hash_insert(vol, i);
   *buffer_out = vol->bcache[i].data;
   return FSW_SUCCESS;
 }
 
+/**
+ * Read up to count blocks starting at phys_bno into the cache with one disk request.
+ * Stops at the first block already in the cache. Errors are ignored : fsw_block_get
+ * will read the block again and report the error.
+ */
+
+static void fsw_block_readahead(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, fsw_u32 cache_level)
+{
+  fsw_status_t    status;
+  fsw_u32         n, k, entries[FSW_READAHEAD_BLOCKS];
+
+  if (count > FSW_READAHEAD_BLOCKS)
+    count = FSW_READAHEAD_BLOCKS;
+  if (count > vol->bcache_max / 4)
+    count = vol->bcache_max / 4;
+  for (n = 0; n < count; n++) {
+    if (fsw_bcache_find(vol, phys_bno + n) != BCACHE_NONE)
+      break;
+  }
+  if (n < 2)
+    return;
+  
+  if (vol->bcache_ra_buffer == NULL) {
+    status = fsw_alloc(FSW_READAHEAD_BLOCKS * vol->phys_blocksize, &vol->bcache_ra_buffer);
+    if (status)
+      return;
+  }
+  status = fsw_read_blocks(vol, phys_bno, n, vol->bcache_ra_buffer);
+  if (status)
+    return;
+  
+  // entries are held while filling, so they don't discard each other
+  for (k = 0; k < n; k++) {
+    status = fsw_bcache_get_entry(vol, &entries[k]);
+    if (status)
+      break;
+    vol->bcache[entries[k]].refcount = 1;
+  }
+  n = k;
+  for (k = 0; k < n; k++) {
+    fsw_memcpy(vol->bcache[entries[k]].data, (fsw_u8 *)vol->bcache_ra_buffer + k * vol->phys_blocksize, vol->phys_blocksize);
+    vol->bcache[entries[k]].phys_bno = phys_bno + k;
+    vol->bcache[entries[k]].cache_level = cache_level;
+    vol->bcache[entries[k]].refcount = 0;
+    fsw_bcache_hash_insert(vol, entries[k]);
+    fsw_bcache_lru_insert(vol, entries[k], 0);
+  }
+}
+
 /**
  * Releases a disk block. This function must be called to release disk blocks returned
  * from fsw_block_get.
@@ -307,9 +527,30 @@ void fsw_block_release_(struct VOLSTRUCTNAME *vol, fsw_u32 phys_bno, void *buffe
   //  the appropriate function pointers are set
   
   // update block cache
-  for (i = 0; i < vol->bcache_size; i++) {
-    if (vol->bcache[i].phys_bno == phys_bno && vol->bcache[i].refcount > 0)
-      vol->bcache[i].refcount--;
+  i = fsw_bcache_find(vol, phys_bno);
+  if (i != BCACHE_NONE && vol->bcache[i].refcount > 0) {
+    vol->bcache[i].refcount--;
+    if (vol->bcache[i].refcount == 0)
+      fsw_bcache_lru_insert(vol, i, 0);
+  }
+}
+
+/**
+ * Set up an empty block cache. Called when mounting and after the cache has been released.
+ */
+
+static void fsw_blockcache_init(struct fsw_volume *vol)
+{
+  fsw_u32 level;
+
+  vol->bcache = NULL;
+  vol->bcache_size = 0;
+  vol->bcache_hash = NULL;
+  vol->bcache_ra_next = (fsw_u32)FSW_INVALID_BNO;
+  vol->bcache_ra_buffer = NULL;
+  for (level = 0; level <= MAX_CACHE_LEVEL; level++) {
+    vol->bcache_lru_head[level] = BCACHE_NONE;
+    vol->bcache_lru_tail[level] = BCACHE_NONE;
   }
 }
 
@@ -331,9 +572,14 @@ static void fsw_blockcache_free(struct fsw_volume *vol)
   }
   if (vol->bcache != NULL) {
     fsw_free(vol->bcache);
-    vol->bcache = NULL;
   }
-  vol->bcache_size = 0;
+  if (vol->bcache_hash != NULL) {
+    fsw_free(vol->bcache_hash);
+  }
+  if (vol->bcache_ra_buffer != NULL) {
+    fsw_free(vol->bcache_ra_buffer);
+  }
+  fsw_blockcache_init(vol);
 }
 
 /**
@@ -1043,6 +1289,36 @@ void fsw_shandle_close(struct fsw_shandle *shand)
   fsw_dnode_release(shand->dnode);
 }
 
+/**
+ * Number of physical blocks contiguous on disk from phys_bno, the first blocks_in_extent of them
+ * being in the current extent. The following extents of the file are only looked at, up to
+ * FSW_READAHEAD_BLOCKS : shand->extent is not changed. File systems like ext2 return one block
+ * per extent, the readahead would never go past the current block without this.
+ */
+
+static fsw_u32 fsw_shandle_contiguous_blocks(struct fsw_shandle *shand, fsw_u32 phys_bno, fsw_u32 blocks_in_extent)
+{
+  struct fsw_dnode *dno = shand->dnode;
+  struct fsw_volume *vol = dno->vol;
+  struct fsw_extent extent;
+  
+  extent.log_start = shand->extent.log_start + shand->extent.log_count;
+  extent.buffer = NULL;
+  while (blocks_in_extent < FSW_READAHEAD_BLOCKS &&
+         (fsw_u64)extent.log_start * vol->log_blocksize < dno->size) {
+    extent.type = FSW_EXTENT_TYPE_INVALID;
+    if (vol->fstype_table->get_extent(vol, dno, &extent))
+      break;
+    if (extent.type == FSW_EXTENT_TYPE_BUFFER)
+      fsw_free(extent.buffer);
+    if (extent.type != FSW_EXTENT_TYPE_PHYSBLOCK || extent.phys_start != phys_bno + blocks_in_extent)
+      break;
+    blocks_in_extent += (fsw_u32)((fsw_u64)extent.log_count * vol->log_blocksize / vol->phys_blocksize);
+    extent.log_start += extent.log_count;
+  }
+  return blocks_in_extent;
+}
+
 /**
  * Read data from a shandle (storage handle for a dnode). This function is called by the
  * host driver or internally when data is read from a file. TODO: more
@@ -1056,7 +1332,7 @@ fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_in
   fsw_u8          *buffer, *block_buffer;
   fsw_u32         buflen, copylen, pos;
   fsw_u32         log_bno, pos_in_extent, phys_bno, pos_in_physblock;
-  fsw_u32         cache_level;
+  fsw_u32         cache_level, blocks_in_extent, count;
   
   if (shand->pos >= dno->size) {   // already at EOF
     *buffer_size_inout = 0;
@@ -1098,18 +1374,55 @@ fsw_status_t fsw_shandle_read(struct fsw_shandle *shand, fsw_u32 *buffer_size_in
       // convert to physical block number and offset
       phys_bno = shand->extent.phys_start + pos_in_extent / vol->phys_blocksize;
       pos_in_physblock = pos_in_extent & (vol->phys_blocksize - 1);
-      copylen = vol->phys_blocksize - pos_in_physblock;
-      if (copylen > buflen)
-        copylen = buflen;
+      // physical blocks left in the extent, from phys_bno
+      blocks_in_extent = (fsw_u32)(((fsw_u64)shand->extent.log_count * vol->log_blocksize - (pos_in_extent - pos_in_physblock)) / vol->phys_blocksize);
       
-      // get one physical block
-      status = fsw_block_get(vol, phys_bno, cache_level, (void **)&block_buffer);
-      if (status)
-        return status;
-      
-      // copy data from it
-      fsw_memcpy(buffer, block_buffer + pos_in_physblock, copylen);
-      fsw_block_release(vol, phys_bno, block_buffer);
+      if (pos_in_physblock == 0 && buflen >= 2 * vol->phys_blocksize) {
+        // whole blocks : read them directly into the caller's buffer. The following extents
+        // are fetched now, so blocks contiguous on disk are read with one disk request.
+        count = buflen / vol->phys_blocksize;
+        if (count > blocks_in_extent)
+          count = blocks_in_extent;
+        while (count == blocks_in_extent && count < buflen / vol->phys_blocksize) {
+          shand->extent.log_start += shand->extent.log_count;
+          status = vol->fstype_table->get_extent(vol, dno, &shand->extent);
+          if (status) {
+            shand->extent.type = FSW_EXTENT_TYPE_INVALID;
+            return status;
+          }
+          // if not contiguous, the extent is kept for the next iteration
+          if (shand->extent.type != FSW_EXTENT_TYPE_PHYSBLOCK || shand->extent.phys_start != phys_bno + blocks_in_extent)
+            break;
+          blocks_in_extent += (fsw_u32)((fsw_u64)shand->extent.log_count * vol->log_blocksize / vol->phys_blocksize);
+          count = buflen / vol->phys_blocksize;
+          if (count > blocks_in_extent)
+            count = blocks_in_extent;
+        }
+        status = fsw_read_blocks(vol, phys_bno, count, buffer);
+        if (status)
+          return status;
+        copylen = count * vol->phys_blocksize;
+        vol->bcache_ra_next = phys_bno + count;
+        
+      } else {
+        copylen = vol->phys_blocksize - pos_in_physblock;
+        if (copylen > buflen)
+          copylen = buflen;
+        
+        // file read sequentially in small chunks : fill the cache with the next blocks of the file
+        if (cache_level == 0 && phys_bno == vol->bcache_ra_next && fsw_bcache_find(vol, phys_bno) == BCACHE_NONE)
+          fsw_block_readahead(vol, phys_bno, fsw_shandle_contiguous_blocks(shand, phys_bno, blocks_in_extent), cache_level);
+        vol->bcache_ra_next = phys_bno + 1;
+        
+        // get one physical block
+        status = fsw_block_get(vol, phys_bno, cache_level, (void **)&block_buffer);
+        if (status)
+          return status;
+        
+        // copy data from it
+        fsw_memcpy(buffer, block_buffer + pos_in_physblock, copylen);
+        fsw_block_release(vol, phys_bno, block_buffer);
+      }
       
     } else if (shand->extent.type == FSW_EXTENT_TYPE_BUFFER) {
       copylen = shand->extent.log_count * vol->log_blocksize - pos_in_extent;
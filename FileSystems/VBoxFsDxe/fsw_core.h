@@ -78,6 +78,17 @@ extern const char* fsw_errors[];
 /** Indicates that the block cache entry is empty. */
 #define FSW_INVALID_BNO (~0UL)
 
+/** Number of block cache levels. fsw_block_get clamps cache_level to FSW_BCACHE_LEVELS-1. */
+#define FSW_BCACHE_LEVELS (6)
+/** Default bound of the block cache, in blocks. The host driver can change vol->bcache_max after mounting. */
+#ifndef FSW_BCACHE_MAX_ENTRIES
+#define FSW_BCACHE_MAX_ENTRIES (512)
+#endif
+/** Maximum number of file data blocks read in advance when a file is read sequentially in small chunks. */
+#ifndef FSW_READAHEAD_BLOCKS
+#define FSW_READAHEAD_BLOCKS (32)
+#endif
+
 #define USE_FULL_LOWERCASE 0
 //
 // Byte-swapping macros
@@ -251,11 +262,20 @@ struct fsw_dnode;
 struct fsw_host_table;
 struct fsw_fstype_table;
 
+/**
+ * Core: Block cache entry. Entries are found by hashing the physical block number.
+ * Unreferenced entries are kept in one LRU list per cache level, so the entry to
+ * reuse is found without scanning the cache.
+ */
+
 struct fsw_blockcache {
     fsw_u32     refcount;           //!< Reference count
     fsw_u32     cache_level;        //!< Level of importance of this block
     fsw_u32     phys_bno;           //!< Physical block number
     void        *data;              //!< Block data buffer
+    fsw_u32     hash_next;          //!< Next entry in the same hash bucket
+    fsw_u32     lru_prev;           //!< Previous (more recently used) entry in the LRU list, if refcount is 0
+    fsw_u32     lru_next;           //!< Next (less recently used) entry in the LRU list, if refcount is 0
 };
 
 /**
@@ -273,6 +293,12 @@ struct fsw_volume {
 
     struct fsw_blockcache *bcache;  //!< Array of block cache entries
     fsw_u32     bcache_size;        //!< Number of entries in the block cache array
+    fsw_u32     bcache_max;         //!< Size above which blocks are discarded instead of growing the cache (unless all are in use)
+    fsw_u32     *bcache_hash;       //!< Hash buckets (bcache_size of them), index of the first entry
+    fsw_u32     bcache_lru_head[FSW_BCACHE_LEVELS]; //!< Most recently released entry, per cache level
+    fsw_u32     bcache_lru_tail[FSW_BCACHE_LEVELS]; //!< Least recently released entry, per cache level
+    fsw_u32     bcache_ra_next;     //!< Physical block following the last file data block read, for readahead
+    void        *bcache_ra_buffer;  //!< Buffer for multi-block reads into the cache
 
     void        *host_data;         //!< Hook for a host-specific data structure
     struct fsw_host_table *host_table;      //!< Dispatch table for host-specific functions
@@ -392,6 +418,7 @@ struct fsw_host_table
                                      fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                                      fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
     fsw_status_t (*read_block)(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+    fsw_status_t (*read_blocks)(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer); //!< Optional, NULL to read the blocks one by one
 };
 
 /**
@@ -104,6 +104,7 @@ void fsw_efi_change_blocksize(struct fsw_volume *vol,
                               fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                               fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
 fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+fsw_status_t fsw_efi_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
 
 EFI_STATUS fsw_efi_map_status(fsw_status_t fsw_status, FSW_VOLUME_DATA *Volume);
 
@@ -181,7 +182,8 @@ struct fsw_host_table   fsw_efi_host_table = {
     FSW_STRING_TYPE_UTF16,
 
     fsw_efi_change_blocksize,
-    fsw_efi_read_block
+    fsw_efi_read_block,
+    fsw_efi_read_blocks
 };
 
 extern struct fsw_fstype_table FSW_FSTYPE_TABLE_NAME (
@@ -563,20 +565,30 @@ void fsw_efi_change_blocksize(struct fsw_volume *vol,
  */
 
 fsw_status_t fsw_efi_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer)
+{
+    return fsw_efi_read_blocks(vol, phys_bno, 1, buffer);
+}
+
+/**
+ * FSW interface function for reading contiguous physical blocks with one disk request.
+ */
+
+fsw_status_t fsw_efi_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer)
 {
     EFI_STATUS          Status;
     FSW_VOLUME_DATA     *Volume = (FSW_VOLUME_DATA *)vol->host_data;
+    UINTN               Size = (UINTN)count * vol->phys_blocksize;
 
-//    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_efi_read_block: %d  (%d)\n"), phys_bno, vol->phys_blocksize));
+//    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_efi_read_blocks: %d  %d  (%d)\n"), phys_bno, count, vol->phys_blocksize));
 
     // read from disk
     if (Volume->DiskIo2 != NULL)
     {
-      Status = Volume->DiskIo2->ReadDiskEx(Volume->DiskIo2, Volume->MediaId, (UINT64)phys_bno * vol->phys_blocksize, &(Volume->DiskIo2Token), vol->phys_blocksize, buffer);
+      Status = Volume->DiskIo2->ReadDiskEx(Volume->DiskIo2, Volume->MediaId, (UINT64)phys_bno * vol->phys_blocksize, &(Volume->DiskIo2Token), Size, buffer);
     } else {
       Status = Volume->DiskIo->ReadDisk(Volume->DiskIo, Volume->MediaId,
                                       (UINT64)phys_bno * vol->phys_blocksize,
-                                      vol->phys_blocksize,
+                                      Size,
                                       buffer);
     }
 
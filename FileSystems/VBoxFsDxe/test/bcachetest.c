@@ -0,0 +1,215 @@
+/**
+ * \file bcachetest.c
+ * Test program for the block cache, multi-block reads and readahead of fsw_core.
+ */
+
+/*
+ * Each file is read from the image twice :
+ *  - with the cache : default bcache_max, multi-block reads and readahead,
+ *  - without it : bcache_max below the first allocation, so the cache stays at 16 entries and
+ *    readahead is off, and read_blocks removed from the host table, so blocks are read one by one.
+ * Both must give the content of the reference copy of the file, read sequentially with several chunk
+ * sizes and at random positions. The cache must also at least halve the disk reads of sequential reads of big files.
+ */
+
+#include "fsw_posix.h"
+
+
+extern struct fsw_fstype_table FSW_FSTYPE_TABLE_NAME(FSTYPE);
+extern struct fsw_host_table fsw_posix_host_table;
+
+static fsw_status_t (*host_read_block)(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+static fsw_status_t (*host_read_blocks)(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
+static unsigned long disk_reads;
+
+static fsw_status_t counting_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer)
+{
+    disk_reads++;
+    return host_read_block(vol, phys_bno, buffer);
+}
+
+static fsw_status_t counting_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer)
+{
+    disk_reads++;
+    return host_read_blocks(vol, phys_bno, count, buffer);
+}
+
+static const size_t chunk_sizes[] = { 1, 100, 511, 1024, 4096, 5000, 65536, 1024*1024, 3*1024*1024 };
+#define NB_CHUNK_SIZES (sizeof(chunk_sizes) / sizeof(chunk_sizes[0]))
+#define NB_RANDOM_READS (500)
+
+static int failures;
+
+static struct fsw_posix_volume *mount_image(const char *image, int cached)
+{
+    struct fsw_posix_volume *pvol;
+
+    fsw_posix_host_table.read_blocks = cached ? counting_read_blocks : NULL;
+    pvol = fsw_posix_mount(image, &FSW_FSTYPE_TABLE_NAME(FSTYPE));
+    if (pvol == NULL)
+        return NULL;
+    if (!cached)
+        pvol->vol->bcache_max = 4;
+    return pvol;
+}
+
+static unsigned char *load_reference(const char *path, size_t *size_out)
+{
+    FILE *f;
+    long size;
+    unsigned char *data;
+
+    f = fopen(path, "rb");
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = malloc(size + 1);
+    if (data != NULL && fread(data, 1, size, f) != (size_t)size) {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size_out = size;
+    return data;
+}
+
+/**
+ * Read the whole file chunk by chunk, compare with the reference. Returns the number of disk reads.
+ */
+
+static unsigned long read_sequential(struct fsw_posix_volume *pvol, const char *path, size_t chunk,
+                                     const unsigned char *ref, size_t ref_size, unsigned char *buf)
+{
+    struct fsw_posix_file *file;
+    size_t pos = 0;
+    ssize_t r;
+    unsigned long start_reads = disk_reads;
+
+    file = fsw_posix_open(pvol, path, 0, 0);
+    if (file == NULL) {
+        printf("  open(%s) failed\n", path);
+        failures++;
+        return 0;
+    }
+    while ((r = fsw_posix_read(file, buf, chunk)) > 0) {
+        if (pos + r > ref_size || memcmp(buf, ref + pos, r) != 0) {
+            printf("  %s, chunk %zu : wrong data at %zu\n", path, chunk, pos);
+            failures++;
+            break;
+        }
+        pos += r;
+    }
+    if (r < 0) {
+        printf("  %s, chunk %zu : read error at %zu\n", path, chunk, pos);
+        failures++;
+    } else if (r == 0 && pos != ref_size) {
+        printf("  %s, chunk %zu : %zu bytes read instead of %zu\n", path, chunk, pos, ref_size);
+        failures++;
+    }
+    fsw_posix_close(file);
+    return disk_reads - start_reads;
+}
+
+/**
+ * Seek to random positions, sometimes past the end, read random lengths, compare with the reference.
+ */
+
+static void read_random(struct fsw_posix_volume *pvol, const char *path, unsigned int seed,
+                        const unsigned char *ref, size_t ref_size, unsigned char *buf, size_t buf_size)
+{
+    struct fsw_posix_file *file;
+    size_t pos, len, expected;
+    ssize_t r;
+    int i;
+
+    file = fsw_posix_open(pvol, path, 0, 0);
+    if (file == NULL) {
+        printf("  open(%s) failed\n", path);
+        failures++;
+        return;
+    }
+    srand(seed);
+    for (i = 0; i < NB_RANDOM_READS; i++) {
+        pos = (size_t)rand() % (ref_size + 4096);
+        if (rand() % 4 == 0)
+            len = (size_t)rand() % buf_size;  // large, goes through the multi-block read
+        else
+            len = (size_t)rand() % 10000;
+        fsw_posix_lseek(file, pos, SEEK_SET);
+        r = fsw_posix_read(file, buf, len);
+        expected = pos >= ref_size ? 0 : (ref_size - pos < len ? ref_size - pos : len);
+        if (r != (ssize_t)expected || memcmp(buf, ref + (pos < ref_size ? pos : 0), expected) != 0) {
+            printf("  %s, seed %u : wrong read of %zu bytes at %zu\n", path, seed, len, pos);
+            failures++;
+            break;
+        }
+    }
+    fsw_posix_close(file);
+}
+
+int main(int argc, char **argv)
+{
+    struct fsw_posix_volume *pvol;
+    unsigned char *ref, *buf;
+    size_t ref_size, buf_size = 4*1024*1024;
+    unsigned long reads[2][NB_CHUNK_SIZES];
+    char ref_path[4096], path[4096];
+    int cached, argi;
+    size_t c;
+
+    if (argc < 4) {
+        printf("Usage: bcachetest <file/device> <reference directory> <file>...\n");
+        return 1;
+    }
+    host_read_block = fsw_posix_host_table.read_block;
+    host_read_blocks = fsw_posix_host_table.read_blocks;
+    fsw_posix_host_table.read_block = counting_read_block;
+    buf = malloc(buf_size);
+    if (buf == NULL)
+        return 1;
+
+    for (argi = 3; argi < argc; argi++) {
+        snprintf(ref_path, sizeof(ref_path), "%s/%s", argv[2], argv[argi]);
+        snprintf(path, sizeof(path), "/%s", argv[argi]);
+        ref = load_reference(ref_path, &ref_size);
+        if (ref == NULL) {
+            printf("Cannot read %s\n", ref_path);
+            return 1;
+        }
+        for (cached = 0; cached < 2; cached++) {
+            pvol = mount_image(argv[1], cached);
+            if (pvol == NULL) {
+                printf("Mounting failed.\n");
+                return 1;
+            }
+            for (c = 0; c < NB_CHUNK_SIZES; c++)
+                reads[cached][c] = read_sequential(pvol, path, chunk_sizes[c], ref, ref_size, buf);
+            read_random(pvol, path, 1, ref, ref_size, buf, buf_size);
+            read_random(pvol, path, 2, ref, ref_size, buf, buf_size);
+            fsw_posix_unmount(pvol);
+        }
+        printf("%s (%zu bytes), disk reads without / with the cache :", path, ref_size);
+        for (c = 0; c < NB_CHUNK_SIZES; c++)
+            printf(" %zu:%lu/%lu", chunk_sizes[c], reads[0][c], reads[1][c]);
+        printf("\n");
+        // sequential reads of a big file : one request for many blocks, directly or by readahead
+        if (ref_size >= 1024*1024) {
+            for (c = 0; c < NB_CHUNK_SIZES; c++) {
+                if (reads[1][c] * 2 > reads[0][c]) {
+                    printf("  %s, chunk %zu : %lu disk reads with the cache, %lu without\n",
+                           path, chunk_sizes[c], reads[1][c], reads[0][c]);
+                    failures++;
+                }
+            }
+        }
+        free(ref);
+    }
+    free(buf);
+
+    printf(failures ? "FAILED\n" : "OK\n");
+    return failures ? 1 : 0;
+}
+
+// EOF
@@ -53,6 +53,7 @@ void fsw_posix_change_blocksize(struct fsw_volume *vol,
                               fsw_u32 old_phys_blocksize, fsw_u32 old_log_blocksize,
                               fsw_u32 new_phys_blocksize, fsw_u32 new_log_blocksize);
 fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer);
+fsw_status_t fsw_posix_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer);
 
 /**
  * Dispatch table for our FSW host driver.
@@ -62,7 +63,8 @@ struct fsw_host_table   fsw_posix_host_table = {
     FSW_STRING_TYPE_ISO88591,
 
     fsw_posix_change_blocksize,
-    fsw_posix_read_block
+    fsw_posix_read_block,
+    fsw_posix_read_blocks
 };
 
 extern struct fsw_fstype_table   FSW_FSTYPE_TABLE_NAME(FSTYPE);
@@ -363,20 +365,29 @@ void fsw_posix_change_blocksize(struct fsw_volume *vol,
  */
 
 fsw_status_t fsw_posix_read_block(struct fsw_volume *vol, fsw_u32 phys_bno, void *buffer)
+{
+    return fsw_posix_read_blocks(vol, phys_bno, 1, buffer);
+}
+
+/**
+ * FSW interface function for reading contiguous physical blocks with one read.
+ */
+
+fsw_status_t fsw_posix_read_blocks(struct fsw_volume *vol, fsw_u32 phys_bno, fsw_u32 count, void *buffer)
 {
     struct fsw_posix_volume *pvol = (struct fsw_posix_volume *)vol->host_data;
     off_t           block_offset, seek_result;
     ssize_t         read_result;
 
-    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_posix_read_block: %d  (%d)\n"), phys_bno, vol->phys_blocksize));
+    FSW_MSG_DEBUGV((FSW_MSGSTR("fsw_posix_read_blocks: %d  %d  (%d)\n"), phys_bno, count, vol->phys_blocksize));
 
     // read from disk
     block_offset = (off_t)phys_bno * vol->phys_blocksize;
     seek_result = lseek(pvol->fd, block_offset, SEEK_SET);
     if (seek_result != block_offset)
         return FSW_IO_ERROR;
-    read_result = read(pvol->fd, buffer, vol->phys_blocksize);
-    if (read_result != vol->phys_blocksize)
+    read_result = read(pvol->fd, buffer, (size_t)count * vol->phys_blocksize);
+    if (read_result != (ssize_t)((size_t)count * vol->phys_blocksize))
         return FSW_IO_ERROR;
 
     return FSW_SUCCESS;
@@ -35,6 +35,10 @@ void
 InitBooterLog (void);
 
 void closeDebugLog(void);
+// Write pending messages, and from now on, write each message to the log file immediately. Call before handing over to the OS loader.
+void unbufferDebugLog(void);
+// Undo unbufferDebugLog(), when the loader it was called for returned.
+void bufferDebugLog(void);
 
 EFI_STATUS
 SetupBooterLog (
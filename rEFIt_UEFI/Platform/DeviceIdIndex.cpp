@@ -0,0 +1,88 @@
+/*
+ * DeviceIdIndex.cpp
+ *
+ * See DeviceIdIndex.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "DeviceIdIndex.h"
+
+
+void DeviceIdIndex::add(UINT64 Key, size_t Entry)
+{
+  Keys.Add(Key);
+  Entries.Add((UINT32)Entry);
+  Sorted = false;
+}
+
+/*
+ * Merge sort. Stable, so entries with the same key stay in table order if they were added in that order.
+ */
+void DeviceIdIndex::sort()
+{
+  size_t n = Keys.size();
+  XArray<UINT32> order;
+  order.CheckSize(n, 0);
+  for ( size_t idx = 0 ; idx < n ; ++idx ) order.Add((UINT32)idx);
+
+  XArray<UINT32> tmp;
+  tmp.setSize(n);
+  UINT32* src = order.data();
+  UINT32* dst = tmp.data();
+  for ( size_t width = 1 ; width < n ; width *= 2 ) {
+    for ( size_t left = 0 ; left < n ; left += 2*width ) {
+      size_t mid = left + width < n ? left + width : n;
+      size_t right = left + 2*width < n ? left + 2*width : n;
+      size_t i = left, j = mid, k = left;
+      while ( i < mid && j < right ) {
+        if ( Keys[src[j]] < Keys[src[i]] ) dst[k++] = src[j++];
+        else dst[k++] = src[i++];
+      }
+      while ( i < mid ) dst[k++] = src[i++];
+      while ( j < right ) dst[k++] = src[j++];
+    }
+    UINT32* swap = src; src = dst; dst = swap;
+  }
+
+  XArray<UINT64> sortedKeys;
+  XArray<UINT32> sortedEntries;
+  sortedKeys.CheckSize(n, 0);
+  sortedEntries.CheckSize(n, 0);
+  for ( size_t idx = 0 ; idx < n ; ++idx ) {
+    sortedKeys.Add(Keys[src[idx]]);
+    sortedEntries.Add(Entries[src[idx]]);
+  }
+  Keys = sortedKeys;
+  Entries = sortedEntries;
+  Sorted = true;
+}
+
+size_t DeviceIdIndex::lowerBound(UINT64 Key) const
+{
+  size_t low = 0;
+  size_t high = Keys.size();
+  while ( low < high ) {
+    size_t mid = low + (high - low) / 2;
+    if ( Keys[mid] < Key ) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+size_t DeviceIdIndex::findInRange(UINT64 Low, UINT64 High) const
+{
+  if ( !Sorted ) return MAX_XSIZE;
+  size_t found = MAX_XSIZE;
+  // entries may have been added in any order, the first one is not always the smallest
+  for ( size_t idx = lowerBound(Low) ; idx < Keys.size() && Keys[idx] < High ; ++idx ) {
+    if ( Entries[idx] < found ) found = Entries[idx];
+  }
+  return found;
+}
+
+void DeviceIdIndex::setEmpty()
+{
+  Keys.setEmpty();
+  Entries.setEmpty();
+  Sorted = false;
+}
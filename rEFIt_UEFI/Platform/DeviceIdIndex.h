@@ -0,0 +1,48 @@
+/*
+ * DeviceIdIndex.h
+ *
+ * Sorted index of a table of PCI ids, like the card name tables of the nvidia, ati and gma injectors.
+ * The tables stay in the order that is easy to maintain in the source, the index is built the first time
+ * a card is looked up. Several entries may have the same id : the one found is the first in table order,
+ * as the linear walk it replaces found it.
+ */
+
+#ifndef PLATFORM_DEVICEIDINDEX_H_
+#define PLATFORM_DEVICEIDINDEX_H_
+
+#include "../cpp_foundation/XArray.h"
+
+
+class DeviceIdIndex
+{
+protected:
+  XArray<UINT64> Keys = XArray<UINT64>();    // sorted, then by entry
+  XArray<UINT32> Entries = XArray<UINT32>(); // Entries[i] : table entry of Keys[i]
+  bool           Sorted = false;
+
+  size_t lowerBound(UINT64 Key) const;
+
+public:
+  DeviceIdIndex() {}
+  DeviceIdIndex(const DeviceIdIndex&) = delete;
+  DeviceIdIndex& operator=(const DeviceIdIndex&) = delete;
+
+  // an id and a subsystem id in one key
+  static UINT64 key(UINT32 Id, UINT32 SubId) { return ((UINT64)Id << 32) | SubId; }
+
+  // Add the entries in any order, then sort()
+  void add(UINT64 Key, size_t Entry);
+  void sort();
+  bool isBuilt() const { return Sorted; }
+  size_t size() const { return Keys.size(); }
+
+  // The first table entry with Key, MAX_XSIZE if none
+  size_t find(UINT64 Key) const { return findInRange(Key, Key + 1); }
+  // The first table entry with Low <= key < High, MAX_XSIZE if none
+  size_t findInRange(UINT64 Low, UINT64 High) const;
+
+  void setEmpty();
+};
+
+
+#endif /* PLATFORM_DEVICEIDINDEX_H_ */
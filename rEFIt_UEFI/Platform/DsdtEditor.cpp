@@ -0,0 +1,249 @@
+/*
+ * DsdtEditor.cpp
+ *
+ * See DsdtEditor.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "DsdtEditor.h"
+#include "FixBiosDsdt.h"
+#include "AmlGenerator.h"
+
+size_t DsdtEditor::findAll(const XBuffer<UINT8>& ToFind)
+{
+  INT32 adr;
+  Patches.setEmpty();
+  for (UINT32 i = 20; i < Len; ) {
+    adr = FindBin(Dsdt + i, Len - i, ToFind);
+    if (adr < 0) {
+      break;
+    }
+    Patches.Add(i + (UINT32)adr);
+    i += (UINT32)(adr + ToFind.size());
+  }
+  return Patches.size();
+}
+
+// first occurrence >= Offset
+size_t DsdtEditor::lowerBound(UINT32 Offset) const
+{
+  size_t low = 0, high = Patches.size();
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (Patches[mid] < Offset) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+// Same test as in CorrectOuters(). LastField is the nearest Field, IndexField or Device before i, or 0.
+BOOLEAN DsdtEditor::isScope(UINT32 i, UINT32 LastField) const
+{
+  if ((Dsdt[i] != 0x10) ||
+      (Dsdt[i-1] == 0x14) || (Dsdt[i-1] == 0xA0) || (Dsdt[i-1] == 0xA1) || (Dsdt[i-1] == 0xA2) ||
+      CmpNum(Dsdt, (INT32)i, TRUE)) {
+    return FALSE;
+  }
+  return LastField == 0 || (INT32)LastField + (INT32)get_size(Dsdt, LastField + 1) < (INT32)i;
+}
+
+// Same test as in CorrectOuterMethod()
+BOOLEAN DsdtEditor::isMethod(UINT32 i) const
+{
+  CHAR8  Name[5];
+  UINT32 size;
+  if ((Dsdt[i] != 0x14) || CmpNum(Dsdt, (INT32)i, FALSE)) {
+    return FALSE;
+  }
+  size = get_size(Dsdt, i + 1);
+  if (!size) {
+    return FALSE;
+  }
+  return GetName(Dsdt, (INT32)(i + 1 + ((size <= 0x3F) ? 1 : (size <= 0xFFF) ? 2 : 3)), &Name[0], NULL);
+}
+
+// get_size(), or 0 if the package would end after the table : the opcode was a byte of something else,
+// such as the second byte of a size field 45 10
+UINT32 DsdtEditor::packageSize(UINT32 SizeAdr) const
+{
+  UINT32 Size = get_size(Dsdt, SizeAdr);
+  return (Size > Len - SizeAdr) ? 0 : Size;
+}
+
+void DsdtEditor::findObjects()
+{
+  UINT32 LastField = 0;
+  UINT32 FieldEnd = 0; // end of the size field of the last candidate with a valid size
+  UINT32 End = (Len > 4) ? Len - 4 : 0; // an object must start at least 3 bytes before an occurrence
+  Outers.setEmpty();
+  Methods.setEmpty();
+  for (UINT32 i = 0x20; i < End; i++) {
+    AmlObject* Object = NULL;
+    if (i < FieldEnd) {
+      // a byte of a size field, such as the 10 of 45 10, is not an opcode
+    } else if ((i > 0x20) && (Dsdt[i] == 0x5B) && (Dsdt[i+1] == 0x82) && !CmpNum(Dsdt, (INT32)i, TRUE)) {
+      Object = new AmlObject;
+      Object->SizeAdr = i + 2;
+      Outers.AddReference(Object, true);
+    } else if ((i > 0x20) && isScope(i, LastField)) {
+      Object = new AmlObject;
+      Object->SizeAdr = i + 1;
+      Outers.AddReference(Object, true);
+    } else if (isMethod(i)) {
+      Object = new AmlObject;
+      Object->SizeAdr = i + 1;
+      Object->IsMethod = TRUE;
+      Methods.AddReference(Object, true);
+    }
+    if (Object) {
+      Object->Start = i;
+      Object->Size = packageSize(Object->SizeAdr);
+      if (Object->Size != 0) {
+        FieldEnd = Object->SizeAdr + sizeFieldLen(Dsdt[Object->SizeAdr]);
+      }
+    }
+    if (i > 0x20 && (Dsdt[i-1] == 0x5B) && ((Dsdt[i] == 0x81) || (Dsdt[i] == 0x82) || (Dsdt[i] == 0x86))) {
+      LastField = i;
+    }
+  }
+}
+
+void DsdtEditor::countPatches()
+{
+  // Device and Scope : all the candidates before the occurrence (adr = offset - 3) that end after adr + 4
+  for (size_t idx = 0; idx < Outers.size(); idx++) {
+    AmlObject& Object = Outers[idx];
+    if (Object.Size == 0) {
+      continue;
+    }
+    UINT32 First = Object.Start + 3;
+    UINT32 Last = Object.SizeAdr + Object.Size - 1;
+    if (Last <= First) {
+      continue;
+    }
+    Object.FirstPatch = (UINT32)lowerBound(First);
+    Object.LastPatch = (UINT32)lowerBound(Last);
+    Object.NbPatches = Object.LastPatch - Object.FirstPatch;
+  }
+
+  // Method : the nearest one before the occurrence (adr = offset - 2), if it ends after adr + 4
+  size_t m = 0;
+  for (size_t idx = 0; idx < Patches.size(); idx++) {
+    UINT32 Offset = Patches[idx];
+    if (Offset < 0x23) {
+      continue;
+    }
+    while (m < Methods.size() && Methods[m].Start <= Offset - 3) {
+      m++;
+    }
+    if (m == 0) {
+      continue;
+    }
+    AmlObject& Method = Methods[m - 1];
+    if (Method.SizeAdr + Method.Size > Offset + 2) {
+      if (Method.NbPatches == 0) {
+        Method.FirstPatch = (UINT32)idx;
+      }
+      Method.NbPatches++;
+    }
+  }
+}
+
+//
+// Sizes are computed from the innermost object, so a size field that grows is added to the objects around it,
+// like the shift returned by write_size() is added for the next outer devices.
+//
+void DsdtEditor::fixSizes(INT32 SizeOffset)
+{
+  XArray<AmlObject*> Touched;
+  size_t o = 0, m = 0;
+  while (o < Outers.size() || m < Methods.size()) {
+    AmlObject* Object;
+    if (m == Methods.size() || (o < Outers.size() && Outers[o].Start < Methods[m].Start)) {
+      Object = &Outers[o++];
+    } else {
+      Object = &Methods[m++];
+    }
+    if (Object->NbPatches > 0) {
+      Touched.Add(Object);
+    }
+  }
+
+  for (size_t idx = Touched.size(); idx-- > 0; ) {
+    AmlObject& Object = *Touched[idx];
+    UINT32 OldFieldLen = sizeFieldLen(Dsdt[Object.SizeAdr]);
+    INT32  Size = (INT32)Object.Size + (INT32)Object.NbPatches * SizeOffset + Object.Growth;
+    if (Size <= 0) {
+      Object.NewSizeFieldLen = 0; // nonsense, keep the old size
+      continue;
+    }
+    // the package length includes its own field
+    UINT8  Field[4];
+    INT32  FieldGrowth = (INT32)aml_write_size((UINT32)Size, (CHAR8*)Field, 0) - (INT32)OldFieldLen;
+    if (FieldGrowth != 0 && (INT32)aml_write_size((UINT32)(Size + FieldGrowth), (CHAR8*)Field, 0) - (INT32)OldFieldLen != FieldGrowth) {
+      FieldGrowth = (INT32)aml_write_size((UINT32)(Size + FieldGrowth), (CHAR8*)Field, 0) - (INT32)OldFieldLen;
+    }
+    Size += FieldGrowth;
+    Object.NewSizeFieldLen = aml_write_size((UINT32)Size, (CHAR8*)Object.NewSizeField, 0);
+    if (FieldGrowth == 0) {
+      continue;
+    }
+    // outer Devices and Scopes that contain the same occurrences
+    UINT32 Patch = Object.FirstPatch;
+    for (size_t outerIdx = idx; outerIdx-- > 0; ) {
+      AmlObject& Outer = *Touched[outerIdx];
+      if (!Outer.IsMethod && Outer.FirstPatch <= Patch && Patch < Outer.LastPatch) {
+        Outer.Growth += FieldGrowth;
+      }
+    }
+  }
+
+  // one copy : replaced patterns and new size fields, in order
+  XBuffer<UINT8> NewDsdt;
+  UINT32 Copied = 0;
+  size_t t = 0;
+  NewDsdt.dataSized(Len + Patches.size() * (SizeOffset > 0 ? SizeOffset : 0) + Touched.size() * 3); // allocate once
+  for (size_t idx = 0; idx <= Patches.size(); idx++) {
+    UINT32 PatchOffset = (idx < Patches.size()) ? Patches[idx] : Len;
+    for ( ; t < Touched.size() && Touched[t]->SizeAdr < PatchOffset; t++) {
+      AmlObject& Object = *Touched[t];
+      UINT32 OldFieldLen = sizeFieldLen(Dsdt[Object.SizeAdr]);
+      if (Object.NewSizeFieldLen == 0 || Object.SizeAdr < Copied || Object.SizeAdr + OldFieldLen > PatchOffset) {
+        continue; // overlaps a replaced pattern
+      }
+      NewDsdt.ncat(Dsdt + Copied, Object.SizeAdr - Copied);
+      NewDsdt.ncat(Object.NewSizeField, Object.NewSizeFieldLen);
+      Copied = Object.SizeAdr + OldFieldLen;
+    }
+    if (idx == Patches.size()) {
+      break;
+    }
+    NewDsdt.ncat(Dsdt + Copied, PatchOffset - Copied);
+    NewDsdt.ncat(ReplaceData, ReplaceSize);
+    Copied = PatchOffset + FindSize;
+  }
+  NewDsdt.ncat(Dsdt + Copied, Len - Copied);
+  memcpy(Dsdt, NewDsdt.data(), NewDsdt.size());
+  Len = (UINT32)NewDsdt.size();
+}
+
+UINT32 DsdtEditor::replaceAll(const XBuffer<UINT8>& ToFind, const XBuffer<UINT8>& ToReplace)
+{
+  if (Patches.isEmpty()) {
+    return Len;
+  }
+  if (ToFind.size() == ToReplace.size()) {
+    // nothing moves, no size to fix
+    for (size_t idx = 0; idx < Patches.size(); idx++) {
+      memcpy(Dsdt + Patches[idx], ToReplace.data(), ToReplace.size());
+    }
+    return Len;
+  }
+  FindSize = (UINT32)ToFind.size();
+  ReplaceData = ToReplace.data();
+  ReplaceSize = (UINT32)ToReplace.size();
+  findObjects();
+  countPatches();
+  fixSizes((INT32)ReplaceSize - (INT32)FindSize);
+  return Len;
+}
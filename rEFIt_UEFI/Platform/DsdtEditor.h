@@ -0,0 +1,74 @@
+/*
+ * DsdtEditor.h
+ *
+ * DsdtEditor applies all the occurrences of a Find/Replace to a DSDT in one copy. It finds Devices, Scopes and
+ * Methods, and reads and writes their package length, with the AML helpers of FixBiosDsdt.cpp and AmlGenerator.cpp.
+ */
+
+#ifndef PLATFORM_DSDTEDITOR_H_
+#define PLATFORM_DSDTEDITOR_H_
+
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XObjArray.h"
+#include "../cpp_foundation/XBuffer.h"
+
+//
+// Applies every occurrence of one Find/Replace to a table with a single forward copy.
+// Before, each occurrence moved the rest of the table with move_data(), then CorrectOuterMethod()
+// and CorrectOuters() walked back to the start of the table and moved it again for each size field that grew.
+// Here, the Device/Scope/Method candidates are found with the same tests in one sweep of the table,
+// each occurrence is counted in the objects it belongs to, and the sizes are fixed in the same copy.
+// Unlike the walk back, a candidate whose package would end after the table, or that starts in the size field
+// of the previous candidate, is not an object.
+//
+class DsdtEditor
+{
+protected:
+  class AmlObject
+  {
+  public:
+    UINT32  Start = 0;          // Device (5B 82), Scope (10) or Method (14) opcode
+    UINT32  SizeAdr = 0;        // package length field
+    UINT32  Size = 0;           // as read by get_size()
+    UINT32  FirstPatch = 0;     // first occurrence this object contains, for outer candidates
+    UINT32  LastPatch = 0;      // last + 1
+    BOOLEAN IsMethod = FALSE;
+    UINT32  NbPatches = 0;
+    INT32   Growth = 0;         // size fields of inner objects that grew, or shrank
+    UINT8   NewSizeField[4] = {0};
+    UINT32  NewSizeFieldLen = 0;
+  };
+
+  UINT8*       Dsdt;
+  UINT32       Len;
+  UINT32       FindSize = 0;
+  const UINT8* ReplaceData = NULL;
+  UINT32       ReplaceSize = 0;
+  XArray<UINT32>       Patches = XArray<UINT32>();       // sorted offsets of the occurrences of ToFind
+  XObjArray<AmlObject> Outers = XObjArray<AmlObject>();  // Device and Scope candidates, sorted by Start
+  XObjArray<AmlObject> Methods = XObjArray<AmlObject>(); // Method candidates with a valid size and name, sorted by Start
+
+  static UINT32 sizeFieldLen(UINT8 FirstByte) { return (UINT32)(FirstByte >> 6) + 1; }
+  size_t lowerBound(UINT32 Offset) const;
+  BOOLEAN isScope(UINT32 i, UINT32 LastField) const;
+  BOOLEAN isMethod(UINT32 i) const;
+  UINT32 packageSize(UINT32 SizeAdr) const;
+  void findObjects();
+  void countPatches();
+  void fixSizes(INT32 SizeOffset);
+
+public:
+  DsdtEditor(UINT8* aDsdt, UINT32 aLen) : Dsdt(aDsdt), Len(aLen) {}
+  DsdtEditor(const DsdtEditor&) = delete;
+  DsdtEditor& operator=(const DsdtEditor&) = delete;
+
+  // Same occurrences as the FindBin() loop of FixAny() : searched from offset 20, not overlapping.
+  size_t findAll(const XBuffer<UINT8>& ToFind);
+  UINT32 patchOffset(size_t idx) const { return Patches[idx]; }
+
+  // Returns the new length. The table buffer must be big enough, as for move_data().
+  UINT32 replaceAll(const XBuffer<UINT8>& ToFind, const XBuffer<UINT8>& ToReplace);
+};
+
+
+#endif /* PLATFORM_DSDTEDITOR_H_ */
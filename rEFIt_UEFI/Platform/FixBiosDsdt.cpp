@@ -7,6 +7,7 @@
 
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 #include "FixBiosDsdt.h"
+#include "DsdtEditor.h"
 #include "StateGenerator.h"
 #include "AcpiPatcher.h"
 #include "cpu.h"
@@ -1776,9 +1777,7 @@ UINT32 FixADP1 (UINT8* dsdt, UINT32 len)
 UINT32 FixAny (UINT8* dsdt, UINT32 len, const XBuffer<UINT8> ToFind, const XBuffer<UINT8> ToReplace)
 {
   size_t sizeoffset;
-  INT32 adr;
-  UINT32 i;
-  BOOLEAN found = FALSE;
+  size_t NbPatches;
   if ( ToFind.isEmpty() || ToReplace.isEmpty() ) {
     DBG(" invalid patches!\n");
     return len;
@@ -1793,31 +1792,19 @@ UINT32 FixAny (UINT8* dsdt, UINT32 len, const XBuffer<UINT8> ToFind, const XBuff
     DBG(" invalid patches (sizeoffset > MAX_INT32)!\n");
     return len;
   }
-  for (i = 20; i < len; ) {
-    adr = FindBin(dsdt + i, len - i, ToFind);
-    if (adr < 0) {
-      if (found) {
-        MsgLog(" ]\n");
-      } else {
-        MsgLog(" bin not found / already patched!\n");
-      }
-      return len;
-    }
-
-    if (!found) {
-      MsgLog(" patched at: [");
-      MsgLog(" (%X)", adr); //print once because whole duration is 26 seconds!!!
-    }
 
-//    MsgLog(" (%X)", adr);
-    found = TRUE;
-    len = move_data(adr + i, dsdt, len, (INT32)sizeoffset); // safe cast, sizeoffset < MAX_INT32
-    CopyMem(dsdt + adr + i, ToReplace.data(), ToReplace.size());
-    len = CorrectOuterMethod(dsdt, len, adr + i - 2, (INT32)sizeoffset); // safe cast, sizeoffset < MAX_INT32
-    len = CorrectOuters(dsdt, len, adr + i - 3, (INT32)sizeoffset); // safe cast, sizeoffset < MAX_INT32
-    i += (UINT32)(adr + ToReplace.size()); // if there is no bug before, it should be safe cast.
+  DsdtEditor Editor(dsdt, len);
+  NbPatches = Editor.findAll(ToFind);
+  if (NbPatches == 0) {
+    MsgLog(" bin not found / already patched!\n");
+    return len;
+  }
+  MsgLog(" patched at: [");
+  for (size_t idx = 0; idx < NbPatches; idx++) {
+    MsgLog(" (%X)", Editor.patchOffset(idx));
   }
-  MsgLog(" ]\n"); //should not be here
+  len = Editor.replaceAll(ToFind, ToReplace);
+  MsgLog(" ]\n");
   return len;
 }
 
@@ -49,6 +49,14 @@ FindBin (
   );
 INT32 FindBin (UINT8 *dsdt, size_t len, const XBuffer<UINT8>& bin);
 
+// AML helpers, also used by DsdtEditor
+BOOLEAN CmpNum(UINT8 *dsdt, INT32 i, BOOLEAN Sure);
+BOOLEAN GetName(UINT8 *dsdt, INT32 adr, OUT CHAR8* name, OUT INTN *shift);
+UINT32 move_data(UINT32 start, UINT8* buffer, UINT32 len, INT32 offset);
+INT32 write_size(UINT32 adr, UINT8* buffer, UINT32 len, INT32 sizeoffset);
+UINT32 CorrectOuterMethod (UINT8 *dsdt, UINT32 len, UINT32 adr,  INT32 shift);
+UINT32 CorrectOuters (UINT8 *dsdt, UINT32 len, UINT32 adr,  INT32 shift);
+
 
 UINT32 FixAny (UINT8* dsdt, UINT32 len, const XBuffer<UINT8> ToFind, const XBuffer<UINT8> ToReplace);
 UINT32 FixRenameByBridge2 (UINT8* dsdt, UINT32 len, const XBuffer<UINT8>& TgtBrgName, const XBuffer<UINT8>& ToFind, const XBuffer<UINT8>& ToReplace);
@@ -0,0 +1,155 @@
+/*
+ * KextBundleCache.cpp
+ *
+ * See KextBundleCache.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "KextBundleCache.h"
+
+#define KEXT_BUNDLE_CACHE_MAGIC "CLKXTIDX"
+#define HEADER_SIZE 16
+#define BUNDLE_HEADER_SIZE 24
+
+
+static UINT32 GetUint32(const UINT8* p)
+{
+  UINT32 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void SetUint32(UINT8* p, UINT32 v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+static UINT64 GetUint64(const UINT8* p)
+{
+  UINT64 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Check the whole file and find where the bundles are
+bool KextBundleCache::index(const XBuffer<UINT8>& Buffer, XArray<size_t>* Offsets)
+{
+  const UINT8* p = Buffer.data();
+  size_t Size = Buffer.size();
+  if (Size < HEADER_SIZE || memcmp(p, KEXT_BUNDLE_CACHE_MAGIC, 8) != 0 || GetUint32(p + 8) != Version) {
+    return false;
+  }
+  UINT32 NbBundles = GetUint32(p + 12);
+  size_t Offset = HEADER_SIZE;
+  for (UINT32 i = 0; i < NbBundles; ++i) {
+    if (Size - Offset < BUNDLE_HEADER_SIZE) return false;
+    UINT32 PathLength = GetUint32(p + Offset + 12);
+    UINT32 VersionLength = GetUint32(p + Offset + 16);
+    UINT32 ExecutableLength = GetUint32(p + Offset + 20);
+    if (PathLength > MaxStringLength || VersionLength > MaxStringLength || ExecutableLength > MaxStringLength) return false;
+    size_t BundleSize = BUNDLE_HEADER_SIZE + stringsSize(PathLength, VersionLength, ExecutableLength);
+    if (Size - Offset < BundleSize) return false;
+    const UINT8* Strings = p + Offset + BUNDLE_HEADER_SIZE;
+    if (Strings[PathLength] != 0 || Strings[PathLength + 1 + VersionLength] != 0 ||
+        Strings[PathLength + 1 + VersionLength + 1 + ExecutableLength] != 0) {
+      return false;
+    }
+    Offsets->Add(Offset);
+    Offset += BundleSize;
+  }
+  return Offset == Size;
+}
+
+bool KextBundleCache::load(UINT8* FileData, size_t FileSize)
+{
+  setEmpty();
+  UINT8 Header[HEADER_SIZE];
+  memcpy(Header, KEXT_BUNDLE_CACHE_MAGIC, 8);
+  SetUint32(Header + 8, Version);
+  SetUint32(Header + 12, 0);
+  Data.ncat(Header, sizeof(Header));
+
+  if (FileData == NULL) {
+    return false;
+  }
+  Saved.stealValueFrom(FileData, FileSize);
+  if (!index(Saved, &SavedBundles)) {
+    Saved.stealValueFrom((UINT8*)NULL, (size_t)0);
+    SavedBundles.setEmpty();
+    return false;
+  }
+  return true;
+}
+
+void KextBundleCache::setEmpty()
+{
+  // free them, setEmpty() would keep the memory
+  Saved.stealValueFrom((UINT8*)NULL, (size_t)0);
+  Data.stealValueFrom((UINT8*)NULL, (size_t)0);
+  SavedBundles.setEmpty();
+  Bundles.setEmpty();
+}
+
+size_t KextBundleCache::findBundle(const XBuffer<UINT8>& Buffer, const XArray<size_t>& Offsets, const XString8& Path)
+{
+  for (size_t idx = 0; idx < Offsets.size(); ++idx) {
+    const UINT8* p = Buffer.data() + Offsets[idx];
+    if (GetUint32(p + 12) == Path.length() && memcmp(p + BUNDLE_HEADER_SIZE, Path.c_str(), Path.length()) == 0) {
+      return idx;
+    }
+  }
+  return MAX_XSIZE;
+}
+
+bool KextBundleCache::find(const XString8& Path, UINT64 Stamp, KextBundleInfo* Info)
+{
+  size_t idx = findBundle(Saved, SavedBundles, Path);
+  if (idx == MAX_XSIZE) {
+    return false;
+  }
+  const UINT8* p = Saved.data() + SavedBundles[idx];
+  if (GetUint64(p) != Stamp) {
+    return false;
+  }
+  const char* Strings = (const char*)p + BUNDLE_HEADER_SIZE;
+  UINT32 PathLength = GetUint32(p + 12);
+  UINT32 VersionLength = GetUint32(p + 16);
+  Info->NoContents = (GetUint32(p + 8) & FlagNoContents) != 0;
+  Info->Version.strncpy(Strings + PathLength + 1, VersionLength);
+  Info->Executable.strncpy(Strings + PathLength + 1 + VersionLength + 1, GetUint32(p + 20));
+  add(Path, Stamp, *Info);
+  return true;
+}
+
+void KextBundleCache::add(const XString8& Path, UINT64 Stamp, const KextBundleInfo& Info)
+{
+  if (!isOpen() || Path.length() > MaxStringLength || Info.Version.length() > MaxStringLength ||
+      Info.Executable.length() > MaxStringLength || findBundle(Data, Bundles, Path) != MAX_XSIZE) {
+    return;
+  }
+  UINT32 PathLength = (UINT32)Path.length();
+  UINT32 VersionLength = (UINT32)Info.Version.length();
+  UINT32 ExecutableLength = (UINT32)Info.Executable.length();
+  size_t Offset = Data.size();
+
+  UINT8 Header[BUNDLE_HEADER_SIZE];
+  memcpy(Header, &Stamp, sizeof(Stamp));
+  SetUint32(Header + 8, Info.NoContents ? FlagNoContents : 0);
+  SetUint32(Header + 12, PathLength);
+  SetUint32(Header + 16, VersionLength);
+  SetUint32(Header + 20, ExecutableLength);
+  Data.ncat(Header, sizeof(Header));
+  // c_str() and the terminating 0 of each
+  Data.ncat((const UINT8*)Path.c_str(), PathLength + 1);
+  Data.ncat((const UINT8*)Info.Version.c_str(), VersionLength + 1);
+  Data.ncat((const UINT8*)Info.Executable.c_str(), ExecutableLength + 1);
+  static const UINT8 Zeros[4] = {0, 0, 0, 0};
+  Data.ncat(Zeros, stringsSize(PathLength, VersionLength, ExecutableLength) - (PathLength + VersionLength + ExecutableLength + 3));
+  Bundles.Add(Offset);
+  SetUint32(Data.data() + 12, (UINT32)Bundles.size());
+}
+
+bool KextBundleCache::isModified() const
+{
+  return isOpen() && (Data.size() != Saved.size() || memcmp(Data.data(), Saved.data(), Data.size()) != 0);
+}
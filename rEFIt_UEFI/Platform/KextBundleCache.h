@@ -0,0 +1,85 @@
+/*
+ * KextBundleCache.h
+ *
+ * What InitKextList takes from the Info.plist of each kext of the kexts dirs, kept in a file on the ESP.
+ * Each Info.plist was loaded and parsed at each boot, twice : for the version shown in the menu, and to find
+ * the executable given to OpenCore. Some are big, AppleALC's is several hundreds of KB.
+ * Now the Info.plist is only opened to get its size and date : a bundle is taken from the cache if its stamp,
+ * the FNV-1a 64 of the path, size and date of its Info.plist, is the same as when it was added.
+ *
+ * File format, little endian, the memory image is the file itself :
+ *   header : Magic[8] "CLKXTIDX", UINT32 Version, UINT32 NbBundles
+ *   NbBundles times : UINT64 Stamp, UINT32 Flags, UINT32 PathLength, UINT32 VersionLength, UINT32 ExecutableLength,
+ *                     Path, Version and Executable with a terminating 0 each, padded together to a multiple of 4
+ * Path is the bundle path relative to the Clover dir. Strings are UTF-8.
+ */
+
+#ifndef PLATFORM_KEXTBUNDLECACHE_H_
+#define PLATFORM_KEXTBUNDLECACHE_H_
+
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XBuffer.h"
+#include "../cpp_foundation/XString.h"
+
+
+class KextBundleInfo
+{
+public:
+  XString8 Version = XString8();    // CFBundleVersion
+  XString8 Executable = XString8(); // CFBundleExecutable, empty if there is none
+  bool     NoContents = false;      // planar kext : Info.plist is not in Contents
+};
+
+class KextBundleCache
+{
+public:
+  static const UINT32 Version = 1;
+  static const UINT32 MaxStringLength = 4096; // anything longer is a broken file
+
+protected:
+  static const UINT32 FlagNoContents = 1;
+
+  XBuffer<UINT8> Saved;                           // the file read at boot, empty if it is not valid
+  XArray<size_t> SavedBundles = XArray<size_t>(); // offset in Saved of each bundle
+  XBuffer<UINT8> Data;                            // the bundles of this boot, as they will be saved
+  XArray<size_t> Bundles = XArray<size_t>();      // offset in Data of each bundle
+
+  static size_t stringsSize(UINT32 PathLength, UINT32 VersionLength, UINT32 ExecutableLength)
+    { return ((size_t)PathLength + VersionLength + ExecutableLength + 3 + 3) & ~(size_t)3; }
+  static bool index(const XBuffer<UINT8>& Buffer, XArray<size_t>* Offsets);
+  static size_t findBundle(const XBuffer<UINT8>& Buffer, const XArray<size_t>& Offsets, const XString8& Path);
+
+public:
+  KextBundleCache() : Saved(), Data() {}
+  KextBundleCache(const KextBundleCache&) = delete;
+  KextBundleCache& operator=(const KextBundleCache&) = delete;
+
+  /*
+   * Open the cache with the one read from a file, FileData may be NULL. FileData is taken, it must be allocated
+   * by AllocatePool or malloc. Returns false if it is not a valid cache : no bundle will be found in it.
+   * The bundles of this boot are then added, none at first.
+   */
+  bool load(UINT8* FileData, size_t FileSize);
+  void setEmpty();
+
+  /*
+   * false if Path is not in the file read, or with another Stamp. Otherwise Info is set, and the bundle is
+   * added to this boot's ones as it is.
+   */
+  bool find(const XString8& Path, UINT64 Stamp, KextBundleInfo* Info);
+  /*
+   * Keep Info for the bundle Path, read from an Info.plist with Stamp.
+   * Nothing is done if the cache is not open, or if Path was already added.
+   */
+  void add(const XString8& Path, UINT64 Stamp, const KextBundleInfo& Info);
+
+  bool isOpen() const { return Data.size() != 0; }
+  // true if the bundles added are not what was loaded, the file must be saved
+  bool isModified() const;
+  size_t getNbBundles() const { return Bundles.size(); }
+  // the file to save
+  const XBuffer<UINT8>& getData() const { return Data; }
+};
+
+
+#endif /* PLATFORM_KEXTBUNDLECACHE_H_ */
@@ -9,6 +9,8 @@
 #include <Platform.h>
 #include "../Settings/SelfOem.h"
 #include "../libeg/libeg.h"
+#include "KextBundleCache.h"
+#include "../cpp_foundation/fnv_hash.h"
 
 
 #ifndef DEBUG_ALL
@@ -28,39 +30,90 @@
 XObjArray<SIDELOAD_KEXT>        InjectKextList;
 
 
+#define KEXT_BUNDLE_CACHE L"misc\\kext_cache.bin"
+
+// Open during InitKextList
+static KextBundleCache BundleCache;
+
+
+/*
+ * Stamp of an Info.plist : its path, size and date. It is opened, not read.
+ */
+static EFI_STATUS GetInfoPlistStamp(const XStringW& InfoPlistPath, UINT64* Stamp)
+{
+  EFI_STATUS      Status;
+  EFI_FILE*       FileHandle = NULL;
+  EFI_FILE_INFO*  FileInfo;
+
+  Status = self.getCloverDir().Open(&self.getCloverDir(), &FileHandle, (CHAR16*)InfoPlistPath.wc_str(), EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+  FileInfo = EfiLibFileInfo(FileHandle);
+  FileHandle->Close(FileHandle);
+  if (FileInfo == NULL) {
+    return EFI_NOT_READY;
+  }
+  *Stamp = fnv1a64(InfoPlistPath.wc_str(), InfoPlistPath.sizeInBytes());
+  *Stamp = fnv1a64(&FileInfo->FileSize, sizeof(FileInfo->FileSize), *Stamp);
+  *Stamp = fnv1a64(&FileInfo->ModificationTime, sizeof(FileInfo->ModificationTime), *Stamp);
+  FreePool(FileInfo);
+  return EFI_SUCCESS;
+}
+
 /*
  * Relative path to SelfDir (the efi dir)
+ * The Info.plist is parsed only if the cache doesn't have it.
  */
-XStringW GetBundleVersion(const XStringW& pathUnderSelf)
+void GetBundleInfo(const XStringW& pathUnderSelf, SIDELOAD_KEXT* Kext)
 {
   EFI_STATUS      Status;
-  XStringW        CFBundleVersion;
   XStringW        InfoPlistPath;
   CHAR8*          InfoPlistPtr = NULL;
   TagDict*      InfoPlistDict = NULL;
   const TagStruct*      Prop = NULL;
   UINTN           Size;
+  UINT64          Stamp = 0;
+  KextBundleInfo  Info;
+  XString8        BundlePath = S8Printf("%ls", pathUnderSelf.wc_str());
+
   InfoPlistPath = SWPrintf("%ls\\%ls", pathUnderSelf.wc_str(), L"Contents\\Info.plist");
-  Status = egLoadFile(&self.getCloverDir(), InfoPlistPath.wc_str(), (UINT8**)&InfoPlistPtr, &Size);
+  Status = GetInfoPlistStamp(InfoPlistPath, &Stamp);
   if (EFI_ERROR(Status)) {
     InfoPlistPath = SWPrintf("%ls\\%ls", pathUnderSelf.wc_str(), L"Info.plist");
-    Status = egLoadFile(&self.getCloverDir(), InfoPlistPath.wc_str(), (UINT8**)&InfoPlistPtr, &Size);
+    Status = GetInfoPlistStamp(InfoPlistPath, &Stamp);
+    Info.NoContents = true;
   }
-  if(!EFI_ERROR(Status)) {
+  if (EFI_ERROR(Status)) {
+    return;
+  }
+  if (!BundleCache.find(BundlePath, Stamp, &Info)) {
+    Status = egLoadFile(&self.getCloverDir(), InfoPlistPath.wc_str(), (UINT8**)&InfoPlistPtr, &Size);
+    if (EFI_ERROR(Status)) {
+      return;
+    }
     //DBG("about to parse xml file %ls\n", InfoPlistPath.wc_str());
     Status = ParseXML(InfoPlistPtr, &InfoPlistDict, Size);
     if(!EFI_ERROR(Status) && (InfoPlistDict != nullptr)) {
       Prop = InfoPlistDict->propertyForKey("CFBundleVersion");
       if (Prop != NULL && Prop->isString() && Prop->getString()->stringValue().notEmpty()) {
-        CFBundleVersion = SWPrintf("%s", Prop->getString()->stringValue().c_str());
+        Info.Version = Prop->getString()->stringValue();
+      }
+      Prop = InfoPlistDict->propertyForKey("CFBundleExecutable");
+      if (Prop != NULL && Prop->isString() && Prop->getString()->stringValue().notEmpty()) {
+        Info.Executable = Prop->getString()->stringValue();
       }
     }
-  }
-  if (InfoPlistPtr) {
     FreePool(InfoPlistPtr);
+    if ( InfoPlistDict ) InfoPlistDict->FreeTag();
+    BundleCache.add(BundlePath, Stamp, Info);
+  }
+  Kext->InfoPlistFound = TRUE;
+  Kext->NoContents = Info.NoContents;
+  Kext->Executable = Info.Executable;
+  if (Info.Version.notEmpty()) {
+    Kext->Version = SWPrintf("%s", Info.Version.c_str());
   }
-  if ( InfoPlistDict ) InfoPlistDict->FreeTag();
-  return CFBundleVersion;
 }
 
 void GetListOfInjectKext(CHAR16 *KextDirNameUnderOEMPath)
@@ -99,7 +152,7 @@ void GetListOfInjectKext(CHAR16 *KextDirNameUnderOEMPath)
     mKext->FileName.SWPrintf("%ls", DirEntry->FileName);
     mKext->MenuItem.BValue = Blocked;
     mKext->KextDirNameUnderOEMPath.SWPrintf("%ls", KextDirNameUnderOEMPath);
-    mKext->Version = GetBundleVersion(pathRelToSelfDir);
+    GetBundleInfo(pathRelToSelfDir, mKext);
     InjectKextList.AddReference(mKext, true);
 
     DBG("Added Kext=%ls\\%ls\n", mKext->KextDirNameUnderOEMPath.wc_str(), mKext->FileName.wc_str());
@@ -118,7 +171,7 @@ void GetListOfInjectKext(CHAR16 *KextDirNameUnderOEMPath)
       mPlugInKext->FileName.SWPrintf("%ls", PlugInEntry->FileName);
       mPlugInKext->MenuItem.BValue = Blocked;
       mPlugInKext->KextDirNameUnderOEMPath = SWPrintf("%ls\\%ls\\Contents\\PlugIns", KextDirNameUnderOEMPath, mKext->FileName.wc_str());
-      mPlugInKext->Version = GetBundleVersion(PlugInsName);
+      GetBundleInfo(PlugInsName, mPlugInKext);
       mKext->PlugInList.AddReference(mPlugInKext, true);
       //      DBG("---| added plugin=%ls, MatchOS=%ls\n", mPlugInKext->FileName, mPlugInKext->MatchOS);
     }
@@ -140,6 +193,16 @@ void InitKextList()
   DbgHeader("InitKextList");
 
   if ( selfOem.isKextsDirFound() ) {
+    UINT8 *FileData = NULL;
+    UINTN FileDataLength = 0;
+    if (EFI_ERROR(egLoadFile(&self.getCloverDir(), KEXT_BUNDLE_CACHE, &FileData, &FileDataLength))) {
+      FileData = NULL;
+      FileDataLength = 0;
+    }
+    if (!BundleCache.load(FileData, FileDataLength)) {
+      DBG("%ls is not valid, it will be rebuilt\n", KEXT_BUNDLE_CACHE);
+    }
+
     // Iterate over kexts directory
     DirIterOpen(&selfOem.getKextsDir(), NULL, &KextsIter);
     while (DirIterNext(&KextsIter, 1, L"*", &FolderEntry)) {
@@ -149,5 +212,13 @@ void InitKextList()
       GetListOfInjectKext(FolderEntry->FileName);
     }
     DirIterClose(&KextsIter);
+
+    // kexts removed are not in the bundles of this boot, they go away too
+    if (BundleCache.isModified()) {
+      if (EFI_ERROR(egSaveFile(&self.getCloverDir(), KEXT_BUNDLE_CACHE, BundleCache.getData().data(), BundleCache.getData().size()))) {
+        DBG("%ls not saved\n", KEXT_BUNDLE_CACHE);
+      }
+    }
+    BundleCache.setEmpty();
   }
 }
@@ -0,0 +1,94 @@
+/*
+ * KextPatchIndex.cpp
+ *
+ * See KextPatchIndex.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "KextPatchIndex.h"
+#include "../cpp_foundation/fnv_hash.h"
+
+
+void KextPatchIndex::setEmpty()
+{
+  Names.setEmpty();
+  HashTable.setEmpty();
+  NextSameName.setEmpty();
+  PartialNames.setEmpty();
+}
+
+UINT32 KextPatchIndex::hashName(const char* name)
+{
+  return fnv1a32(name, strlen(name));
+}
+
+void KextPatchIndex::insertInHashTable(size_t idx)
+{
+  size_t slot = hashName(Names[idx].c_str()) & (HashTable.size() - 1);
+  while ( HashTable[slot] != 0  &&  Names[HashTable[slot] - 1] != Names[idx] ) {
+    slot = (slot + 1) & (HashTable.size() - 1);
+  }
+  if ( HashTable[slot] == 0 ) {
+    HashTable[slot] = (UINT32)(idx + 1);
+    return;
+  }
+  // same bundle identifier as a previous patch : append to its list
+  size_t last = HashTable[slot] - 1;
+  while ( NextSameName[last] != MAX_XSIZE ) last = NextSameName[last];
+  NextSameName[last] = idx;
+}
+
+void KextPatchIndex::add(const XString8& Name)
+{
+  size_t idx = Names.size();
+  Names.Add(Name);
+  NextSameName.Add(MAX_XSIZE);
+  if ( !Name.contains(".") ) {
+    PartialNames.Add(idx);
+    return;
+  }
+  if ( HashTable.size() < Names.size() * 2 ) {
+    // grow and rehash. Rehashing in order keeps the lists sorted.
+    size_t hashSize = HashTable.isEmpty() ? 16 : HashTable.size();
+    while ( hashSize < Names.size() * 2 ) hashSize <<= 1;
+    HashTable.setEmpty();
+    HashTable.Add(0, hashSize);
+    for ( size_t i = 0 ; i < idx ; ++i ) {
+      NextSameName[i] = MAX_XSIZE;
+      if ( Names[i].contains(".") ) insertInHashTable(i);
+    }
+  }
+  insertInHashTable(idx);
+}
+
+void KextPatchIndex::find(const char* BundleIdentifier, XArray<size_t>* PatchIndexes) const
+{
+  PatchIndexes->setEmpty();
+  if ( BundleIdentifier == NULL ) return;
+
+  size_t exact = MAX_XSIZE;
+  if ( !HashTable.isEmpty() ) {
+    size_t slot = hashName(BundleIdentifier) & (HashTable.size() - 1);
+    while ( HashTable[slot] != 0 ) {
+      if ( strcmp(Names[HashTable[slot] - 1].c_str(), BundleIdentifier) == 0 ) {
+        exact = HashTable[slot] - 1;
+        break;
+      }
+      slot = (slot + 1) & (HashTable.size() - 1);
+    }
+  }
+
+  // merge the exact matches and the partial names, both are sorted
+  size_t partialIdx = 0;
+  while ( exact != MAX_XSIZE  ||  partialIdx < PartialNames.size() ) {
+    if ( partialIdx < PartialNames.size()  &&  (exact == MAX_XSIZE || PartialNames[partialIdx] < exact) ) {
+      if ( strstr(BundleIdentifier, Names[PartialNames[partialIdx]].c_str()) != NULL ) {
+        PatchIndexes->Add(PartialNames[partialIdx]);
+      }
+      partialIdx++;
+    } else {
+      PatchIndexes->Add(exact);
+      exact = NextSameName[exact];
+    }
+  }
+}
@@ -0,0 +1,47 @@
+/*
+ * KextPatchIndex.h
+ *
+ * Index of the KextPatches by kext name, so PatchKext() doesn't compare every patch name with every kext.
+ * A name with a '.' is a bundle identifier and must match exactly. Other names match any bundle identifier
+ * that contains them.
+ */
+
+#ifndef PLATFORM_KEXTPATCHINDEX_H_
+#define PLATFORM_KEXTPATCHINDEX_H_
+
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XStringArray.h"
+
+
+class KextPatchIndex
+{
+protected:
+  XString8Array  Names = XString8Array();
+  XArray<UINT32> HashTable = XArray<UINT32>();    // open addressing, index + 1 of the first patch for a bundle identifier, 0 for an empty slot
+  XArray<size_t> NextSameName = XArray<size_t>(); // NextSameName[i] : next patch with the same bundle identifier as patch i, or MAX_XSIZE
+  XArray<size_t> PartialNames = XArray<size_t>(); // patches whose name isn't a bundle identifier, in order
+
+  static UINT32 hashName(const char* name);
+  void insertInHashTable(size_t idx);
+
+public:
+  KextPatchIndex() {}
+  KextPatchIndex(const KextPatchIndex&) = delete;
+  KextPatchIndex& operator=(const KextPatchIndex&) = delete;
+
+  /*
+   * Patches must be added in order : the index of the patch in the KextPatches array is the number of patches already added.
+   */
+  void add(const XString8& Name);
+  size_t size() const { return Names.size(); }
+
+  /*
+   * Fills PatchIndexes with the indexes of the patches for this kext, in increasing order.
+   */
+  void find(const char* BundleIdentifier, XArray<size_t>* PatchIndexes) const;
+
+  void setEmpty();
+};
+
+
+#endif /* PLATFORM_KEXTPATCHINDEX_H_ */
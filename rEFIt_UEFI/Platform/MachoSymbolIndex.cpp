@@ -0,0 +1,155 @@
+/*
+ * MachoSymbolIndex.cpp
+ *
+ * See MachoSymbolIndex.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "MachoSymbolIndex.h"
+#include "../cpp_foundation/fnv_hash.h"
+
+
+void MachoSymbolIndex::setEmpty()
+{
+  Key = NULL;
+  Names = NULL;
+  NameOffsets.setEmpty();
+  HashTable.setEmpty();
+  SortedByName.setEmpty();
+  Bigrams.setEmpty();
+}
+
+UINT32 MachoSymbolIndex::hashName(const char* name, size_t len)
+{
+  return fnv1a32(name, len);
+}
+
+UINT64 MachoSymbolIndex::bigramsOf(const char* name)
+{
+  UINT64 bigrams = 0;
+  for ( ; name[0] != 0 && name[1] != 0 ; ++name ) {
+    bigrams |= 1ULL << (((UINT8)name[0] * 31 + (UINT8)name[1]) & 63);
+  }
+  return bigrams;
+}
+
+void MachoSymbolIndex::build(const void* aKey, const char* aNames, const UINT32* FirstNameOffset, size_t Stride, size_t NbSymbols)
+{
+  setEmpty();
+  if ( !aKey || !aNames || !FirstNameOffset ) return;
+  Key = aKey;
+  Names = aNames;
+
+  NameOffsets.CheckSize(NbSymbols, 0);
+  for ( size_t idx = 0 ; idx < NbSymbols ; ++idx ) {
+    NameOffsets.Add(*(const UINT32*)((const UINT8*)FirstNameOffset + idx*Stride));
+  }
+
+  size_t hashSize = 16;
+  while ( hashSize < NbSymbols * 2 ) hashSize <<= 1;
+  HashTable.Add(0, hashSize);
+  for ( size_t idx = 0 ; idx < NbSymbols ; ++idx ) {
+    const char* name = nameAt(idx);
+    size_t len = strlen(name);
+    size_t slot = hashName(name, len) & (hashSize - 1);
+    while ( HashTable[slot] != 0 ) {
+      if ( strcmp(nameAt(HashTable[slot] - 1), name) == 0 ) break; // keep the first symbol with this name
+      slot = (slot + 1) & (hashSize - 1);
+    }
+    if ( HashTable[slot] == 0 ) HashTable[slot] = (UINT32)(idx + 1);
+  }
+
+  Bigrams.CheckSize(NbSymbols, 0);
+  for ( size_t idx = 0 ; idx < NbSymbols ; ++idx ) {
+    Bigrams.Add(bigramsOf(nameAt(idx)));
+  }
+
+  sortByName();
+}
+
+/*
+ * Merge sort. Stable, so symbols with the same name stay ordered by index.
+ */
+void MachoSymbolIndex::sortByName()
+{
+  size_t n = NameOffsets.size();
+  SortedByName.setEmpty();
+  SortedByName.CheckSize(n, 0);
+  for ( size_t idx = 0 ; idx < n ; ++idx ) SortedByName.Add((UINT32)idx);
+
+  XArray<UINT32> tmp;
+  tmp.setSize(n);
+  UINT32* src = SortedByName.data();
+  UINT32* dst = tmp.data();
+  for ( size_t width = 1 ; width < n ; width *= 2 ) {
+    for ( size_t left = 0 ; left < n ; left += 2*width ) {
+      size_t mid = left + width < n ? left + width : n;
+      size_t right = left + 2*width < n ? left + 2*width : n;
+      size_t i = left, j = mid, k = left;
+      while ( i < mid && j < right ) {
+        if ( compareStripped(nameAt(src[j]), nameAt(src[i])) < 0 ) dst[k++] = src[j++];
+        else dst[k++] = src[i++];
+      }
+      while ( i < mid ) dst[k++] = src[i++];
+      while ( j < right ) dst[k++] = src[j++];
+    }
+    UINT32* swap = src; src = dst; dst = swap;
+  }
+  if ( src != SortedByName.data() ) memcpy(SortedByName.data(), src, n * sizeof(UINT32));
+}
+
+size_t MachoSymbolIndex::findExact(const char* name, size_t len) const
+{
+  if ( HashTable.isEmpty() ) return MAX_XSIZE;
+  size_t slot = hashName(name, len) & (HashTable.size() - 1);
+  while ( HashTable[slot] != 0 ) {
+    const char* candidate = nameAt(HashTable[slot] - 1);
+    if ( strncmp(candidate, name, len) == 0 && candidate[len] == 0 ) return HashTable[slot] - 1;
+    slot = (slot + 1) & (HashTable.size() - 1);
+  }
+  return MAX_XSIZE;
+}
+
+size_t MachoSymbolIndex::findByPrefix(const char* procedure) const
+{
+  const char* stripped = skipUnderscores(procedure);
+  size_t strippedLen = strlen(stripped);
+  if ( strippedLen == 0 ) return MAX_XSIZE;
+
+  // lower bound
+  size_t low = 0;
+  size_t high = SortedByName.size();
+  while ( low < high ) {
+    size_t mid = low + (high - low) / 2;
+    if ( strcmp(skipUnderscores(nameAt(SortedByName[mid])), stripped) < 0 ) low = mid + 1;
+    else high = mid;
+  }
+  size_t found = MAX_XSIZE;
+  for ( size_t idx = low ; idx < SortedByName.size() ; ++idx ) {
+    const char* name = nameAt(SortedByName[idx]);
+    if ( strncmp(skipUnderscores(name), stripped, strippedLen) != 0 ) break;
+    // procedure may have more leading '_' than name
+    if ( SortedByName[idx] < found  &&  strstr(name, procedure) != NULL ) found = SortedByName[idx];
+  }
+  return found;
+}
+
+size_t MachoSymbolIndex::find(const XString8& procedure) const
+{
+  if ( procedure.isEmpty() || !Names ) return MAX_XSIZE;
+
+  // Any of these contains procedure. The answer can't be after them.
+  size_t bound = findExact(procedure.c_str(), procedure.sizeInBytes());
+  XString8 underscored = S8Printf("_%s", procedure.c_str());
+  size_t idx = findExact(underscored.c_str(), underscored.sizeInBytes());
+  if ( idx < bound ) bound = idx;
+  idx = findByPrefix(procedure.c_str());
+  if ( idx < bound ) bound = idx;
+
+  size_t end = bound < NameOffsets.size() ? bound : NameOffsets.size();
+  UINT64 bigrams = bigramsOf(procedure.c_str());
+  for ( idx = 0 ; idx < end ; ++idx ) {
+    if ( (Bigrams[idx] & bigrams) == bigrams  &&  strstr(nameAt(idx), procedure.c_str()) != NULL ) return idx;
+  }
+  return bound;
+}
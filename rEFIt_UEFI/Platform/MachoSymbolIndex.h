@@ -0,0 +1,61 @@
+/*
+ * MachoSymbolIndex.h
+ *
+ * Index of a Mach-O symbol table (nlist_64 or the VTABLE layout used for the kernel) by symbol name.
+ * Built once per kernel or kext, so each symbol lookup doesn't scan the whole string table.
+ */
+
+#ifndef PLATFORM_MACHOSYMBOLINDEX_H_
+#define PLATFORM_MACHOSYMBOLINDEX_H_
+
+#include "../cpp_foundation/XArray.h"
+
+
+class MachoSymbolIndex
+{
+protected:
+  const void*    Key = NULL;   // the symbol table the index was built for
+  const char*    Names = NULL; // string table
+  XArray<UINT32> NameOffsets = XArray<UINT32>();  // NameOffsets[i] : offset in Names of the name of symbol i
+  XArray<UINT32> HashTable = XArray<UINT32>();    // open addressing, symbol index + 1, 0 for an empty slot. Size is a power of 2.
+  XArray<UINT32> SortedByName = XArray<UINT32>(); // symbol indexes sorted by name without the leading '_', then by index
+  XArray<UINT64> Bigrams = XArray<UINT64>();      // Bigrams[i] : one bit for each pair of consecutive chars of the name of symbol i
+
+  const char* nameAt(size_t symbolIdx) const { return Names + NameOffsets[symbolIdx]; }
+  static const char* skipUnderscores(const char* name) { while ( *name == '_' ) name++; return name; }
+  static UINT32 hashName(const char* name, size_t len);
+  static UINT64 bigramsOf(const char* name);
+  static int compareStripped(const char* name1, const char* name2) { return strcmp(skipUnderscores(name1), skipUnderscores(name2)); }
+
+  size_t findExact(const char* name, size_t len) const;
+  size_t findByPrefix(const char* procedure) const;
+  void sortByName();
+
+public:
+  MachoSymbolIndex() {}
+  MachoSymbolIndex(const MachoSymbolIndex&) = delete;
+  MachoSymbolIndex& operator=(const MachoSymbolIndex&) = delete;
+
+  /*
+   * FirstNameOffset points to the name offset field (n_strx for nlist_64) of the first symbol.
+   * Stride is the size of one symbol entry, in bytes.
+   * Key identifies the symbol table (usually its address). It is only used by isBuiltFor().
+   */
+  void build(const void* Key, const char* Names, const UINT32* FirstNameOffset, size_t Stride, size_t NbSymbols);
+
+  bool isBuiltFor(const void* aKey, const char* aNames, size_t NbSymbols) const { return Key != NULL && Key == aKey && Names == aNames && NameOffsets.size() == NbSymbols; }
+  size_t size() const { return NameOffsets.size(); }
+
+  /*
+   * Same result as a strstr() of each name, in symbol order : the lowest symbol index whose name contains procedure.
+   * The exact name, the name with a leading '_' and the names starting with procedure give a symbol that contains it,
+   * so only the symbols before that one are checked. The bigrams skip most of the names without calling strstr().
+   * Returns the index of the symbol, or MAX_XSIZE if not found.
+   */
+  size_t find(const XString8& procedure) const;
+
+  void setEmpty();
+};
+
+
+#endif /* PLATFORM_MACHOSYMBOLINDEX_H_ */
@@ -0,0 +1,300 @@
+/*
+ * MultiPatternPatcher.cpp
+ *
+ * See MultiPatternPatcher.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "MultiPatternPatcher.h"
+#include "MemoryOperation.h"
+
+#ifndef DEBUG_ALL
+#define DEBUG_MULTIPATTERNPATCHER 1
+#else
+#define DEBUG_MULTIPATTERNPATCHER DEBUG_ALL
+#endif
+
+#if DEBUG_MULTIPATTERNPATCHER == 0
+#define DBG(...)
+#else
+#define DBG(...) DebugLog(DEBUG_MULTIPATTERNPATCHER, __VA_ARGS__)
+#endif
+
+#define NO_TRANSITION MAX_UINT32
+
+
+size_t MultiPatternPatcher::addPatch(const UINT8* Find, const UINT8* MaskFind, size_t FindSize,
+                                     const UINT8* Replace, const UINT8* MaskReplace,
+                                     size_t RegionStart, size_t RegionLen, INTN Count, INTN Skip, size_t Tag)
+{
+  Patch* patch = new Patch;
+  patch->Find = Find;
+  patch->MaskFind = MaskFind;
+  patch->FindSize = FindSize;
+  patch->Replace = Replace;
+  patch->MaskReplace = MaskReplace;
+  patch->RegionStart = RegionStart;
+  patch->RegionLen = RegionLen;
+  patch->Count = Count;
+  patch->Skip = Skip;
+  patch->Tag = Tag;
+  // Same test as SearchAndReplaceMask : such a patch does nothing
+  if ( !Find || !Replace || !FindSize ) {
+    patch->FindSize = 0;
+  }
+  return Patches.AddReference(patch, true);
+}
+
+void MultiPatternPatcher::setEmpty()
+{
+  Patches.setEmpty();
+  Delta.setEmpty();
+  StateOutput.setEmpty();
+  DictLink.setEmpty();
+  DirtyRanges.setEmpty();
+}
+
+/*
+ * End of the bytes a patch can read or change : a match can start at the last byte of the region.
+ * RegionLen is often "up to the end", so don't add before comparing.
+ */
+size_t MultiPatternPatcher::modifiableEnd(const Patch& patch, size_t BufferSize)
+{
+  if ( patch.RegionStart > BufferSize ) return BufferSize;
+  size_t left = BufferSize - patch.RegionStart;
+  if ( patch.RegionLen >= left || patch.FindSize >= left - patch.RegionLen ) return BufferSize;
+  return patch.RegionStart + patch.RegionLen + patch.FindSize;
+}
+
+/*
+ * Build a complete DFA (every state has 256 transitions) from the unmasked prefixes.
+ * State 0 is the root.
+ */
+void MultiPatternPatcher::compile()
+{
+  Delta.setEmpty();
+  StateOutput.setEmpty();
+  DictLink.setEmpty();
+
+  Delta.Add(NO_TRANSITION, 256);
+  StateOutput.Add(MAX_XSIZE);
+
+  for ( size_t idx = 0 ; idx < Patches.size() ; ++idx ) {
+    Patch& patch = Patches[idx];
+    patch.KeyLen = 0;
+    patch.NextSameKey = MAX_XSIZE;
+    if ( patch.FindSize == 0 ) continue;
+    if ( patch.MaskFind ) {
+      while ( patch.KeyLen < patch.FindSize  &&  patch.MaskFind[patch.KeyLen] == 0xFF ) patch.KeyLen++;
+    }else{
+      patch.KeyLen = patch.FindSize;
+    }
+    if ( patch.KeyLen == 0 ) continue; // first byte is masked. This patch will go through SearchAndReplaceMask.
+
+    UINT32 state = 0;
+    for ( size_t i = 0 ; i < patch.KeyLen ; ++i ) {
+      UINT32& next = Delta[state*256 + patch.Find[i]];
+      if ( next == NO_TRANSITION ) {
+        next = (UINT32)StateOutput.size(); // Delta may be reallocated by the next line. Do not use "next" after.
+        Delta.Add(NO_TRANSITION, 256);
+        StateOutput.Add(MAX_XSIZE);
+      }
+      state = Delta[state*256 + patch.Find[i]];
+    }
+    // Keep the patches on the same state ordered by index
+    if ( StateOutput[state] == MAX_XSIZE ) {
+      StateOutput[state] = idx;
+    }else{
+      size_t last = StateOutput[state];
+      while ( Patches[last].NextSameKey != MAX_XSIZE ) last = Patches[last].NextSameKey;
+      Patches[last].NextSameKey = idx;
+    }
+  }
+
+  // Breadth first to compute failure links and fill missing transitions
+  size_t nbStates = StateOutput.size();
+  XArray<UINT32> Fail;
+  XArray<UINT32> Queue;
+  Fail.Add(0, nbStates);
+  DictLink.Add(0, nbStates);
+  Queue.CheckSize(nbStates, 0);
+
+  for ( size_t c = 0 ; c < 256 ; ++c ) {
+    UINT32 next = Delta[c];
+    if ( next == NO_TRANSITION ) {
+      Delta[c] = 0;
+    }else{
+      Fail[next] = 0;
+      Queue.Add(next);
+    }
+  }
+  for ( size_t head = 0 ; head < Queue.size() ; ++head ) {
+    UINT32 state = Queue[head];
+    for ( size_t c = 0 ; c < 256 ; ++c ) {
+      UINT32 next = Delta[state*256 + c];
+      UINT32 failTransition = Delta[Fail[state]*256 + c];
+      if ( next == NO_TRANSITION ) {
+        Delta[state*256 + c] = failTransition;
+      }else{
+        Fail[next] = failTransition;
+        DictLink[next] = StateOutput[failTransition] != MAX_XSIZE ? failTransition : DictLink[failTransition];
+        Queue.Add(next);
+      }
+    }
+  }
+}
+
+/*
+ * Single pass over the buffer. Record every full match (masks checked) of every patch, inside its region.
+ */
+void MultiPatternPatcher::scan(const UINT8* Buffer, size_t BufferSize)
+{
+  size_t scanStart = MAX_XSIZE;
+  size_t scanEnd = 0;
+  for ( size_t idx = 0 ; idx < Patches.size() ; ++idx ) {
+    Patch& patch = Patches[idx];
+    patch.Hits.setEmpty();
+    patch.Overflowed = false;
+    patch.ReplacesDone = 0;
+    if ( patch.KeyLen == 0 ) continue;
+    if ( patch.RegionStart < scanStart ) scanStart = patch.RegionStart;
+    size_t regionEnd = modifiableEnd(patch, BufferSize);
+    if ( regionEnd > scanEnd ) scanEnd = regionEnd;
+  }
+  if ( scanStart >= scanEnd ) return;
+
+  UINT32 state = 0;
+  for ( size_t pos = scanStart ; pos < scanEnd ; ++pos ) {
+    state = Delta[state*256 + Buffer[pos]];
+    UINT32 outState = StateOutput[state] != MAX_XSIZE ? state : DictLink[state];
+    while ( outState != 0 ) {
+      for ( size_t idx = StateOutput[outState] ; idx != MAX_XSIZE ; idx = Patches[idx].NextSameKey ) {
+        Patch& patch = Patches[idx];
+        if ( patch.Overflowed ) continue;
+        size_t start = pos + 1 - patch.KeyLen;
+        if ( start < patch.RegionStart || start - patch.RegionStart >= patch.RegionLen ) continue;
+        if ( start + patch.FindSize > BufferSize ) continue;
+        if ( patch.KeyLen < patch.FindSize  &&
+             !CompareMemMask(Buffer + start + patch.KeyLen, patch.Find + patch.KeyLen, patch.FindSize - patch.KeyLen, patch.MaskFind + patch.KeyLen, patch.FindSize - patch.KeyLen) ) {
+          continue;
+        }
+        if ( patch.Hits.size() >= MaxHitsPerPatch ) {
+          patch.Overflowed = true;
+          patch.Hits.setEmpty();
+          continue;
+        }
+        patch.Hits.Add(start);
+      }
+      outState = DictLink[outState];
+    }
+  }
+}
+
+/*
+ * Ranges are kept sorted and merged. There is only one range per replace done, so a linear insert is fine.
+ */
+void MultiPatternPatcher::addDirtyRange(size_t Start, size_t End)
+{
+  size_t idx = 0;
+  while ( idx < DirtyRanges.size() && DirtyRanges[idx].End < Start ) idx++;
+  if ( idx < DirtyRanges.size() && DirtyRanges[idx].Start <= End ) {
+    // Overlap or adjacent : extend this one, then absorb the following ones.
+    if ( Start < DirtyRanges[idx].Start ) DirtyRanges[idx].Start = Start;
+    if ( End > DirtyRanges[idx].End ) DirtyRanges[idx].End = End;
+    while ( idx + 1 < DirtyRanges.size() && DirtyRanges[idx+1].Start <= DirtyRanges[idx].End ) {
+      if ( DirtyRanges[idx+1].End > DirtyRanges[idx].End ) DirtyRanges[idx].End = DirtyRanges[idx+1].End;
+      DirtyRanges.RemoveAtIndex(idx+1);
+    }
+    return;
+  }
+  Range range;
+  range.Start = Start;
+  range.End = End;
+  DirtyRanges.Add(range);
+  for ( size_t i = DirtyRanges.size() - 1 ; i > idx ; --i ) {
+    DirtyRanges[i] = DirtyRanges[i-1];
+  }
+  DirtyRanges[idx] = range;
+}
+
+/*
+ * Same logic as SearchAndReplaceMask, but only positions that can match are visited :
+ *  - the hits recorded during the scan, if they are outside a range modified by a previous patch,
+ *  - every position that overlaps a modified range, because a previous patch can have created a match there.
+ */
+size_t MultiPatternPatcher::applyPatch(Patch& patch, UINT8* Buffer, size_t BufferSize)
+{
+  if ( patch.FindSize == 0 || patch.FindSize > BufferSize || patch.RegionStart > BufferSize - patch.FindSize ) return 0;
+
+  // Unlike SearchAndReplaceMask, never compare past the end of the buffer
+  size_t regionEnd = patch.RegionStart + patch.RegionLen;
+  if ( regionEnd < patch.RegionStart || regionEnd > BufferSize - patch.FindSize + 1 ) regionEnd = BufferSize - patch.FindSize + 1;
+
+  if ( patch.KeyLen == 0 || patch.Overflowed ) {
+    return SearchAndReplaceMask(Buffer + patch.RegionStart, regionEnd - patch.RegionStart, patch.Find, patch.MaskFind, patch.FindSize,
+                                patch.Replace, patch.MaskReplace, patch.Count, patch.Skip);
+  }
+
+  XArray<size_t> candidates;
+  size_t hitIdx = 0;
+  for ( size_t rangeIdx = 0 ; rangeIdx < DirtyRanges.size() ; ++rangeIdx ) {
+    size_t windowStart = DirtyRanges[rangeIdx].Start + 1 >= patch.FindSize ? DirtyRanges[rangeIdx].Start + 1 - patch.FindSize : 0;
+    size_t windowEnd = DirtyRanges[rangeIdx].End;
+    if ( windowStart < patch.RegionStart ) windowStart = patch.RegionStart;
+    if ( windowEnd > regionEnd ) windowEnd = regionEnd;
+    if ( candidates.size() > 0  &&  windowStart <= candidates[candidates.size()-1] ) windowStart = candidates[candidates.size()-1] + 1;
+    while ( hitIdx < patch.Hits.size() && patch.Hits[hitIdx] < windowStart ) candidates.Add(patch.Hits[hitIdx++]);
+    while ( hitIdx < patch.Hits.size() && patch.Hits[hitIdx] < windowEnd ) hitIdx++;
+    for ( size_t pos = windowStart ; pos < windowEnd && pos + patch.FindSize <= BufferSize ; ++pos ) {
+      if ( CompareMemMask(Buffer + pos, patch.Find, patch.FindSize, patch.MaskFind, patch.FindSize) ) candidates.Add(pos);
+    }
+  }
+  while ( hitIdx < patch.Hits.size() ) candidates.Add(patch.Hits[hitIdx++]);
+
+  size_t numReplaces = 0;
+  INTN   maxReplaces = patch.Count;
+  INTN   skip = patch.Skip;
+  size_t nextPos = patch.RegionStart;
+  for ( size_t idx = 0 ; idx < candidates.size() ; ++idx ) {
+    if ( patch.Count > 0 && maxReplaces <= 0 ) break;
+    size_t pos = candidates[idx];
+    if ( pos < nextPos ) continue; // overlaps the previous match
+    if ( !CompareMemMask(Buffer + pos, patch.Find, patch.FindSize, patch.MaskFind, patch.FindSize) ) continue;
+    if ( skip == 0 ) {
+      CopyMemMask(Buffer + pos, patch.Replace, patch.MaskReplace, patch.FindSize);
+      DBG("Replace at ofs:%zX\n", pos);
+      addDirtyRange(pos, pos + patch.FindSize);
+      numReplaces++;
+      maxReplaces--;
+    }else{
+      --skip;
+    }
+    nextPos = pos + patch.FindSize;
+  }
+  return numReplaces;
+}
+
+size_t MultiPatternPatcher::apply(UINT8* Buffer, size_t BufferSize)
+{
+  size_t total = 0;
+
+  DirtyRanges.setEmpty();
+  if ( !Buffer || Patches.isEmpty() ) return 0;
+
+  compile();
+  scan(Buffer, BufferSize);
+  for ( size_t idx = 0 ; idx < Patches.size() ; ++idx ) {
+    Patch& patch = Patches[idx];
+    if ( patch.KeyLen == 0 || patch.Overflowed ) {
+      // Positions modified by SearchAndReplaceMask are not known, so every following patch has to check everything again.
+      patch.ReplacesDone = applyPatch(patch, Buffer, BufferSize);
+      if ( patch.ReplacesDone > 0 ) {
+        addDirtyRange(patch.RegionStart, modifiableEnd(patch, BufferSize));
+      }
+    }else{
+      patch.ReplacesDone = applyPatch(patch, Buffer, BufferSize);
+    }
+    total += patch.ReplacesDone;
+  }
+  return total;
+}
@@ -0,0 +1,103 @@
+/*
+ * MultiPatternPatcher.h
+ *
+ * Applies a set of masked Find/Replace patches with a single scan of the buffer.
+ * The unmasked prefix of every Find pattern is compiled into an Aho-Corasick
+ * automaton, masks are checked at each candidate position.
+ *
+ * Patches are still applied in the order they were added, with the same
+ * semantic as consecutive calls to SearchAndReplaceMask() : a patch sees the
+ * bytes modified by the patches added before it.
+ */
+
+#ifndef PLATFORM_MULTIPATTERNPATCHER_H_
+#define PLATFORM_MULTIPATTERNPATCHER_H_
+
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XObjArray.h"
+
+
+class MultiPatternPatcher
+{
+public:
+  // If a pattern is found more than that, it's not worth keeping every hit. It will be applied with SearchAndReplaceMask().
+  static const size_t MaxHitsPerPatch = 4096;
+
+protected:
+  class Patch
+  {
+  public:
+    // Pointers are not owned. They must stay valid until apply() returns.
+    const UINT8* Find = NULL;
+    const UINT8* MaskFind = NULL;
+    size_t       FindSize = 0;
+    const UINT8* Replace = NULL;
+    const UINT8* MaskReplace = NULL;
+    size_t       RegionStart = 0;
+    size_t       RegionLen = 0;
+    INTN         Count = 0;
+    INTN         Skip = 0;
+    size_t       Tag = 0;
+
+    // Computed
+    size_t         KeyLen = 0;            // number of leading bytes of Find with a 0xFF mask. 0 means not in the automaton.
+    size_t         NextSameKey = MAX_XSIZE; // next patch ending on the same automaton state
+    bool           Overflowed = false;
+    XArray<size_t> Hits = XArray<size_t>();
+    size_t         ReplacesDone = 0;
+
+    Patch() {}
+    Patch(const Patch&) = delete;
+    Patch& operator=(const Patch&) = delete;
+  };
+
+  class Range
+  {
+  public:
+    size_t Start;
+    size_t End;
+  };
+
+  XObjArray<Patch> Patches;
+  XArray<UINT32>   Delta = XArray<UINT32>();        // 256 transitions per state
+  XArray<size_t>   StateOutput = XArray<size_t>();  // first patch whose key ends at this state, or MAX_XSIZE
+  XArray<UINT32>   DictLink = XArray<UINT32>();     // nearest state on the failure chain with an output, 0 if none
+  XArray<Range>    DirtyRanges = XArray<Range>();   // sorted, non overlapping ranges modified by apply()
+
+  static size_t modifiableEnd(const Patch& patch, size_t BufferSize);
+  void compile();
+  void scan(const UINT8* Buffer, size_t BufferSize);
+  void addDirtyRange(size_t Start, size_t End);
+  size_t applyPatch(Patch& patch, UINT8* Buffer, size_t BufferSize);
+
+public:
+  MultiPatternPatcher() {}
+  MultiPatternPatcher(const MultiPatternPatcher&) = delete;
+  MultiPatternPatcher& operator=(const MultiPatternPatcher&) = delete;
+
+  /*
+   * Region is [RegionStart, RegionStart+RegionLen[ of the buffer that will be given to apply().
+   * Count <= 0 means no limit. Skip is the number of matches to ignore before the first replace.
+   * Tag is not used by the patcher. It's a convenience for the caller to know where the patch comes from.
+   * Returns the index of the patch.
+   */
+  size_t addPatch(const UINT8* Find, const UINT8* MaskFind, size_t FindSize,
+                  const UINT8* Replace, const UINT8* MaskReplace,
+                  size_t RegionStart, size_t RegionLen, INTN Count, INTN Skip, size_t Tag);
+
+  size_t size() const { return Patches.size(); }
+  bool isEmpty() const { return Patches.isEmpty(); }
+  size_t tag(size_t idx) const { return Patches[idx].Tag; }
+  size_t replacesDone(size_t idx) const { return Patches[idx].ReplacesDone; }
+
+  /*
+   * Scan Buffer once and apply all the patches, in the order they were added.
+   * Returns the total number of replaces done.
+   */
+  size_t apply(UINT8* Buffer, size_t BufferSize);
+
+  void setEmpty();
+};
+
+
+#endif /* PLATFORM_MULTIPATTERNPATCHER_H_ */
@@ -0,0 +1,109 @@
+/*
+ * PrelinkInfoIndex.cpp
+ *
+ * See PrelinkInfoIndex.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "PrelinkInfoIndex.h"
+
+
+//
+// IDStart points just after ID=" or IDREF=" . Returns a pointer to the closing quote,
+// or NULL if the ID can't be indexed (not canonical decimal, or too big).
+//
+CONST CHAR8* PrelinkInfoIndex::parseID(CONST CHAR8* IDStart, UINTN* ID)
+{
+  CONST CHAR8* IDEnd = IDStart;
+
+  *ID = 0;
+  while (*IDEnd >= '0' && *IDEnd <= '9') {
+    if (IDEnd - IDStart >= 8) {
+      return NULL;
+    }
+    *ID = *ID * 10 + (*IDEnd - '0');
+    IDEnd++;
+  }
+  if (IDEnd == IDStart || *IDEnd != '"' || (IDStart[0] == '0' && IDEnd - IDStart > 1) || *ID >= MaxIndexedID) {
+    return NULL;
+  }
+  return IDEnd;
+}
+
+void PrelinkInfoIndex::build(CHAR8* WholePlist)
+{
+  CHAR8* Tag;
+  CHAR8* InfoPlistStart = NULL;
+  INTN   DictLevel = 0;
+
+  Kexts.setEmpty();
+  IntegerValues.setEmpty();
+  IntegerKnown.setEmpty();
+
+  for (Tag = WholePlist; (Tag = strchr(Tag, '<')) != NULL; ++Tag) {
+    if (strncmp(Tag + 1, "dict>", 5) == 0) {
+      // opening dict
+      DictLevel++;
+      if (DictLevel == 2) {
+        // kext start
+        InfoPlistStart = Tag;
+      }
+      Tag += 5;
+    } else if (strncmp(Tag + 1, "/dict>", 6) == 0) {
+      // closing dict
+      if (DictLevel == 2 && InfoPlistStart != NULL) {
+        KextRange Range;
+        Range.Start = InfoPlistStart;
+        Range.End = Tag + 7;
+        Kexts.Add(Range);
+      }
+      DictLevel--;
+      Tag += 6;
+    } else if (strncmp(Tag + 1, "integer ID=\"", 12) == 0) {
+      addInteger(Tag);
+      Tag += 12;
+    }
+  }
+}
+
+//
+// IntTag points to <integer ID="n" ...>value</integer>
+// Like the search in the whole plist, only the first occurrence of an ID counts.
+//
+void PrelinkInfoIndex::addInteger(CONST CHAR8* IntTag)
+{
+  CONST CHAR8* IDEnd;
+  CONST CHAR8* Value;
+  UINTN        ID;
+
+  IDEnd = parseID(IntTag + 13, &ID);
+  if (IDEnd == NULL) {
+    return;
+  }
+  if (ID < IntegerKnown.size() && IntegerKnown[ID]) {
+    return;
+  }
+  Value = strchr(IDEnd, '>');
+  if (Value == NULL || Value[-1] == '/') {
+    return;
+  }
+  if (ID >= IntegerKnown.size()) {
+    IntegerValues.CheckSize(ID + 1, ID + 1);
+    IntegerKnown.CheckSize(ID + 1, ID + 1);
+    IntegerValues.Add(0, ID + 1 - IntegerValues.size());
+    IntegerKnown.Add(0, ID + 1 - IntegerKnown.size());
+  }
+  IntegerValues[ID] = AsciiStrHexToUint64(Value + 1);
+  IntegerKnown[ID] = 1;
+}
+
+BOOLEAN PrelinkInfoIndex::getInteger(CONST CHAR8* IDStart, UINT64* Value) const
+{
+  UINTN ID;
+
+  if (parseID(IDStart, &ID) == NULL || ID >= IntegerKnown.size() || !IntegerKnown[ID]) {
+    return FALSE;
+  }
+  *Value = IntegerValues[ID];
+  return TRUE;
+}
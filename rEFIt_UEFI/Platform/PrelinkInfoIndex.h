@@ -0,0 +1,52 @@
+/*
+ * PrelinkInfoIndex.h
+ *
+ * Result of a single pass over the prelink info plist :
+ * - the byte range of each kext Info.plist (dict at level 2)
+ * - the value of each <integer ID="n" ...>, indexed by n
+ * Before that, the whole plist was searched again for each IDREF, for each kext.
+ */
+
+#ifndef PLATFORM_PRELINKINFOINDEX_H_
+#define PLATFORM_PRELINKINFOINDEX_H_
+
+#include "../cpp_foundation/XArray.h"
+
+
+class PrelinkInfoIndex
+{
+public:
+  class KextRange
+  {
+  public:
+    CHAR8* Start; // "<dict>"
+    CHAR8* End;   // just after "</dict>"
+  };
+
+  // IDs are small consecutive numbers. Bigger ones are not indexed and will be searched in the plist.
+  static const UINTN MaxIndexedID = 0x100000;
+
+  XArray<KextRange> Kexts = XArray<KextRange>();
+  XArray<UINT64>    IntegerValues = XArray<UINT64>(); // IntegerValues[n] : value of <integer ID="n">
+  XArray<UINT8>     IntegerKnown = XArray<UINT8>();   // 1 if IntegerValues[n] is valid
+
+  PrelinkInfoIndex() {}
+  PrelinkInfoIndex(const PrelinkInfoIndex&) = delete;
+  PrelinkInfoIndex& operator=(const PrelinkInfoIndex&) = delete;
+
+  /*
+   * WholePlist is the zero terminated _PrelinkInfoDictionary. Kexts point into it.
+   */
+  void build(CHAR8* WholePlist);
+  /*
+   * IDStart points just after IDREF=" . FALSE if this ID is not indexed : the plist must be searched for it.
+   */
+  BOOLEAN getInteger(CONST CHAR8* IDStart, UINT64* Value) const;
+
+protected:
+  static CONST CHAR8* parseID(CONST CHAR8* IDStart, UINTN* ID);
+  void addInteger(CONST CHAR8* IntTag);
+};
+
+
+#endif /* PLATFORM_PRELINKINFOINDEX_H_ */
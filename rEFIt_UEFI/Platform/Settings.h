@@ -719,6 +719,7 @@ public:
       XStringW                DefaultVolume = XStringW();
       XStringW                DefaultLoader = XStringW();
       bool                    DebugLog = false;
+      UINT32                  DebugFlushInterval = 1000;
       bool                    FastBoot = false;
       bool                    NoEarlyProgress = false;
       bool                    NeverHibernate = false;
@@ -755,6 +756,7 @@ public:
         if ( !(DefaultVolume == other.DefaultVolume) ) return false;
         if ( !(DefaultLoader == other.DefaultLoader) ) return false;
         if ( !(DebugLog == other.DebugLog) ) return false;
+        if ( !(DebugFlushInterval == other.DebugFlushInterval) ) return false;
         if ( !(FastBoot == other.FastBoot) ) return false;
         if ( !(NoEarlyProgress == other.NoEarlyProgress) ) return false;
         if ( !(NeverHibernate == other.NeverHibernate) ) return false;
@@ -785,6 +787,7 @@ public:
         DefaultVolume = configPlist.dgetDefaultVolume();
         DefaultLoader = configPlist.dgetDefaultLoader();
         DebugLog = configPlist.dgetDebugLog();
+        DebugFlushInterval = configPlist.dgetDebugFlushInterval();
         FastBoot = configPlist.dgetFastBoot();
         NoEarlyProgress = configPlist.dgetNoEarlyProgress();
         NeverHibernate = configPlist.dgetNeverHibernate();
@@ -2726,6 +2729,9 @@ public:
   XStringW       FileName = XStringW();
   XStringW       KextDirNameUnderOEMPath = XStringW();
   XStringW       Version = XStringW();
+  XString8       Executable = XString8(); // CFBundleExecutable
+  BOOLEAN        InfoPlistFound = FALSE;
+  BOOLEAN        NoContents = FALSE;      // planar kext, without Contents
   INPUT_ITEM     MenuItem = INPUT_ITEM();
   
   SIDELOAD_KEXT() : PlugInList() {};
@@ -0,0 +1,244 @@
+/*
+ * SpdSnapshot.cpp
+ *
+ * See SpdSnapshot.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SpdSnapshot.h"
+#include "../cpp_foundation/fnv_hash.h"
+
+#define SPD_SNAPSHOT_MAGIC "CLSPDSNP"
+#define HEADER_SIZE 16
+#define SLOT_HEADER_SIZE 8
+#define SLOT_SIZE (SLOT_HEADER_SIZE + SpdSnapshot::LoadedSize + SpdSnapshot::SpdSize)
+
+// Intel SMB reg offsets
+#define SMBHSTSTS 0
+#define SMBHSTCNT 2
+#define SMBHSTADD 4
+#define SMBHSTDAT1 6
+#define SMBBLKDAT 7
+
+// SMBHSTSTS bits
+#define SMBHSTSTS_HOST_BUSY 0x01
+#define SMBHSTSTS_INTR      0x02
+#define SMBHSTSTS_DEV_ERR   0x04
+#define SMBHSTSTS_BUS_ERR   0x08
+#define SMBHSTSTS_FAILED    0x10
+#define SMBHSTSTS_BYTE_DONE 0x80
+#define SMBHSTSTS_ERRORS    (SMBHSTSTS_DEV_ERR | SMBHSTSTS_BUS_ERR | SMBHSTSTS_FAILED)
+#define SMBHSTSTS_FLAGS     (SMBHSTSTS_BYTE_DONE | SMBHSTSTS_INTR | SMBHSTSTS_ERRORS)
+
+// SMBHSTCNT bits
+#define SMBHSTCNT_KILL      0x02
+#define SMBHSTCNT_I2C_BLOCK 0x18
+#define SMBHSTCNT_LAST_BYTE 0x20
+#define SMBHSTCNT_START     0x40
+
+#define SMB_TIMEOUT_MS 5
+
+
+static UINT32 GetUint32(const UINT8* p)
+{
+  UINT32 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void SetUint32(UINT8* p, UINT32 v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+static UINT16 GetUint16(const UINT8* p)
+{
+  UINT16 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+// Stop the transaction and leave the controller ready for the next one
+static void SmbusKill(SmbusIo& Io, UINT32 Base)
+{
+  Io.write8(Base + SMBHSTCNT, SMBHSTCNT_KILL);
+  Io.write8(Base + SMBHSTCNT, 0);
+  Io.write8(Base + SMBHSTSTS, SMBHSTSTS_FLAGS);
+}
+
+bool SmbusI2cBlockRead(SmbusIo& Io, UINT32 Base, UINT8 Adr, UINT8 Cmd, UINT8* Buffer, UINT8 Length, bool SetReadBit)
+{
+  UINT8 Status;
+  UINT64 Start;
+
+  if (Length == 0 || Length > 32) {
+    return false;
+  }
+  Start = Io.milliseconds();
+  while ((Status = Io.read8(Base + SMBHSTSTS)) & SMBHSTSTS_HOST_BUSY) {
+    if (Io.milliseconds() - Start > SMB_TIMEOUT_MS) {
+      return false;
+    }
+  }
+  Io.write8(Base + SMBHSTSTS, Status & SMBHSTSTS_FLAGS); // what the last transaction left
+
+  // The ICH datasheet has the R/W bit cleared for an I2C read, and the offset in DATA1
+  Io.write8(Base + SMBHSTADD, (UINT8)((Adr << 1) | (SetReadBit ? 1 : 0)));
+  Io.write8(Base + SMBHSTDAT1, Cmd);
+  UINT8 Control = SMBHSTCNT_I2C_BLOCK;
+  if (Length == 1) {
+    Control |= SMBHSTCNT_LAST_BYTE;
+  }
+  Io.write8(Base + SMBHSTCNT, Control | SMBHSTCNT_START);
+
+  for (UINT8 i = 0; i < Length; i++) {
+    Start = Io.milliseconds();
+    while (!((Status = Io.read8(Base + SMBHSTSTS)) & (SMBHSTSTS_BYTE_DONE | SMBHSTSTS_ERRORS))) {
+      if (Io.milliseconds() - Start > SMB_TIMEOUT_MS) {
+        SmbusKill(Io, Base);
+        return false;
+      }
+    }
+    if (Status & SMBHSTSTS_ERRORS) {
+      SmbusKill(Io, Base);
+      return false;
+    }
+    Buffer[i] = Io.read8(Base + SMBBLKDAT);
+    if (i + 2 == Length) {
+      Io.write8(Base + SMBHSTCNT, Control | SMBHSTCNT_LAST_BYTE); // the next one is the last
+    }
+    Io.write8(Base + SMBHSTSTS, SMBHSTSTS_BYTE_DONE); // go on
+  }
+
+  Start = Io.milliseconds();
+  for (;;) {
+    Status = Io.read8(Base + SMBHSTSTS);
+    if (!(Status & SMBHSTSTS_HOST_BUSY) && (Status & (SMBHSTSTS_INTR | SMBHSTSTS_ERRORS))) {
+      break;
+    }
+    if (Io.milliseconds() - Start > SMB_TIMEOUT_MS) {
+      SmbusKill(Io, Base);
+      return false;
+    }
+  }
+  Io.write8(Base + SMBHSTSTS, Status & SMBHSTSTS_FLAGS);
+  return (Status & SMBHSTSTS_ERRORS) == 0;
+}
+
+
+static bool HasSerial(const UINT8* Serial)
+{
+  bool AllZero = true;
+  bool AllFF = true;
+  for (UINT16 i = 0; i < SpdSnapshot::SerialSize; ++i) {
+    AllZero = AllZero && Serial[i] == 0;
+    AllFF = AllFF && Serial[i] == 0xFF;
+  }
+  return !AllZero && !AllFF;
+}
+
+bool SpdSnapshot::isValid(const XBuffer<UINT8>& Buffer)
+{
+  const UINT8* p = Buffer.data();
+  size_t Size = Buffer.size();
+  if (Size < HEADER_SIZE || memcmp(p, SPD_SNAPSHOT_MAGIC, 8) != 0 || GetUint32(p + 8) != Version) {
+    return false;
+  }
+  UINT32 NbSlots = GetUint32(p + 12);
+  if ((Size - HEADER_SIZE) % SLOT_SIZE != 0 || (Size - HEADER_SIZE) / SLOT_SIZE != NbSlots) {
+    return false;
+  }
+  for (size_t Offset = HEADER_SIZE; Offset < Size; Offset += SLOT_SIZE) {
+    UINT16 SerialOffset = GetUint16(p + Offset + 2);
+    if (SerialOffset > SpdSize - SerialSize ||
+        GetUint32(p + Offset + 4) != fnv1a32(p + Offset + SLOT_HEADER_SIZE, SLOT_SIZE - SLOT_HEADER_SIZE)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SpdSnapshot::load(UINT8* FileData, size_t FileSize)
+{
+  setEmpty();
+  UINT8 Header[HEADER_SIZE];
+  memcpy(Header, SPD_SNAPSHOT_MAGIC, 8);
+  SetUint32(Header + 8, Version);
+  SetUint32(Header + 12, 0);
+  Data.ncat(Header, sizeof(Header));
+
+  if (FileData == NULL) {
+    return false;
+  }
+  Saved.stealValueFrom(FileData, FileSize);
+  if (!isValid(Saved)) {
+    Saved.stealValueFrom((UINT8*)NULL, (size_t)0);
+    return false;
+  }
+  return true;
+}
+
+void SpdSnapshot::setEmpty()
+{
+  // free them, setEmpty() would keep the memory
+  Saved.stealValueFrom((UINT8*)NULL, (size_t)0);
+  Data.stealValueFrom((UINT8*)NULL, (size_t)0);
+}
+
+const UINT8* SpdSnapshot::findSlot(const XBuffer<UINT8>& Buffer, UINT8 Slot) const
+{
+  for (size_t Offset = HEADER_SIZE; Offset < Buffer.size(); Offset += SLOT_SIZE) {
+    if (Buffer.data()[Offset] == Slot) {
+      return Buffer.data() + Offset;
+    }
+  }
+  return NULL;
+}
+
+bool SpdSnapshot::get(UINT8 Slot, UINT8* Spd, UINT8* Loaded) const
+{
+  const UINT8* p = findSlot(Saved, Slot);
+  if (p == NULL || p[1] != Spd[2]) { // SPD_MEMORY_TYPE
+    return false;
+  }
+  const UINT8* SavedLoaded = p + SLOT_HEADER_SIZE;
+  const UINT8* SavedSpd = SavedLoaded + LoadedSize;
+  UINT16 SerialOffset = GetUint16(p + 2);
+  if (memcmp(Spd + SerialOffset, SavedSpd + SerialOffset, SerialSize) != 0 || !HasSerial(Spd + SerialOffset)) {
+    return false;
+  }
+  memcpy(Loaded, SavedLoaded, LoadedSize);
+  memcpy(Spd, SavedSpd, SpdSize);
+  return true;
+}
+
+void SpdSnapshot::add(UINT8 Slot, UINT16 SerialOffset, const UINT8* Spd, const UINT8* Loaded)
+{
+  if (!isOpen() || SerialOffset > SpdSize - SerialSize || !HasSerial(Spd + SerialOffset) || findSlot(Data, Slot) != NULL) {
+    return;
+  }
+  for (UINT16 i = 0; i < SerialSize; ++i) {
+    if (!isLoaded(Loaded, SerialOffset + i)) {
+      return;
+    }
+  }
+  UINT8 SlotHeader[SLOT_HEADER_SIZE];
+  SlotHeader[0] = Slot;
+  SlotHeader[1] = Spd[2]; // SPD_MEMORY_TYPE
+  memcpy(SlotHeader + 2, &SerialOffset, sizeof(SerialOffset));
+  SetUint32(SlotHeader + 4, fnv1a32(Spd, SpdSize, fnv1a32(Loaded, LoadedSize)));
+  Data.ncat(SlotHeader, sizeof(SlotHeader));
+  Data.ncat(Loaded, LoadedSize);
+  Data.ncat(Spd, SpdSize);
+  SetUint32(Data.data() + 12, GetUint32(Data.data() + 12) + 1);
+}
+
+bool SpdSnapshot::isModified() const
+{
+  return isOpen() && (Data.size() != Saved.size() || memcmp(Data.data(), Saved.data(), Data.size()) != 0);
+}
+
+size_t SpdSnapshot::getNbSlots() const
+{
+  return isOpen() ? GetUint32(Data.data() + 12) : 0;
+}
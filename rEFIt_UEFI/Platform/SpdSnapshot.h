@@ -0,0 +1,95 @@
+/*
+ * SpdSnapshot.h
+ *
+ * The SPD bytes read by ScanSPD, kept in a file on the ESP. Each SMBus access is a transaction waited for
+ * by polling, so the next boot reads only the memory type and the serial number of each module, and takes
+ * the other bytes from the snapshot if they are the same as when it was made.
+ *
+ * A module without a serial number (all 0 or all FF) is not kept : another module could take its place unnoticed.
+ *
+ * File format, little endian, the memory image is the file itself :
+ *   header : Magic[8] "CLSPDSNP", UINT32 Version, UINT32 NbSlots
+ *   NbSlots times : UINT8 Slot, UINT8 MemoryType, UINT16 SerialOffset, UINT32 Checksum,
+ *                   Loaded[LoadedSize] one bit by SPD byte that was read, Spd[SpdSize]
+ * Checksum is FNV-1a 32 of what follows it in the slot.
+ *
+ * SmbusIo and SmbusI2cBlockRead are the I2C block read of the Intel ICH/PCH SMBus controller, to read the SPD
+ * 32 bytes at a time. The port accesses go through SmbusIo, so it can be tested without the hardware.
+ */
+
+#ifndef PLATFORM_SPDSNAPSHOT_H_
+#define PLATFORM_SPDSNAPSHOT_H_
+
+#include "../cpp_foundation/XBuffer.h"
+
+
+class SmbusIo
+{
+public:
+  virtual ~SmbusIo() {}
+  virtual UINT8 read8(UINT32 Port) = 0;
+  virtual void write8(UINT32 Port, UINT8 Value) = 0;
+  // any time in milliseconds, for the timeouts
+  virtual UINT64 milliseconds() = 0;
+};
+
+/*
+ * Read Length bytes (1 to 32) from the offset Cmd of the device Adr, on the ICH/PCH SMBus controller at Base.
+ * SetReadBit must be true if the controller has SPD Write Disable set (Lynx Point and later).
+ * Returns false if the controller stays busy, reports an error or times out. Buffer may then be partly written.
+ */
+bool SmbusI2cBlockRead(SmbusIo& Io, UINT32 Base, UINT8 Adr, UINT8 Cmd, UINT8* Buffer, UINT8 Length, bool SetReadBit);
+
+
+class SpdSnapshot
+{
+public:
+  static const UINT32 Version = 1;
+  static const UINT16 SpdSize = 0x1E7; // MAX_SPD_SIZE
+  static const UINT16 LoadedSize = (SpdSize + 7) / 8;
+  static const UINT16 SerialSize = 4;
+
+protected:
+  XBuffer<UINT8> Saved; // the file read at boot, empty if it is not valid
+  XBuffer<UINT8> Data;  // the slots of this boot, as they will be saved
+
+  const UINT8* findSlot(const XBuffer<UINT8>& Buffer, UINT8 Slot) const;
+  static bool isValid(const XBuffer<UINT8>& Buffer);
+
+public:
+  SpdSnapshot() : Saved(), Data() {}
+  SpdSnapshot(const SpdSnapshot&) = delete;
+  SpdSnapshot& operator=(const SpdSnapshot&) = delete;
+
+  static bool isLoaded(const UINT8* Loaded, UINT16 Index) { return (Loaded[Index >> 3] >> (Index & 7)) & 1; }
+  static void setLoaded(UINT8* Loaded, UINT16 Index) { Loaded[Index >> 3] |= (UINT8)(1 << (Index & 7)); }
+
+  /*
+   * Open the snapshot with the one read from a file, FileData may be NULL. FileData is taken, it must be allocated
+   * by AllocatePool or malloc. Returns false if it is not a valid snapshot : no slot will be found in it.
+   * The slots of this boot are then added, empty at first.
+   */
+  bool load(UINT8* FileData, size_t FileSize);
+  void setEmpty();
+
+  /*
+   * Spd has the memory type and the serial number of the module in Slot, just read. If the snapshot has the same module
+   * in Slot, its bytes are copied into Spd and Loaded (SpdSize and LoadedSize bytes) and true is returned.
+   */
+  bool get(UINT8 Slot, UINT8* Spd, UINT8* Loaded) const;
+  /*
+   * Keep the bytes of Spd marked in Loaded for the module in Slot, its serial number at SerialOffset.
+   * Nothing is done if the snapshot is not open, for a module without serial number, or if Slot was already added.
+   */
+  void add(UINT8 Slot, UINT16 SerialOffset, const UINT8* Spd, const UINT8* Loaded);
+
+  bool isOpen() const { return Data.size() != 0; }
+  // true if the slots added are not what was loaded, the file must be saved
+  bool isModified() const;
+  size_t getNbSlots() const;
+  // the file to save
+  const XBuffer<UINT8>& getData() const { return Data; }
+};
+
+
+#endif /* PLATFORM_SPDSNAPSHOT_H_ */
@@ -12,6 +12,7 @@
 #include <Efi.h>
 #include "../cpp_foundation/XString.h"
 #include "../libeg/libeg.h"
+#include "VolumeDirCache.h"
 
 
 class LEGACY_OS
@@ -57,6 +58,7 @@ public:
   XString8            ApfsContainerUUID = XString8();
   APPLE_APFS_VOLUME_ROLE  ApfsRole = 0;
   XString8Array        ApfsTargetUUIDArray = XString8Array(); // this is the array of folders that are named as UUID
+  VolumeDirCache       DirCache;  // only enabled during ScanLoader()
 
   REFIT_VOLUME() {};
   REFIT_VOLUME(const REFIT_VOLUME& other) = delete; // Can be defined if needed
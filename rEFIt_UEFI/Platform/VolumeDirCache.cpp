@@ -0,0 +1,201 @@
+/*
+ * VolumeDirCache.cpp
+ *
+ * See VolumeDirCache.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "VolumeDirCache.h"
+
+extern "C" {
+#include <Library/MemoryAllocationLib.h>
+}
+
+#ifndef DEBUG_ALL
+#define DEBUG_VOLUMEDIRCACHE 1
+#else
+#define DEBUG_VOLUMEDIRCACHE DEBUG_ALL
+#endif
+
+#if DEBUG_VOLUMEDIRCACHE == 0
+#define DBG(...)
+#else
+#define DBG(...) DebugLog(DEBUG_VOLUMEDIRCACHE, __VA_ARGS__)
+#endif
+
+
+// Same as FileExists() in refit/lib.cpp
+static BOOLEAN openAndClose(const EFI_FILE* Root, const CHAR16* RelativePath)
+{
+  EFI_FILE* TestFile = NULL;
+  EFI_STATUS Status = Root->Open(Root, &TestFile, RelativePath, EFI_FILE_MODE_READ, 0);
+  if (Status == EFI_SUCCESS) {
+    if (TestFile && TestFile->Close) {
+      TestFile->Close(TestFile);
+    }
+    return TRUE;
+  }
+  return FALSE;
+}
+
+static inline CHAR16 lowerAscii(CHAR16 c) { return (c >= 'A' && c <= 'Z') ? (CHAR16)(c - 'A' + 'a') : c; }
+
+int VolumeDirCache::compareIC(const CHAR16* Name1, size_t Len1, const CHAR16* Name2, size_t Len2)
+{
+  size_t Len = Len1 < Len2 ? Len1 : Len2;
+  for (size_t i = 0; i < Len; ++i) {
+    CHAR16 c1 = lowerAscii(Name1[i]);
+    CHAR16 c2 = lowerAscii(Name2[i]);
+    if (c1 != c2) return c1 < c2 ? -1 : 1;
+  }
+  if (Len1 == Len2) return 0;
+  return Len1 < Len2 ? -1 : 1;
+}
+
+// FAT opens a file by its 8.3 alias too, as BOOTX6~1.EFI, but Read() only gives the long name
+bool VolumeDirCache::mayBeShortName(const CHAR16* Name, size_t Len)
+{
+  for (size_t i = 0; i < Len; ++i) {
+    if (Name[i] == '~') return true;
+  }
+  return false;
+}
+
+size_t VolumeDirCache::Dir::lowerBound(const CHAR16* Name, size_t Len) const
+{
+  size_t low = 0;
+  size_t high = Entries.size();
+  while (low < high) {
+    size_t mid = low + (high - low) / 2;
+    if (compareIC(Entries[mid].Name.wc_str(), Entries[mid].Name.length(), Name, Len) < 0) low = mid + 1;
+    else high = mid;
+  }
+  return low;
+}
+
+void VolumeDirCache::Dir::read(const EFI_FILE* Root)
+{
+  EFI_FILE* Handle = NULL;
+  // a new handle for the root too, to not move the position of Root
+  if (EFI_ERROR(Root->Open(Root, &Handle, Path.isEmpty() ? L"\\" : Path.wc_str(), EFI_FILE_MODE_READ, 0))) return;
+  Readable = true;
+
+  UINTN AllocatedSize = SIZE_OF_EFI_FILE_INFO + 256 * sizeof(CHAR16);
+  EFI_FILE_INFO* FileInfo = (EFI_FILE_INFO*)AllocatePool(AllocatedSize);
+  while (FileInfo != NULL) {
+    UINTN BufferSize = AllocatedSize;
+    EFI_STATUS Status = Handle->Read(Handle, &BufferSize, FileInfo);
+    if (Status == EFI_BUFFER_TOO_SMALL && BufferSize > AllocatedSize) {
+      FreePool(FileInfo);
+      FileInfo = (EFI_FILE_INFO*)AllocatePool(BufferSize);
+      AllocatedSize = BufferSize;
+      continue;
+    }
+    if (EFI_ERROR(Status)) break;
+    if (BufferSize == 0) {
+      Complete = true;
+      break;
+    }
+    const CHAR16* Name = FileInfo->FileName;
+    if (Name[0] == '.' && (Name[1] == 0 || (Name[1] == '.' && Name[2] == 0))) continue;
+    if (Entries.size() >= MaxEntriesPerDir) break;
+
+    DirEntry* Entry = new DirEntry;
+    Entry->Name.takeValueFrom(Name);
+    Entry->IsDir = (FileInfo->Attribute & EFI_FILE_DIRECTORY) != 0;
+    // equal names ignoring case stay in directory order
+    size_t pos = lowerBound(Entry->Name.wc_str(), Entry->Name.length());
+    while (pos < Entries.size() && compareIC(Entries[pos].Name.wc_str(), Entries[pos].Name.length(), Entry->Name.wc_str(), Entry->Name.length()) == 0) pos++;
+    Entries.InsertRef(Entry, pos, true);
+  }
+  if (FileInfo != NULL) FreePool(FileInfo);
+
+  Handle->Close(Handle);
+}
+
+void VolumeDirCache::enable(const EFI_FILE* aRoot)
+{
+  setEmpty();
+  Root = aRoot;
+  Enabled = aRoot != NULL;
+}
+
+void VolumeDirCache::setEmpty()
+{
+  if (Enabled && (NbOpenSaved > 0 || NbDirRead > 0)) {
+    DBG("    directory cache: %zu directories read, %zu opens saved\n", NbDirRead, NbOpenSaved);
+  }
+  Enabled = false;
+  Root = NULL;
+  Dirs.setEmpty();
+  NbOpenSaved = 0;
+  NbDirRead = 0;
+}
+
+VolumeDirCache::Dir* VolumeDirCache::getDir(const XStringW& Path)
+{
+  for (size_t idx = 0; idx < Dirs.size(); ++idx) {
+    if (Dirs[idx].Path == Path) return &Dirs[idx];
+  }
+  Dir* NewDir = new Dir;
+  NewDir->Path = Path;
+  NewDir->read(Root);
+  NbDirRead++;
+  Dirs.AddReference(NewDir, true);
+  return NewDir;
+}
+
+VolumeDirCache::LookupResult VolumeDirCache::lookup(const Dir& dir, const CHAR16* Name, size_t Len, const DirEntry** Entry) const
+{
+  bool MatchIgnoringCase = false;
+  for (size_t idx = dir.lowerBound(Name, Len); idx < dir.Entries.size(); ++idx) {
+    const DirEntry& Candidate = dir.Entries[idx];
+    if (compareIC(Candidate.Name.wc_str(), Candidate.Name.length(), Name, Len) != 0) break;
+    if (Candidate.Name.length() == Len && memcmp(Candidate.Name.wc_str(), Name, Len * sizeof(CHAR16)) == 0) {
+      *Entry = &Candidate;
+      return Found;
+    }
+    MatchIgnoringCase = true;
+  }
+  if (MatchIgnoringCase || !dir.Complete || mayBeShortName(Name, Len)) return Unsure;
+  return NotFound;
+}
+
+BOOLEAN VolumeDirCache::fileExists(const EFI_FILE* aRoot, const CHAR16* RelativePath)
+{
+  if (!Enabled || aRoot != Root || RelativePath == NULL) {
+    return openAndClose(aRoot, RelativePath);
+  }
+
+  const CHAR16* p = RelativePath;
+  while (*p == '\\') p++;
+  Dir* dir = getDir(XStringW());
+  while (*p != 0) {
+    const CHAR16* end = p;
+    while (*end != 0 && *end != '\\') {
+      if (*end >= 0x80 || *end == '/') return openAndClose(aRoot, RelativePath);
+      end++;
+    }
+    size_t Len = (size_t)(end - p);
+    if (Len == 0 || (p[0] == '.' && (Len == 1 || (Len == 2 && p[1] == '.'))) || (*end == '\\' && end[1] == 0)) {
+      return openAndClose(aRoot, RelativePath);
+    }
+    if (!dir->Readable) return openAndClose(aRoot, RelativePath);
+
+    const DirEntry* Entry = NULL;
+    LookupResult Result = lookup(*dir, p, Len, &Entry);
+    if (Result == Unsure) return openAndClose(aRoot, RelativePath);
+    if (Result == NotFound || (*end != 0 && !Entry->IsDir)) {
+      NbOpenSaved++;
+      return FALSE;
+    }
+    if (*end == 0) {
+      NbOpenSaved++;
+      return TRUE;
+    }
+
+    dir = getDir(dir->Path.isEmpty() ? Entry->Name : dir->Path + L"\\"_XSW + Entry->Name);
+    p = end + 1;
+  }
+  return openAndClose(aRoot, RelativePath); // the root itself
+}
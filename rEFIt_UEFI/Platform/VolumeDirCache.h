@@ -0,0 +1,92 @@
+/*
+ * VolumeDirCache.h
+ *
+ * Snapshot of the directories of a volume, to answer FileExists() without an Open/Close per path.
+ * ScanLoader() checks dozens of well-known paths on each volume. With the cache, each directory
+ * on the way to these paths is read once, then the checks are answered from memory.
+ *
+ * Names are compared the way the file system would : an exact match means the file exists, no match
+ * even ignoring case means it doesn't. A match only ignoring case depends on the file system, so the
+ * file is opened as before. Same for paths with non ASCII characters, and for names with a '~', that can
+ * be the FAT 8.3 alias of a long name.
+ */
+
+#ifndef PLATFORM_VOLUMEDIRCACHE_H_
+#define PLATFORM_VOLUMEDIRCACHE_H_
+
+extern "C" {
+#include <Protocol/SimpleFileSystem.h>
+#include <Guid/FileInfo.h>
+}
+#include "../cpp_foundation/XObjArray.h"
+#include "../cpp_foundation/XString.h"
+
+
+class VolumeDirCache
+{
+public:
+  // A directory with more entries is not kept complete. Names not found in it are checked with Open.
+  static const size_t MaxEntriesPerDir = 1024;
+
+protected:
+  class DirEntry
+  {
+  public:
+    XStringW Name = XStringW();
+    bool     IsDir = false;
+  };
+
+  class Dir
+  {
+  public:
+    XStringW             Path = XStringW(); // without leading '\', built with the names read from the parent. Empty for the root.
+    bool                 Readable = false;
+    bool                 Complete = false;
+    XObjArray<DirEntry>  Entries = XObjArray<DirEntry>(); // sorted by name, ignoring ASCII case
+
+    Dir() {}
+    Dir(const Dir&) = delete;
+    Dir& operator=(const Dir&) = delete;
+
+    size_t lowerBound(const CHAR16* Name, size_t Len) const;
+    void read(const EFI_FILE* Root);
+  };
+
+  typedef enum { NotFound, Found, Unsure } LookupResult;
+
+  bool            Enabled = false;
+  const EFI_FILE* Root = NULL;
+  XObjArray<Dir>  Dirs;
+
+  static int compareIC(const CHAR16* Name1, size_t Len1, const CHAR16* Name2, size_t Len2);
+  static bool mayBeShortName(const CHAR16* Name, size_t Len);
+  Dir* getDir(const XStringW& Path);
+  LookupResult lookup(const Dir& dir, const CHAR16* Name, size_t Len, const DirEntry** Entry) const;
+
+public:
+  size_t NbOpenSaved = 0; // FileExists() answered from memory
+  size_t NbDirRead = 0;
+
+  VolumeDirCache() {}
+  VolumeDirCache(const VolumeDirCache&) = delete;
+  VolumeDirCache& operator=(const VolumeDirCache&) = delete;
+
+  /*
+   * From now on, fileExists() is answered from the directories of Root, read when needed.
+   * The files of the volume must not be modified until setEmpty().
+   */
+  void enable(const EFI_FILE* aRoot);
+  bool isEnabled() const { return Enabled; }
+
+  /*
+   * Same result as FileExists(Root, RelativePath). RelativePath is from the root of the volume.
+   */
+  BOOLEAN fileExists(const EFI_FILE* aRoot, const CHAR16* RelativePath);
+  BOOLEAN fileExists(const EFI_FILE* aRoot, const XStringW& RelativePath) { return fileExists(aRoot, RelativePath.wc_str()); }
+
+  // Free the snapshot and disable the cache
+  void setEmpty();
+};
+
+
+#endif /* PLATFORM_VOLUMEDIRCACHE_H_ */
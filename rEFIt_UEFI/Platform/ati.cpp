@@ -9,6 +9,7 @@
 #include "ati.h"
 #include "ati_reg.h"
 #include "smbios.h"
+#include "DeviceIdIndex.h"
 #include "FixBiosDsdt.h"
 #include "../include/Pci.h"
 #include "../include/Devices.h"
@@ -1922,6 +1923,44 @@ BOOLEAN devprop_add_pci_config_space(void)
 }
 #endif
 
+const size_t radeon_cards_count = sizeof(radeon_cards) / sizeof(radeon_cards[0]);
+
+static DeviceIdIndex radeon_cards_index;
+
+static void build_radeon_cards_index()
+{
+  UINTN i;
+
+  if (radeon_cards_index.isBuilt()) {
+    return;
+  }
+  for (i = 0; radeon_cards[i].device_id ; i++) {
+    radeon_cards_index.add(radeon_cards[i].device_id, i);
+  }
+  radeon_cards_index.sort();
+}
+
+size_t find_radeon_card(UINT16 device_id)
+{
+  build_radeon_cards_index();
+  return radeon_cards_index.find(device_id);
+}
+
+size_t find_radeon_card_family(UINT16 device_id)
+{
+  build_radeon_cards_index();
+  return radeon_cards_index.findInRange(device_id & ~0xf, (device_id & ~0xf) + 0x10);
+}
+
+const radeon_card_info_t* radeon_card_info(UINT16 device_id)
+{
+  size_t i = find_radeon_card(device_id);
+  if (i == MAX_XSIZE) {
+    i = radeon_cards_count - 1;
+  }
+  return &radeon_cards[i];
+}
+
 static BOOLEAN init_card(pci_dt_t *pci_dev)
 {
   BOOLEAN add_vbios = gSettings.Graphics.LoadVBios;
@@ -1940,15 +1979,12 @@ static BOOLEAN init_card(pci_dt_t *pci_dev)
   }
   card->pci_dev = pci_dev;
 
-  for (i = 0; radeon_cards[i].device_id ; i++) {
-    if (radeon_cards[i].device_id != pci_dev->device_id) {
-      continue;
-    }
+  i = find_radeon_card(pci_dev->device_id);
+  if (i != MAX_XSIZE) {
     card->info = (__typeof__(card->info))AllocateCopyPool(sizeof(radeon_card_info_t), &radeon_cards[i]);
     if (!card->info->cfg_name) {
       card->info->cfg_name = kRadeon;
     }
-    break;
   }
 
   for (j = 0; j < gConf.GfxPropertiesArray.size(); j++) {
@@ -1965,11 +2001,9 @@ static BOOLEAN init_card(pci_dt_t *pci_dev)
 	  DBG("Unsupported ATI card! Device ID: [%04hX:%04hX] Subsystem ID: [%08X] \n",
         pci_dev->vendor_id, pci_dev->device_id, pci_dev->subsys_id.subsys_id);
     DBG("search for brothers family\n");
-    for (i = 0; radeon_cards[i].device_id ; i++) {
-      if ((radeon_cards[i].device_id & ~0xf) == (pci_dev->device_id & ~0xf)) {
-        card->info = (__typeof__(card->info))AllocateCopyPool(sizeof(radeon_card_info_t), &radeon_cards[i]);
-        break;
-      }
+    i = find_radeon_card_family(pci_dev->device_id);
+    if (i != MAX_XSIZE) {
+      card->info = (__typeof__(card->info))AllocateCopyPool(sizeof(radeon_card_info_t), &radeon_cards[i]);
     }
     if (!card->info->cfg_name) {
       DBG("...compatible config is not found, set common\n");
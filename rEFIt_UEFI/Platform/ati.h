@@ -307,8 +307,16 @@ BOOLEAN get_name_pci_val(value_t *val, INTN index, BOOLEAN Sier);
 
 // Constants. Can be defined even if DONT_DEFINE_GLOBALS
 extern const radeon_card_info_t radeon_cards[];
+extern const size_t radeon_cards_count;
 extern const card_config_t card_configs[];
 
+// The first entry of radeon_cards for device_id, MAX_XSIZE if none. Never the last one, "AMD Unknown".
+size_t find_radeon_card(UINT16 device_id);
+// The first entry of radeon_cards of the same family, with the same device_id & ~0xf. MAX_XSIZE if none.
+size_t find_radeon_card_family(UINT16 device_id);
+// The entry of radeon_cards for device_id, the last one, "AMD Unknown", if there is none
+const radeon_card_info_t* radeon_card_info(UINT16 device_id);
+
 #ifndef DONT_DEFINE_GLOBALS
 extern AtiDevProp ati_devprop_list[];
 extern const CHAR8 *chip_family_name[];
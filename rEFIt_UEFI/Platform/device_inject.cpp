@@ -220,8 +220,7 @@ BOOLEAN devprop_add_value(DevPropDevice *device, CONST CHAR8 *nm, const UINT8 *v
   UINT32 length;
   UINT8 *data;
   UINTN i, l;
-  UINT32 *datalength;
-  UINT8 *newdata;
+  UINT32 datalength;
 
   if(!device || !nm || !vl /*|| !len*/) //rehabman: allow zero length data
     return FALSE;
@@ -232,9 +231,19 @@ BOOLEAN devprop_add_value(DevPropDevice *device, CONST CHAR8 *nm, const UINT8 *v
    DBG("\n"); */
   l = AsciiStrLen(nm);
   length = (UINT32)((l * 2) + len + (2 * sizeof(UINT32)) + 2);
-  data = (UINT8*)AllocateZeroPool(length);
-  if(!data)
-    return FALSE;
+
+  // the property is appended in place. device->data grows by doubling.
+  offset = device->length - (24 + (6 * device->num_pci_devpaths));
+  if (offset + length > device->data_allocated) {
+    UINT32 newAllocated = MAX(offset + length, device->data_allocated * 2);
+    UINT8 *newdata = (UINT8*)ReallocatePool(device->data_allocated, newAllocated, device->data);
+    if(!newdata)
+      return FALSE;
+    device->data = newdata;
+    device->data_allocated = newAllocated;
+  }
+  data = device->data + offset;
+  ZeroMem(data, length);
 
   off= 0;
 
@@ -249,30 +258,15 @@ BOOLEAN devprop_add_value(DevPropDevice *device, CONST CHAR8 *nm, const UINT8 *v
 
   off += 2;
   l = len;
-  datalength = (UINT32*)&data[off];
-  *datalength = (UINT32)(l + 4);
+  datalength = (UINT32)(l + 4);
+  CopyMem(&data[off], &datalength, sizeof(datalength));
   off += 4;
-  for(i = 0 ; i < l ; i++, off++) {
-    data[off] = *vl++;
-  }
-
-  offset = device->length - (24 + (6 * device->num_pci_devpaths));
-
-  newdata = (UINT8*)AllocateZeroPool((length + offset));
-  if(!newdata)
-    return FALSE;
-  if((device->data) && (offset > 1)) {
- 		CopyMem((void*)newdata, (void*)device->data, offset);
-  }
-
-  CopyMem((void*)(newdata + offset), (void*)data, length);
+  CopyMem(&data[off], vl, l);
 
   device->length += length;
   device->string->length += length;
   device->numentries++;
-  device->data = newdata;
 
-  FreePool(data);
   return TRUE;
 }
 
@@ -281,6 +275,41 @@ bool devprop_add_value(DevPropDevice *device, const XString8& nm, const XBuffer<
   return devprop_add_value(device, nm.data(), vl.data(), vl.size());
 }
 
+// "%02X" of each byte
+static const CHAR8 HexOfByte[256][3] = {
+  "00", "01", "02", "03", "04", "05", "06", "07", "08", "09", "0A", "0B", "0C", "0D", "0E", "0F",
+  "10", "11", "12", "13", "14", "15", "16", "17", "18", "19", "1A", "1B", "1C", "1D", "1E", "1F",
+  "20", "21", "22", "23", "24", "25", "26", "27", "28", "29", "2A", "2B", "2C", "2D", "2E", "2F",
+  "30", "31", "32", "33", "34", "35", "36", "37", "38", "39", "3A", "3B", "3C", "3D", "3E", "3F",
+  "40", "41", "42", "43", "44", "45", "46", "47", "48", "49", "4A", "4B", "4C", "4D", "4E", "4F",
+  "50", "51", "52", "53", "54", "55", "56", "57", "58", "59", "5A", "5B", "5C", "5D", "5E", "5F",
+  "60", "61", "62", "63", "64", "65", "66", "67", "68", "69", "6A", "6B", "6C", "6D", "6E", "6F",
+  "70", "71", "72", "73", "74", "75", "76", "77", "78", "79", "7A", "7B", "7C", "7D", "7E", "7F",
+  "80", "81", "82", "83", "84", "85", "86", "87", "88", "89", "8A", "8B", "8C", "8D", "8E", "8F",
+  "90", "91", "92", "93", "94", "95", "96", "97", "98", "99", "9A", "9B", "9C", "9D", "9E", "9F",
+  "A0", "A1", "A2", "A3", "A4", "A5", "A6", "A7", "A8", "A9", "AA", "AB", "AC", "AD", "AE", "AF",
+  "B0", "B1", "B2", "B3", "B4", "B5", "B6", "B7", "B8", "B9", "BA", "BB", "BC", "BD", "BE", "BF",
+  "C0", "C1", "C2", "C3", "C4", "C5", "C6", "C7", "C8", "C9", "CA", "CB", "CC", "CD", "CE", "CF",
+  "D0", "D1", "D2", "D3", "D4", "D5", "D6", "D7", "D8", "D9", "DA", "DB", "DC", "DD", "DE", "DF",
+  "E0", "E1", "E2", "E3", "E4", "E5", "E6", "E7", "E8", "E9", "EA", "EB", "EC", "ED", "EE", "EF",
+  "F0", "F1", "F2", "F3", "F4", "F5", "F6", "F7", "F8", "F9", "FA", "FB", "FC", "FD", "FE", "FF",
+};
+
+static void devprop_cat_hex(XBuffer<char>& buffer, const UINT8 *data, UINTN size)
+{
+  CHAR8 chunk[256];
+  while (size > 0) {
+    UINTN n = MIN(size, sizeof(chunk) / 2);
+    for (UINTN i = 0; i < n; i++) {
+      chunk[i*2] = HexOfByte[data[i]][0];
+      chunk[i*2+1] = HexOfByte[data[i]][1];
+    }
+    buffer.ncat(chunk, n * 2);
+    data += n;
+    size -= n;
+  }
+}
+
 XBuffer<char> devprop_generate_string(DevPropString *StringBuf)
 {
   UINTN len = StringBuf->length * 2;
@@ -315,9 +344,7 @@ XBuffer<char> devprop_generate_string(DevPropString *StringBuf)
                 StringBuf->entries[i]->path_end.subtype,
                 SwapBytes16(StringBuf->entries[i]->path_end.length));
 
-    for(x = 0; x < (StringBuf->entries[i]->length) - (24 + (6 * StringBuf->entries[i]->num_pci_devpaths)); x++) {
-      buffer.S8Catf("%02hhX", *dataptr++);
-    }
+    devprop_cat_hex(buffer, dataptr, (StringBuf->entries[i]->length) - (24 + (6 * StringBuf->entries[i]->num_pci_devpaths)));
     i++;
   }
   return buffer;
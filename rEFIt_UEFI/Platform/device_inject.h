@@ -92,6 +92,7 @@ struct DevPropDevice {
 	UINT8 *data;
 
 	// ------------------------
+	UINT32 data_allocated;	// size allocated for data, the properties use less
 	UINT8	 num_pci_devpaths;
 	struct DevPropString *string;
 	// ------------------------
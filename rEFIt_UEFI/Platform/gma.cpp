@@ -66,6 +66,7 @@
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 #include "gma.h"
 #include "platformdata.h"
+#include "DeviceIdIndex.h"
 #include "FixBiosDsdt.h"
 #include "../include/Devices.h"
 #include "../Platform/Settings.h"
@@ -471,7 +472,7 @@ UINT8 mn_HD3000_os_info[20] = {
 };
 
 
-static struct gma_gpu_t KnownGPUS[] = {
+const gma_gpu_t KnownGPUS[] = {
   { 0xFFFF, "Intel Unsupported"              }, // common name for unsuported devices
 #if WILL_WORK
   //============== PowerVR ===================
@@ -946,14 +947,29 @@ static struct gma_gpu_t KnownGPUS[] = {
 };
 
 
+const size_t KnownGPUS_count = sizeof(KnownGPUS) / sizeof(KnownGPUS[0]);
+
+static DeviceIdIndex KnownGPUSIndex;
+
+size_t find_gma_gpu(UINT16 id)
+{
+  size_t i;
+
+  if (!KnownGPUSIndex.isBuilt()) {
+    for (i = 0; i < KnownGPUS_count; i++) {
+      KnownGPUSIndex.add(KnownGPUS[i].device, i);
+    }
+    KnownGPUSIndex.sort();
+  }
+  return KnownGPUSIndex.find(id);
+}
+
 CONST CHAR8 *get_gma_model(UINT16 id)
 {
-  UINTN i;
+  size_t i = find_gma_gpu(id);
 
-  for (i = 0; i < (sizeof(KnownGPUS) / sizeof(KnownGPUS[0])); i++)
-  {
-    if (KnownGPUS[i].device == id)
-      return KnownGPUS[i].name;
+  if (i != MAX_XSIZE) {
+    return KnownGPUS[i].name;
   }
   return KnownGPUS[0].name;
 }
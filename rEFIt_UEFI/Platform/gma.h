@@ -37,5 +37,11 @@ CONST CHAR8
 *get_gma_model (
   IN UINT16 DeviceID
   );
+
+extern const gma_gpu_t KnownGPUS[];
+extern const size_t KnownGPUS_count;
+
+// The first entry of KnownGPUS for id, MAX_XSIZE if none
+size_t find_gma_gpu(UINT16 id);
     
 #endif /* !__LIBSAIO_GMA_H */
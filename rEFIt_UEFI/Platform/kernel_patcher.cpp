@@ -20,6 +20,7 @@
 
 #include "kernel_patcher.h"
 #include "MemoryOperation.h"
+#include "MultiPatternPatcher.h"
 #include "../include/OSFlags.h"
 
 //#include "sse3_patcher.h"
@@ -222,20 +223,18 @@ UINTN LOADER_ENTRY::searchProcInDriver(UINT8 * driver, UINT32 driverLen, const X
   if (!vArray || !lSizeVtable || !Names) {
     return 0;
   }
-  INT32 i;
-  UINT32 Offset = 0; // Init to avoid warning
-  bool found = false;
-  for (i = 0; i < lSizeVtable; ++i) {
-    Offset = vArray[i].n_un.n_strx;
-    if (strstr(&Names[Offset], procedure.c_str())) {
-      found = true;
-      break;
-    }
+  // Kexts are all in memory at the same time, so the symbol table address identifies the kext.
+  // For a kernel collection, all kexts share the same table.
+  if (!DriverSymbolIndex.isBuiltFor(vArray, Names, lSizeVtable)) {
+    DriverSymbolIndex.build(vArray, Names, &vArray[0].n_un.n_strx, sizeof(struct nlist_64), lSizeVtable);
   }
-  if (!found) {
+  size_t symbolIdx = DriverSymbolIndex.find(procedure);
+  if (symbolIdx == MAX_XSIZE) {
     DBG("%s not found\n", procedure.c_str());
     return 0;
   }
+  INT32 i = (INT32)symbolIdx;
+  UINT32 Offset = vArray[i].n_un.n_strx;
   DBG("found section %d at pos=%d\n", vArray[i].n_sect, i);
   DBG("name offset=0x%x vtable_off=0x%lx\n", symCmd->stroff + Offset, symCmd->symoff + i * sizeof(struct nlist_64));
 //  INT32 textAddr = searchSectionByNum(driver, 1);
@@ -333,25 +332,17 @@ UINTN LOADER_ENTRY::searchProc(const XString8& procedure)
   VTABLE * vArray = (VTABLE*)(&KernelData[AddrVtable]);
   //search for the name
 //  gBS->Stall(9000000);
-  size_t i;
-  bool found = false;
-  for (i=0; i<SizeVtable; ++i) {
-    size_t Offset = vArray[i].NameOffset;
-    if (Offset == 0) break;
-//    if (N < 10) {
-//      DBG("Offset %lx Seg=%x\n", Offset, vArray[i].Seg);
-//      DBG("Name to compare %s\n", &Names[Offset]);
-//      N++;
-//    }
-//    DBG_RT("Offset %lx Seg=%x\n", Offset, vArray[i].Seg);
-//    DBG_RT("Name to compare %s\n", &Names[Offset]);
-//    Stall(3000000);
-    if (AsciiStrStr(&Names[Offset], procedure.c_str()) != NULL) {
-      found = true;
-      break;
+  if (KernelSymbolIndex.size() == 0 || !KernelSymbolIndex.isBuiltFor(vArray, Names, KernelSymbolIndex.size())) {
+    // the table ends at SizeVtable or at the first symbol without name
+    size_t nbSymbols = 0;
+    while (nbSymbols < SizeVtable && vArray[nbSymbols].NameOffset != 0) {
+      nbSymbols++;
     }
+    KernelSymbolIndex.build(vArray, Names, &vArray[0].NameOffset, sizeof(VTABLE), nbSymbols);
+    DBG("kernel symbol index: %zu symbols\n", KernelSymbolIndex.size());
   }
-  if (!found) {
+  size_t i = KernelSymbolIndex.find(procedure);
+  if (i == MAX_XSIZE) {
     return 0;
   }
 //  INT32 SegVAddr;
@@ -2352,11 +2343,36 @@ LOADER_ENTRY::FindBootArgs()
   }
 }
 
+/*
+ * Apply the patches collected in Patcher, with one scan of Data, and log the result of each one.
+ * Patcher tags are indexes in Patches.
+ * Returns the number of patches that did at least one replace.
+ */
+template <class PatchType, class PatchArray>
+static INTN ApplyPatchBatch(MultiPatternPatcher& Patcher, const PatchArray& Patches, UINT8* Data, UINTN DataSize)
+{
+  INTN y = 0;
+  if ( Patcher.isEmpty() ) return 0;
+  Patcher.apply(Data, DataSize);
+  for ( size_t k = 0 ; k < Patcher.size() ; ++k ) {
+    const PatchType& Patch = Patches[Patcher.tag(k)];
+    size_t Num = Patcher.replacesDone(k);
+    if (Num) {
+      y++;
+    }
+    DBG( "Patch[%zu]: %s ==> %s : %zu replaces done\n", Patcher.tag(k), Patch.Label.c_str(), Num ? "Success" : "Error", Num);
+  }
+  Patcher.setEmpty();
+  return y;
+}
+
 BOOLEAN
 LOADER_ENTRY::KernelUserPatch()
 {
   INTN Num, y = 0;
-
+  // Patches without StartPattern are all applied with one scan of the kernel.
+  // A patch with a StartPattern flushes the pending ones first, to keep the order of the patches.
+  MultiPatternPatcher Patcher;
 
   // old confuse
   // We are using KernelAndKextPatches as set by Custom Entries.
@@ -2383,11 +2399,23 @@ LOADER_ENTRY::KernelUserPatch()
     } else {
       procLen = SearchLen;
     }
+    if (KernelAndKextPatches.KernelPatches[i].StartPattern.isEmpty()) { //old behavior
+      Patcher.addPatch(KernelAndKextPatches.KernelPatches[i].Find.data(),
+                       KernelAndKextPatches.KernelPatches[i].MaskFind.data(),
+                       KernelAndKextPatches.KernelPatches[i].Find.size(),
+                       KernelAndKextPatches.KernelPatches[i].Replace.data(),
+                       KernelAndKextPatches.KernelPatches[i].MaskReplace.data(),
+                       procAddr, procLen,
+                       KernelAndKextPatches.KernelPatches[i].Count,
+                       KernelAndKextPatches.KernelPatches[i].Skip,
+                       i);
+      continue;
+    }
+    y += ApplyPatchBatch<KERNEL_PATCH>(Patcher, KernelAndKextPatches.KernelPatches, KernelData, KERNEL_MAX_SIZE);
     UINT8 * curs = &KernelData[procAddr];
     UINTN j = 0;
     while (j < KERNEL_MAX_SIZE) {
-      if (KernelAndKextPatches.KernelPatches[i].StartPattern.isEmpty() || //old behavior
-          CompareMemMask((const UINT8*)curs,
+      if (CompareMemMask((const UINT8*)curs,
                          KernelAndKextPatches.KernelPatches[i].StartPattern.data(),
                          KernelAndKextPatches.KernelPatches[i].StartPattern.size(),
                          KernelAndKextPatches.KernelPatches[i].StartMask.data(),
@@ -2409,13 +2437,14 @@ LOADER_ENTRY::KernelUserPatch()
           j    += SearchLen - 1;
         }
         DBG( "==> %s : %lld replaces done\n", Num ? "Success" : "Error", Num);
-        if ( once || KernelAndKextPatches.KernelPatches[i].StartPattern.isEmpty() ) {
+        if ( once ) {
           break;
         }
       }
       j++; curs++;
     }
   }
+  y += ApplyPatchBatch<KERNEL_PATCH>(Patcher, KernelAndKextPatches.KernelPatches, KernelData, KERNEL_MAX_SIZE);
   if (KernelAndKextPatches.KPDebug) {
     gBS->Stall(2000000);
   }
@@ -2427,6 +2456,8 @@ BOOLEAN
 LOADER_ENTRY::BooterPatch(IN UINT8 *BooterData, IN UINT64 BooterSize)
 {
   INTN Num, y = 0;
+  // Same as KernelUserPatch : patches without StartPattern are applied with one scan of the booter.
+  MultiPatternPatcher Patcher;
 
 
   for (size_t i = 0 ; i < KernelAndKextPatches.BootPatches.size(); ++i)
@@ -2442,11 +2473,23 @@ LOADER_ENTRY::BooterPatch(IN UINT8 *BooterData, IN UINT64 BooterSize)
       DBG( "==> disabled\n");
       continue;
     }
+    if (KernelAndKextPatches.BootPatches[i].StartPattern.isEmpty()) { //old behavior
+      Patcher.addPatch(KernelAndKextPatches.BootPatches[i].Find.data(),
+                       KernelAndKextPatches.BootPatches[i].MaskFind.data(),
+                       KernelAndKextPatches.BootPatches[i].Find.size(),
+                       KernelAndKextPatches.BootPatches[i].Replace.data(),
+                       KernelAndKextPatches.BootPatches[i].MaskReplace.data(),
+                       0, SearchLen,
+                       KernelAndKextPatches.BootPatches[i].Count,
+                       KernelAndKextPatches.BootPatches[i].Skip,
+                       i);
+      continue;
+    }
+    y += ApplyPatchBatch<BOOT_PATCH>(Patcher, KernelAndKextPatches.BootPatches, BooterData, BooterSize);
     UINT8 * curs = BooterData;
     UINTN j = 0;
     while (j < BooterSize) {
-      if (KernelAndKextPatches.BootPatches[i].StartPattern.isEmpty() || //old behavior
-          CompareMemMask((const UINT8*)curs,
+      if (CompareMemMask((const UINT8*)curs,
                          (const UINT8*)KernelAndKextPatches.BootPatches[i].StartPattern.data(),
                          KernelAndKextPatches.BootPatches[i].StartPattern.size(),
                          (const UINT8*)KernelAndKextPatches.BootPatches[i].StartMask.data(),
@@ -2469,13 +2512,11 @@ LOADER_ENTRY::BooterPatch(IN UINT8 *BooterData, IN UINT64 BooterSize)
         }
 
         DBG( "==> %s : %lld replaces done\n", Num ? "Success" : "Error", Num);
-        if ( KernelAndKextPatches.BootPatches[i].StartPattern.isEmpty() ) {
-          break;
-        }
       }
       j++; curs++;
     }
   }
+  y += ApplyPatchBatch<BOOT_PATCH>(Patcher, KernelAndKextPatches.BootPatches, BooterData, BooterSize);
   if (KernelAndKextPatches.KPDebug) {
     gBS->Stall(2000000);
   }
@@ -43,54 +43,70 @@ XObjArray<KEXT_ENTRY> gKextList;
 ////////////////////
 // before booting
 ////////////////////
-EFI_STATUS EFIAPI ThinFatFile(IN OUT UINT8 **binary, IN OUT UINTN *length, IN cpu_type_t archCpuType)
+/*
+ * Find the slice of archCpuType in a kext executable without loading it : header is the start of the file, headerLength bytes
+ * of it (enough for the fat header and its archs), fileLength the size of the file.
+ * A thin file is its own slice. As before, a fat file without archCpuType gives a slice of size 0.
+ */
+EFI_STATUS EFIAPI GetThinSlice(IN const UINT8 *header, IN UINTN headerLength, IN UINT64 fileLength, IN cpu_type_t archCpuType, OUT UINT32 *offset, OUT UINT32 *size)
 {
-  UINT32 nfat, swapped, size = 0;
-  FAT_HEADER *fhp = (FAT_HEADER *)*binary;
-  FAT_ARCH   *fap = (FAT_ARCH *)(*binary + sizeof(FAT_HEADER));
+  UINT32 magic, nfat, swapped;
+  FAT_ARCH fat;
   cpu_type_t fapcputype;
   UINT32 fapoffset;
   UINT32 fapsize;
 
+  *offset = 0;
+  *size = 0;
+  if (headerLength < sizeof(FAT_HEADER)) {
+    MsgLog("Thinning fails\n");
+    return EFI_NOT_FOUND;
+  }
+  CopyMem(&magic, header, sizeof(magic));
+  CopyMem(&nfat, header + sizeof(magic), sizeof(nfat));
+
   swapped = 0;
-  if (fhp->magic == FAT_MAGIC) {
-    nfat = fhp->nfat_arch;
-  } else if (fhp->magic == FAT_CIGAM) {
-    nfat = SwapBytes32(fhp->nfat_arch);
+  if (magic == FAT_CIGAM) {
+    nfat = SwapBytes32(nfat);
     swapped = 1;
+  } else if (magic == FAT_MAGIC) {
+    //already in host order
+  } else if (magic == THIN_X64 || magic == THIN_IA32) {
     //already thin
-  } else if (fhp->magic == THIN_X64){
-    if (archCpuType == CPU_TYPE_X86_64) {
-      return EFI_SUCCESS;
+    if ((magic == THIN_X64 && archCpuType != CPU_TYPE_X86_64) || (magic == THIN_IA32 && archCpuType != CPU_TYPE_I386)) {
+      return EFI_NOT_FOUND;
     }
-    return EFI_NOT_FOUND;
-  } else if (fhp->magic == THIN_IA32){
-    if (archCpuType == CPU_TYPE_I386) {
-      return EFI_SUCCESS;
+    if (fileLength > MAX_UINT32) {
+      return EFI_NOT_FOUND;
     }
-    return EFI_NOT_FOUND;
+    *size = (UINT32)fileLength;
+    return EFI_SUCCESS;
   } else {
     MsgLog("Thinning fails\n");
     return EFI_NOT_FOUND;
   }
 
-  for (; nfat > 0; nfat--, fap++) {
+  for (UINTN pos = sizeof(FAT_HEADER); nfat > 0 && pos + sizeof(FAT_ARCH) <= headerLength; nfat--, pos += sizeof(FAT_ARCH)) {
+    CopyMem(&fat, header + pos, sizeof(fat));
     if (swapped) {
-      fapcputype = SwapBytes32(fap->cputype);
-      fapoffset = SwapBytes32(fap->offset);
-      fapsize = SwapBytes32(fap->size);
+      fapcputype = SwapBytes32(fat.cputype);
+      fapoffset = SwapBytes32(fat.offset);
+      fapsize = SwapBytes32(fat.size);
     } else {
-      fapcputype = fap->cputype;
-      fapoffset = fap->offset;
-      fapsize = fap->size;
+      fapcputype = fat.cputype;
+      fapoffset = fat.offset;
+      fapsize = fat.size;
     }
     if (fapcputype == archCpuType) {
-      *binary = (*binary + fapoffset);
-      size = fapsize;
+      if ((UINT64)fapoffset + fapsize > fileLength) {
+        MsgLog("Thinning fails, slice out of file\n");
+        return EFI_NOT_FOUND;
+      }
+      *offset = fapoffset;
+      *size = fapsize;
       break;
     }
   }
-  if (length != 0) *length = size;
 
   return EFI_SUCCESS;
 }
@@ -135,59 +151,14 @@ BOOLEAN LOADER_ENTRY::checkOSBundleRequired(const TagDict* dict)
 //extern void KernelAndKextPatcherInit(IN LOADER_ENTRY *Entry);
 //extern void AnyKextPatch(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist, UINT32 InfoPlistSize, INT32 N, LOADER_ENTRY *Entry);
 
-//XStringW infoPlistPath = getKextPlist(dir, KextEntry, &NoContents);
-XStringW LOADER_ENTRY::getKextPlist(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry, BOOLEAN* NoContents)
-{
-  XStringW    TempName;
-  
-  TempName = SWPrintf("%ls\\%ls\\%ls", dirPath.wc_str(), KextEntry.FileName.wc_str(), L"Contents\\Info.plist");
-#ifndef LESS_DEBUG
-  MsgLog("info plist path: %ls\n", TempName.wc_str());
-#endif
-  if (!FileExists(&self.getCloverDir(), TempName)) {
-    //try to find a planar kext, without Contents
-    TempName = SWPrintf("%ls\\%ls\\%ls", dirPath.wc_str(), KextEntry.FileName.wc_str(), L"Info.plist");
-    if (!FileExists(&self.getCloverDir(), TempName)) {
-      MsgLog("Failed to load extra kext : %ls \n", TempName.wc_str());
-      return L""_XSW;
-    }
-    *NoContents = TRUE;
-  } else {
-    *NoContents = FALSE;
-  }
-  return TempName;
-}
-
-//TagDict*    dict = getInfoPlist(infoPlistPath);
-TagDict* LOADER_ENTRY::getInfoPlist(const XStringW& infoPlistPath)
-{
-  EFI_STATUS  Status;
-  UINT8*      infoDictBuffer = NULL;
-  UINTN       infoDictBufferLength = 0;
-  TagDict*    dict = NULL;
-
-  Status = egLoadFile(&self.getCloverDir(), infoPlistPath.wc_str(), &infoDictBuffer, &infoDictBufferLength);
-  if (!EFI_ERROR(Status)) {  //double check
-    if( ParseXML((CHAR8*)infoDictBuffer, &dict, infoDictBufferLength)!=0 ) {
-      MsgLog("Failed to parse Info.plist: %ls\n", infoPlistPath.wc_str());
-      dict =  NULL;
-    }
-    FreePool(infoDictBuffer);
-    return dict;
-  }
-  return NULL;
-}
-
-//XString8 execpath = getKextExecPath(dir, KextEntry, dict, NoContents);
-XString8  LOADER_ENTRY::getKextExecPath(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry, TagDict* dict, BOOLEAN NoContents)
+//XString8 execpath = getKextExecPath(dir, KextEntry);
+XString8  LOADER_ENTRY::getKextExecPath(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry)
 {
-  const TagStruct* prop = NULL;
   XString8    TempName;
   
-  prop = dict->propertyForKey("CFBundleExecutable");
-  if( prop != NULL && prop->isString() && prop->getString()->stringValue().notEmpty() ) {
-    const XString8& Executable = prop->getString()->stringValue();
-    if (NoContents) {
+  if( KextEntry.Executable.notEmpty() ) {
+    const XString8& Executable = KextEntry.Executable;
+    if (KextEntry.NoContents) {
       TempName = S8Printf("%s", Executable.c_str());
     } else {
       TempName = S8Printf("Contents\\MacOS\\%s", Executable.c_str());
@@ -201,18 +172,66 @@ XString8  LOADER_ENTRY::getKextExecPath(const XStringW& dirPath, const SIDELOAD_
   return TempName;
 }
 
+/*
+ * Open Path and get its size, so it can be read where it goes
+ */
+static EFI_STATUS OpenKextFile(const EFI_FILE *RootDir, const XStringW& Path, EFI_FILE **FileHandle, UINT64 *FileSize)
+{
+  EFI_STATUS     Status;
+  EFI_FILE_INFO  *FileInfo;
+
+  *FileHandle = NULL;
+  Status = RootDir->Open(RootDir, FileHandle, (CHAR16*)Path.wc_str(), EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR(Status) || *FileHandle == NULL) {
+    return EFI_ERROR(Status) ? Status : EFI_NOT_FOUND;
+  }
+  FileInfo = EfiLibFileInfo(*FileHandle);
+  if (FileInfo == NULL) {
+    (*FileHandle)->Close(*FileHandle);
+    *FileHandle = NULL;
+    return EFI_NOT_READY;
+  }
+  *FileSize = FileInfo->FileSize;
+  FreePool(FileInfo);
+  return EFI_SUCCESS;
+}
+
+/*
+ * Read exactly Length bytes at Offset
+ */
+static EFI_STATUS ReadKextFile(EFI_FILE *FileHandle, UINT64 Offset, void *Buffer, UINTN Length)
+{
+  EFI_STATUS  Status;
+  UINTN       ReadLength = Length;
+
+  Status = FileHandle->SetPosition(FileHandle, Offset);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+  Status = FileHandle->Read(FileHandle, &ReadLength, Buffer);
+  if (EFI_ERROR(Status)) {
+    return Status;
+  }
+  return ReadLength == Length ? EFI_SUCCESS : EFI_END_OF_FILE;
+}
+
 //it seems no more used? Or???
 // FileName is better as a XString8 instead of XStringW because _BooterKextFileInfo will need an utf8.
+// The executable is not loaded whole : only the slice of archCpuType is read, straight to its place in the kext.
 EFI_STATUS LOADER_ENTRY::LoadKext(const EFI_FILE *RootDir, const XString8& FileName, IN cpu_type_t archCpuType, IN OUT void *kext_v)
 {
   EFI_STATUS  Status;
+  EFI_FILE*   infoDictFile = NULL;
+  UINT64      infoDictFileSize = 0;
   UINT8*      infoDictBuffer = NULL;
-  UINTN       infoDictBufferLength = 0;
-  UINT8*      executableFatBuffer = NULL;
-  UINT8*      executableBuffer = NULL;
-  UINTN       executableBufferLength = 0;
-//  CHAR8*      bundlePathBuffer = NULL;
-//  UINTN       bundlePathBufferLength = 0;
+  UINT32      infoDictBufferLength = 0;
+  EFI_FILE*   executableFile = NULL;
+  UINT64      executableFileSize = 0;
+  UINT8       executableHeader[sizeof(FAT_HEADER) + 16 * sizeof(FAT_ARCH)];
+  UINTN       executableHeaderLength = 0;
+  UINT32      executableOffset = 0;
+  UINT32      executableBufferLength = 0;
+  UINT32      bundlePathLength = (UINT32)FileName.sizeInBytesIncludingTerminator();
   XStringW    TempName;
   TagDict*    dict = NULL;
   const TagStruct*      prop = NULL;
@@ -222,73 +241,107 @@ EFI_STATUS LOADER_ENTRY::LoadKext(const EFI_FILE *RootDir, const XString8& FileN
   _DeviceTreeBuffer *kext = (_DeviceTreeBuffer *)kext_v;
 
   TempName = SWPrintf("%s\\%ls", FileName.c_str(), L"Contents\\Info.plist");
-  Status = egLoadFile(RootDir, TempName.wc_str(), &infoDictBuffer, &infoDictBufferLength);
+  Status = OpenKextFile(RootDir, TempName, &infoDictFile, &infoDictFileSize);
   if (EFI_ERROR(Status)) {
     //try to find a planar kext, without Contents
     TempName = SWPrintf("%s\\%ls", FileName.c_str(), L"Info.plist");
-    infoDictBufferLength = 0;
-    Status = egLoadFile(RootDir, TempName.wc_str(), &infoDictBuffer, &infoDictBufferLength);
+    Status = OpenKextFile(RootDir, TempName, &infoDictFile, &infoDictFileSize);
     if (EFI_ERROR(Status)) {
       MsgLog("Failed to load extra kext : %ls status=%s\n", TempName.wc_str(), efiStrError(Status));
       return EFI_NOT_FOUND;
     }
     NoContents = TRUE;
   }
-  if( ParseXML((CHAR8*)infoDictBuffer, &dict,infoDictBufferLength)!=0 ) {
+  // the executable name is in the Info.plist : it is read before the size of the kext is known
+  if (infoDictFileSize > MAX_UINT32 / 4) {
+    infoDictFile->Close(infoDictFile);
+    MsgLog("Failed to load extra kext (Info.plist too big): %s\n", FileName.c_str());
+    return EFI_NOT_FOUND;
+  }
+  infoDictBufferLength = (UINT32)infoDictFileSize;
+  infoDictBuffer = (UINT8*)AllocatePool(infoDictBufferLength + 1);
+  if (infoDictBuffer == NULL) {
+    infoDictFile->Close(infoDictFile);
+    return EFI_OUT_OF_RESOURCES;
+  }
+  Status = ReadKextFile(infoDictFile, 0, infoDictBuffer, infoDictBufferLength);
+  infoDictFile->Close(infoDictFile);
+  if (EFI_ERROR(Status)) {
+    FreePool(infoDictBuffer);
+    MsgLog("Failed to load extra kext : %ls status=%s\n", TempName.wc_str(), efiStrError(Status));
+    return EFI_NOT_FOUND;
+  }
+  if( infoDictBufferLength == 0 || ParseXML((CHAR8*)infoDictBuffer, &dict, infoDictBufferLength)!=0 ) {
     FreePool(infoDictBuffer);
     MsgLog("Failed to load extra kext (failed to parse Info.plist): %s\n", FileName.c_str());
     return EFI_NOT_FOUND;
   }
-    
+
   inject = checkOSBundleRequired(dict);
   if(!inject) {
+      FreePool(infoDictBuffer);
+      dict->FreeTag();
       MsgLog("Skipping kext injection by OSBundleRequired : %s\n", FileName.c_str());
       return EFI_UNSUPPORTED;
   }
-    
+
   prop = dict->propertyForKey("CFBundleExecutable");
   if( prop != NULL && prop->isString() && prop->getString()->stringValue().notEmpty() ) {
-    XString8 Executable = prop->getString()->stringValue();
+    const XString8& Executable = prop->getString()->stringValue();
     if (NoContents) {
       TempName = SWPrintf("%s\\%s", FileName.c_str(), Executable.c_str());
-      //     snwprintf(TempName, 512, "%s\\%s", FileName, Executable);
     } else {
       TempName = SWPrintf("%s\\Contents\\MacOS\\%s", FileName.c_str(), Executable.c_str());
-      //    snwprintf(TempName, 512, L"%s\\%s\\%s", FileName, "Contents\\MacOS",Executable);
     }
-    Status = egLoadFile(RootDir, TempName.wc_str(), &executableFatBuffer, &executableBufferLength);
+    Status = OpenKextFile(RootDir, TempName, &executableFile, &executableFileSize);
+    if (!EFI_ERROR(Status)) {
+      // the fat header and its archs, or the start of a thin executable
+      executableHeaderLength = executableFileSize < sizeof(executableHeader) ? (UINTN)executableFileSize : sizeof(executableHeader);
+      Status = ReadKextFile(executableFile, 0, executableHeader, executableHeaderLength);
+    }
     if (EFI_ERROR(Status)) {
+      if (executableFile != NULL) executableFile->Close(executableFile);
       FreePool(infoDictBuffer);
+      dict->FreeTag();
       MsgLog("Failed to load extra kext (executable not found): %s\n", FileName.c_str());
       return EFI_NOT_FOUND;
     }
-    executableBuffer = executableFatBuffer;
-    if (ThinFatFile(&executableBuffer, &executableBufferLength, archCpuType)) {
+    if (GetThinSlice(executableHeader, executableHeaderLength, executableFileSize, archCpuType, &executableOffset, &executableBufferLength)) {
+      executableFile->Close(executableFile);
       FreePool(infoDictBuffer);
-      FreePool(executableBuffer);
+      dict->FreeTag();
       MsgLog("Thinning failed: %s\n", FileName.c_str());
       return EFI_NOT_FOUND;
     }
   }
-//  bundlePathBufferLength = StrLen(FileName) + 1;
-//  bundlePathBuffer = (__typeof__(bundlePathBuffer))AllocateZeroPool(bundlePathBufferLength);
-//  UnicodeStrToAsciiStrS(FileName, bundlePathBuffer, bundlePathBufferLength);
+  dict->FreeTag();
 
-  kext->length = (UINT32)(sizeof(_BooterKextFileInfo) + infoDictBufferLength + executableBufferLength + FileName.sizeInBytesIncludingTerminator());
+  kext->length = (UINT32)(sizeof(_BooterKextFileInfo) + infoDictBufferLength + executableBufferLength + bundlePathLength);
   infoAddr = (_BooterKextFileInfo *)AllocatePool(kext->length);
+  if (infoAddr == NULL) {
+    if (executableFile != NULL) executableFile->Close(executableFile);
+    FreePool(infoDictBuffer);
+    return EFI_OUT_OF_RESOURCES;
+  }
   infoAddr->infoDictPhysAddr = sizeof(_BooterKextFileInfo);
-  infoAddr->infoDictLength = (UINT32)infoDictBufferLength;
+  infoAddr->infoDictLength = infoDictBufferLength;
   infoAddr->executablePhysAddr = (UINT32)(sizeof(_BooterKextFileInfo) + infoDictBufferLength);
-  infoAddr->executableLength = (UINT32)executableBufferLength;
+  infoAddr->executableLength = executableBufferLength;
   infoAddr->bundlePathPhysAddr = (UINT32)(sizeof(_BooterKextFileInfo) + infoDictBufferLength + executableBufferLength);
-  infoAddr->bundlePathLength = (UINT32)FileName.sizeInBytesIncludingTerminator();
-  kext->paddr = (UINT32)(UINTN)infoAddr; // Note that we cannot free infoAddr because of this
-  CopyMem((CHAR8 *)infoAddr + sizeof(_BooterKextFileInfo), infoDictBuffer, infoDictBufferLength);
-  CopyMem((CHAR8 *)infoAddr + sizeof(_BooterKextFileInfo) + infoDictBufferLength, executableBuffer, executableBufferLength);
-  CopyMem((CHAR8 *)infoAddr + sizeof(_BooterKextFileInfo) + infoDictBufferLength + executableBufferLength, FileName.c_str(), FileName.sizeInBytesIncludingTerminator());
+  infoAddr->bundlePathLength = bundlePathLength;
+  CopyMem((CHAR8 *)infoAddr + infoAddr->infoDictPhysAddr, infoDictBuffer, infoDictBufferLength);
   FreePool(infoDictBuffer);
-  FreePool(executableFatBuffer);
-  dict->FreeTag();
+  if (executableFile != NULL) {
+    Status = ReadKextFile(executableFile, executableOffset, (CHAR8 *)infoAddr + infoAddr->executablePhysAddr, executableBufferLength);
+    executableFile->Close(executableFile);
+    if (EFI_ERROR(Status)) {
+      FreePool(infoAddr);
+      MsgLog("Failed to load extra kext (executable not read): %s status=%s\n", FileName.c_str(), efiStrError(Status));
+      return EFI_NOT_FOUND;
+    }
+  }
+  CopyMem((CHAR8 *)infoAddr + infoAddr->bundlePathPhysAddr, FileName.c_str(), bundlePathLength);
+  kext->paddr = (UINT32)(UINTN)infoAddr; // Note that we cannot free infoAddr because of this
 
   return EFI_SUCCESS;
 }
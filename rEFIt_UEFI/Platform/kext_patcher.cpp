@@ -23,6 +23,8 @@ extern "C" {
 #include "kext_inject.h"
 #include "../gui/menu_items/menu_items.h"
 #include "MemoryOperation.h"
+#include "MultiPatternPatcher.h"
+#include "PrelinkInfoIndex.h"
 
 #define OLD_METHOD 0
 
@@ -1028,6 +1030,66 @@ void LOADER_ENTRY::AnyKextPatch(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPli
   }
 }
 
+//
+// Binary patch without StartPattern : instead of a scan of the kext for each patch,
+// it is queued in Patcher and all the queued patches of the kext are applied with one scan.
+// Same region as AnyKextPatch(). Returns FALSE if the patch must go through AnyKextPatch().
+//
+BOOLEAN LOADER_ENTRY::AddKextPatchToBatch(MultiPatternPatcher& Patcher, UINT8 *Driver, UINT32 DriverSize, size_t N)
+{
+  const KEXT_PATCH& kextpatch = KernelAndKextPatches.KextPatches[N];
+  UINTN   SearchLen = kextpatch.SearchLen;
+
+  if (!kextpatch.MenuItem.BValue || kextpatch.IsPlistPatch || kextpatch.StartPattern.notEmpty()) {
+    return FALSE;
+  }
+
+  DBG("\nAnyKextPatch %zu: driverAddr = %llx, driverSize = %x\n  Label = %s\n",
+      N, (UINTN)Driver, DriverSize, kextpatch.Label.c_str());
+
+  if (!SearchLen ||
+      (SearchLen > DriverSize)) {
+    SearchLen = DriverSize;
+  }
+  UINTN procAddr = searchProcInDriver(Driver, DriverSize, kextpatch.ProcedureName);
+  UINTN procLen = (SearchLen == DriverSize) ? DriverSize - procAddr : SearchLen;
+
+  Patcher.addPatch(kextpatch.Find.data(),
+                   kextpatch.MaskFind.data(),
+                   kextpatch.Find.size(),
+                   kextpatch.Replace.data(),
+                   kextpatch.MaskReplace.data(),
+                   procAddr, procLen,
+                   kextpatch.Count,
+                   kextpatch.Skip,
+                   N);
+  return TRUE;
+}
+
+void LOADER_ENTRY::ApplyKextPatchBatch(MultiPatternPatcher& Patcher, UINT8 *Driver, UINT32 DriverSize)
+{
+  if (Patcher.isEmpty()) {
+    return;
+  }
+  Patcher.apply(Driver, DriverSize);
+  for (size_t k = 0; k < Patcher.size(); k++) {
+    size_t Num = Patcher.replacesDone(k);
+    DBG_RT("\nAnyKextPatch %zu: driverAddr = %llx, driverSize = %x\n  Label = %s\n",
+           Patcher.tag(k), (UINTN)Driver, DriverSize, KernelAndKextPatches.KextPatches[Patcher.tag(k)].Label.c_str());
+    DBG_RT("Kext: %s\n", gKextBundleIdentifier);
+    DBG_RT("Binary patch\n");
+    if (KernelAndKextPatches.KPDebug) {
+      if (Num > 0) {
+        DBG_RT("==> patched %zu times!\n", Num);
+      } else {
+        DBG_RT("==> NOT patched!\n");
+      }
+      gBS->Stall(2000000);
+    }
+  }
+  Patcher.setEmpty();
+}
+
 //
 // Called from SetFSInjection(), before boot.efi is started,
 // to allow patchers to prepare FSInject to force load needed kexts.
@@ -1120,16 +1182,31 @@ void LOADER_ENTRY::PatchKext(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist,
   }
   //com.apple.iokit.IOGraphicsFamily
   
+  // one hash probe for the bundle identifier, plus the patches with a partial name
+  if (KextPatchesIndex.size() != KernelAndKextPatches.KextPatches.size()) {
+    KextPatchesIndex.setEmpty();
     for (size_t i = 0; i < KernelAndKextPatches.KextPatches.size(); i++) {
-      XString8& Name = KernelAndKextPatches.KextPatches[i].Name;
-      BOOLEAN   isBundle = Name.contains(".");
-      if ((KernelAndKextPatches.KextPatches[i].Find.size() > 0) &&
-          isBundle?(AsciiStrCmp(gKextBundleIdentifier, Name.c_str()) == 0):(AsciiStrStr(gKextBundleIdentifier, Name.c_str()) != NULL)) {
-      //    (AsciiStrStr(InfoPlist, KernelAndKextPatches.KextPatches[i].Name) != NULL)) {
-        DBG_RT("\n\nPatch kext: %s\n", KernelAndKextPatches.KextPatches[i].Name.c_str());
-        AnyKextPatch(Driver, DriverSize, InfoPlist, InfoPlistSize, i);
-      }
+      KextPatchesIndex.add(KernelAndKextPatches.KextPatches[i].Name);
     }
+  }
+  XArray<size_t> PatchIndexes;
+  KextPatchesIndex.find(gKextBundleIdentifier, &PatchIndexes);
+
+  // Patches are applied in order. A patch that can't be batched flushes the pending ones first.
+  MultiPatternPatcher Patcher;
+  for (size_t k = 0; k < PatchIndexes.size(); k++) {
+    size_t i = PatchIndexes[k];
+    if (KernelAndKextPatches.KextPatches[i].Find.size() == 0) {
+      continue;
+    }
+    DBG_RT("\n\nPatch kext: %s\n", KernelAndKextPatches.KextPatches[i].Name.c_str());
+    if (AddKextPatchToBatch(Patcher, Driver, DriverSize, i)) {
+      continue;
+    }
+    ApplyKextPatchBatch(Patcher, Driver, DriverSize);
+    AnyKextPatch(Driver, DriverSize, InfoPlist, InfoPlistSize, i);
+  }
+  ApplyKextPatchBatch(Patcher, Driver, DriverSize);
 }
 
 //
@@ -1142,7 +1219,7 @@ void LOADER_ENTRY::PatchKext(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist,
 // a) <integer ID="26" size="64">0x2b000</integer>
 //    returns 0x2b000
 // b) <integer IDREF="26"/>
-//    searches for <integer ID="26"... from WholePlist
+//    looks for ID 26 in Index, or if not indexed, searches for <integer ID="26"... from WholePlist
 //    and returns value from that referenced field
 //
 // Whole function is here since we should avoid ParseXML() and it's
@@ -1151,7 +1228,7 @@ void LOADER_ENTRY::PatchKext(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist,
 // This func is hard to read and debug and probably not reliable,
 // but it seems it works.
 //
-UINT64 GetPlistHexValue(CONST CHAR8 *Plist, CONST CHAR8 *Key, CONST CHAR8 *WholePlist)
+UINT64 GetPlistHexValue(CONST CHAR8 *Plist, CONST CHAR8 *Key, CONST CHAR8 *WholePlist, const PrelinkInfoIndex *Index)
 {
   CHAR8     *Value;
   CHAR8     *IntTag;
@@ -1224,6 +1301,9 @@ UINT64 GetPlistHexValue(CONST CHAR8 *Plist, CONST CHAR8 *Key, CONST CHAR8 *Whole
     DBG("\nIDLen too big\n");
     return 0;
   }
+  if (Index != NULL && Index->getInteger(IDStart, &NumValue)) {
+    return NumValue;
+  }
   AsciiStrCpyS(Buffer, 48, "<integer ID=\"");
   AsciiStrnCatS(Buffer, 48, IDStart, IDLen);
   AsciiStrCatS(Buffer, 48, "\"");
@@ -1307,14 +1387,13 @@ UINT64 GetPlistHexValue(CONST CHAR8 *Plist, CONST CHAR8 *Key, CONST CHAR8 *Whole
 void LOADER_ENTRY::PatchPrelinkedKexts()
 {
   CHAR8     *WholePlist;
-  CHAR8     *DictPtr;
-  CHAR8     *InfoPlistStart = NULL;
-  CHAR8     *InfoPlistEnd = NULL;
-  INTN      DictLevel = 0;
+  CHAR8     *InfoPlistStart;
+  CHAR8     *InfoPlistEnd;
   CHAR8     SavedValue;
   //INTN      DbgCount = 0;
   UINT64    KextAddr = 0;
   UINT32    KextSize;
+  PrelinkInfoIndex Index;
   
   
   WholePlist = (CHAR8*)(UINTN)PrelinkInfoAddr;
@@ -1341,62 +1420,50 @@ void LOADER_ENTRY::PatchPrelinkedKexts()
   }
   DBG("\n");
 
-  DictPtr = WholePlist;
-  //new dict is the new kext
-  while ((DictPtr = strstr(DictPtr, "dict>")) != NULL) {
-    if (DictPtr[-1] == '<') {
-      // opening dict
-      DictLevel++;
-      if (DictLevel == 2) {
-        // kext start
-        InfoPlistStart = DictPtr - 1;
-      }
-    } else if (DictPtr[-2] == '<' && DictPtr[-1] == '/') {
-      
-      // closing dict
-      if (DictLevel == 2 && InfoPlistStart != NULL) {
-        // kext end
-        InfoPlistEnd = DictPtr + 5 /* "dict>" */;
-        
-        // terminate Info.plist with 0
-        SavedValue = *InfoPlistEnd;
-        *InfoPlistEnd = '\0';
-        
-        // get kext address from _PrelinkExecutableSourceAddr
-        // truncate to 32 bit to get physical addr? Yes!
-        KextAddr = (UINT32)GetPlistHexValue(InfoPlistStart, kPrelinkExecutableSourceKey, WholePlist);
-        // KextAddr is always relative to 0x200000
-        // and if KernelSlide is != 0 then KextAddr must be adjusted
-        KextAddr += KernelSlide;
-        // and adjust for AptioFixDrv's KernelRelocBase
-        KextAddr += KernelRelocBase;
-        
-        KextSize = (UINT32)GetPlistHexValue(InfoPlistStart, kPrelinkExecutableSizeKey, WholePlist);
-//        DBG("found kext addr=0x%llX size=0x%X\n", KextAddr, KextSize);
-        /*if (DbgCount < 3
-         || DbgCount == 100 || DbgCount == 101 || DbgCount == 102
-         ) {
-         DBG(L"\n\nKext: St = %hhX, Size = %hhX\n", KextAddr, KextSize);
-         DBG(L"Info: St = %p, End = %p\n%s\n", InfoPlistStart, InfoPlistEnd, InfoPlistStart);
-         gBS->Stall(20000000);
-         }
-         */
-        
-        // patch it
-        PatchKext(
-                  (UINT8*)(UINTN)KextAddr,
-                  KextSize,
-                  InfoPlistStart,
-                  (UINT32)(InfoPlistEnd - InfoPlistStart)
-                  );
-        
-        // return saved char
-        *InfoPlistEnd = SavedValue;
-        //DbgCount++;
-      }
-      DictLevel--;
-    }
-    DictPtr += 5;
+  // one pass to find kexts and IDs. Info.plist patches below are done in place and keep the size.
+  Index.build(WholePlist);
+  DBG("prelink info: %zu kexts, %zu integer IDs\n", Index.Kexts.size(), Index.IntegerValues.size());
+
+  //each dict at level 2 is a kext
+  for (size_t idx = 0; idx < Index.Kexts.size(); ++idx) {
+    InfoPlistStart = Index.Kexts[idx].Start;
+    InfoPlistEnd = Index.Kexts[idx].End;
+    
+    // terminate Info.plist with 0
+    SavedValue = *InfoPlistEnd;
+    *InfoPlistEnd = '\0';
+    
+    // get kext address from _PrelinkExecutableSourceAddr
+    // truncate to 32 bit to get physical addr? Yes!
+    KextAddr = (UINT32)GetPlistHexValue(InfoPlistStart, kPrelinkExecutableSourceKey, WholePlist, &Index);
+    // KextAddr is always relative to 0x200000
+    // and if KernelSlide is != 0 then KextAddr must be adjusted
+    KextAddr += KernelSlide;
+    // and adjust for AptioFixDrv's KernelRelocBase
+    KextAddr += KernelRelocBase;
+    
+    KextSize = (UINT32)GetPlistHexValue(InfoPlistStart, kPrelinkExecutableSizeKey, WholePlist, &Index);
+//    DBG("found kext addr=0x%llX size=0x%X\n", KextAddr, KextSize);
+    /*if (DbgCount < 3
+     || DbgCount == 100 || DbgCount == 101 || DbgCount == 102
+     ) {
+     DBG(L"\n\nKext: St = %hhX, Size = %hhX\n", KextAddr, KextSize);
+     DBG(L"Info: St = %p, End = %p\n%s\n", InfoPlistStart, InfoPlistEnd, InfoPlistStart);
+     gBS->Stall(20000000);
+     }
+     */
+    
+    // patch it
+    PatchKext(
+              (UINT8*)(UINTN)KextAddr,
+              KextSize,
+              InfoPlistStart,
+              (UINT32)(InfoPlistEnd - InfoPlistStart)
+              );
+    
+    // return saved char
+    *InfoPlistEnd = SavedValue;
+    //DbgCount++;
   }
 }
 
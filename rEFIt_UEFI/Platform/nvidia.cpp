@@ -52,6 +52,7 @@
 #include "device_inject.h"
 #include "smbios.h"
 #include "card_vlist.h"
+#include "DeviceIdIndex.h"
 #include "FixBiosDsdt.h"
 #include "../include/Pci.h"
 #include "../include/Devices.h"
@@ -116,7 +117,7 @@ const UINT8  pwm_info[] = {
 };
 #define PWM_LEN ( sizeof(pwm_info) / sizeof(UINT8) )
 
-static const nvidia_pci_info_t nvidia_card_vendors[] = {
+const nvidia_pci_info_t nvidia_card_vendors[] = {
   { 0x10190000,  "Elitegroup" },
   { 0x10250000,  "Acer" },
   { 0x10280000,  "Dell" },
@@ -170,7 +171,7 @@ static const nvidia_pci_info_t nvidia_card_vendors[] = {
   { 0x73770000,  "Colorful" },
 };
 
-static const nvidia_pci_info_t nvidia_card_generic[] = {
+const nvidia_pci_info_t nvidia_card_generic[] = {
   // 0000 - 0040
   { 0x10DE0000,  "Unknown" },
   // 0040 - 004F
@@ -1448,7 +1449,7 @@ static const nvidia_pci_info_t nvidia_card_generic[] = {
   // 2000 - 1EFFF
 };
 
-static nvidia_card_info_t nvidia_card_exceptions[] = {
+const nvidia_card_info_t nvidia_card_exceptions[] = {
   /* ========================================================================================
    * Layout is device(VendorId + DeviceId), subdev (SubvendorId + SubdeviceId), display name.
    * ========================================================================================
@@ -2012,9 +2013,57 @@ static INT32 patch_nvidia_rom(UINT8 *rom)
   return (has_lvds ? PATCH_ROM_SUCCESS_HAS_LVDS : PATCH_ROM_SUCCESS);
 }
 
+const size_t nvidia_card_vendors_count = sizeof(nvidia_card_vendors) / sizeof(nvidia_card_vendors[0]);
+const size_t nvidia_card_generic_count = sizeof(nvidia_card_generic) / sizeof(nvidia_card_generic[0]);
+const size_t nvidia_card_exceptions_count = sizeof(nvidia_card_exceptions) / sizeof(nvidia_card_exceptions[0]);
+
+static DeviceIdIndex nvidia_exceptions_index;
+static DeviceIdIndex nvidia_generic_index;
+static DeviceIdIndex nvidia_vendors_index;
+
+static void build_nvidia_indexes()
+{
+  UINTN i;
+
+  if (nvidia_generic_index.isBuilt()) {
+    return;
+  }
+  for (i = 0; i < nvidia_card_exceptions_count; i++) {
+    nvidia_exceptions_index.add(DeviceIdIndex::key(nvidia_card_exceptions[i].device, nvidia_card_exceptions[i].subdev), i);
+  }
+  nvidia_exceptions_index.sort();
+  // the first one is the name of unknown cards
+  for (i = 1; i < nvidia_card_generic_count; i++) {
+    nvidia_generic_index.add(nvidia_card_generic[i].device, i);
+  }
+  nvidia_generic_index.sort();
+  for (i = 0; i < nvidia_card_vendors_count; i++) {
+    nvidia_vendors_index.add(nvidia_card_vendors[i].device, i);
+  }
+  nvidia_vendors_index.sort();
+}
+
+size_t find_nvidia_card_exception(UINT32 device_id, UINT32 subsys_id)
+{
+  build_nvidia_indexes();
+  return nvidia_exceptions_index.find(DeviceIdIndex::key(device_id, subsys_id));
+}
+
+size_t find_nvidia_card_generic(UINT32 device_id)
+{
+  build_nvidia_indexes();
+  return nvidia_generic_index.find(device_id);
+}
+
+size_t find_nvidia_card_vendor(UINT32 subsys_id)
+{
+  build_nvidia_indexes();
+  return nvidia_vendors_index.find(subsys_id & 0xffff0000);
+}
+
 CONST CHAR8 *get_nvidia_model(UINT32 device_id, UINT32 subsys_id)
 {
-  UINTN i, j;
+  size_t i, j;
   //DBG("get_nvidia_model for (%08X, %08X)\n", device_id, subsys_id);
 
   //ErmaC added selector for nVidia "old" style in System Profiler
@@ -2023,39 +2072,35 @@ CONST CHAR8 *get_nvidia_model(UINT32 device_id, UINT32 subsys_id)
   {
     // Then check the exceptions table
     if (subsys_id) {
-      for (i = 0; i < (sizeof(nvidia_card_exceptions) / sizeof(nvidia_card_exceptions[0])); i++) {
-        if ((nvidia_card_exceptions[i].device == device_id) &&
-            (nvidia_card_exceptions[i].subdev == subsys_id)) {
-          return nvidia_card_exceptions[i].name_model;
-        }
+      i = find_nvidia_card_exception(device_id, subsys_id);
+      if (i != MAX_XSIZE) {
+        return nvidia_card_exceptions[i].name_model;
       }
     }
   }
 
   // At last try the generic names
-  for (i = 1; i < (sizeof(nvidia_card_generic) / sizeof(nvidia_card_generic[0])); i++) {
-    if (nvidia_card_generic[i].device == device_id) {
-      //--
-      //ErmaC added selector for nVidia "old" style in System Profiler
-      if (gSettings.Graphics.NvidiaGeneric) {
-        DBG("Apply NvidiaGeneric\n");
-		  snprintf(generic_name, 128, "NVIDIA %s", nvidia_card_generic[i].name_model);
+  i = find_nvidia_card_generic(device_id);
+  if (i != MAX_XSIZE) {
+    //--
+    //ErmaC added selector for nVidia "old" style in System Profiler
+    if (gSettings.Graphics.NvidiaGeneric) {
+      DBG("Apply NvidiaGeneric\n");
+      snprintf(generic_name, 128, "NVIDIA %s", nvidia_card_generic[i].name_model);
+      return &generic_name[0]; // generic_name;
+    }
+    //      DBG("Not applied NvidiaGeneric\n");
+    //--
+    if (subsys_id) {
+      j = find_nvidia_card_vendor(subsys_id);
+      if (j != MAX_XSIZE) {
+        snprintf(generic_name, 128, "%s %s",
+                 nvidia_card_vendors[j].name_model,
+                 nvidia_card_generic[i].name_model);
         return &generic_name[0]; // generic_name;
       }
-      //      DBG("Not applied NvidiaGeneric\n");
-      //--
-      if (subsys_id) {
-        for (j = 0; j < (sizeof(nvidia_card_vendors) / sizeof(nvidia_card_vendors[0])); j++) {
-          if (nvidia_card_vendors[j].device == (subsys_id & 0xffff0000)) {
-			  snprintf(generic_name, 128, "%s %s",
-                        nvidia_card_vendors[j].name_model,
-                        nvidia_card_generic[i].name_model);
-            return &generic_name[0]; // generic_name;
-          }
-        }
-      }
-      return nvidia_card_generic[i].name_model;
     }
+    return nvidia_card_generic[i].name_model;
   }
   return nvidia_card_generic[0].name_model;
 }
@@ -187,4 +187,19 @@ setup_nvidia_devprop (
 
 CONST CHAR8* get_nvidia_model(UINT32 device_id, UINT32 subsys_id);
 
+// Names of the cards : the vendors, the generic names, and the names for a subsystem id
+extern const nvidia_pci_info_t nvidia_card_vendors[];
+extern const size_t nvidia_card_vendors_count;
+extern const nvidia_pci_info_t nvidia_card_generic[];
+extern const size_t nvidia_card_generic_count;
+extern const nvidia_card_info_t nvidia_card_exceptions[];
+extern const size_t nvidia_card_exceptions_count;
+
+// The first entry of nvidia_card_exceptions for device_id and subsys_id, MAX_XSIZE if none
+size_t find_nvidia_card_exception(UINT32 device_id, UINT32 subsys_id);
+// The first entry of nvidia_card_generic for device_id, MAX_XSIZE if none. Never the first one, "Unknown".
+size_t find_nvidia_card_generic(UINT32 device_id);
+// The first entry of nvidia_card_vendors for the subsystem vendor of subsys_id, MAX_XSIZE if none
+size_t find_nvidia_card_vendor(UINT32 subsys_id);
+
 #endif /* !__LIBSAIO_NVIDIA_H */
@@ -86,8 +86,8 @@ TagArray* TagArray::getEmptyTag()
   TagArray* tag;
 
   if ( tagsFree.size() > 0 ) {
-    tag = &tagsFree[0];
-    tagsFree.RemoveWithoutFreeingAtIndex(0);
+    tag = &tagsFree[tagsFree.size()-1];
+    tagsFree.RemoveWithoutFreeingAtIndex(tagsFree.size()-1);
 //tagcachehit++;
 //DBG("tagcachehit=%lld\n", tagcachehit);
     return tag;
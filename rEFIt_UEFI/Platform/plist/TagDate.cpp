@@ -54,8 +54,8 @@ TagDate* TagDate::getEmptyTag()
   TagDate* tag;
 
   if ( tagsFree.size() > 0 ) {
-    tag = &tagsFree[0];
-    tagsFree.RemoveWithoutFreeingAtIndex(0);
+    tag = &tagsFree[tagsFree.size()-1];
+    tagsFree.RemoveWithoutFreeingAtIndex(tagsFree.size()-1);
 //tagcachehit++;
 //DBG("tagcachehit=%lld\n", tagcachehit);
     return tag;
@@ -43,6 +43,7 @@
 #endif
 
 #include "TagDict.h"
+#include "../../cpp_foundation/fnv_hash.h"
 
 XObjArray<TagDict> TagDict::tagsFree;
 
@@ -53,8 +54,8 @@ TagDict* TagDict::getEmptyTag()
   TagDict* tag;
 
   if ( tagsFree.size() > 0 ) {
-    tag = &tagsFree[0];
-    tagsFree.RemoveWithoutFreeingAtIndex(0);
+    tag = &tagsFree[tagsFree.size()-1];
+    tagsFree.RemoveWithoutFreeingAtIndex(tagsFree.size()-1);
 //tagcachehit++;
 //DBG("tagcachehit=%lld\n", tagcachehit);
     return tag;
@@ -72,6 +73,8 @@ void TagDict::FreeTag()
     _dictContent[tagIdx].FreeTag();
     _dictContent.RemoveWithoutFreeingAtIndex(tagIdx);
   }
+  _keyIndex.setEmpty();
+  _keyIndexedSize = 0;
   tagsFree.AddReference(this, true);
 }
 
@@ -151,19 +154,69 @@ EFI_STATUS TagDict::getKeyAndValueAtIndex(INTN id, const TagKey** key, const Tag
   return EFI_UNSUPPORTED;
 }
 
-const TagStruct* TagDict::propertyForKey(const CHAR8* key) const
+// FNV-1a of the key in lower case. isEqualIC() only ignores the case of ascii letters.
+size_t TagDict::keyHash(const CHAR8* key)
 {
-  const XObjArray<TagStruct>& tagList = _dictContent;
-  for (size_t tagIdx = 0 ; tagIdx < tagList.size() ; tagIdx++ )
+  UINT64 hash = Fnv1a64Seed;
+  for ( ; *key ; key++ ) {
+    CHAR8 c = *key;
+    if ( c >= 'A'  &&  c <= 'Z' ) c += 'a' - 'A';
+    hash = fnv1a64Byte(hash, (UINT8)c);
+  }
+  return (size_t)hash;
+}
+
+void TagDict::buildKeyIndex() const
+{
+  size_t nbSlots = 1;
+  while ( nbSlots < _dictContent.size() * 2 ) nbSlots <<= 1; // keys are less than half of the content, so at least 3/4 of the slots are free
+  size_t mask = nbSlots - 1;
+
+  _keyIndex.setEmpty();
+  _keyIndex.Add(0, nbSlots);
+  for (size_t tagIdx = 0 ; tagIdx < _dictContent.size() ; tagIdx++ )
   {
-    if ( tagList[tagIdx].isKey()  &&  tagList[tagIdx].getKey()->keyStringValue().isEqualIC(key) ) {
-      if ( tagIdx+1 >= tagList.size() ) return NULL;
-      if ( tagList[tagIdx+1].isKey() ) return NULL;
-      return &tagList[tagIdx+1];
+    if ( !_dictContent[tagIdx].isKey() ) continue;
+    const XString8& keyString = _dictContent[tagIdx].getKey()->keyStringValue();
+    size_t slot = keyHash(keyString.c_str()) & mask;
+    while ( _keyIndex[slot] != 0  &&  !_dictContent[_keyIndex[slot]-1].getKey()->keyStringValue().isEqualIC(keyString) ) {
+      slot = (slot + 1) & mask;
+    }
+    if ( _keyIndex[slot] == 0 ) _keyIndex[slot] = tagIdx + 1; // a key already there is kept, as the loop in keyTagIdx() would find it first
+  }
+  _keyIndexedSize = _dictContent.size();
+}
+
+// Index in _dictContent of the first key equal to key, ignoring case. MAX_XSIZE if there is none.
+size_t TagDict::keyTagIdx(const CHAR8* key) const
+{
+  const XObjArray<TagStruct>& tagList = _dictContent;
+  if ( tagList.size() < MinSizeForKeyIndex ) {
+    for (size_t tagIdx = 0 ; tagIdx < tagList.size() ; tagIdx++ )
+    {
+      if ( tagList[tagIdx].isKey()  &&  tagList[tagIdx].getKey()->keyStringValue().isEqualIC(key) ) return tagIdx;
     }
+    return MAX_XSIZE;
+  }
+
+  if ( _keyIndexedSize != tagList.size() ) buildKeyIndex();
+  size_t mask = _keyIndex.size() - 1;
+  for (size_t slot = keyHash(key) & mask ; _keyIndex[slot] != 0 ; slot = (slot + 1) & mask )
+  {
+    size_t tagIdx = _keyIndex[slot] - 1;
+    if ( tagList[tagIdx].getKey()->keyStringValue().isEqualIC(key) ) return tagIdx;
   }
+  return MAX_XSIZE;
+}
 
-  return NULL;
+const TagStruct* TagDict::propertyForKey(const CHAR8* key) const
+{
+  const XObjArray<TagStruct>& tagList = _dictContent;
+  size_t tagIdx = keyTagIdx(key);
+  if ( tagIdx == MAX_XSIZE ) return NULL;
+  if ( tagIdx+1 >= tagList.size() ) return NULL;
+  if ( tagList[tagIdx+1].isKey() ) return NULL;
+  return &tagList[tagIdx+1];
 }
 
 const TagDict* TagDict::dictPropertyForKey(const CHAR8* key) const
@@ -14,10 +14,22 @@ class TagDict : public TagStruct
 {
   static XObjArray<TagDict> tagsFree;
   XObjArray<TagStruct> _dictContent;
+  /*
+   * Hash table of the keys, to not compare a key with all the others in a big dict.
+   * Slot is 0 or the index in _dictContent of the key + 1. Only the first of the keys equal (ignoring case) is there.
+   * Built at the first propertyForKey() and again when the size of _dictContent changes or dictContent() is called.
+   */
+  mutable XArray<size_t> _keyIndex;
+  mutable size_t _keyIndexedSize;
+
+  static const size_t MinSizeForKeyIndex = 16; // under that, a loop is faster than hashing
+  static size_t keyHash(const CHAR8* key);
+  void buildKeyIndex() const;
+  size_t keyTagIdx(const CHAR8* key) const;
 
 public:
 
-  TagDict() : _dictContent() {}
+  TagDict() : _dictContent(), _keyIndex(), _keyIndexedSize(0) {}
   TagDict(const TagDict& other) = delete; // Can be defined if needed
   const TagDict& operator = (const TagDict&); // Can be defined if needed
   virtual ~TagDict() { }
@@ -50,6 +62,7 @@ public:
 #ifdef DEBUG
     if ( !isDict() ) panic("TagDict::dictContent() : !isDict() ");
 #endif
+    _keyIndexedSize = 0; // might be modified
     return _dictContent;
   }
   INTN dictKeyCount() const;
@@ -52,6 +52,12 @@ public:
     if ( xstring.isEmpty() ) log_technical_bug("TagKey::setKeyValue() : xstring.isEmpty() ");
     _string = xstring;
   }
+  // a copy of size chars of s, so s can be freed
+  void setKeyValue(const CHAR8* s, size_t size)
+  {
+    if ( size == 0 ) log_technical_bug("TagKey::setKeyValue() : size == 0 ");
+    _string.strsicpy(s, size);
+  }
 
 };
 
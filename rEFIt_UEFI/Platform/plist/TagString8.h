@@ -53,6 +53,11 @@ public:
     //if ( xstring.isEmpty() ) panic("TagStruct::setStringValue() : xstring.isEmpty() ");
     _string = xstring;
   }
+  // a copy of size chars of s, so s can be freed
+  void setStringValue(const CHAR8* s, size_t size)
+  {
+    _string.strsicpy(s, size);
+  }
 
 };
 
@@ -46,7 +46,6 @@
 #define DBG(...) DebugLog(DEBUG_PLIST, __VA_ARGS__)
 #endif
 
-CHAR8* buffer_start = NULL;
 
 // Forward declarations
 EFI_STATUS ParseTagDict( CHAR8* buffer, TagStruct* * tag, UINT32 empty, UINT32* lenPtr);
@@ -242,11 +241,12 @@ EFI_STATUS ParseXML(const CHAR8* buffer, TagDict** dict, size_t bufSize)
     return EFI_INVALID_PARAMETER;
   }
 
+  // tags copy their strings, this copy is only for the parser that writes in it
   configBuffer = (__typeof__(configBuffer))malloc(bufferSize+1);
-  memset(configBuffer, 0, bufferSize+1);
   if(configBuffer == NULL) {
     return EFI_OUT_OF_RESOURCES;
   }
+  memset(configBuffer, 0, bufferSize+1);
 
   memmove(configBuffer, buffer, bufferSize);
   for (i=0; i<bufferSize; i++) {
@@ -254,7 +254,6 @@ EFI_STATUS ParseXML(const CHAR8* buffer, TagDict** dict, size_t bufSize)
       configBuffer[i] = 0x20;  //replace random zero bytes to spaces
     }
   }
-  buffer_start = configBuffer;
   while (TRUE)
   {
     Status = XMLParseNextTag(configBuffer + pos, &tag, &length);
@@ -276,13 +275,16 @@ EFI_STATUS ParseXML(const CHAR8* buffer, TagDict** dict, size_t bufSize)
 	  tag->FreeTag();
     tag = NULL;
   }
-//  FreePool(configBuffer);
+  free(configBuffer);
 
   if (EFI_ERROR(Status)) {
     return Status;
   }
   if (tag->isDict()) *dict = tag->getDict();
-  else *dict = NULL;
+  else {
+    tag->FreeTag();
+    *dict = NULL;
+  }
   return EFI_SUCCESS;
 }
 
@@ -514,7 +516,7 @@ EFI_STATUS ParseTagKey( char * buffer, TagStruct** tag, UINT32* lenPtr)
 //    return Status;
 //  }
   tmpTag = TagKey::getEmptyTag();
-  tmpTag->setKeyValue(LString8(buffer, strlen(buffer)));
+  tmpTag->setKeyValue(buffer, strlen(buffer));
 
   *tag = tmpTag;
   *lenPtr = length + length2;
@@ -542,7 +544,7 @@ EFI_STATUS ParseTagString(CHAR8* buffer, TagStruct* * tag,UINT32* lenPtr)
   }
 
   size_t outlen = XMLDecode(buffer, strlen(buffer), buffer, strlen(buffer));
-  tmpTag->setStringValue(LString8(buffer, outlen));
+  tmpTag->setStringValue(buffer, outlen);
   *tag = tmpTag;
   *lenPtr = length;
   DBG(" parse string %s\n", tmpTag->getString()->stringValue().c_str());
@@ -700,7 +702,7 @@ EFI_STATUS ParseTagDate(CHAR8* buffer, TagStruct* * tag,UINT32* lenPtr)
 
 
   tmpTag = TagDate::getEmptyTag();
-  tmpTag->setDateValue(LString8(buffer, length));
+  tmpTag->setDateValue(XString8().takeValueFrom(buffer, strlen(buffer)));
 
   *tag = tmpTag;
   *lenPtr = length;
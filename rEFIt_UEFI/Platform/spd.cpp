@@ -17,7 +17,9 @@
 
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 #include "../Platform/Settings.h"
+#include "../Settings/Self.h"
 #include "spd.h"
+#include "SpdSnapshot.h"
 #include "memvendors.h"
 #include "cpu.h"
 #include "smbios.h"
@@ -39,6 +41,14 @@
 
 BOOLEAN     smbIntel;
 UINT8				smbPage;
+BOOLEAN     smbBlockRead;     // I2C block read works on this controller
+BOOLEAN     smbSpdWriteDisabled;
+
+#define SPD_SNAPSHOT L"misc\\spd_snapshot.bin"
+static_assert(SpdSnapshot::SpdSize == MAX_SPD_SIZE, "SpdSnapshot::SpdSize == MAX_SPD_SIZE");
+
+// the bytes of the SPD buffer already read for the current slot
+STATIC UINT8 spdLoaded[SpdSnapshot::LoadedSize];
 
 CONST CHAR8 *spd_memory_types[] =
 {
@@ -293,15 +303,76 @@ UINT8 smb_read_byte(UINT32 base, UINT8 adr, UINT16 cmd)
   }
 }
 
-/* SPD i2c read optimization: prefetch only what we need, read non prefetcheable bytes on the fly */
-#define READ_SPD(spd, base, slot, x) spd[x] = smb_read_byte(base, 0x50 + slot, x)
+class SmbusPortIo : public SmbusIo
+{
+public:
+  virtual UINT8 read8(UINT32 Port) { return IoRead8(Port); }
+  virtual void write8(UINT32 Port, UINT8 Value) { IoWrite8(Port, Value); }
+  virtual UINT64 milliseconds() { return DivU64x64Remainder(AsmReadTsc(), DivU64x32(gCPUStructure.TSCFrequency, 1000), 0); }
+};
+
+/* SPD i2c read optimization: prefetch only what we need, read non prefetcheable bytes on the fly, each one once */
+#define READ_SPD(spd, base, slot, x) read_spd_byte(spd, base, slot, x)
+
+STATIC void read_spd_byte(UINT8* spd, UINT32 base, UINT8 slot, UINT16 x)
+{
+  if (!SpdSnapshot::isLoaded(spdLoaded, x)) {
+    spd[x] = smb_read_byte(base, 0x50 + slot, x);
+    SpdSnapshot::setLoaded(spdLoaded, x);
+  }
+}
+
+/** Read the 32 bytes block of byte x in one I2C block read. FALSE if the controller can't, use READ_SPD then */
+STATIC BOOLEAN read_spd_block(UINT8* spd, UINT32 base, UINT8 slot, UINT16 x)
+{
+  UINT16 start = x & ~31;
+  UINT8  length = (UINT8)MIN(32, MAX_SPD_SIZE - start);
+  UINT16 i;
 
+  if (!smbBlockRead) {
+    return FALSE;
+  }
+  if (((start >> 8) & 1) != smbPage) {
+    spd[start] = smb_read_byte(base, 0x50 + slot, start); // a byte read changes the page
+  }
+  SmbusPortIo Io;
+  if (!SmbusI2cBlockRead(Io, base, 0x50 + slot, (UINT8)start, spd + start, length, smbSpdWriteDisabled)) {
+    DBG("SPD block read failed for byte %2hhX:%d, reading byte by byte\n", 0x50 + slot, start);
+    smbBlockRead = FALSE;
+    return FALSE;
+  }
+  for (i = start; i < start + length; i++) {
+    SpdSnapshot::setLoaded(spdLoaded, i);
+  }
+  return TRUE;
+}
+
+/** Offset of the module serial number, 0 if the type has none */
+STATIC UINT16 spd_serial_offset(UINT8 type)
+{
+  switch (type) {
+    case SPD_MEMORY_TYPE_SDRAM_DDR4:
+      return SPD_DDR4_SERIAL_NUMBER;
+    case SPD_MEMORY_TYPE_SDRAM_DDR3:
+      return 122;
+    case SPD_MEMORY_TYPE_SDRAM_DDR2:
+    case SPD_MEMORY_TYPE_SDRAM_DDR:
+      return SPD_ASSEMBLY_SERIAL_NUMBER;
+    default:
+      return 0;
+  }
+}
 
 /** Read from spd *used* values only*/
 void init_spd(UINT16* spd_indexes, UINT8* spd, UINT32 base, UINT8 slot)
 {
   UINT16 i;
   for (i=0; spd_indexes[i]; i++) {
+    // one block read is worth it if the next byte is in the same block
+    if (!SpdSnapshot::isLoaded(spdLoaded, spd_indexes[i]) && spd_indexes[i+1] &&
+        (spd_indexes[i+1] & ~31) == (spd_indexes[i] & ~31)) {
+      read_spd_block(spd, base, slot, spd_indexes[i]);
+    }
     READ_SPD(spd, base, slot, spd_indexes[i]);
   }
 
@@ -573,6 +644,11 @@ CHAR8* getDDRPartNum(UINT8* spd, UINT32 base, UINT8 slot)
     start = 73;
   }
 
+  if (start != 0 && !SpdSnapshot::isLoaded(spdLoaded, start) && read_spd_block(spd, base, slot, start) &&
+      !SpdSnapshot::isLoaded(spdLoaded, start + 19)) {
+    read_spd_block(spd, base, slot, start + 19);
+  }
+
   // Check that the spd part name is zero terminated and that it is ascii:
   ZeroMem(asciiPartNo, 32);  //sizeof(asciiPartNo));
   for (i = start; i < start + 20; i++) {
@@ -591,11 +667,12 @@ CHAR8* getDDRPartNum(UINT8* spd, UINT32 base, UINT8 slot)
 #define PCI_COMMAND_OFFSET                          0x04
 
 /** Read from smbus the SPD content and interpret it for detecting memory attributes */
-STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
+STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did, SpdSnapshot& Snapshot)
 {
   //	EFI_STATUS	Status;
   UINT16      speed;
   UINT8       i;// spd_size, spd_type;
+  UINT16      j, serialOffset;
   UINT32			base, mmio, hostc;
   UINT16			Command;
   //RAM_SLOT_INFO*  slot;
@@ -646,6 +723,7 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
 
     base &= 0xFFFE;
     smbIntel = TRUE;
+    smbBlockRead = TRUE; // ICH5 and later, it's checked by the first one
   }
   else {
     /*Status = */PciIo->Pci.Read (
@@ -657,6 +735,7 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
                                   );
     base &= 0xFFFC;
     smbIntel = FALSE;
+    smbBlockRead = FALSE;
   }
   /*Status = */PciIo->Pci.Read (
                                 PciIo,
@@ -669,6 +748,7 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
 
 	MsgLog("Scanning SMBus [%04hX:%04hX], mmio: 0x%X, ioport: 0x%X, hostc: 0x%X\n",
          vid, did, mmio, base, hostc);
+  smbSpdWriteDisabled = smbIntel && (hostc & 0x10) != 0; // SPD_WD, the I2C read then needs the read bit
 
   // needed at least for laptops
   //fullBanks = (gDMI->MemoryModules == gDMI->CntMemorySlots);
@@ -680,7 +760,8 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
   for (i = 0; i <  TotalSlotsCount; i++){
     //<==
     ZeroMem(spdbuf, MAX_SPD_SIZE);
-    READ_SPD(spdbuf, base, i, SPD_MEMORY_TYPE);
+    ZeroMem(spdLoaded, sizeof(spdLoaded));
+    spdbuf[SPD_MEMORY_TYPE] = smb_read_byte(base, 0x50 + i, SPD_MEMORY_TYPE);
     if (spdbuf[SPD_MEMORY_TYPE] == 0xFF) {
       //DBG("SPD[%d]: Empty\n", i);
       continue;
@@ -689,9 +770,21 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
       // First 0x40 bytes of DDR4 spd second page is 0. Maybe we need to change page, so do that and retry.
       DBG("SPD[%d]: Got invalid type %d @0x%X. Will set page and retry.\n", i, spdbuf[SPD_MEMORY_TYPE], 0x50 + i);
       smbPage = 0xFF; // force page to be set
-      READ_SPD(spdbuf, base, i, SPD_MEMORY_TYPE);
+      spdbuf[SPD_MEMORY_TYPE] = smb_read_byte(base, 0x50 + i, SPD_MEMORY_TYPE);
     }
-    
+    SpdSnapshot::setLoaded(spdLoaded, SPD_MEMORY_TYPE);
+
+    // Same module as in the snapshot : only the serial number is read
+    serialOffset = spd_serial_offset(spdbuf[SPD_MEMORY_TYPE]);
+    if (serialOffset != 0) {
+      for (j = 0; j < SpdSnapshot::SerialSize; j++) {
+        READ_SPD(spdbuf, base, i, serialOffset + j);
+      }
+      if (Snapshot.get(i, spdbuf, spdLoaded)) {
+        DBG("SPD[%d]: from %ls\n", i, SPD_SNAPSHOT);
+      }
+    }
+
     // Copy spd data into buffer
     DBG("SPD[%d]: Type %d @0x%X\n", i, spdbuf[SPD_MEMORY_TYPE], 0x50 + i);
     switch (spdbuf[SPD_MEMORY_TYPE])  {
@@ -845,6 +938,7 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
 
     gRAM.SPD[i].InUse = TRUE;
     ++(gRAM.SPDInUse);
+    Snapshot.add(i, serialOffset, spdbuf, spdLoaded);
     //}
 
     // laptops sometimes show slot 0 and 2 with slot 1 empty when only 2 slots are presents so:
@@ -854,8 +948,9 @@ STATIC void read_smb(EFI_PCI_IO_PROTOCOL *PciIo, UINT16	vid, UINT16	did)
 
   } // for
   if (smbPage != 0) {
-    READ_SPD(spdbuf, base, 0, 0); // force first page when we're done
+    smb_read_byte(base, 0x50, 0); // force first page when we're done
   }
+  FreePool(spdbuf);
 }
 
 void ScanSPD()
@@ -869,8 +964,19 @@ void ScanSPD()
   UINTN                 Index;
 //  UINTN                 ProtocolIndex;
   PCI_TYPE00            gPci;
+  SpdSnapshot           Snapshot;
+  UINT8                 *FileData = NULL;
+  UINTN                 FileDataLength = 0;
 
   DbgHeader("ScanSPD");
+
+  if (EFI_ERROR(egLoadFile(&self.getCloverDir(), SPD_SNAPSHOT, &FileData, &FileDataLength))) {
+    FileData = NULL;
+    FileDataLength = 0;
+  }
+  if (!Snapshot.load(FileData, FileDataLength)) {
+    DBG("%ls is not valid, it will be rebuilt\n", SPD_SNAPSHOT);
+  }
   
   // Scan PCI handles
   Status = gBS->LocateHandleBuffer (
@@ -905,12 +1011,19 @@ void ScanSPD()
                gPci.Hdr.ClassCode[0],
                efiStrError(Status)
                );
-          read_smb(PciIo, gPci.Hdr.VendorId, gPci.Hdr.DeviceId);
+          read_smb(PciIo, gPci.Hdr.VendorId, gPci.Hdr.DeviceId, Snapshot);
         }
       }
     }
   }
 
+  if (Snapshot.isModified()) {
+    if (EFI_ERROR(egSaveFile(&self.getCloverDir(), SPD_SNAPSHOT, Snapshot.getData().data(), Snapshot.getData().size()))) {
+      DBG("%ls not saved\n", SPD_SNAPSHOT);
+    }
+  }
+  Snapshot.setEmpty();
+
 
   // Scan PCI BUS For SmBus controller 
 /*  Status = gBS->LocateHandleBuffer(AllHandles,NULL,NULL,&HandleCount,&HandleBuffer);
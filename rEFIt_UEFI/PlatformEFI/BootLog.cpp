@@ -75,6 +75,22 @@ PrintBytes(IN void *Bytes, IN UINTN Number)
 static XStringW debugLogFileName;
 static EFI_FILE_PROTOCOL* gLogFile = NULL;
 // Do not keep a pointer to MemLogBuffer. Because a reallocation, it could become invalid.
+// Offset in MemLogBuffer of the first byte not yet written to the log file.
+static UINTN debugLogWrittenOffset = 0;
+
+/*
+ * Unless DebugFlushInterval is 0, messages are not written one by one : the MemLog buffer itself is the write buffer.
+ * Pending bytes are written when there is more than DEBUG_LOG_FLUSH_THRESHOLD of them, by a periodic timer
+ * every DebugFlushInterval ms, and when the log is closed (before starting an image).
+ * The timer must not read MemLogBuffer while a message is being added, as the buffer could be reallocated. In that case,
+ * it only requests a flush, done by the message callback.
+ */
+#define DEBUG_LOG_FLUSH_THRESHOLD (64*1024)
+static EFI_EVENT debugLogFlushTimer = NULL;
+static UINT32 debugLogFlushTimerInterval = 0; // ms. 0 when timer is not armed.
+static BOOLEAN debugLogUnbuffered = FALSE;
+static volatile BOOLEAN debugLogBusy = FALSE;
+static volatile BOOLEAN debugLogFlushRequested = FALSE;
 
 int g_OpeningLogFile = 0;
 
@@ -98,7 +114,7 @@ public:
 #define DGB_nbCallback(...) do { SuspendMemLogCallback smc; DBG(__VA_ARGS__); } while (0)
 #endif
 
-void closeDebugLog()
+static void closeDebugLogFile()
 {
 //  EFI_STATUS          Status;
 
@@ -205,42 +221,123 @@ static UINTN GetDebugLogFile()
   }
 }
 
-VOID SaveMessageToDebugLogFile(IN CHAR8 *LastMessage)
+/*
+ * Write what has been added to MemLogBuffer since the last write.
+ */
+static void writeDebugLogPending()
 {
   EFI_STATUS Status;
 
-  UINTN lastWrittenOffset = GetDebugLogFile();
+  if ( gLogFile == NULL ) {
+    debugLogWrittenOffset = GetDebugLogFile();
+    if ( gLogFile == NULL ) return;
+  }
 
-  if ( gLogFile == NULL ) return;
+  UINTN MemLogLen = GetMemLogLen();
+  if ( debugLogWrittenOffset >= MemLogLen ) return;
 
-  // Write out this message
-  const char* lastWrittenPointer = GetMemLogBuffer() + lastWrittenOffset;
-  UINTN TextLen = strlen(lastWrittenPointer);
+  const char* lastWrittenPointer = GetMemLogBuffer() + debugLogWrittenOffset;
+  UINTN TextLen = MemLogLen - debugLogWrittenOffset;
   UINTN TextLen2 = TextLen;
 
   Status = gLogFile->Write(gLogFile, &TextLen2, lastWrittenPointer);
-  lastWrittenOffset += TextLen2;
+  debugLogWrittenOffset += TextLen2;
   if ( EFI_ERROR(Status) ) {
     DGB_nbCallback("SaveMessageToDebugLogFile write error %s\n", efiStrError(Status));
-    closeDebugLog();
+    closeDebugLogFile();
   }else{
     if ( TextLen2 != TextLen ) {
       DGB_nbCallback("SaveMessageToDebugLogFile TextLen2(%lld) != TextLen(%lld)\n", TextLen2, TextLen);
-      closeDebugLog();
-    }else{
-      // Not all Firmware implements Flush. So we have to close everytime to force flush. Let's Close() instead of Flush()
-      // Is there a performance difference ? Is it worth to create a setting ? Probably not...
-//          Status = LogFile->Flush(LogFile);
-//          if ( EFI_ERROR(Status) ) {
-//            DGB_nbCallback("SaveMessageToDebugLogFile Cannot flush error %s\n", efiStrError(Status));
-//            closeDebugLog();
-//          }
+      closeDebugLogFile();
     }
   }
-  // Not all Firmware implements Flush. So we have to close every time to force flush.
+}
+
+/*
+ * Not all Firmware implements Flush. If it doesn't, data reaches the disk at the latest when the file is closed.
+ */
+static void flushDebugLogFile()
+{
+  debugLogFlushRequested = FALSE;
+  writeDebugLogPending();
+  if ( gLogFile ) gLogFile->Flush(gLogFile);
+}
+
+static VOID EFIAPI DebugLogFlushTimerNotify(IN EFI_EVENT Event, IN VOID *Context)
+{
+  if ( debugLogBusy ) {
+    debugLogFlushRequested = TRUE;
+    return;
+  }
+  if ( gLogFile == NULL  &&  debugLogWrittenOffset >= GetMemLogLen() ) return;
+  debugLogBusy = TRUE;
+  {
+    SuspendMemLogCallback smc;
+    flushDebugLogFile();
+  }
+  debugLogBusy = FALSE;
+}
+
+static void armDebugLogFlushTimer(UINT32 Interval)
+{
+  EFI_STATUS Status;
+
+  if ( debugLogFlushTimerInterval == Interval ) return;
+  if ( debugLogFlushTimer == NULL ) {
+    Status = gBS->CreateEvent(EVT_TIMER | EVT_NOTIFY_SIGNAL, TPL_CALLBACK, DebugLogFlushTimerNotify, NULL, &debugLogFlushTimer);
+    if ( EFI_ERROR(Status) ) {
+      debugLogFlushTimer = NULL;
+      return;
+    }
+  }
+  Status = gBS->SetTimer(debugLogFlushTimer, TimerPeriodic, MultU64x32(Interval, 10000)); // 100ns units
+  if ( !EFI_ERROR(Status) ) debugLogFlushTimerInterval = Interval;
+}
+
+static void cancelDebugLogFlushTimer()
+{
+  if ( debugLogFlushTimer == NULL || debugLogFlushTimerInterval == 0 ) return;
+  gBS->SetTimer(debugLogFlushTimer, TimerCancel, 0);
+  debugLogFlushTimerInterval = 0;
+}
+
+VOID SaveMessageToDebugLogFile(IN CHAR8 *LastMessage)
+{
+  if ( debugLogUnbuffered  ||  gSettings.Boot.DebugFlushInterval == 0 ) {
+    cancelDebugLogFlushTimer();
+    writeDebugLogPending();
+    // Not all Firmware implements Flush. So we have to close every time to force flush.
+    closeDebugLogFile();
+    return;
+  }
+  if ( debugLogFlushRequested  ||  GetMemLogLen() - debugLogWrittenOffset >= DEBUG_LOG_FLUSH_THRESHOLD ) {
+    flushDebugLogFile();
+  }
+  armDebugLogFlushTimer(gSettings.Boot.DebugFlushInterval);
+}
+
+void closeDebugLog()
+{
+  cancelDebugLogFlushTimer();
+  if ( gSettings.Boot.DebugLog ) {
+    SuspendMemLogCallback smc;
+    writeDebugLogPending();
+  }
+  closeDebugLogFile();
+}
+
+void unbufferDebugLog()
+{
+  debugLogUnbuffered = TRUE;
   closeDebugLog();
 }
 
+void bufferDebugLog()
+{
+  // the timer is armed again by the next message
+  debugLogUnbuffered = FALSE;
+}
+
 void EFIAPI MemLogCallback(IN INTN DebugMode, IN CHAR8 *LastMessage)
 {
   // Print message to console
@@ -250,7 +347,10 @@ void EFIAPI MemLogCallback(IN INTN DebugMode, IN CHAR8 *LastMessage)
   
   if ((DebugMode >= 1) && gSettings.Boot.DebugLog) {
     SuspendMemLogCallback smc;
+    BOOLEAN busy = debugLogBusy;
+    debugLogBusy = TRUE;
     SaveMessageToDebugLogFile(LastMessage);
+    debugLogBusy = busy;
   }
 }
 
@@ -269,10 +369,13 @@ void EFIAPI DebugLog(IN INTN DebugMode, IN CONST CHAR8 *FormatString, ...)
      return;
    }
 
-   // Print message to log buffer
+   // Print message to log buffer. MemLogBuffer may be reallocated : the flush timer must not read it.
+   BOOLEAN busy = debugLogBusy;
+   debugLogBusy = TRUE;
    VA_START(Marker, FormatString);
    MemLogfVA(TRUE, DebugMode, FormatString, Marker);
    VA_END(Marker);
+   debugLogBusy = busy;
 }
 
 void InitBooterLog(void)
@@ -352,7 +455,10 @@ void EFIAPI DebugLogForOC(IN INTN DebugLevel, IN CONST CHAR8 *FormatString, ...)
    if (FormatString == NULL ) return;
 
    // Print message to log buffer
+   BOOLEAN busy = debugLogBusy;
+   debugLogBusy = TRUE;
    VA_START(Marker, FormatString);
    MemLogVA(TRUE, 1, FormatString, Marker);
    VA_END(Marker);
+   debugLogBusy = busy;
 }
@@ -98,6 +98,14 @@ void closeDebugLog()
 {
 }
 
+void unbufferDebugLog()
+{
+}
+
+void bufferDebugLog()
+{
+}
+
 EFI_STATUS
 SaveBooterLog (
   const EFI_FILE* BaseDir  OPTIONAL,
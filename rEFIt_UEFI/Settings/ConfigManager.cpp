@@ -129,17 +129,9 @@ void ConfigManager::DiscoverDevices()
 
           switch (Pci.Hdr.VendorId) {
             case 0x1002: {
-              const radeon_card_info_t *info = NULL;
+              const radeon_card_info_t *info = radeon_card_info(Pci.Hdr.DeviceId);
               gfx->Vendor = Ati;
 
-              size_t i = 0;
-              do {
-                info      = &radeon_cards[i];
-                if (info->device_id == Pci.Hdr.DeviceId) {
-                  break;
-                }
-              } while (radeon_cards[i++].device_id != 0);
-
               gfx->Model.takeValueFrom(info->model_name);
               gfx->Config.takeValueFrom(card_configs[info->cfg_name].name);
               gfx->Ports                  = card_configs[info->cfg_name].ports;
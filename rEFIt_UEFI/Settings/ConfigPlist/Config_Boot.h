@@ -69,6 +69,7 @@ public:
   XmlStringW DefaultVolume = XmlStringW();
   XmlString8AllowEmpty DefaultLoader = XmlString8AllowEmpty();
   XmlBoolYesNo Debug = XmlBoolYesNo();
+  XmlUInt32 DebugFlushInterval = XmlUInt32();
   XmlBool FastBoot = XmlBool();
   XmlBool NoEarlyProgress = XmlBool();
   XmlBool NeverHibernate = XmlBool();
@@ -103,7 +104,7 @@ public:
     }
   } CustomLogo = CustomLogoUnion();
 
-  XmlDictField m_fields[23] = {
+  XmlDictField m_fields[24] = {
     {"Timeout", Timeout},
     {"SkipHibernateTimeout", SkipHibernateTimeout},
     {"DisableCloverHotkeys", DisableCloverHotkeys},
@@ -112,6 +113,7 @@ public:
     {"DefaultVolume", DefaultVolume},
     {"DefaultLoader", DefaultLoader},
     {"Debug", Debug},
+    {"DebugFlushInterval", DebugFlushInterval},
     {"Fast", FastBoot},
     {"NoEarlyProgress", NoEarlyProgress},
     {"NeverHibernate", NeverHibernate},
@@ -145,6 +147,7 @@ public:
   };
   const XString8&  dgetDefaultLoader() const { return DefaultLoader.isDefined() ? DefaultLoader.value() : NullXString8; };
   bool dgetDebugLog() const { return Debug.isDefined() ? Debug.value() : false; };
+  UINT32 dgetDebugFlushInterval() const { return DebugFlushInterval.isDefined() ? DebugFlushInterval.value() : 1000; }; // in ms. 0 means write every message immediately.
   bool dgetFastBoot() const { return FastBoot.isDefined() ? FastBoot.value() : false; };
   bool dgetNoEarlyProgress() const { return NoEarlyProgress.isDefined() ? NoEarlyProgress.value() : false; };
   bool dgetNeverHibernate() const { return NeverHibernate.isDefined() ? NeverHibernate.value() : false; };
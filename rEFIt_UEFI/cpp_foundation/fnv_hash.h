@@ -0,0 +1,39 @@
+/*
+ * fnv_hash.h
+ *
+ * FNV-1a, 32 and 64 bits, for the hash tables and the stamps of the files kept on the ESP.
+ * Chain the calls by giving the previous result as Hash. The steps for one byte are constexpr,
+ * for a hash of a literal computed by the compiler or a byte changed before it is hashed.
+ */
+
+#ifndef __fnv_hash_h__
+#define __fnv_hash_h__
+
+#include <stddef.h>
+#include <stdint.h>
+
+constexpr uint32_t Fnv1a32Seed = 2166136261U;
+constexpr uint64_t Fnv1a64Seed = 0xcbf29ce484222325ULL;
+
+constexpr uint32_t fnv1a32Byte(uint32_t Hash, uint8_t Byte) { return (Hash ^ Byte) * 16777619U; }
+constexpr uint64_t fnv1a64Byte(uint64_t Hash, uint8_t Byte) { return (Hash ^ Byte) * 0x100000001b3ULL; }
+
+inline uint32_t fnv1a32(const void* Buffer, size_t Size, uint32_t Hash = Fnv1a32Seed)
+{
+  const uint8_t* p = (const uint8_t*)Buffer;
+  for (size_t i = 0; i < Size; ++i) {
+    Hash = fnv1a32Byte(Hash, p[i]);
+  }
+  return Hash;
+}
+
+inline uint64_t fnv1a64(const void* Buffer, size_t Size, uint64_t Hash = Fnv1a64Seed)
+{
+  const uint8_t* p = (const uint8_t*)Buffer;
+  for (size_t i = 0; i < Size; ++i) {
+    Hash = fnv1a64Byte(Hash, p[i]);
+  }
+  return Hash;
+}
+
+#endif /* __fnv_hash_h__ */
@@ -38,12 +38,13 @@ XmlAbstractType& XmlDict::parseValueFromXmlLite(XmlLiteParser* xmlLiteParser, co
   if ( nb == 0 ) {
     panic("Dict '%s' has no field defined", xmlPath.c_str());
   }
+  uint32_t keyHash = strnHashIC(keyValue, keyValueLength);
   for ( size_t idx = 0 ; !*keyFound && idx < nb ; idx++ )
   {
     XmlDictField& xmlDictField = fields[idx];
     const char* fieldName = xmlDictField.m_name;
     XmlAbstractType& xmlAbstractType = xmlDictField.xmlAbstractType;
-    if ( strnIsEqualIC(keyValue, keyValueLength, fieldName) )
+    if ( xmlDictField.m_nameHash == keyHash  &&  strnIsEqualIC(keyValue, keyValueLength, fieldName) )
     {
 #ifdef DEBUG
 if ( xmlPath.containsIC("/ACPI/RenameDevices") ) {
@@ -89,7 +90,7 @@ if ( strcmp(fieldName, "AutoMerge") == 0 ) {
 }
 
 XmlAbstractType& XmlDict::parseKeyAndValueFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, bool generateErrors, const char** keyValuePtr,
-size_t* keyValueLengthPtr)
+size_t* keyValueLengthPtr, XString8* xmlSubPathPtr)
 {
   const char*& keyValue = *keyValuePtr;
   size_t& keyValueLength = *keyValueLengthPtr;
@@ -106,9 +107,11 @@ size_t* keyValueLengthPtr)
     xmlLiteParser->skipNextTag(generateErrors); // return value doesn't need to be tested, because skipNextTag() set xmlLiteParser::xmlParsingError to true.
     return nullXmlType;
   }
-  XString8 xmlSubPath = xmlPath;
-  if ( xmlPath.lastChar() == '/' ) xmlSubPath.S8Catf("%.*s", (int)keyValueLength, keyValue);
-  else xmlSubPath.S8Catf("/%.*s", (int)keyValueLength, keyValue);
+  // no formatting, and no allocation once the buffer is big enough
+  XString8& xmlSubPath = *xmlSubPathPtr;
+  xmlSubPath.strsicpy(xmlPath.data(), xmlPath.length());
+  if ( xmlPath.lastChar() != '/' ) xmlSubPath += '/';
+  xmlSubPath.strsicat(keyValue, keyValueLength);
 
 //#ifdef DEBUG
 //XmlParserPosition valuePos = xmlLiteParser->getPosition();
@@ -119,8 +122,7 @@ size_t* keyValueLengthPtr)
 
   if ( !keyFound ) {
     if ( keyValueLength == 0  ||  keyValue[0] != '#' ) {
-      XString8 xmlSubPath2 = xmlPath.lastChar() == '/' ? S8Printf("Unknown key '%s%.*s:%d'. Skipped.", xmlPath.c_str(), (int)keyValueLength, keyValue, keyPos.getLine()) : S8Printf("Unknown key '%s/%.*s:%d'. Skipped.", xmlPath.c_str(), (int)keyValueLength, keyValue, keyPos.getLine());
-      xmlLiteParser->addWarning(generateErrors, xmlSubPath2);
+      if ( generateErrors ) xmlLiteParser->addWarning(generateErrors, S8Printf("Unknown key '%s:%d'. Skipped.", xmlSubPath.c_str(), keyPos.getLine()));
     }
     xmlLiteParser->skipNextTag(generateErrors); // return value doesn't need to be tested, because skipNextTag() set xmlLiteParser::xmlParsingError to true.
   }
@@ -146,7 +148,7 @@ bool XmlDict::parseFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xml
 
 //  const char* keyValue;
 //  size_t keyValueLength;
-//  XString8 xmlSubPath;
+  XString8 xmlSubPath;
 
   while ( !xmlLiteParser->isEof() && !xmlLiteParser->nextTagIsClosingTag("dict") )
   {
@@ -167,7 +169,7 @@ XmlParserPosition valuePos = xmlLiteParser->getPosition();
     size_t keyValueLength;
     XmlParserPosition beforePos = xmlLiteParser->getPosition();
     
-    XmlAbstractType& xmlAbstractType = parseKeyAndValueFromXmlLite(xmlLiteParser, xmlPath, generateErrors, &keyValue, &keyValueLength);
+    XmlAbstractType& xmlAbstractType = parseKeyAndValueFromXmlLite(xmlLiteParser, xmlPath, generateErrors, &keyValue, &keyValueLength, &xmlSubPath);
 
 //    if ( xmlLiteParser->xmlParsingError ) {
 //      //return false;
@@ -176,7 +178,6 @@ XmlParserPosition valuePos = xmlLiteParser->getPosition();
 //    {
       if ( xmlAbstractType.isDefined() )
       {
-        XString8 xmlSubPath = xmlPath.lastChar() == '/' ? S8Printf("%s%.*s", xmlPath.c_str(), (int)keyValueLength, keyValue) : S8Printf("%s/%.*s", xmlPath.c_str(), (int)keyValueLength, keyValue);
         bool validated = xmlAbstractType.validate(xmlLiteParser, xmlSubPath, keyPos, generateErrors);
         if ( !validated ) xmlAbstractType.reset();
       }else{
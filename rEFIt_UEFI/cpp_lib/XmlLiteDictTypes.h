@@ -22,8 +22,9 @@ class XmlDictField
 {
 public:
   const char* m_name;
+  uint32_t m_nameHash; // strHashIC(m_name), compared before the name itself
   XmlAbstractType& xmlAbstractType;
-  XmlDictField(const char* name, XmlAbstractType& XmlAbstractType) : m_name(name), xmlAbstractType(XmlAbstractType) {};
+  constexpr XmlDictField(const char* name, XmlAbstractType& XmlAbstractType) : m_name(name), m_nameHash(strHashIC(name)), xmlAbstractType(XmlAbstractType) {};
 };
 
 class XmlDict : public XmlAbstractType
@@ -41,7 +42,8 @@ public:
   virtual bool isTheNextTag(XmlLiteParser* xmlLiteParser) override { return xmlLiteParser->nextTagIsOpeningTag("dict"); }
 
   virtual XmlAbstractType& parseValueFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, bool generateErrors, const XmlParserPosition &keyPos, const char *keyValue, size_t keyValueLength, bool* keyFound);
-  virtual XmlAbstractType& parseKeyAndValueFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, bool generateErrors, const char** keyValuePtr, size_t* keyValueLengthPtr);
+  // xmlSubPath is set to xmlPath/key. It's given by the caller, so its buffer is reused for all the keys of the dict.
+  virtual XmlAbstractType& parseKeyAndValueFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, bool generateErrors, const char** keyValuePtr, size_t* keyValueLengthPtr, XString8* xmlSubPath);
   virtual bool parseFromXmlLite(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, bool generateErrors) override;
 
   virtual bool validate(XmlLiteParser* xmlLiteParser, const XString8& xmlPath, const XmlParserPosition& keyPos, bool generateErrors) override;
@@ -42,6 +42,16 @@ bool strnIsEqualIC(const char* key, size_t keyLength, const char* value)
   return strnnIsEqualIC(key, keyLength, value, strlen(value));
 }
 
+// Same as strHashIC(), but a loop : a key read from a file can be long.
+uint32_t strnHashIC(const char* key, size_t keyLength)
+{
+  uint32_t hash = Fnv1a32Seed;
+  for ( size_t idx = 0 ; idx < keyLength  &&  key[idx] != 0 ; idx++ ) {
+    hash = fnv1a32Byte(hash, asciiLowerForHash(key[idx]));
+  }
+  return hash;
+}
+
 
 XmlParserPosition XmlLiteParser::getPosition()
 {
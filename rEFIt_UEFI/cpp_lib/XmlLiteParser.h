@@ -9,6 +9,7 @@
 #define __XML_LITE_H__
 
 #include "../cpp_foundation/XStringArray.h"
+#include "../cpp_foundation/fnv_hash.h"
 #include "../cpp_lib/XmlLiteSimpleTypes.h"
 #include "../cpp_lib/XmlLiteParser.h"
 
@@ -22,6 +23,14 @@ bool strnIsEqual(const char* key, size_t keyLength, const char* value);
 bool strnnIsEqualIC(const char* key, size_t keyLength, const char* value, size_t valueLength);
 bool strnIsEqualIC(const char* key, size_t keyLength, const char* value);
 
+/*
+ * FNV-1a hash ignoring ascii case, so two keys equal for strnIsEqualIC() have the same hash.
+ * strHashIC() is a recursive C++11 constexpr, for literals : the compiler can compute it.
+ */
+constexpr uint8_t asciiLowerForHash(char c) { return (uint8_t)(c >= 'A' && c <= 'Z' ? c + ('a' - 'A') : c); }
+constexpr uint32_t strHashIC(const char* s, uint32_t hash = Fnv1a32Seed) { return *s == 0 ? hash : strHashIC(s + 1, fnv1a32Byte(hash, asciiLowerForHash(*s))); }
+uint32_t strnHashIC(const char* key, size_t keyLength);
+
 class XmlParserMessage
 {
   public:
@@ -0,0 +1,39 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "CacheFile_test_common.h"
+
+UINT8* copyData(const XBuffer<UINT8>& File, size_t* Size, size_t Extra)
+{
+  *Size = File.size() + Extra;
+  UINT8* p = (UINT8*)malloc(*Size + 1); // never 0 bytes
+  memcpy(p, File.data(), File.size());
+  memset(p + File.size(), 0, Extra);
+  return p;
+}
+
+int rejectBrokenFiles(CacheFileLoader& Loader, const XBuffer<UINT8>& File, size_t TruncateStep,
+                      const CacheFileDamage* Damages, size_t NbDamages)
+{
+  size_t size;
+  UINT8* p;
+
+  // truncated anywhere
+  for ( size_t cut = 0 ; cut < File.size() ; cut += TruncateStep ) {
+    p = copyData(File, &size);
+    if ( Loader.load(p, cut) ) return 2;
+  }
+  // garbage at the end
+  p = copyData(File, &size, 1);
+  if ( Loader.load(p, size) ) return 3;
+  p = copyData(File, &size, 4);
+  if ( Loader.load(p, size) ) return 3;
+
+  for ( size_t i = 0 ; i < NbDamages ; ++i ) {
+    p = copyData(File, &size);
+    p[Damages[i].Offset] ^= Damages[i].Xor;
+    if ( Loader.load(p, size) ) return 10 + (int)i;
+  }
+
+  p = copyData(File, &size);
+  if ( !Loader.load(p, size) ) return 1;
+  return 0;
+}
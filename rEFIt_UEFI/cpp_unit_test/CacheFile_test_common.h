@@ -0,0 +1,41 @@
+/*
+ * CacheFile_test_common.h
+ *
+ * What the tests of the caches kept in a file on the ESP share : XThemeCache, SpdSnapshot and KextBundleCache.
+ * Each gives the file to save with getData(), and takes the file read at boot with load(), that frees it.
+ */
+
+#ifndef CPP_UNIT_TEST_CACHEFILE_TEST_COMMON_H_
+#define CPP_UNIT_TEST_CACHEFILE_TEST_COMMON_H_
+
+#include "../cpp_foundation/XBuffer.h"
+
+// The Size bytes of File then Extra bytes of 0, in a buffer allocated like the one egLoadFile() gives to load()
+UINT8* copyData(const XBuffer<UINT8>& File, size_t* Size, size_t Extra = 0);
+
+// load() of the cache tested, with what else it takes
+class CacheFileLoader
+{
+public:
+  virtual ~CacheFileLoader() {}
+  virtual bool load(UINT8* FileData, size_t FileSize) = 0;
+};
+
+// A byte of the file, and what to xor it with to break the file
+class CacheFileDamage
+{
+public:
+  size_t Offset;
+  UINT8  Xor;
+};
+
+/*
+ * Broken copies of File must not load : truncated every TruncateStep bytes, with one and four more bytes,
+ * or with one of the Damages. File itself must load, it is the last one given to Loader.
+ * Returns 0, or what was wrong : 1 File, 2 truncated, 3 longer, 10 + i Damages[i].
+ */
+int rejectBrokenFiles(CacheFileLoader& Loader, const XBuffer<UINT8>& File, size_t TruncateStep,
+                      const CacheFileDamage* Damages, size_t NbDamages);
+
+
+#endif /* CPP_UNIT_TEST_CACHEFILE_TEST_COMMON_H_ */
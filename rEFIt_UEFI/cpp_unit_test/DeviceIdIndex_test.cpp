@@ -0,0 +1,124 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "DeviceIdIndex_test.h"
+#include "../Platform/DeviceIdIndex.h"
+
+// Same layout as the nvidia tables : unsorted, with the same ids several times
+typedef struct {
+  UINT32 device;
+  UINT32 subdev;
+  const char* name;
+} test_card_t;
+
+static const test_card_t cards[] = {
+  { 0x10DE1C82, 0x00000000, "GeForce GTX 1050 Ti" },
+  { 0x10DE0040, 0x10438178, "Asus V9999 Ultra" },
+  { 0x10DE0040, 0x7FFFFFFF, "GeForce 6800 Ultra" },
+  { 0x10DE1C81, 0x00000000, "GeForce GTX 1050" },
+  { 0x10DE0040, 0x10438178, "Asus V9999 Ultra duplicate" },
+  { 0x10DE0041, 0x00000000, "GeForce 6800" },
+  { 0x10DE1C82, 0x14622000, "MSI GeForce GTX 1050 Ti" },
+  { 0x10DE0040, 0x00000000, "GeForce 6800 Ultra generic" },
+  { 0x10DE1C82, 0x00000000, "GeForce GTX 1050 Ti duplicate" },
+  { 0x10DE0045, 0x00000000, "GeForce 6800 GT" },
+};
+#define NB_CARDS (sizeof(cards) / sizeof(cards[0]))
+
+// what get_nvidia_model() did
+static size_t linearFind(UINT32 device, UINT32 subdev)
+{
+  for ( size_t i = 0 ; i < NB_CARDS ; ++i ) {
+    if ( cards[i].device == device && cards[i].subdev == subdev ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+// what init_card() did for the brothers family
+static size_t linearFindFamily(UINT32 device)
+{
+  for ( size_t i = 0 ; i < NB_CARDS ; ++i ) {
+    if ( (cards[i].device & ~0xf) == (device & ~0xf) ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static int tableTests()
+{
+  DeviceIdIndex index;
+  if ( index.isBuilt() || index.find(0) != MAX_XSIZE ) return 1;
+  for ( size_t i = 0 ; i < NB_CARDS ; ++i ) index.add(DeviceIdIndex::key(cards[i].device, cards[i].subdev), i);
+  if ( index.isBuilt() ) return 2;
+  index.sort();
+  if ( !index.isBuilt() || index.size() != NB_CARDS ) return 3;
+
+  // every entry gives the same name as the linear walk
+  for ( size_t i = 0 ; i < NB_CARDS ; ++i ) {
+    size_t found = index.find(DeviceIdIndex::key(cards[i].device, cards[i].subdev));
+    if ( found != linearFind(cards[i].device, cards[i].subdev) ) return 4;
+    if ( strcmp(cards[found].name, cards[linearFind(cards[i].device, cards[i].subdev)].name) != 0 ) return 5;
+  }
+  if ( strcmp(cards[index.find(DeviceIdIndex::key(0x10DE0040, 0x10438178))].name, "Asus V9999 Ultra") != 0 ) return 6;
+  if ( strcmp(cards[index.find(DeviceIdIndex::key(0x10DE1C82, 0))].name, "GeForce GTX 1050 Ti") != 0 ) return 7;
+
+  // not in the table, and near the ends
+  if ( index.find(DeviceIdIndex::key(0x10DE0040, 0x10438179)) != MAX_XSIZE ) return 8;
+  if ( index.find(DeviceIdIndex::key(0x10DE1C83, 0)) != MAX_XSIZE ) return 9;
+  if ( index.find(0) != MAX_XSIZE || index.find(MAX_UINT64 - 1) != MAX_XSIZE ) return 10;
+
+  index.setEmpty();
+  if ( index.isBuilt() || index.size() != 0 || index.find(DeviceIdIndex::key(0x10DE0041, 0)) != MAX_XSIZE ) return 11;
+  return 0;
+}
+
+static int rangeTests()
+{
+  // ids only, as the radeon and gma tables
+  DeviceIdIndex index;
+  for ( size_t i = 0 ; i < NB_CARDS ; ++i ) index.add(cards[i].device, i);
+  index.sort();
+  for ( UINT32 device = 0x10DE0000 ; device < 0x10DE2000 ; ++device ) {
+    if ( index.findInRange(device & ~0xf, (device & ~0xf) + 0x10) != linearFindFamily(device) ) return 20;
+  }
+  // the first in table order, not the smallest id : 0x10DE0040 is before 0x10DE0041 and 0x10DE0045 in the table
+  if ( index.findInRange(0x10DE0040, 0x10DE0050) != 1 ) return 21;
+  if ( index.findInRange(0x10DE0041, 0x10DE0050) != 5 ) return 22;
+  if ( index.findInRange(0x10DE1C80, 0x10DE1C90) != 0 ) return 23;
+  if ( index.findInRange(0x10DE0050, 0x10DE0040) != MAX_XSIZE ) return 24;
+  return 0;
+}
+
+static int randomTests()
+{
+  // a big table with many duplicates, added in table order
+  XArray<UINT32> ids;
+  UINT32 seed = 12345;
+  for ( size_t i = 0 ; i < 2000 ; ++i ) {
+    seed = seed * 1103515245 + 12345;
+    ids.Add(0x10020000 | ((seed >> 16) & 0x3FF));
+  }
+  DeviceIdIndex index;
+  for ( size_t i = 0 ; i < ids.size() ; ++i ) index.add(ids[i], i);
+  index.sort();
+  for ( UINT32 id = 0x10020000 ; id < 0x10020400 + 2 ; ++id ) {
+    size_t expected = MAX_XSIZE;
+    for ( size_t i = 0 ; i < ids.size() ; ++i ) {
+      if ( ids[i] == id ) {
+        expected = i;
+        break;
+      }
+    }
+    if ( index.find(id) != expected ) return 30;
+  }
+  return 0;
+}
+
+int DeviceIdIndex_tests()
+{
+  int ret;
+  ret = tableTests();
+  if ( ret != 0 ) return ret;
+  ret = rangeTests();
+  if ( ret != 0 ) return ret;
+  ret = randomTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int DeviceIdIndex_tests();
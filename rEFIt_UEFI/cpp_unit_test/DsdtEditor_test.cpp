@@ -0,0 +1,253 @@
+/*
+ * Only in Clover : the AML helpers of FixBiosDsdt.cpp are not in cpp_tests.
+ */
+#ifdef CLOVER_BUILD
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "DsdtEditor_test.h"
+#include "../Platform/DsdtEditor.h"
+#include "../Platform/FixBiosDsdt.h"
+#include "../Platform/AmlGenerator.h"
+
+#define HEADER_SIZE 36
+
+static UINT32 seed = 1;
+
+static UINT32 randomNumber(UINT32 max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % max;
+}
+
+static const char Find[] = "QZQZ";
+
+/*
+ * A table and, built along with it, what it must be once Find is replaced. Both get the same bytes,
+ * except for the occurrences and the package lengths.
+ */
+class AmlPair
+{
+public:
+  XBuffer<UINT8> Table = XBuffer<UINT8>();
+  XBuffer<UINT8> Expected = XBuffer<UINT8>();
+  bool           SizeFieldGrew = false; // a package length needs more bytes once patched
+
+  void cat(const void* Data, size_t Size) { Table.ncat(Data, Size); Expected.ncat(Data, Size); }
+  void cat(UINT8 Byte) { cat(&Byte, 1); }
+  void occurrence(const XBuffer<UINT8>& Replace) { Table.ncat(Find, 4); Expected.ncat(Replace.data(), Replace.size()); }
+  // No 'Q' : a random name can't end with the start of Find.
+  void name() { for ( int i = 0 ; i < 4 ; ++i ) cat((UINT8)('A' + randomNumber(16))); }
+};
+
+static UINT32 sizeFieldLen(size_t BodySize)
+{
+  UINT8 Field[4];
+  UINT32 FieldLen = aml_write_size((UINT32)BodySize + 1, (CHAR8*)Field, 0);
+  return aml_write_size((UINT32)BodySize + FieldLen, (CHAR8*)Field, 0);
+}
+
+static void package(XBuffer<UINT8>* Out, const XBuffer<UINT8>& Body)
+{
+  UINT8 Field[4];
+  UINT32 FieldLen = aml_write_size((UINT32)(Body.size() + sizeFieldLen(Body.size())), (CHAR8*)Field, 0);
+  Out->ncat(Field, FieldLen);
+  Out->ncat(Body.data(), Body.size());
+}
+
+// Opcode, then the package length of Body in each of the two tables
+static void addPackage(AmlPair* Out, const UINT8* Opcode, size_t OpcodeSize, const AmlPair& Body)
+{
+  Out->cat(Opcode, OpcodeSize);
+  package(&Out->Table, Body.Table);
+  package(&Out->Expected, Body.Expected);
+  Out->SizeFieldGrew |= Body.SizeFieldGrew || sizeFieldLen(Body.Table.size()) != sizeFieldLen(Body.Expected.size());
+}
+
+/*
+ * Scopes, Devices and Methods, with Name() and Store() in between. As CorrectOuters() wouldn't see a Scope in a Device,
+ * there is none, and no object in a Method, as CorrectOuterMethod() handles only the nearest one.
+ */
+static void randomObjects(AmlPair* Out, const XBuffer<UINT8>& Replace, int Depth, UINT32 Budget, bool InDevice, bool InMethod)
+{
+  static const UINT8 Scope[] = { 0x10 };
+  static const UINT8 Device[] = { 0x5B, 0x82 };
+  static const UINT8 Method[] = { 0x14 };
+  UINT32 NbObjects = 1 + randomNumber(Budget);
+  for ( UINT32 i = 0 ; i < NbObjects ; ++i ) {
+    UINT32 r = randomNumber(10);
+    if ( Depth < 4 && r < 3 && !InMethod ) {
+      UINT32 Kind = randomNumber(3);
+      if ( Kind == 0 && InDevice ) Kind = 2;
+      AmlPair Body;
+      Body.name();
+      if ( Kind == 2 ) Body.cat((UINT8)randomNumber(8)); // method flags
+      randomObjects(&Body, Replace, Depth + 1, Budget, InDevice || Kind == 1, Kind == 2);
+      if ( Kind == 0 ) addPackage(Out, Scope, sizeof(Scope), Body);
+      else if ( Kind == 1 ) addPackage(Out, Device, sizeof(Device), Body);
+      else addPackage(Out, Method, sizeof(Method), Body);
+    } else if ( r < 6 ) {
+      // Name (XXXX, 0x0n)
+      Out->cat(0x08);
+      if ( randomNumber(3) == 0 ) Out->occurrence(Replace);
+      else Out->name();
+      Out->cat(0x0A);
+      Out->cat((UINT8)(1 + randomNumber(9)));
+    } else {
+      // Store ("...", ...)
+      Out->cat(0x70);
+      UINT32 Length = randomNumber(40);
+      for ( UINT32 j = 0 ; j < Length ; ++j ) Out->cat((UINT8)('A' + randomNumber(16)));
+      if ( randomNumber(2) ) Out->occurrence(Replace);
+    }
+  }
+}
+
+// Header, Scope (_SB_) { Body }, Name (ABCD, One)
+static void table(AmlPair* Out, const AmlPair& Body)
+{
+  static const UINT8 Scope[] = { 0x10 };
+  AmlPair SB;
+  SB.cat("_SB_", 4);
+  SB.Table.ncat(Body.Table.data(), Body.Table.size());
+  SB.Expected.ncat(Body.Expected.data(), Body.Expected.size());
+  SB.SizeFieldGrew = Body.SizeFieldGrew;
+  for ( size_t i = 0 ; i < HEADER_SIZE ; ++i ) Out->cat('a');
+  addPackage(Out, Scope, sizeof(Scope), SB);
+  Out->cat("\x08" "ABCD" "\x0A" "\x01", 7);
+}
+
+/*
+ * What FixAny() did before DsdtEditor : move the end of the table for each occurrence, then walk back to correct
+ * the sizes of the Method and the Devices and Scopes around it.
+ */
+static UINT32 FixAny_OLD(UINT8* dsdt, UINT32 len, const XBuffer<UINT8>& ToFind, const XBuffer<UINT8>& ToReplace)
+{
+  INT32 adr;
+  INT32 sizeoffset = (INT32)ToReplace.size() - (INT32)ToFind.size();
+  for ( UINT32 i = 20 ; i < len ; ) {
+    adr = FindBin(dsdt + i, len - i, ToFind);
+    if ( adr < 0 ) break;
+    len = move_data(adr + i, dsdt, len, sizeoffset);
+    memcpy(dsdt + adr + i, ToReplace.data(), ToReplace.size());
+    len = CorrectOuterMethod(dsdt, len, adr + i - 2, sizeoffset);
+    len = CorrectOuters(dsdt, len, adr + i - 3, sizeoffset);
+    i += (UINT32)(adr + ToReplace.size());
+  }
+  return len;
+}
+
+static UINT32 replaceAll(const XBuffer<UINT8>& Table, UINT8* Buffer, const XBuffer<UINT8>& ToFind, const XBuffer<UINT8>& ToReplace)
+{
+  memcpy(Buffer, Table.data(), Table.size());
+  DsdtEditor Editor(Buffer, (UINT32)Table.size());
+  Editor.findAll(ToFind);
+  return Editor.replaceAll(ToFind, ToReplace);
+}
+
+static bool isExpected(const UINT8* Buffer, UINT32 Len, const XBuffer<UINT8>& Expected)
+{
+  return Len == Expected.size() && memcmp(Buffer, Expected.data(), Len) == 0;
+}
+
+/*
+ * Each tree is checked against the table built with it. Where no package length changes its size, the old path
+ * gives that table too, so it is not wrong the same way as DsdtEditor. Except for the few trees where the old walk
+ * takes a byte of a package length for a Scope.
+ */
+static int randomTests()
+{
+  size_t NbOld = 0;
+  size_t NbOldExpected = 0;
+  XBuffer<UINT8> ToFind;
+  ToFind.ncat(Find, 4);
+  for ( int round = 0 ; round < 400 ; ++round ) {
+    // longer, the package lengths of the objects around need more bytes
+    XBuffer<UINT8> ToReplace;
+    ToReplace.ncat(Find, 4);
+    UINT32 Extra = randomNumber(round % 5 == 0 ? 300 : 20);
+    for ( UINT32 j = 0 ; j < Extra ; ++j ) ToReplace.cat((UINT8)('a' + randomNumber(26)));
+
+    AmlPair Body;
+    randomObjects(&Body, ToReplace, 0, round % 3 == 0 ? 6 : 3, false, false);
+    AmlPair Tree;
+    table(&Tree, Body);
+
+    size_t BufferSize = Tree.Expected.size() * 2 + 1024;
+    UINT8* Buffer = (UINT8*)malloc(BufferSize);
+    UINT8* Old = (UINT8*)malloc(BufferSize);
+    UINT32 Len = replaceAll(Tree.Table, Buffer, ToFind, ToReplace);
+    memcpy(Old, Tree.Table.data(), Tree.Table.size());
+    UINT32 OldLen = FixAny_OLD(Old, (UINT32)Tree.Table.size(), ToFind, ToReplace);
+    bool ok = isExpected(Buffer, Len, Tree.Expected);
+    if ( !Tree.SizeFieldGrew ) {
+      NbOld++;
+      if ( isExpected(Old, OldLen, Tree.Expected) ) NbOldExpected++;
+    }
+    free(Buffer);
+    free(Old);
+    if ( !ok ) return 1;
+  }
+  if ( NbOld < 200 ) return 2;
+  if ( NbOldExpected * 20 < NbOld * 19 ) return 3;
+  return 0;
+}
+
+/*
+ * A byte of a package length is also an opcode : Scope (ABCD) with a length of 0x10, or 0x10n on two bytes.
+ * The 0x10 is not a Scope, whether the length after it would go past the end of the table or not.
+ */
+static int sizeFieldTests()
+{
+  static const UINT8 Scope[] = { 0x10 };
+  static const char* Names[] = { "_SB_", "AAAA", "KHCD", "GKPG" };
+  XBuffer<UINT8> ToFind;
+  ToFind.ncat(Find, 4);
+  XBuffer<UINT8> ToReplace;
+  ToReplace.ncat("QZQZzzx", 7);
+
+  for ( size_t n = 0 ; n < sizeof(Names) / sizeof(Names[0]) ; ++n ) {
+    for ( UINT32 Length = 0 ; Length < 300 ; ++Length ) {
+      // Scope (Name) { Name (QZQZ, 1) Store ("AAA...") }, its package length goes from 0x0A to 0x13B
+      AmlPair Inner;
+      Inner.cat(Names[n], 4);
+      Inner.cat(0x08);
+      Inner.occurrence(ToReplace);
+      Inner.cat("\x0A\x01", 2);
+      Inner.cat(0x70);
+      for ( UINT32 j = 0 ; j < Length ; ++j ) Inner.cat('A');
+      AmlPair Body;
+      addPackage(&Body, Scope, sizeof(Scope), Inner);
+      // then enough after it for a length read in the name to end in the table
+      for ( int j = 0 ; j < 20 ; ++j ) {
+        Body.cat(0x08);
+        Body.occurrence(ToReplace);
+        Body.cat(0x0A);
+        Body.cat((UINT8)j);
+        Body.cat(0x70);
+        for ( int k = 0 ; k < 60 ; ++k ) Body.cat('B');
+      }
+      AmlPair Tree;
+      table(&Tree, Body);
+
+      UINT8* Buffer = (UINT8*)malloc(Tree.Expected.size() + 1024);
+      UINT32 Len = replaceAll(Tree.Table, Buffer, ToFind, ToReplace);
+      bool ok = isExpected(Buffer, Len, Tree.Expected);
+      free(Buffer);
+      if ( !ok ) return 10 + (int)n;
+    }
+  }
+  return 0;
+}
+
+int DsdtEditor_tests()
+{
+  int ret;
+
+  ret = randomTests();
+  if ( ret != 0 ) return ret;
+  ret = sizeFieldTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
+
+#endif // CLOVER_BUILD
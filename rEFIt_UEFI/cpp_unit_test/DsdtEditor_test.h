@@ -0,0 +1 @@
+int DsdtEditor_tests();
@@ -0,0 +1,138 @@
+/*
+ * Only in Clover : the tables and their lookups are in nvidia.cpp, ati.cpp and gma.cpp, not in cpp_tests.
+ */
+#ifdef CLOVER_BUILD
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "GpuCardTables_test.h"
+#include "../Platform/nvidia.h"
+#include "../Platform/ati.h"
+#include "../Platform/gma.h"
+
+// The walks the indexes replaced : get_nvidia_model(), init_card(), ConfigManager::DiscoverDevices() and get_gma_model()
+
+static size_t linearNvidiaException(UINT32 device_id, UINT32 subsys_id)
+{
+  for ( size_t i = 0 ; i < nvidia_card_exceptions_count ; ++i ) {
+    if ( nvidia_card_exceptions[i].device == device_id && nvidia_card_exceptions[i].subdev == subsys_id ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static size_t linearNvidiaGeneric(UINT32 device_id)
+{
+  for ( size_t i = 1 ; i < nvidia_card_generic_count ; ++i ) {
+    if ( nvidia_card_generic[i].device == device_id ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static size_t linearNvidiaVendor(UINT32 subsys_id)
+{
+  for ( size_t i = 0 ; i < nvidia_card_vendors_count ; ++i ) {
+    if ( nvidia_card_vendors[i].device == (subsys_id & 0xffff0000) ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static size_t linearRadeon(UINT16 device_id)
+{
+  for ( size_t i = 0 ; radeon_cards[i].device_id ; ++i ) {
+    if ( radeon_cards[i].device_id == device_id ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static size_t linearRadeonFamily(UINT16 device_id)
+{
+  for ( size_t i = 0 ; radeon_cards[i].device_id ; ++i ) {
+    if ( (radeon_cards[i].device_id & ~0xf) == (device_id & ~0xf) ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+// stops on the "AMD Unknown" entry if device_id is not found
+static size_t linearRadeonInfo(UINT16 device_id)
+{
+  size_t i = 0;
+  size_t found;
+  do {
+    found = i;
+    if ( radeon_cards[i].device_id == device_id ) break;
+  } while ( radeon_cards[i++].device_id != 0 );
+  return found;
+}
+
+static size_t linearGma(UINT16 id)
+{
+  for ( size_t i = 0 ; i < KnownGPUS_count ; ++i ) {
+    if ( KnownGPUS[i].device == id ) return i;
+  }
+  return MAX_XSIZE;
+}
+
+static int nvidiaTests()
+{
+  for ( size_t i = 0 ; i < nvidia_card_exceptions_count ; ++i ) {
+    UINT32 device_id = nvidia_card_exceptions[i].device;
+    UINT32 subsys_id = nvidia_card_exceptions[i].subdev;
+    if ( find_nvidia_card_exception(device_id, subsys_id) != linearNvidiaException(device_id, subsys_id) ) return 1;
+    if ( find_nvidia_card_exception(device_id, subsys_id + 1) != linearNvidiaException(device_id, subsys_id + 1) ) return 2;
+    if ( find_nvidia_card_generic(device_id) != linearNvidiaGeneric(device_id) ) return 3;
+    if ( find_nvidia_card_vendor(subsys_id) != linearNvidiaVendor(subsys_id) ) return 4;
+  }
+  for ( size_t i = 0 ; i < nvidia_card_generic_count ; ++i ) {
+    UINT32 device_id = nvidia_card_generic[i].device;
+    if ( find_nvidia_card_generic(device_id) != linearNvidiaGeneric(device_id) ) return 5;
+  }
+  // every nvidia device id, the 0x10DE0000 of "Unknown" too
+  for ( UINT32 device_id = 0x10DE0000 ; device_id <= 0x10DEFFFF ; ++device_id ) {
+    if ( find_nvidia_card_generic(device_id) != linearNvidiaGeneric(device_id) ) return 6;
+  }
+  for ( size_t i = 0 ; i < nvidia_card_vendors_count ; ++i ) {
+    UINT32 subsys_id = nvidia_card_vendors[i].device | 0x1234;
+    if ( find_nvidia_card_vendor(subsys_id) != linearNvidiaVendor(subsys_id) || find_nvidia_card_vendor(subsys_id) == MAX_XSIZE ) return 7;
+  }
+  if ( find_nvidia_card_vendor(0xFFFF1234) != MAX_XSIZE ) return 8; // no vendor 0xFFFF
+  return 0;
+}
+
+static int radeonTests()
+{
+  // the last entry ends the table
+  if ( radeon_cards[radeon_cards_count - 1].device_id != 0 ) return 20;
+  for ( size_t i = 0 ; i < radeon_cards_count - 1 ; ++i ) {
+    if ( radeon_cards[i].device_id == 0 ) return 21;
+  }
+  // every entry and every family, 0 that ends the table too
+  for ( UINT32 id = 0 ; id <= 0xFFFF ; ++id ) {
+    UINT16 device_id = (UINT16)id;
+    if ( find_radeon_card(device_id) != linearRadeon(device_id) ) return 22;
+    if ( find_radeon_card_family(device_id) != linearRadeonFamily(device_id) ) return 23;
+    if ( radeon_card_info(device_id) != &radeon_cards[linearRadeonInfo(device_id)] ) return 24;
+  }
+  return 0;
+}
+
+static int gmaTests()
+{
+  for ( UINT32 id = 0 ; id <= 0xFFFF ; ++id ) {
+    if ( find_gma_gpu((UINT16)id) != linearGma((UINT16)id) ) return 30;
+  }
+  if ( find_gma_gpu(0xFFFF) != 0 ) return 31;
+  return 0;
+}
+
+int GpuCardTables_tests()
+{
+  int ret;
+  ret = nvidiaTests();
+  if ( ret != 0 ) return ret;
+  ret = radeonTests();
+  if ( ret != 0 ) return ret;
+  ret = gmaTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
+
+#endif // CLOVER_BUILD
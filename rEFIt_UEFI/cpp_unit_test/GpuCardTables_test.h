@@ -0,0 +1 @@
+int GpuCardTables_tests();
@@ -0,0 +1,119 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "KextBundleCache_test.h"
+#include "CacheFile_test_common.h"
+#include "../Platform/KextBundleCache.h"
+
+static KextBundleInfo makeInfo(const char* version, const char* executable, bool noContents)
+{
+  KextBundleInfo info;
+  info.Version.takeValueFrom(version);
+  info.Executable.takeValueFrom(executable);
+  info.NoContents = noContents;
+  return info;
+}
+
+static bool sameInfo(const KextBundleInfo& info, const char* version, const char* executable, bool noContents)
+{
+  return info.Version == XString8().takeValueFrom(version) && info.Executable == XString8().takeValueFrom(executable) && info.NoContents == noContents;
+}
+
+// Nothing must be found in a file that didn't load
+class BundleCacheLoader : public CacheFileLoader
+{
+public:
+  KextBundleCache& Cache;
+  BundleCacheLoader(KextBundleCache& cache) : Cache(cache) {}
+  virtual bool load(UINT8* FileData, size_t FileSize) {
+    KextBundleInfo info;
+    return Cache.load(FileData, FileSize) || Cache.find("kexts\\Other\\Lilu.kext"_XS8, 1, &info);
+  }
+};
+
+static void fill(KextBundleCache& cache)
+{
+  cache.add("kexts\\Other\\Lilu.kext"_XS8, 1, makeInfo("1.5.0", "Lilu", false));
+  cache.add("kexts\\Other\\VoodooPS2Controller.kext\\Contents\\PlugIns\\VoodooPS2Keyboard.kext"_XS8, 2, makeInfo("2.2.1", "VoodooPS2Keyboard", false));
+  cache.add("kexts\\Other\\Codeless.kext"_XS8, 3, makeInfo("", "", true)); // no executable, planar
+  cache.add("kexts\\Other\\Lilu.kext"_XS8, 4, makeInfo("9", "Other", true)); // already there, ignored
+}
+
+static int roundTripTests()
+{
+  KextBundleCache cache;
+  KextBundleInfo info;
+
+  // no file yet : even without kexts, an empty one is saved
+  if ( cache.load(NULL, 0) || !cache.isOpen() || !cache.isModified() || cache.getNbBundles() != 0 ) return 1;
+  if ( cache.find("kexts\\Other\\Lilu.kext"_XS8, 1, &info) ) return 2;
+  size_t size;
+  UINT8* file = copyData(cache.getData(), &size);
+  if ( !cache.load(file, size) || cache.isModified() ) return 2;
+  fill(cache);
+  if ( !cache.isModified() || cache.getNbBundles() != 3 ) return 3;
+
+  file = copyData(cache.getData(), &size);
+  if ( !cache.load(file, size) || cache.getNbBundles() != 0 ) return 4;
+
+  // same stamp : found, and kept for the next file
+  if ( !cache.find("kexts\\Other\\VoodooPS2Controller.kext\\Contents\\PlugIns\\VoodooPS2Keyboard.kext"_XS8, 2, &info) ) return 5;
+  if ( !sameInfo(info, "2.2.1", "VoodooPS2Keyboard", false) ) return 6;
+  if ( !cache.find("kexts\\Other\\Codeless.kext"_XS8, 3, &info) || !sameInfo(info, "", "", true) ) return 7;
+  if ( cache.getNbBundles() != 2 ) return 8;
+
+  // the Info.plist changed, not in the file, or not a full path
+  if ( cache.find("kexts\\Other\\Lilu.kext"_XS8, 5, &info) ) return 9;
+  if ( cache.find("kexts\\Other\\AppleALC.kext"_XS8, 1, &info) ) return 10;
+  if ( cache.find("kexts\\Other\\Lilu.kex"_XS8, 1, &info) ) return 11;
+
+  // Lilu was updated and is added again, in another order than the file : it must be saved
+  cache.add("kexts\\Other\\Lilu.kext"_XS8, 5, makeInfo("1.5.1", "Lilu", false));
+  if ( !cache.isModified() || cache.getNbBundles() != 3 ) return 12;
+
+  // the same bundles in the same order give the same file
+  file = copyData(cache.getData(), &size);
+  cache.load(file, size);
+  cache.find("kexts\\Other\\VoodooPS2Controller.kext\\Contents\\PlugIns\\VoodooPS2Keyboard.kext"_XS8, 2, &info);
+  cache.find("kexts\\Other\\Codeless.kext"_XS8, 3, &info);
+  if ( !cache.find("kexts\\Other\\Lilu.kext"_XS8, 5, &info) || !sameInfo(info, "1.5.1", "Lilu", false) ) return 13;
+  if ( cache.isModified() ) return 14;
+
+  // a kext removed : the file shrinks
+  file = copyData(cache.getData(), &size);
+  cache.load(file, size);
+  cache.find("kexts\\Other\\Lilu.kext"_XS8, 5, &info);
+  if ( !cache.isModified() || cache.getNbBundles() != 1 ) return 15;
+
+  cache.setEmpty();
+  if ( cache.isOpen() || cache.isModified() ) return 16;
+  return 0;
+}
+
+static int badFileTests()
+{
+  KextBundleCache cache;
+  KextBundleInfo info;
+  cache.load(NULL, 0);
+  fill(cache);
+  XBuffer<UINT8> good;
+  good.ncat(cache.getData().data(), cache.getData().size());
+
+  // every truncation, one more byte, a wrong magic, version, count, string length or missing terminator
+  static const CacheFileDamage Damages[] = { {0, 0x41}, {8, 0x41}, {12, 0x41}, {16 + 12, 0x41}, {16 + 16, 0x41}, {16 + 24 + 21, 0x41} };
+  BundleCacheLoader loader(cache);
+  int ret = rejectBrokenFiles(loader, good, 1, Damages, sizeof(Damages) / sizeof(Damages[0]));
+  if ( ret != 0 ) return 20 + ret;
+  // the file itself
+  if ( !cache.find("kexts\\Other\\Lilu.kext"_XS8, 1, &info) ) return 19;
+  cache.setEmpty();
+  return 0;
+}
+
+int KextBundleCache_tests()
+{
+  int ret;
+  ret = roundTripTests();
+  if ( ret != 0 ) return ret;
+  ret = badFileTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
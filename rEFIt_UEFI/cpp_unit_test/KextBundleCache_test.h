@@ -0,0 +1 @@
+int KextBundleCache_tests();
@@ -0,0 +1,90 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "../Platform/KextPatchIndex.h"
+
+/*
+ * The loop that was used by PatchKext before the index.
+ */
+static void findPatches_OLD(const XString8Array& Names, const char* BundleIdentifier, XArray<size_t>* PatchIndexes)
+{
+  PatchIndexes->setEmpty();
+  for (size_t i = 0; i < Names.size(); i++) {
+    BOOLEAN isBundle = Names[i].contains(".");
+    if ( isBundle ? (strcmp(BundleIdentifier, Names[i].c_str()) == 0) : (strstr(BundleIdentifier, Names[i].c_str()) != NULL) ) {
+      PatchIndexes->Add(i);
+    }
+  }
+}
+
+static bool isSame(const XArray<size_t>& a1, const XArray<size_t>& a2)
+{
+  if ( a1.size() != a2.size() ) return false;
+  for ( size_t idx = 0 ; idx < a1.size() ; ++idx ) {
+    if ( a1[idx] != a2[idx] ) return false;
+  }
+  return true;
+}
+
+static const char* const patchNames[] = {
+  "com.apple.iokit.IOGraphicsFamily",
+  "AppleHDA",
+  "com.apple.driver.AppleHDA",
+  "com.apple.iokit.IOGraphicsFamily",
+  "IOAHCIBlockStorage",
+  "com.apple.driver.AppleHDAController",
+  "HDA",
+  "com.apple.iokit.IOGraphicsFamily",
+  "com.apple.driver.AppleHDA",
+};
+
+static const char* const bundleIdentifiers[] = {
+  "com.apple.iokit.IOGraphicsFamily",
+  "com.apple.driver.AppleHDA",
+  "com.apple.driver.AppleHDAController",
+  "com.apple.iokit.IOAHCIBlockStorage",
+  "com.apple.driver.AppleHD",
+  "com.apple.iokit.IOGraphicsFamily2",
+  "",
+};
+
+int KextPatchIndex_tests()
+{
+  XString8Array names;
+  KextPatchIndex index;
+  XArray<size_t> found;
+  XArray<size_t> expected;
+
+  // empty index
+  index.find("com.apple.driver.AppleHDA", &found);
+  if ( found.size() != 0 ) return 1;
+
+  // Add enough names to make the hash table grow a few times.
+  for ( size_t round = 0 ; round < 10 ; ++round ) {
+    for ( size_t idx = 0 ; idx < sizeof(patchNames)/sizeof(patchNames[0]) ; ++idx ) {
+      XString8 name;
+      if ( round % 2 == 0 ) name.takeValueFrom(patchNames[idx]);
+      else name.S8Printf("%s%zu", patchNames[idx], round);
+      names.Add(name);
+      index.add(name);
+    }
+    if ( index.size() != names.size() ) return 2;
+
+    for ( size_t idx = 0 ; idx < sizeof(bundleIdentifiers)/sizeof(bundleIdentifiers[0]) ; ++idx ) {
+      index.find(bundleIdentifiers[idx], &found);
+      findPatches_OLD(names, bundleIdentifiers[idx], &expected);
+      if ( !isSame(found, expected) ) return 10 + (int)idx;
+    }
+    for ( size_t idx = 0 ; idx < names.size() ; ++idx ) {
+      index.find(names[idx].c_str(), &found);
+      findPatches_OLD(names, names[idx].c_str(), &expected);
+      if ( !isSame(found, expected) ) return 30;
+    }
+  }
+
+  // order : com.apple.driver.AppleHDA is 1 (partial), 2, 6 (partial) and 8
+  index.setEmpty();
+  for ( size_t idx = 0 ; idx < sizeof(patchNames)/sizeof(patchNames[0]) ; ++idx ) index.add(XString8().takeValueFrom(patchNames[idx]));
+  index.find("com.apple.driver.AppleHDA", &found);
+  if ( found.size() != 4 || found[0] != 1 || found[1] != 2 || found[2] != 6 || found[3] != 8 ) return 40;
+
+  return 0;
+}
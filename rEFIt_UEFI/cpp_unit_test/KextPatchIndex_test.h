@@ -0,0 +1 @@
+int KextPatchIndex_tests();
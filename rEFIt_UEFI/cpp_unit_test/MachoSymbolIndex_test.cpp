@@ -0,0 +1,129 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include <UefiLoader.h>
+#include "../Platform/MachoSymbolIndex.h"
+
+/*
+ * The scan that was used by searchProcInDriver before the index.
+ */
+static size_t searchProcInDriver_OLD(const struct nlist_64* vArray, UINT32 lSizeVtable, const char* Names, const XString8& procedure)
+{
+  for (UINT32 i = 0; i < lSizeVtable; ++i) {
+    UINT32 Offset = vArray[i].n_un.n_strx;
+    if (strstr(&Names[Offset], procedure.c_str())) {
+      return i;
+    }
+  }
+  return MAX_XSIZE;
+}
+
+/*
+ * A minimal Mach-O : header, one LC_SYMTAB, the nlist_64 array and the string table.
+ */
+static void buildMacho(XBuffer<UINT8>* macho, const char* const* symbolNames, size_t nbSymbols)
+{
+  XBuffer<UINT8> strtab;
+  XArray<UINT32> strx;
+  strtab.ncat("\0", 1); // n_strx 0 is the empty name
+  for ( size_t idx = 0 ; idx < nbSymbols ; ++idx ) {
+    strx.Add((UINT32)strtab.size());
+    strtab.ncat(symbolNames[idx], strlen(symbolNames[idx]) + 1);
+  }
+
+  struct mach_header_64 header;
+  memset(&header, 0, sizeof(header));
+  header.magic = MH_MAGIC_64;
+  header.filetype = MH_KEXT_BUNDLE;
+  header.ncmds = 1;
+  header.sizeofcmds = sizeof(struct symtab_command);
+
+  struct symtab_command symtab;
+  symtab.cmd = LC_SYMTAB;
+  symtab.cmdsize = sizeof(struct symtab_command);
+  symtab.symoff = sizeof(struct mach_header_64) + sizeof(struct symtab_command);
+  symtab.nsyms = (UINT32)nbSymbols;
+  symtab.stroff = symtab.symoff + (UINT32)(nbSymbols * sizeof(struct nlist_64));
+  symtab.strsize = (UINT32)strtab.size();
+
+  macho->setEmpty();
+  macho->ncat(&header, sizeof(header));
+  macho->ncat(&symtab, sizeof(symtab));
+  for ( size_t idx = 0 ; idx < nbSymbols ; ++idx ) {
+    struct nlist_64 nlist;
+    memset(&nlist, 0, sizeof(nlist));
+    nlist.n_un.n_strx = strx[idx];
+    nlist.n_type = N_SECT | N_EXT;
+    nlist.n_sect = 1;
+    nlist.n_value = 0x1000 + idx * 0x10;
+    macho->ncat(&nlist, sizeof(nlist));
+  }
+  macho->ncat(strtab.data(), strtab.size());
+}
+
+int MachoSymbolIndex_tests()
+{
+  static const char* const symbolNames[] = {
+    "__ZN11IOPCIDevice9configReadEj",
+    "_xcpm_init_local",
+    "_xcpm_init",
+    "_xcpm_idle",
+    "__xcpm_core_scope_msrs",
+    "_xcpm_SMT_scope_msrs",
+    "_cpuid_features",
+    "_cpuid_set_info",
+    "_lapic_interrupt",
+    "_panic",
+    "_panic",
+    "_initFB",
+    "_gIOFBVerboseBoot",
+    "__ZN10AppleRTC14updateChecksumEv",
+    "_my_panic_handler",
+    "radr://5614542",
+  };
+  size_t nbSymbols = sizeof(symbolNames) / sizeof(symbolNames[0]);
+
+  XBuffer<UINT8> macho;
+  buildMacho(&macho, symbolNames, nbSymbols);
+  const struct symtab_command* symtab = (const struct symtab_command*)(macho.data() + sizeof(struct mach_header_64));
+  const struct nlist_64* vArray = (const struct nlist_64*)(macho.data() + symtab->symoff);
+  const char* Names = (const char*)(macho.data() + symtab->stroff);
+
+  MachoSymbolIndex index;
+  if ( index.isBuiltFor(vArray, Names, nbSymbols) ) return 1;
+  index.build(vArray, Names, &vArray[0].n_un.n_strx, sizeof(struct nlist_64), symtab->nsyms);
+  if ( !index.isBuiltFor(vArray, Names, nbSymbols) ) return 2;
+  if ( index.size() != nbSymbols ) return 3;
+
+  static const char* const queries[] = {
+    "xcpm_idle", "_xcpm_idle", "xcpm_core_scope_msrs", "_xcpm_SMT_scope_msrs", "cpuid_features", "_cpuid_set_info",
+    "lapic_interrupt", "initFB", "gIOFBVerboseBoot", "updateChecksum", "configRead", "IOPCIDevice", "xcpm_init_local",
+    "cpuid", "SMT_scope", "radr://5614542", "_radr", "does_not_exist", "__xcpm_idle", "___ZN11IOPCIDevice",
+    // ambiguous : the first symbol containing the name, not the exact one
+    "xcpm_init", "_xcpm_init", "panic", "_panic", "xcpm_in", "my_panic", "init", "_",
+  };
+  for ( size_t q = 0 ; q < sizeof(queries) / sizeof(queries[0]) ; ++q ) {
+    XString8 procedure;
+    procedure.takeValueFrom(queries[q]);
+    if ( index.find(procedure) != searchProcInDriver_OLD(vArray, symtab->nsyms, Names, procedure) ) return 10 + (int)q;
+  }
+  if ( index.find("xcpm_init"_XS8) != 1 ) return 40;
+  if ( index.find("panic"_XS8) != 9 ) return 41;
+
+  // Every part of every name
+  for ( size_t idx = 0 ; idx < nbSymbols ; ++idx ) {
+    size_t len = strlen(symbolNames[idx]);
+    for ( size_t start = 0 ; start < len ; ++start ) {
+      for ( size_t end = start + 1 ; end <= len ; ++end ) {
+        XString8 procedure;
+        procedure.strncpy(symbolNames[idx] + start, end - start);
+        size_t found = index.find(procedure);
+        if ( found != searchProcInDriver_OLD(vArray, symtab->nsyms, Names, procedure) ) return 50;
+        if ( found > idx ) return 51;
+      }
+    }
+  }
+
+  index.setEmpty();
+  if ( index.find("panic"_XS8) != MAX_XSIZE ) return 110;
+
+  return 0;
+}
@@ -0,0 +1 @@
+int MachoSymbolIndex_tests();
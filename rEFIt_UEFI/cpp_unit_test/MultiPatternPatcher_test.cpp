@@ -0,0 +1,195 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "MultiPatternPatcher_test.h"
+#include "../Platform/MultiPatternPatcher.h"
+#include "../Platform/MemoryOperation.h"
+
+#define NB_PATCHES 12
+#define MAX_FIND_SIZE 6
+#define BUFFER_SIZE 1500
+
+static UINT32 seed = 1;
+
+static UINT32 randomNumber(UINT32 max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % max;
+}
+
+// Few different bytes, so patterns overlap and a patch often creates a match for the next ones.
+static UINT8 randomByte()
+{
+  return (UINT8)randomNumber(4);
+}
+
+class TestPatch
+{
+public:
+  UINT8  Find[MAX_FIND_SIZE];
+  UINT8  MaskFind[MAX_FIND_SIZE];
+  UINT8  Replace[MAX_FIND_SIZE];
+  UINT8  MaskReplace[MAX_FIND_SIZE];
+  bool   HasMaskFind;
+  bool   HasMaskReplace;
+  size_t FindSize;
+  size_t RegionStart;
+  size_t RegionLen;
+  INTN   Count;
+  INTN   Skip;
+};
+
+static void randomPatch(TestPatch* patch, const TestPatch* previous)
+{
+  patch->FindSize = 1 + randomNumber(MAX_FIND_SIZE);
+  for ( size_t i = 0 ; i < MAX_FIND_SIZE ; ++i ) {
+    patch->Find[i] = randomByte();
+    patch->Replace[i] = randomByte();
+    // a mask with bits on and off, or a byte that doesn't count at all
+    UINT32 r = randomNumber(4);
+    patch->MaskFind[i] = r == 0 ? 0 : r == 1 ? 0x01 : 0xFF;
+    patch->MaskReplace[i] = randomNumber(2) ? 0xFF : 0x02;
+  }
+  // look for what the previous patch wrote
+  if ( previous != NULL  &&  randomNumber(3) == 0 ) {
+    for ( size_t i = 0 ; i < MAX_FIND_SIZE ; ++i ) {
+      size_t j = i + randomNumber(2);
+      if ( j < MAX_FIND_SIZE ) patch->Find[i] = previous->Replace[j];
+    }
+  }
+  // with a mask not 0xFF on the first byte, the patch is not in the automaton
+  patch->HasMaskFind = randomNumber(3) == 0;
+  patch->HasMaskReplace = randomNumber(3) == 0;
+  switch ( randomNumber(4) ) {
+    case 0:
+      patch->RegionStart = 0;
+      patch->RegionLen = MAX_XSIZE;
+      break;
+    case 1:
+      patch->RegionStart = 0;
+      patch->RegionLen = BUFFER_SIZE;
+      break;
+    default:
+      patch->RegionStart = randomNumber(BUFFER_SIZE + 2);
+      patch->RegionLen = randomNumber(BUFFER_SIZE);
+      break;
+  }
+  patch->Count = (INTN)randomNumber(5) - 1;
+  patch->Skip = randomNumber(2) ? 0 : (INTN)randomNumber(4);
+}
+
+/*
+ * What was done before the patcher : one SearchAndReplaceMask per patch on its region.
+ */
+static size_t applyPatch_OLD(const TestPatch& patch, UINT8* Buffer, size_t BufferSize)
+{
+  if ( patch.FindSize > BufferSize || patch.RegionStart > BufferSize - patch.FindSize ) return 0;
+  size_t regionEnd = patch.RegionStart + patch.RegionLen;
+  if ( regionEnd < patch.RegionStart || regionEnd > BufferSize - patch.FindSize + 1 ) regionEnd = BufferSize - patch.FindSize + 1;
+  return SearchAndReplaceMask(Buffer + patch.RegionStart, regionEnd - patch.RegionStart, patch.Find, patch.HasMaskFind ? patch.MaskFind : NULL, patch.FindSize,
+                              patch.Replace, patch.HasMaskReplace ? patch.MaskReplace : NULL, patch.Count, patch.Skip);
+}
+
+static void addPatch(MultiPatternPatcher* patcher, const TestPatch& patch, size_t Tag)
+{
+  patcher->addPatch(patch.Find, patch.HasMaskFind ? patch.MaskFind : NULL, patch.FindSize,
+                    patch.Replace, patch.HasMaskReplace ? patch.MaskReplace : NULL,
+                    patch.RegionStart, patch.RegionLen, patch.Count, patch.Skip, Tag);
+}
+
+static int randomTests()
+{
+  static UINT8 buffer[BUFFER_SIZE];
+  static UINT8 expected[BUFFER_SIZE];
+  TestPatch patches[NB_PATCHES];
+  size_t replaces[NB_PATCHES];
+  MultiPatternPatcher patcher;
+
+  for ( size_t round = 0 ; round < 500 ; ++round ) {
+    size_t bufferSize = round < 10 ? round : BUFFER_SIZE - randomNumber(20);
+    size_t nbPatches = 1 + randomNumber(NB_PATCHES);
+    for ( size_t i = 0 ; i < bufferSize ; ++i ) buffer[i] = expected[i] = randomByte();
+
+    size_t expectedTotal = 0;
+    patcher.setEmpty();
+    for ( size_t idx = 0 ; idx < nbPatches ; ++idx ) {
+      randomPatch(&patches[idx], idx > 0 ? &patches[idx-1] : NULL);
+      replaces[idx] = applyPatch_OLD(patches[idx], expected, bufferSize);
+      expectedTotal += replaces[idx];
+      addPatch(&patcher, patches[idx], 100 + idx);
+    }
+    if ( patcher.size() != nbPatches ) return 1;
+
+    if ( patcher.apply(buffer, bufferSize) != expectedTotal ) return 2;
+    if ( memcmp(buffer, expected, bufferSize) != 0 ) return 3;
+    for ( size_t idx = 0 ; idx < nbPatches ; ++idx ) {
+      if ( patcher.replacesDone(idx) != replaces[idx] ) return 4;
+      if ( patcher.tag(idx) != 100 + idx ) return 5;
+    }
+  }
+  return 0;
+}
+
+/*
+ * More hits than MaxHitsPerPatch : the patch falls back to SearchAndReplaceMask, but it must still see
+ * what the other patches did.
+ */
+static int overflowTests()
+{
+  size_t bufferSize = MultiPatternPatcher::MaxHitsPerPatch * 3;
+  UINT8* buffer = (UINT8*)malloc(bufferSize);
+  UINT8* expected = (UINT8*)malloc(bufferSize);
+  TestPatch patches[3];
+  memset(patches, 0, sizeof(patches));
+  for ( size_t i = 0 ; i < bufferSize ; ++i ) buffer[i] = expected[i] = (UINT8)(i % 3 == 0 ? 1 : 0);
+
+  // 1 0 0 -> 1 2 0, everywhere
+  patches[0].FindSize = 3;
+  patches[0].Find[0] = 1;
+  patches[0].Replace[0] = 1;
+  patches[0].Replace[1] = 2;
+  patches[0].RegionLen = MAX_XSIZE;
+  // 2 0 1 -> 3 0 1, skip the first 10, then 5000
+  patches[1].FindSize = 3;
+  patches[1].Find[0] = 2;
+  patches[1].Find[2] = 1;
+  patches[1].Replace[0] = 3;
+  patches[1].Replace[2] = 1;
+  patches[1].RegionLen = MAX_XSIZE;
+  patches[1].Count = 5000;
+  patches[1].Skip = 10;
+  // 3 0 1 2, only in the second half
+  patches[2].FindSize = 4;
+  patches[2].Find[0] = 3;
+  patches[2].Find[2] = 1;
+  patches[2].Find[3] = 2;
+  patches[2].Replace[0] = 4;
+  patches[2].RegionStart = bufferSize / 2;
+  patches[2].RegionLen = MAX_XSIZE;
+
+  MultiPatternPatcher patcher;
+  size_t expectedTotal = 0;
+  for ( size_t idx = 0 ; idx < 3 ; ++idx ) {
+    expectedTotal += applyPatch_OLD(patches[idx], expected, bufferSize);
+    addPatch(&patcher, patches[idx], idx);
+  }
+  int ret = 0;
+  if ( patcher.apply(buffer, bufferSize) != expectedTotal ) ret = 10;
+  else if ( memcmp(buffer, expected, bufferSize) != 0 ) ret = 11;
+  free(buffer);
+  free(expected);
+  return ret;
+}
+
+int MultiPatternPatcher_tests()
+{
+  int ret;
+
+  MultiPatternPatcher patcher;
+  UINT8 buffer[4] = { 1, 2, 3, 4 };
+  if ( patcher.apply(buffer, sizeof(buffer)) != 0 ) return 100;
+
+  ret = randomTests();
+  if ( ret != 0 ) return ret;
+  ret = overflowTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
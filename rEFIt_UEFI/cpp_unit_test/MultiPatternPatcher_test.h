@@ -0,0 +1 @@
+int MultiPatternPatcher_tests();
@@ -0,0 +1,117 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "PrelinkInfoIndex_test.h"
+#include "../Platform/PrelinkInfoIndex.h"
+
+/*
+ * The walk that was used by PatchPrelinkedKexts before the index.
+ */
+static void findKexts_OLD(CHAR8* WholePlist, XArray<PrelinkInfoIndex::KextRange>* Kexts)
+{
+  CHAR8* DictPtr = WholePlist;
+  CHAR8* InfoPlistStart = NULL;
+  INTN   DictLevel = 0;
+
+  Kexts->setEmpty();
+  while ((DictPtr = strstr(DictPtr, "dict>")) != NULL) {
+    if (DictPtr[-1] == '<') {
+      DictLevel++;
+      if (DictLevel == 2) {
+        InfoPlistStart = DictPtr - 1;
+      }
+    } else if (DictPtr[-2] == '<' && DictPtr[-1] == '/') {
+      if (DictLevel == 2 && InfoPlistStart != NULL) {
+        PrelinkInfoIndex::KextRange Range;
+        Range.Start = InfoPlistStart;
+        Range.End = DictPtr + 5;
+        Kexts->Add(Range);
+      }
+      DictLevel--;
+    }
+    DictPtr += 5;
+  }
+}
+
+/*
+ * The search of an IDREF in the whole plist, as GetPlistHexValue does when the ID is not indexed.
+ */
+static BOOLEAN getInteger_OLD(const CHAR8* WholePlist, const CHAR8* ID, UINT64* Value)
+{
+  XString8 Search = S8Printf("<integer ID=\"%s\"", ID);
+  const CHAR8* IntTag = strstr(WholePlist, Search.c_str());
+  if (IntTag == NULL) return FALSE;
+  const CHAR8* End = strchr(IntTag, '>');
+  if (End == NULL || End[-1] == '/') return FALSE;
+  *Value = AsciiStrHexToUint64(End + 1);
+  return TRUE;
+}
+
+static const char* const plistText =
+  "<dict><key>_PrelinkInfoDictionary</key><array>"
+  "<dict>"
+    "<key>CFBundleIdentifier</key><string>com.apple.kpi.bsd</string>"
+    "<key>_PrelinkExecutableSourceAddr</key><integer size=\"64\" ID=\"1\">0xffffff8000c00000</integer>"
+    "<key>_PrelinkExecutableSize</key><integer size=\"64\" ID=\"2\">0x2b000</integer>"
+    "<key>OSBundleLibraries</key><dict><key>com.apple.kpi.mach</key><string>8.0</string></dict>"
+  "</dict>"
+  "<dict>"
+    "<key>CFBundleIdentifier</key><string>com.apple.driver.AppleHDA</string>"
+    "<key>_PrelinkExecutableSourceAddr</key><integer size=\"64\" IDREF=\"1\"/>"
+    "<key>_PrelinkExecutableSize</key><integer ID=\"3\" size=\"64\">0x1000</integer>"
+    "<key>Empty</key><dict></dict>"
+  "</dict>"
+  "<dict>"
+    "<key>_PrelinkExecutableSize</key><integer IDREF=\"2\"/>"
+    "<key>A</key><integer ID=\"007\" size=\"64\">0x7</integer>"
+    "<key>B</key><integer ID=\"12345678\" size=\"64\">0x8</integer>"
+    "<key>C</key><integer ID=\"9\" size=\"64\"/>"
+    "<key>D</key><integer ID=\"3\" size=\"64\">0x33</integer>"
+    "<key>E</key><integer ID=\"1000\" size=\"64\">0x1000</integer>"
+  "</dict>"
+  "<dict/>"
+  "</array></dict>";
+
+static const char* const IDs[] = {
+  "0", "1", "2", "3", "4", "007", "7", "12345678", "9", "1000", "999", "00", "", "1\"",
+};
+
+int PrelinkInfoIndex_tests()
+{
+  XBuffer<CHAR8> plist;
+  plist.ncat(plistText, strlen(plistText) + 1);
+  CHAR8* WholePlist = plist.data();
+
+  PrelinkInfoIndex Index;
+  Index.build(WholePlist);
+
+  XArray<PrelinkInfoIndex::KextRange> Kexts;
+  findKexts_OLD(WholePlist, &Kexts);
+  if ( Kexts.size() != 3 ) return 1;
+  if ( Index.Kexts.size() != Kexts.size() ) return 2;
+  for ( size_t idx = 0 ; idx < Kexts.size() ; ++idx ) {
+    if ( Index.Kexts[idx].Start != Kexts[idx].Start ) return 3;
+    if ( Index.Kexts[idx].End != Kexts[idx].End ) return 4;
+  }
+
+  for ( size_t idx = 0 ; idx < sizeof(IDs)/sizeof(IDs[0]) ; ++idx ) {
+    XString8 IDREF = S8Printf("%s\"", IDs[idx]);
+    UINT64 Value = 0;
+    UINT64 Expected = 0;
+    BOOLEAN Found = getInteger_OLD(WholePlist, IDs[idx], &Expected);
+    if ( Index.getInteger(IDREF.c_str(), &Value) ) {
+      // when the index answers, it is what the search would find
+      if ( !Found || Value != Expected ) return 10 + (int)idx;
+    }else{
+      // only IDs that can't be indexed, or that are really not there, are left to the search
+      if ( Found && strcmp(IDs[idx], "007") != 0 && strcmp(IDs[idx], "12345678") != 0 ) return 30 + (int)idx;
+    }
+  }
+
+  // the first ID="3" counts
+  UINT64 Value = 0;
+  if ( !Index.getInteger("3\"", &Value) || Value != 0x1000 ) return 50;
+
+  Index.build(plist.data() + plist.size() - 1); // empty
+  if ( Index.Kexts.size() != 0 || Index.getInteger("1\"", &Value) ) return 51;
+
+  return 0;
+}
@@ -0,0 +1 @@
+int PrelinkInfoIndex_tests();
@@ -0,0 +1,176 @@
+/*
+ * Only in Clover : nanosvg and XImage are not in cpp_tests.
+ */
+#ifdef CLOVER_BUILD
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SVGGlyphCache_test.h"
+#include "../libeg/SVGGlyphCache.h"
+
+/*
+ * A font in a theme.svg : advances of 500 and 600 units, a glyph with two contours, one without path,
+ * and the '_' of the cursor that overlaps the letter after it.
+ */
+static const char FontSVG[] =
+  "<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"100\" height=\"100\">"
+  "<defs><font id=\"Test\" horiz-adv-x=\"500\">"
+  "<font-face font-family=\"Test\" units-per-em=\"1000\" ascent=\"800\" descent=\"-200\" bbox=\"-50 -200 950 800\"/>"
+  "<missing-glyph horiz-adv-x=\"500\" d=\"M50 0L450 0L450 700L50 700Z\"/>"
+  "<glyph unicode=\"A\" horiz-adv-x=\"600\" d=\"M0 0L300 700L600 0L450 0L380 180L220 180L150 0ZM260 280L340 280L300 400Z\"/>"
+  "<glyph unicode=\"o\" horiz-adv-x=\"500\" d=\"M250 -10C390 -10 460 100 460 250C460 400 390 510 250 510C110 510 40 400 40 250C40 100 110 -10 250 -10Z\"/>"
+  "<glyph unicode=\"l\" horiz-adv-x=\"300\" d=\"M100 0L200 0L200 720L100 720Z\"/>"
+  "<glyph unicode=\" \" horiz-adv-x=\"250\"/>"
+  "<glyph unicode=\"_\" horiz-adv-x=\"500\" d=\"M-20 -150L520 -150L520 -80L-20 -80Z\"/>"
+  "</font></defs></svg>";
+
+/*
+ * What renderSVGtext() did before the cache : all the letters added to one image, rasterized at once.
+ */
+static float renderString_OLD(NSVGfont* Font, XImage* Buffer, INTN PosX, INTN PosY, INTN Height, UINT32 Color, const XStringW& String, size_t Cursor)
+{
+  NSVGparser* p = nsvg__createParser();
+  NSVGtext* text = (NSVGtext*)AllocateZeroPool(sizeof(NSVGtext));
+  text->font = Font;
+  text->fontColor = Color;
+  text->fontSize = (float)Height;
+  nsvg__xformIdentity(text->xform);
+  p->text = text;
+  float Scale = (float)Height / (Font->bbox[3] - Font->bbox[1]);
+  float x = (float)PosX;
+  float y = (float)PosY + Font->bbox[1] * Scale;
+  p->isText = TRUE;
+  for (size_t i = 0; i < String.length(); i++) {
+    if (i == Cursor) {
+      addLetter(p, 0x5F, x, y, Scale, Color);
+    }
+    x = addLetter(p, String.char16At(i), x, y, Scale, Color);
+  }
+  p->image->realBounds[0] = Font->bbox[0] * Scale;
+  p->image->realBounds[1] = Font->bbox[1] * Scale;
+  p->image->realBounds[2] = Font->bbox[2] * Scale + x;
+  p->image->realBounds[3] = Font->bbox[3] * Scale;
+  NSVGrasterizer* rast = nsvgCreateRasterizer();
+  nsvgRasterize(rast, p->image, 0, 0, 1.f, 1.f, (UINT8*)Buffer->GetPixelPtr(0,0),
+                (int)Buffer->GetWidth(), (int)Buffer->GetHeight(), (int)(Buffer->GetWidth()*4));
+  nsvgDeleteRasterizer(rast);
+  p->text = NULL;
+  FreePool(text);
+  nsvg__deleteParser(p);
+  return x;
+}
+
+// What renderSVGtext() does now
+static float renderString(SVGGlyphCache* Cache, NSVGfont* Font, XImage* Buffer, INTN PosX, INTN PosY, INTN Height, UINT32 Color, const XStringW& String, size_t Cursor)
+{
+  float Scale = (float)Height / (Font->bbox[3] - Font->bbox[1]);
+  float x = (float)PosX;
+  float PenShift = - 2.f * Font->bbox[0] * Scale;
+  for (size_t i = 0; i < String.length(); i++) {
+    float Pen = x + PenShift;
+    INTN PenX = (INTN)Pen;
+    if (Pen < (float)PenX) {
+      PenX--;
+    }
+    int SubX = (int)((Pen - (float)PenX) * SVGGlyphCache::SubPixels + 0.5f);
+    if (SubX == SVGGlyphCache::SubPixels) {
+      PenX++;
+      SubX = 0;
+    }
+    const SVGGlyphCache::GlyphMask* Glyph;
+    if (i == Cursor) {
+      Glyph = Cache->getGlyph(Font, Scale, Color, 0x5F, SubX);
+      if (Glyph) SVGGlyphCache::blend(*Glyph, *Buffer, PenX, PosY);
+    }
+    Glyph = Cache->getGlyph(Font, Scale, Color, String.char16At(i), SubX);
+    if (Glyph) {
+      SVGGlyphCache::blend(*Glyph, *Buffer, PenX, PosY);
+      x += Glyph->Advance;
+    }
+  }
+  nsvgUnpremultiplyAlpha((UINT8*)Buffer->GetPixelPtr(0,0), (int)Buffer->GetWidth(), (int)Buffer->GetHeight(), (int)(Buffer->GetWidth()*4));
+  return x;
+}
+
+/*
+ * The biggest difference of a channel between the two images, premultiplied : where alpha is small, the colors
+ * given back by nsvgUnpremultiplyAlpha() are far from each other for the smallest change of alpha.
+ */
+static int maxDifference(const XImage& Image1, const XImage& Image2)
+{
+  int Max = 0;
+  const UINT8* p1 = (const UINT8*)Image1.GetPixelPtr(0,0);
+  const UINT8* p2 = (const UINT8*)Image2.GetPixelPtr(0,0);
+  for (size_t i = 0; i < (size_t)(Image1.GetWidth() * Image1.GetHeight()); i++, p1 += 4, p2 += 4) {
+    for (int c = 0; c < 4; c++) {
+      int v1 = c == 3 ? p1[3] : p1[c] * p1[3] / 255;
+      int v2 = c == 3 ? p2[3] : p2[c] * p2[3] / 255;
+      int d = v1 > v2 ? v1 - v2 : v2 - v1;
+      if (d > Max) Max = d;
+    }
+  }
+  return Max;
+}
+
+/*
+ * Each string is drawn into an empty buffer both ways, cut at the edges of the buffer sometimes.
+ * With a height of 20 pixels, the advances and the pen shift are whole pixels : the pixels must be the same,
+ * but for the rounding of premultiplied colors. With other heights the pen is rounded to a quarter of a pixel,
+ * which moves a vertical edge by at most 1/8 of a pixel, 32 for a channel. And an horizontal edge that is exactly
+ * on a row of the samples of nanosvgrast, 13.6 pixels from the top at 17 pixels, may fall on one side in a glyph
+ * and on the other in the string : a row is 255 / NSVG__SUBSAMPLES. A glyph one pixel off is 255 somewhere.
+ */
+static int compareTests(SVGGlyphCache* Cache, NSVGfont* Font)
+{
+  static const wchar_t* Strings[] = { L"A", L"Allo lA", L"oAoAoAo", L"l l l", L"\x263A A" /* missing glyph */ };
+  static const UINT32 Colors[] = { 0xFF000000, 0xFFFFFFFF, 0x80C02040 };
+  static const INTN Heights[] = { 20, 17, 23, 31 };
+  static const INTN PosX[] = { 0, 3, -7, 180 };
+
+  for (size_t h = 0; h < sizeof(Heights) / sizeof(Heights[0]); h++) {
+    int Tolerance = Heights[h] == 20 ? 2 : 255 / NSVG__SUBSAMPLES + 32;
+    for (size_t s = 0; s < sizeof(Strings) / sizeof(Strings[0]); s++) {
+      XStringW String;
+      String.takeValueFrom(Strings[s]);
+      for (size_t c = 0; c < sizeof(Colors) / sizeof(Colors[0]); c++) {
+        for (size_t x = 0; x < sizeof(PosX) / sizeof(PosX[0]); x++) {
+          size_t Cursor = (s + x) % 3 == 0 ? 1 : MAX_XSIZE;
+          XImage Old(200, 40);
+          XImage New(200, 40);
+          Old.Fill();
+          New.Fill();
+          float OldX = renderString_OLD(Font, &Old, PosX[x], 5, Heights[h], Colors[c], String, Cursor);
+          float NewX = renderString(Cache, Font, &New, PosX[x], 5, Heights[h], Colors[c], String, Cursor);
+          // the width returned is the same
+          if (OldX - NewX > 0.001f || NewX - OldX > 0.001f) return 1;
+          if (maxDifference(Old, New) > Tolerance) return Heights[h] == 20 ? 2 : 3;
+        }
+      }
+    }
+  }
+  return 0;
+}
+
+int SVGGlyphCache_tests()
+{
+  char* Buffer = (char*)AllocateCopyPool(sizeof(FontSVG), FontSVG);
+  NSVGparser* p = nsvgParse(Buffer, 72, 1.f);
+  NSVGfont* Font = p ? p->font : NULL;
+  if (Font == NULL) return 100;
+
+  SVGGlyphCache* Cache = new SVGGlyphCache;
+  int ret = compareTests(Cache, Font);
+  delete Cache;
+
+  // the font is in fontsDB, with the fonts of the theme
+  if (fontsDB != NULL && fontsDB->font == Font) {
+    NSVGfontChain* Next = fontsDB->next;
+    FreePool(fontsDB);
+    fontsDB = Next;
+  }
+  nsvg__deleteFont(Font);
+  nsvg__deleteParser(p);
+  FreePool(Buffer);
+  return ret;
+}
+
+#endif // CLOVER_BUILD
@@ -0,0 +1 @@
+int SVGGlyphCache_tests();
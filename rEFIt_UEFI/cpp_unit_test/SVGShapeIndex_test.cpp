@@ -0,0 +1,187 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SVGShapeIndex_test.h"
+#include "../libeg/SVGShapeIndex.h"
+
+static UINT32 seed = 1;
+
+static UINT32 randomNumber(UINT32 max)
+{
+  seed = seed * 1103515245 + 12345;
+  return (seed >> 16) % max;
+}
+
+// A few ids, so that groups share them. The empty one is an anonymous group.
+static const char* GroupIds[] = { "", "icon_a", "icon_b", "icon_c", "selection_big", "frame_0001", "Banner" };
+#define NB_GROUP_IDS (sizeof(GroupIds) / sizeof(GroupIds[0]))
+
+/*
+ * Groups, each one inside a random group created before it or at the top, and shapes in random groups.
+ * Made twice with the same seed : one image for the old walk, one for the index.
+ */
+class RandomImage
+{
+public:
+  NSVGimage             Image;
+  XArray<NSVGgroup*>    Groups = XArray<NSVGgroup*>();
+  XArray<NSVGshape*>    Shapes = XArray<NSVGshape*>(); // in the initial order of Image.shapes
+
+  RandomImage(UINT32 Seed, size_t NbGroups, size_t NbShapes)
+  {
+    seed = Seed;
+    memset(&Image, 0, sizeof(Image));
+    for ( size_t i = 0 ; i < NbGroups ; ++i ) {
+      NSVGgroup* group = (NSVGgroup*)calloc(1, sizeof(NSVGgroup));
+      strcpy(group->id, GroupIds[randomNumber(NB_GROUP_IDS)]);
+      UINT32 Parent = randomNumber((UINT32)i + 1);
+      group->next = Parent == i ? NULL : Groups[Parent];
+      Groups.Add(group);
+    }
+    NSVGshape* Tail = NULL;
+    for ( size_t i = 0 ; i < NbShapes ; ++i ) {
+      NSVGshape* shape = (NSVGshape*)calloc(1, sizeof(NSVGshape));
+      UINT32 Group = randomNumber((UINT32)NbGroups + 1);
+      shape->group = Group == NbGroups ? NULL : Groups[Group];
+      if ( Tail == NULL ) Image.shapes = shape;
+      else Tail->next = shape;
+      Tail = shape;
+      Shapes.Add(shape);
+    }
+  }
+  ~RandomImage()
+  {
+    for ( size_t i = 0 ; i < Shapes.size() ; ++i ) free(Shapes[i]);
+    for ( size_t i = 0 ; i < Groups.size() ; ++i ) free(Groups[i]);
+  }
+  RandomImage(const RandomImage&) = delete;
+  RandomImage& operator=(const RandomImage&) = delete;
+
+  size_t number(const NSVGshape* shape) const
+  {
+    for ( size_t i = 0 ; i < Shapes.size() ; ++i ) {
+      if ( Shapes[i] == shape ) return i;
+    }
+    return MAX_XSIZE;
+  }
+
+  // numbers of the shapes still in Image.shapes
+  void remaining(XArray<size_t>* Result) const
+  {
+    Result->setEmpty();
+    for ( NSVGshape* shape = Image.shapes ; shape ; shape = shape->next ) Result->Add(number(shape));
+  }
+};
+
+// What ParseSVGXIcon() did before the index : walk all the shapes and the groups around each, take the ones of Id out
+static void takeIconShapes_OLD(RandomImage* Random, const char* Id, XArray<size_t>* Result)
+{
+  Result->setEmpty();
+  NSVGshape* shapePrev = NULL;
+  NSVGshape* shape = Random->Image.shapes;
+  while ( shape ) {
+    NSVGshape* shapeNext = shape->next;
+    NSVGgroup* group = shape->group;
+    while ( group && strcmp(group->id, Id) != 0 ) group = group->next;
+    if ( group ) {
+      Result->Add(Random->number(shape));
+      if ( shapePrev ) shapePrev->next = shapeNext;
+      else Random->Image.shapes = shapeNext;
+    } else {
+      shapePrev = shape;
+    }
+    shape = shapeNext;
+  }
+}
+
+// What ParseSVGXIcon() does now
+static void takeIconShapes(SVGShapeIndex* Index, RandomImage* Random, const char* Id, XArray<size_t>* Result)
+{
+  Result->setEmpty();
+  if ( !Index->isFor(&Random->Image) ) {
+    Index->build(&Random->Image);
+  }
+  XArray<size_t> IconShapes;
+  Index->getShapes(Id, &IconShapes);
+  for ( size_t i = 0 ; i < IconShapes.size() ; ++i ) {
+    Result->Add(Random->number(Index->getShape(IconShapes[i])));
+    Index->take(&Random->Image, IconShapes[i]);
+  }
+}
+
+static bool sameArray(const XArray<size_t>& a, const XArray<size_t>& b)
+{
+  if ( a.size() != b.size() ) return false;
+  for ( size_t i = 0 ; i < a.size() ; ++i ) {
+    if ( a[i] != b[i] ) return false;
+  }
+  return true;
+}
+
+/*
+ * The icons are taken from both images, like ParseSVGXTheme() and the anime frames parsed later do : each icon must
+ * get the same shapes in the same order, and the shapes left must be the same. Some rounds clear the index midway,
+ * as ParseSVGXTheme() does at its end, others take a shape out of the list by hand, which isFor() must see.
+ */
+static int randomTests()
+{
+  for ( UINT32 round = 0 ; round < 500 ; ++round ) {
+    size_t NbGroups = 1 + round % 40;
+    size_t NbShapes = round % 97;
+    RandomImage Old(round + 1, NbGroups, NbShapes);
+    RandomImage New(round + 1, NbGroups, NbShapes);
+    SVGShapeIndex Index;
+    Index.build(&New.Image);
+
+    seed = round * 7 + 3;
+    XArray<size_t> OldShapes;
+    XArray<size_t> NewShapes;
+    XArray<size_t> OldRemaining;
+    XArray<size_t> NewRemaining;
+    for ( int icon = 0 ; icon < 12 ; ++icon ) {
+      UINT32 r = randomNumber(10);
+      if ( r == 0 ) {
+        Index.setEmpty();
+      } else if ( r == 1 && Old.Image.shapes != NULL ) {
+        Old.Image.shapes = Old.Image.shapes->next;
+        New.Image.shapes = New.Image.shapes->next;
+      }
+      // an id not in the image now and then
+      const char* Id = randomNumber(8) == 0 ? "none" : GroupIds[1 + randomNumber(NB_GROUP_IDS - 1)];
+      takeIconShapes_OLD(&Old, Id, &OldShapes);
+      takeIconShapes(&Index, &New, Id, &NewShapes);
+      if ( !sameArray(OldShapes, NewShapes) ) return 1;
+      Old.remaining(&OldRemaining);
+      New.remaining(&NewRemaining);
+      if ( !sameArray(OldRemaining, NewRemaining) ) return 2;
+    }
+    // the anonymous groups are not indexed, and the old walk never looked for them
+    Index.getShapes("", &NewShapes);
+    if ( NewShapes.size() != 0 ) return 3;
+  }
+  return 0;
+}
+
+// A new image where the last one was : isFor() is true until setEmpty(), as when a theme is freed and another parsed
+static int setEmptyTests()
+{
+  SVGShapeIndex Index;
+  RandomImage Random(5, 4, 10);
+  Index.build(&Random.Image);
+  if ( !Index.isFor(&Random.Image) ) return 10;
+  Index.setEmpty();
+  if ( Index.isFor(&Random.Image) ) return 11;
+  XArray<size_t> Shapes;
+  Index.getShapes("icon_a", &Shapes);
+  if ( Shapes.size() != 0 ) return 12;
+  return 0;
+}
+
+int SVGShapeIndex_tests()
+{
+  int ret;
+
+  ret = randomTests();
+  if ( ret != 0 ) return ret;
+  ret = setEmptyTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int SVGShapeIndex_tests();
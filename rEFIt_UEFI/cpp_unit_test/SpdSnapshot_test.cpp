@@ -0,0 +1,290 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SpdSnapshot_test.h"
+#include "CacheFile_test_common.h"
+#include "../Platform/SpdSnapshot.h"
+
+#define BASE 0xEFA0
+#define DDR3 0x0B
+#define DDR4 0x0C
+
+/*
+ * An ICH/PCH SMBus controller with SPD eeproms at 0x50 + slot, for I2C block reads.
+ * Each access to a port is immediate, and the clock goes 1ms forward each time it is read.
+ */
+class TestSmbus : public SmbusIo
+{
+public:
+  UINT8  Eeprom[4][256];
+  bool   Present[4] = { true, true, false, false };
+  bool   StuckBusy = false;
+  size_t FailAfter = 0;      // a bus error after this number of bytes, 0 for none
+
+  UINT8  Sts = 0, Cnt = 0, Add = 0, Dat1 = 0, BlkDat = 0;
+  bool   InBlock = false;
+  bool   LastByte = false;
+  UINT8  Offset = 0;
+  size_t Delivered = 0;
+  UINT64 Now = 0;
+
+  TestSmbus() {
+    for ( size_t dev = 0 ; dev < 4 ; ++dev ) {
+      for ( size_t i = 0 ; i < 256 ; ++i ) Eeprom[dev][i] = (UINT8)(i * 7 + dev * 31 + 1);
+    }
+  }
+
+  void deliver() {
+    if ( FailAfter != 0 && Delivered == FailAfter ) {
+      InBlock = false;
+      Sts = (Sts & ~0x01) | 0x08; // BUS_ERR
+      return;
+    }
+    BlkDat = Eeprom[(Add >> 1) - 0x50][Offset++];
+    Delivered++;
+    LastByte = (Cnt & 0x20) != 0; // LAST_BYTE was set before this byte : it's NAKed
+    Sts |= 0x01 | 0x80;
+  }
+
+  virtual UINT8 read8(UINT32 Port) {
+    switch ( Port - BASE ) {
+      case 0: return StuckBusy ? (Sts | 0x01) : Sts;
+      case 2: return Cnt;
+      case 4: return Add;
+      case 6: return Dat1;
+      case 7: return BlkDat;
+      default: return 0xFF;
+    }
+  }
+
+  virtual void write8(UINT32 Port, UINT8 Value) {
+    switch ( Port - BASE ) {
+      case 0:
+        Sts &= ~(Value & 0x9E);
+        if ( (Value & 0x80) && InBlock ) {
+          if ( LastByte ) {
+            InBlock = false;
+            Sts = (Sts & ~0x01) | 0x02; // INTR
+          } else {
+            deliver();
+          }
+        }
+        break;
+      case 2:
+        Cnt = Value;
+        if ( Value & 0x02 ) { // KILL
+          InBlock = false;
+          Sts = (Sts & ~0x01) | 0x10;
+        } else if ( (Value & 0x40) && (Value & 0x1C) == 0x18 ) { // START, I2C block read
+          UINT8 dev = (UINT8)((Add >> 1) - 0x50);
+          if ( dev >= 4 || !Present[dev] ) {
+            Sts |= 0x04; // DEV_ERR
+            break;
+          }
+          InBlock = true;
+          Offset = Dat1;
+          Delivered = 0;
+          deliver();
+        }
+        break;
+      case 4: Add = Value; break;
+      case 6: Dat1 = Value; break;
+    }
+  }
+
+  virtual UINT64 milliseconds() { return Now++; }
+};
+
+static int blockReadTests()
+{
+  UINT8 buffer[32];
+  {
+    TestSmbus smbus;
+    // a whole block, then the shorter ones
+    if ( !SmbusI2cBlockRead(smbus, BASE, 0x50, 0x40, buffer, 32, false) ) return 1;
+    if ( smbus.Delivered != 32 || memcmp(buffer, &smbus.Eeprom[0][0x40], 32) != 0 ) return 2;
+    if ( smbus.Sts != 0 || (smbus.Add & 1) != 0 ) return 3;
+    if ( !SmbusI2cBlockRead(smbus, BASE, 0x51, 0xE0, buffer, 7, true) ) return 4; // the last block of a DDR4 SPD
+    if ( smbus.Delivered != 7 || memcmp(buffer, &smbus.Eeprom[1][0xE0], 7) != 0 || (smbus.Add & 1) != 1 ) return 5;
+    if ( !SmbusI2cBlockRead(smbus, BASE, 0x50, 3, buffer, 2, false) || smbus.Delivered != 2 || memcmp(buffer, &smbus.Eeprom[0][3], 2) != 0 ) return 6;
+    if ( !SmbusI2cBlockRead(smbus, BASE, 0x50, 2, buffer, 1, false) || smbus.Delivered != 1 || buffer[0] != smbus.Eeprom[0][2] ) return 7;
+    if ( smbus.Sts != 0 || smbus.InBlock ) return 8;
+  }
+  {
+    // empty slot : the controller is ready for the next read
+    TestSmbus smbus;
+    if ( SmbusI2cBlockRead(smbus, BASE, 0x52, 0, buffer, 32, false) ) return 10;
+    if ( (smbus.Sts & 0x01) != 0 ) return 11;
+    if ( !SmbusI2cBlockRead(smbus, BASE, 0x50, 0, buffer, 32, false) || memcmp(buffer, &smbus.Eeprom[0][0], 32) != 0 ) return 12;
+  }
+  {
+    // error in the middle of the transfer
+    TestSmbus smbus;
+    smbus.FailAfter = 5;
+    if ( SmbusI2cBlockRead(smbus, BASE, 0x50, 0, buffer, 32, false) ) return 13;
+    if ( smbus.InBlock || (smbus.Sts & 0x01) != 0 ) return 14;
+  }
+  {
+    // busy for ever : the timeout ends it
+    TestSmbus smbus;
+    smbus.StuckBusy = true;
+    if ( SmbusI2cBlockRead(smbus, BASE, 0x50, 0, buffer, 32, false) ) return 15;
+    if ( smbus.Now > 100 ) return 16;
+  }
+  {
+    TestSmbus smbus;
+    if ( SmbusI2cBlockRead(smbus, BASE, 0x50, 0, buffer, 0, false) ) return 17;
+    if ( SmbusI2cBlockRead(smbus, BASE, 0x50, 0, buffer, 33, false) ) return 18;
+  }
+  return 0;
+}
+
+static UINT8 spd0[SpdSnapshot::SpdSize], loaded0[SpdSnapshot::LoadedSize];
+static UINT8 spd2[SpdSnapshot::SpdSize], loaded2[SpdSnapshot::LoadedSize];
+
+// The bytes ScanSPD would have read, serial number at serialOffset
+static void makeSpd(UINT8* spd, UINT8* loaded, UINT8 type, UINT16 serialOffset, UINT8 seed)
+{
+  memset(spd, 0, SpdSnapshot::SpdSize);
+  memset(loaded, 0, SpdSnapshot::LoadedSize);
+  for ( UINT16 i = 0 ; i < SpdSnapshot::SpdSize ; i += 3 ) {
+    spd[i] = (UINT8)(i * seed + 1);
+    SpdSnapshot::setLoaded(loaded, i);
+  }
+  spd[2] = type;
+  SpdSnapshot::setLoaded(loaded, 2);
+  for ( UINT16 i = 0 ; i < SpdSnapshot::SerialSize ; ++i ) {
+    spd[serialOffset + i] = (UINT8)(seed + i);
+    SpdSnapshot::setLoaded(loaded, serialOffset + i);
+  }
+}
+
+// What is read at the next boot before asking the snapshot
+static void readTypeAndSerial(UINT8* spd, UINT8* loaded, const UINT8* from, UINT16 serialOffset)
+{
+  memset(spd, 0, SpdSnapshot::SpdSize);
+  memset(loaded, 0, SpdSnapshot::LoadedSize);
+  spd[2] = from[2];
+  memcpy(spd + serialOffset, from + serialOffset, SpdSnapshot::SerialSize);
+}
+
+class SnapshotLoader : public CacheFileLoader
+{
+public:
+  SpdSnapshot& Snapshot;
+  SnapshotLoader(SpdSnapshot& snapshot) : Snapshot(snapshot) {}
+  virtual bool load(UINT8* FileData, size_t FileSize) { return Snapshot.load(FileData, FileSize); }
+};
+
+static int fillTests(SpdSnapshot& snapshot)
+{
+  if ( snapshot.load(NULL, 0) ) return 20;
+  if ( !snapshot.isOpen() || snapshot.getNbSlots() != 0 ) return 21;
+
+  makeSpd(spd0, loaded0, DDR4, 325, 3);
+  makeSpd(spd2, loaded2, DDR3, 122, 5);
+  snapshot.add(0, 325, spd0, loaded0);
+  snapshot.add(2, 122, spd2, loaded2);
+  snapshot.add(0, 325, spd2, loaded2); // already there
+  if ( snapshot.getNbSlots() != 2 ) return 22;
+
+  UINT8 spd[SpdSnapshot::SpdSize], loaded[SpdSnapshot::LoadedSize];
+  // modules without serial number, or the serial number was not read
+  makeSpd(spd, loaded, DDR3, 122, 7);
+  memset(spd + 122, 0, SpdSnapshot::SerialSize);
+  snapshot.add(1, 122, spd, loaded);
+  memset(spd + 122, 0xFF, SpdSnapshot::SerialSize);
+  snapshot.add(1, 122, spd, loaded);
+  makeSpd(spd, loaded, DDR3, 122, 7);
+  loaded[123 >> 3] &= ~(1 << (123 & 7));
+  snapshot.add(1, 122, spd, loaded);
+  snapshot.add(1, SpdSnapshot::SpdSize - 1, spd, loaded);
+  if ( snapshot.getNbSlots() != 2 || !snapshot.isModified() ) return 23;
+  return 0;
+}
+
+static int roundTripTests()
+{
+  SpdSnapshot snapshot;
+  int ret = fillTests(snapshot);
+  if ( ret != 0 ) return ret;
+
+  size_t size;
+  UINT8* p = copyData(snapshot.getData(), &size);
+  SpdSnapshot next;
+  if ( !next.load(p, size) ) return 30;
+  if ( next.getNbSlots() != 0 ) return 31;
+
+  UINT8 spd[SpdSnapshot::SpdSize], loaded[SpdSnapshot::LoadedSize];
+  readTypeAndSerial(spd, loaded, spd0, 325);
+  if ( !next.get(0, spd, loaded) ) return 32;
+  if ( memcmp(spd, spd0, sizeof(spd)) != 0 || memcmp(loaded, loaded0, sizeof(loaded)) != 0 ) return 33;
+  readTypeAndSerial(spd, loaded, spd2, 122);
+  if ( !next.get(2, spd, loaded) ) return 34;
+  if ( memcmp(spd, spd2, sizeof(spd)) != 0 || memcmp(loaded, loaded2, sizeof(loaded)) != 0 ) return 35;
+
+  // an empty slot, a module moved to another slot, another serial number, another type
+  readTypeAndSerial(spd, loaded, spd2, 122);
+  if ( next.get(1, spd, loaded) || next.get(0, spd, loaded) ) return 36;
+  readTypeAndSerial(spd, loaded, spd0, 325);
+  spd[328] ^= 1;
+  if ( next.get(0, spd, loaded) ) return 37;
+  if ( spd[0] != 0 || loaded[0] != 0 ) return 38; // untouched
+  readTypeAndSerial(spd, loaded, spd0, 325);
+  spd[2] = DDR3;
+  if ( next.get(0, spd, loaded) ) return 39;
+
+  // the same modules : nothing to save
+  next.add(0, 325, spd0, loaded0);
+  next.add(2, 122, spd2, loaded2);
+  if ( next.isModified() || next.getNbSlots() != 2 ) return 40;
+
+  // one removed
+  p = copyData(snapshot.getData(), &size);
+  if ( !next.load(p, size) ) return 41;
+  next.add(0, 325, spd0, loaded0);
+  if ( !next.isModified() || next.getNbSlots() != 1 ) return 42;
+  return 0;
+}
+
+static int rejectTests()
+{
+  SpdSnapshot snapshot;
+  int ret = fillTests(snapshot);
+  if ( ret != 0 ) return ret;
+
+  SpdSnapshot next;
+  UINT8 spd[SpdSnapshot::SpdSize], loaded[SpdSnapshot::LoadedSize];
+
+  // truncated, longer, a byte changed in the SPD, in the loaded bits, in the header : magic, version, count, serial number offset
+  const CacheFileDamage Damages[] = { {snapshot.getData().size() - 100, 0x10}, {16 + 8 + 3, 0x01}, {0, 'C' ^ 'X'}, {8, 0x03}, {12, 0x01}, {16 + 3, 0x7F} };
+  SnapshotLoader loader(next);
+  ret = rejectBrokenFiles(loader, snapshot.getData(), 37, Damages, sizeof(Damages) / sizeof(Damages[0]));
+  if ( ret != 0 ) return 60 + ret;
+
+  // nothing is found in an invalid one, and it is saved again
+  size_t size;
+  UINT8* p = copyData(snapshot.getData(), &size);
+  p[0] = 'X';
+  if ( next.load(p, size) ) return 50;
+  readTypeAndSerial(spd, loaded, spd0, 325);
+  if ( next.get(0, spd, loaded) ) return 57;
+  next.add(0, 325, spd0, loaded0);
+  if ( !next.isModified() ) return 58;
+
+  // a closed snapshot keeps nothing
+  next.setEmpty();
+  next.add(0, 325, spd0, loaded0);
+  if ( next.isOpen() || next.isModified() || next.getNbSlots() != 0 ) return 59;
+  return 0;
+}
+
+int SpdSnapshot_tests()
+{
+  int ret;
+  ret = blockReadTests();
+  if ( ret != 0 ) return ret;
+  ret = roundTripTests();
+  if ( ret != 0 ) return ret;
+  ret = rejectTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int SpdSnapshot_tests();
@@ -0,0 +1,238 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "VolumeDirCache_test.h"
+#include "../Platform/VolumeDirCache.h"
+
+/*
+ * A volume in memory, names compared ignoring case as FAT does. A short name is the 8.3 alias of a long one :
+ * Open() finds it, Read() doesn't list it.
+ */
+class MockNode
+{
+public:
+  int           Parent;    // index in Nodes, -1 for the root
+  const CHAR16* Name;
+  bool          IsDir;
+  const CHAR16* ShortName; // NULL if the name is a valid 8.3 one
+};
+
+static CHAR16 LongName[300];
+
+static MockNode Nodes[] = {
+  { -1, L"EFI", true, NULL },
+  { 0, L"BOOT", true, NULL },
+  { 1, L"BOOTX64.efi", false, L"BOOTX6~1.EFI" },
+  { 0, L"CLOVER", true, NULL },
+  { 3, L"CLOVERX64.efi", false, L"CLOVER~1.EFI" },
+  { 3, LongName, false, L"AAAAAA~1" }, // FileName bigger than the first buffer of Dir::read()
+  { 0, L"Microsoft", true, L"MICROS~1" },
+  { 6, L"Boot", true, NULL },
+  { 7, L"bootmgfw.efi", false, NULL },
+  { -1, L"System", true, NULL },
+  { 9, L"Library", true, NULL },
+  { -1, L"mach_kernel", false, NULL },
+};
+
+#define NB_NODES (int)(sizeof(Nodes) / sizeof(Nodes[0]))
+
+class MockFile
+{
+public:
+  EFI_FILE_PROTOCOL Protocol; // first, so the EFI_FILE* is the MockFile*
+  int               Node;
+  int               Position; // next node to look at in Read()
+  int               NbDotsRead;
+};
+
+static size_t NbOpen = 0;
+
+static MockFile* newFile(int Node);
+
+static size_t nameLength(const CHAR16* Name)
+{
+  size_t Len = 0;
+  while ( Name[Len] != 0 ) Len++;
+  return Len;
+}
+
+static bool sameNameIC(const CHAR16* Name, size_t Len, const CHAR16* Name2)
+{
+  if ( Name2 == NULL || nameLength(Name2) != Len ) return false;
+  for ( size_t i = 0 ; i < Len ; ++i ) {
+    CHAR16 c1 = (Name[i] >= 'a' && Name[i] <= 'z') ? (CHAR16)(Name[i] - 'a' + 'A') : Name[i];
+    CHAR16 c2 = (Name2[i] >= 'a' && Name2[i] <= 'z') ? (CHAR16)(Name2[i] - 'a' + 'A') : Name2[i];
+    if ( c1 != c2 ) return false;
+  }
+  return true;
+}
+
+static EFI_STATUS EFIAPI mockOpen(JCONST EFI_FILE_PROTOCOL* This, EFI_FILE_PROTOCOL** NewHandle, JCONST CHAR16* FileName, UINT64 OpenMode, UINT64 Attributes)
+{
+  (void)OpenMode;
+  (void)Attributes;
+  NbOpen++;
+  int Node = ((MockFile*)This)->Node;
+  const CHAR16* p = FileName;
+  if ( *p == '\\' ) Node = -1;
+  while ( *p != 0 ) {
+    while ( *p == '\\' ) p++;
+    if ( *p == 0 ) break;
+    const CHAR16* end = p;
+    while ( *end != 0 && *end != '\\' ) end++;
+    if ( Node >= 0 && !Nodes[Node].IsDir ) return EFI_NOT_FOUND;
+    int Child = -1;
+    for ( int i = 0 ; i < NB_NODES && Child < 0 ; ++i ) {
+      if ( Nodes[i].Parent == Node && (sameNameIC(p, (size_t)(end - p), Nodes[i].Name) || sameNameIC(p, (size_t)(end - p), Nodes[i].ShortName)) ) Child = i;
+    }
+    if ( Child < 0 ) return EFI_NOT_FOUND;
+    Node = Child;
+    p = end;
+  }
+  *NewHandle = &newFile(Node)->Protocol;
+  return EFI_SUCCESS;
+}
+
+static EFI_STATUS EFIAPI mockClose(JCONST EFI_FILE_PROTOCOL* This)
+{
+  free((void*)This);
+  return EFI_SUCCESS;
+}
+
+// The entries of a directory : "." and "..", except for the root, then the nodes in it
+static EFI_STATUS EFIAPI mockRead(JCONST EFI_FILE_PROTOCOL* This, UINTN* BufferSize, VOID* Buffer)
+{
+  MockFile* File = (MockFile*)This;
+  const CHAR16* Name = NULL;
+  bool IsDir = true;
+  int Next = File->Position;
+  if ( File->Node >= 0 && File->NbDotsRead < 2 ) {
+    Name = File->NbDotsRead == 0 ? L"." : L"..";
+  } else {
+    while ( Next < NB_NODES && Nodes[Next].Parent != File->Node ) Next++;
+    if ( Next == NB_NODES ) {
+      *BufferSize = 0;
+      return EFI_SUCCESS;
+    }
+    Name = Nodes[Next].Name;
+    IsDir = Nodes[Next].IsDir;
+  }
+  UINTN Size = SIZE_OF_EFI_FILE_INFO + (nameLength(Name) + 1) * sizeof(CHAR16);
+  if ( *BufferSize < Size ) {
+    *BufferSize = Size;
+    return EFI_BUFFER_TOO_SMALL;
+  }
+  EFI_FILE_INFO* Info = (EFI_FILE_INFO*)Buffer;
+  memset(Info, 0, Size);
+  Info->Size = Size;
+  Info->Attribute = IsDir ? EFI_FILE_DIRECTORY : 0;
+  memcpy(Info->FileName, Name, (nameLength(Name) + 1) * sizeof(CHAR16));
+  *BufferSize = Size;
+  if ( File->Node >= 0 && File->NbDotsRead < 2 ) File->NbDotsRead++;
+  else File->Position = Next + 1;
+  return EFI_SUCCESS;
+}
+
+static MockFile* newFile(int Node)
+{
+  MockFile* File = (MockFile*)malloc(sizeof(MockFile));
+  memset(File, 0, sizeof(MockFile));
+  File->Protocol.Open = mockOpen;
+  File->Protocol.Close = mockClose;
+  File->Protocol.Read = mockRead;
+  File->Node = Node;
+  return File;
+}
+
+// What FileExists() does, without the cache
+static BOOLEAN openAndClose(EFI_FILE* Root, const CHAR16* Path)
+{
+  EFI_FILE* File = NULL;
+  if ( EFI_ERROR(Root->Open(Root, &File, (CHAR16*)Path, EFI_FILE_MODE_READ, 0)) ) return FALSE;
+  File->Close(File);
+  return TRUE;
+}
+
+/*
+ * Each path, with the result expected and whether the cache must open it. The directories on the way are read once,
+ * the first time.
+ */
+class PathTest
+{
+public:
+  const CHAR16* Path;
+  BOOLEAN       Exists;
+  bool          Opened;
+};
+
+static const PathTest PathTests[] = {
+  // hit
+  { L"EFI\\BOOT\\BOOTX64.efi", TRUE, false },
+  { L"\\EFI\\CLOVER\\CLOVERX64.efi", TRUE, false },
+  { L"EFI\\Microsoft\\Boot\\bootmgfw.efi", TRUE, false },
+  { L"System\\Library", TRUE, false },
+  // miss
+  { L"EFI\\BOOT\\BOOTIA32.efi", FALSE, false },
+  { L"EFI\\OC\\OpenCore.efi", FALSE, false },
+  { L"mach_kernel\\Contents", FALSE, false },
+  { L"EFI\\CLOVER\\CLOVERX64.efi\\x", FALSE, false },
+  // same name ignoring case : the file system decides
+  { L"EFI\\BOOT\\BOOTX64.EFI", TRUE, true },
+  { L"efi\\clover\\cloverx64.efi", TRUE, true },
+  { L"EFI\\microsoft\\Boot\\bootmgfw.efi", TRUE, true },
+  // 8.3 aliases, not listed
+  { L"EFI\\BOOT\\BOOTX6~1.EFI", TRUE, true },
+  { L"EFI\\MICROS~1\\Boot\\bootmgfw.efi", TRUE, true },
+  { L"EFI\\CLOVER\\AAAAAA~1", TRUE, true },
+  { L"EFI\\BOOT\\BOOTIA~1.EFI", FALSE, true },
+};
+
+static int pathTests()
+{
+  for ( size_t i = 0 ; i < sizeof(LongName) / sizeof(LongName[0]) - 1 ; ++i ) LongName[i] = (CHAR16)('a' + i % 26);
+  LongName[sizeof(LongName) / sizeof(LongName[0]) - 1] = 0;
+
+  EFI_FILE* Root = &newFile(-1)->Protocol;
+  VolumeDirCache Cache;
+  Cache.enable(Root);
+  size_t NbOpenSaved = 0;
+  for ( int round = 0 ; round < 2 ; ++round ) {
+    for ( size_t i = 0 ; i < sizeof(PathTests) / sizeof(PathTests[0]) ; ++i ) {
+      const PathTest& Test = PathTests[i];
+      if ( openAndClose(Root, Test.Path) != Test.Exists ) return 1;
+      size_t NbDirRead = Cache.NbDirRead;
+      NbOpen = 0;
+      if ( Cache.fileExists(Root, Test.Path) != Test.Exists ) return 2;
+      if ( NbOpen != Cache.NbDirRead - NbDirRead + (Test.Opened ? 1 : 0) ) return 3;
+      if ( round == 1 && Cache.NbDirRead != NbDirRead ) return 4;
+      if ( !Test.Opened ) NbOpenSaved++;
+      if ( Cache.NbOpenSaved != NbOpenSaved ) return 5;
+    }
+  }
+  // the root, EFI, BOOT, CLOVER, Microsoft, Microsoft\Boot and System. Not Library, nothing is looked for in it.
+  if ( Cache.NbDirRead != 7 ) return 6;
+
+  // the long name is there too
+  XStringW Long = L"EFI\\CLOVER\\"_XSW + XStringW().takeValueFrom(LongName);
+  NbOpen = 0;
+  if ( !Cache.fileExists(Root, Long) || NbOpen != 0 ) return 7;
+
+  // another volume : opened
+  EFI_FILE* Other = &newFile(-1)->Protocol;
+  NbOpen = 0;
+  if ( !Cache.fileExists(Other, L"EFI\\BOOT\\BOOTX64.efi") || NbOpen != 1 ) return 8;
+  Other->Close(Other);
+
+  Cache.setEmpty();
+  NbOpen = 0;
+  if ( !Cache.fileExists(Root, L"EFI\\BOOT\\BOOTX64.efi") || NbOpen != 1 ) return 9;
+  Root->Close(Root);
+  return 0;
+}
+
+int VolumeDirCache_tests()
+{
+  int ret;
+
+  ret = pathTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int VolumeDirCache_tests();
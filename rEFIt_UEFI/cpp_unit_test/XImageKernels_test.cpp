@@ -0,0 +1,133 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "XImageKernels_test.h"
+#include "../libeg/XImageKernels.h"
+
+#define NB_PIXELS 1031 // not a multiple of 4, to test the tail
+
+static UINT32 seed = 1;
+
+static UINT8 randomByte()
+{
+  seed = seed * 1103515245 + 12345;
+  return (UINT8)(seed >> 16);
+}
+
+// Alpha 0 and 255 are the most common in icons. Opaque group of 4 pixels are needed to take the vector path.
+static void fillRandom(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* pixels, size_t count, bool opaque)
+{
+  for ( size_t i = 0 ; i < count ; ++i ) {
+    pixels[i].Blue = randomByte();
+    pixels[i].Green = randomByte();
+    pixels[i].Red = randomByte();
+    UINT8 r = randomByte();
+    pixels[i].Reserved = opaque ? 255 : r < 64 ? 0 : r < 128 ? 255 : randomByte();
+  }
+}
+
+static int composeTests()
+{
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL top[NB_PIXELS];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL comp[NB_PIXELS];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL compRef[NB_PIXELS];
+
+  for ( int pass = 0 ; pass < 16 ; ++pass ) {
+    bool lowest = (pass & 1) != 0;
+    bool gray = (pass & 2) != 0;
+    fillRandom(top, NB_PIXELS, false);
+    fillRandom(comp, NB_PIXELS, (pass & 4) != 0);
+    if ( pass & 8 ) {
+      for ( size_t i = 0 ; i < NB_PIXELS ; i += 7 ) comp[i].Reserved = randomByte(); // breaks some groups of 4
+    }
+    memcpy(compRef, comp, sizeof(comp));
+    // start at 1 to test unaligned rows
+    XImageComposeRow(comp + 1, top + 1, NB_PIXELS - 1, lowest, gray);
+    XImageComposeRowScalar(compRef + 1, top + 1, NB_PIXELS - 1, lowest, gray);
+    if ( memcmp(comp, compRef, sizeof(comp)) != 0 ) return 1;
+  }
+
+  // Opaque Top replaces, transparent Top leaves Comp unchanged
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL t[4] = { {10, 20, 30, 255}, {10, 20, 30, 0}, {10, 20, 30, 255}, {10, 20, 30, 0} };
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL c[4] = { {1, 2, 3, 255}, {1, 2, 3, 255}, {1, 2, 3, 255}, {1, 2, 3, 255} };
+  XImageComposeRow(c, t, 4, false, false);
+  if ( c[0].Blue != 10 || c[0].Green != 20 || c[0].Red != 30 || c[0].Reserved != 255 ) return 10;
+  if ( c[1].Blue != 1 || c[1].Green != 2 || c[1].Red != 3 || c[1].Reserved != 255 ) return 11;
+
+  // Half transparent over transparent : Top color, Top alpha
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL t2 = {10, 20, 30, 128};
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL c2 = {1, 2, 3, 0};
+  XImageComposeRow(&c2, &t2, 1, false, false);
+  if ( c2.Blue != 10 || c2.Green != 20 || c2.Red != 30 || c2.Reserved != 128 ) return 12;
+
+  // Half over opaque : rounded average
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL t3[4] = { {200, 0, 100, 128}, {200, 0, 100, 128}, {200, 0, 100, 128}, {200, 0, 100, 128} };
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL c3[4] = { {0, 100, 100, 255}, {0, 100, 100, 255}, {0, 100, 100, 255}, {0, 100, 100, 255} };
+  XImageComposeRow(c3, t3, 4, false, false);
+  if ( c3[3].Blue != 100 || c3[3].Green != 50 || c3[3].Red != 100 || c3[3].Reserved != 255 ) return 13;
+  return 0;
+}
+
+static int scaleTests()
+{
+  const UINTN srcWidth = 37;
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL row0[srcWidth];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL row1[srcWidth];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL dst[NB_PIXELS];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL dstRef[NB_PIXELS];
+
+  // 1/16 to 4x, and steps that don't fall on a pixel
+  static const UINT32 steps[] = { 65536, 65536 * 2, 65536 / 2, 65536 * 3 / 2, 65536 * 2 / 3, 12345, 65536 * 16, 65536 / 4 + 7 };
+  for ( size_t s = 0 ; s < sizeof(steps) / sizeof(steps[0]) ; ++s ) {
+    fillRandom(row0, srcWidth, false);
+    fillRandom(row1, srcWidth, false);
+    UINTN dstWidth = (UINTN)(((UINT64)srcWidth << 16) / steps[s]);
+    if ( dstWidth > NB_PIXELS ) dstWidth = NB_PIXELS;
+    for ( UINT32 fy = 0 ; fy < 128 ; fy += 9 ) {
+      XImageScaleRow(dst, dstWidth, row0, row1, srcWidth, steps[s], fy);
+      XImageScaleRowScalar(dstRef, dstWidth, row0, row1, srcWidth, steps[s], fy);
+      if ( memcmp(dst, dstRef, dstWidth * sizeof(dst[0])) != 0 ) return 20;
+    }
+  }
+  // Scale 1 is a copy
+  fillRandom(row0, srcWidth, false);
+  XImageScaleRow(dst, srcWidth, row0, row1, srcWidth, 65536, 0);
+  if ( memcmp(dst, row0, sizeof(row0)) != 0 ) return 21;
+  // Half way between two pixels
+  EFI_GRAPHICS_OUTPUT_BLT_PIXEL two[2] = { {0, 100, 255, 0}, {100, 0, 255, 255} };
+  XImageScaleRow(dst, 4, two, two, 2, 65536 / 2, 0);
+  if ( dst[1].Blue != 50 || dst[1].Green != 50 || dst[1].Red != 255 || dst[1].Reserved != 128 ) return 22;
+  if ( dst[3].Blue != 100 || dst[3].Reserved != 255 ) return 23; // past the last pixel : clamped
+  return 0;
+}
+
+static int flipTests()
+{
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL pixels[NB_PIXELS];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL pixelsRef[NB_PIXELS];
+  static EFI_GRAPHICS_OUTPUT_BLT_PIXEL original[NB_PIXELS];
+  fillRandom(pixels, NB_PIXELS, false);
+  memcpy(pixelsRef, pixels, sizeof(pixels));
+  memcpy(original, pixels, sizeof(pixels));
+  XImageFlipRB(pixels + 1, NB_PIXELS - 1);
+  XImageFlipRBScalar(pixelsRef + 1, NB_PIXELS - 1);
+  if ( memcmp(pixels, pixelsRef, sizeof(pixels)) != 0 ) return 30;
+  if ( pixels[5].Blue != original[5].Red || pixels[5].Red != original[5].Blue || pixels[5].Green != original[5].Green || pixels[5].Reserved != original[5].Reserved ) return 31;
+  XImageFlipRB(pixels + 1, NB_PIXELS - 1);
+  if ( memcmp(pixels, original, sizeof(pixels)) != 0 ) return 32;
+  return 0;
+}
+
+int XImageKernels_tests()
+{
+  int ret;
+  // the vector gray conversion relies on it
+  for ( UINT32 sum = 0 ; sum <= 7 * 255 ; ++sum ) {
+    if ( (sum * 9363) >> 16 != sum / 7 ) return 100;
+  }
+  ret = composeTests();
+  if ( ret != 0 ) return ret;
+  ret = scaleTests();
+  if ( ret != 0 ) return ret;
+  ret = flipTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
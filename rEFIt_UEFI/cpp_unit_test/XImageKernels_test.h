@@ -0,0 +1 @@
+int XImageKernels_tests();
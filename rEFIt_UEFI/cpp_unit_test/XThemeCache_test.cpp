@@ -0,0 +1,120 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "XThemeCache_test.h"
+#include "CacheFile_test_common.h"
+#include "../libeg/XThemeCache.h"
+
+#define KEY 0x0123456789abcdefULL
+
+static EFI_GRAPHICS_OUTPUT_BLT_PIXEL small[1] = { {1, 2, 3, 4} };
+static EFI_GRAPHICS_OUTPUT_BLT_PIXEL big[7 * 5];
+
+static void fillBig()
+{
+  for ( size_t i = 0 ; i < sizeof(big) / sizeof(big[0]) ; ++i ) {
+    big[i].Blue = (UINT8)i;
+    big[i].Green = (UINT8)(i * 3);
+    big[i].Red = (UINT8)(i * 7);
+    big[i].Reserved = (UINT8)(255 - i);
+  }
+}
+
+static bool checkImage(const XThemeCache& cache, const char* name, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* expected, UINTN expectedWidth, UINTN expectedHeight)
+{
+  const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* pixels;
+  UINTN width, height;
+  if ( !cache.find(XString8().takeValueFrom(name), &pixels, &width, &height) ) return false;
+  if ( expected == NULL ) return pixels == NULL && width == 0 && height == 0;
+  if ( pixels == NULL || width != expectedWidth || height != expectedHeight ) return false;
+  return memcmp(pixels, expected, width * height * sizeof(*pixels)) == 0;
+}
+
+class ThemeCacheLoader : public CacheFileLoader
+{
+public:
+  XThemeCache& Cache;
+  ThemeCacheLoader(XThemeCache& cache) : Cache(cache) {}
+  virtual bool load(UINT8* FileData, size_t FileSize) { return Cache.load(FileData, FileSize, KEY); }
+};
+
+static int fillTests(XThemeCache& cache)
+{
+  cache.start(KEY);
+  if ( !cache.isOpen() || cache.isModified() || cache.getKey() != KEY || cache.getNbImages() != 0 ) return 1;
+  if ( checkImage(cache, "logo", NULL, 0, 0) ) return 2;
+
+  cache.add("logo"_XS8, big, 7, 5);
+  cache.add("os_mac_night"_XS8, NULL, 0, 0); // not in the theme
+  cache.add("abc"_XS8, small, 1, 1); // name length is a multiple of 4 with the 0
+  cache.add("logo"_XS8, small, 1, 1); // already there, ignored
+  if ( !cache.isModified() || cache.getNbImages() != 3 ) return 3;
+  if ( !checkImage(cache, "logo", big, 7, 5) ) return 4;
+  if ( !checkImage(cache, "os_mac_night", NULL, 0, 0) ) return 5;
+  if ( !checkImage(cache, "abc", small, 1, 1) ) return 6;
+  if ( checkImage(cache, "log", NULL, 0, 0) || checkImage(cache, "logo2", NULL, 0, 0) ) return 7;
+  return 0;
+}
+
+static int roundTripTests()
+{
+  XThemeCache cache;
+  int ret = fillTests(cache);
+  if ( ret != 0 ) return ret;
+
+  size_t size;
+  UINT8* p = copyData(cache.getData(), &size);
+  XThemeCache loaded;
+  if ( !loaded.load(p, size, KEY) ) return 10;
+  if ( loaded.isModified() || loaded.getKey() != KEY || loaded.getNbImages() != 3 ) return 11;
+  if ( !checkImage(loaded, "logo", big, 7, 5) ) return 12;
+  if ( !checkImage(loaded, "os_mac_night", NULL, 0, 0) ) return 13;
+  if ( !checkImage(loaded, "abc", small, 1, 1) ) return 14;
+  if ( loaded.getData() != cache.getData() ) return 15;
+
+  // images added after a load are saved with the others
+  loaded.add("selection_big"_XS8, big + 1, 2, 3);
+  if ( !loaded.isModified() ) return 16;
+  p = copyData(loaded.getData(), &size);
+  XThemeCache reloaded;
+  if ( !reloaded.load(p, size, KEY) ) return 17;
+  if ( reloaded.getNbImages() != 4 || !checkImage(reloaded, "selection_big", big + 1, 2, 3) || !checkImage(reloaded, "logo", big, 7, 5) ) return 18;
+  return 0;
+}
+
+static int rejectTests()
+{
+  XThemeCache cache;
+  int ret = fillTests(cache);
+  if ( ret != 0 ) return ret;
+
+  size_t size;
+  UINT8* p = copyData(cache.getData(), &size);
+  XThemeCache loaded;
+  // made for another theme or screen : opened empty for the new key
+  if ( loaded.load(p, size, KEY + 1) ) return 20;
+  if ( !loaded.isOpen() || loaded.getKey() != KEY + 1 || loaded.getNbImages() != 0 ) return 21;
+
+  // truncated, longer, bad magic, bad version, an image too big
+  static const CacheFileDamage Damages[] = { {0, 'C' ^ 'X'}, {8, 0x03}, {24 + 4 + 3, 0x7F} }; // 0x7F : width of the first image
+  ThemeCacheLoader loader(loaded);
+  ret = rejectBrokenFiles(loader, cache.getData(), 5, Damages, sizeof(Damages) / sizeof(Damages[0]));
+  if ( ret != 0 ) return 30 + ret;
+
+  if ( loaded.load(NULL, 0, KEY) || !loaded.isOpen() || loaded.getNbImages() != 0 ) return 27;
+
+  // a closed cache keeps nothing
+  loaded.setEmpty();
+  loaded.add("logo"_XS8, big, 7, 5);
+  if ( loaded.isOpen() || loaded.isModified() || checkImage(loaded, "logo", big, 7, 5) ) return 28;
+  return 0;
+}
+
+int XThemeCache_tests()
+{
+  int ret;
+  fillBig();
+  ret = roundTripTests();
+  if ( ret != 0 ) return ret;
+  ret = rejectTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int XThemeCache_tests();
@@ -15,11 +15,23 @@
 #include "printf_lite-test.h"
 #include "LoadOptions_test.h"
 #include "XToolsCommon_test.h"
+#include "fnv_hash_test.h"
 #include "XBuffer_tests.h"
 #include "plist_tests.h"
 #include "find_replace_mask_Clover_tests.h"
 #include "find_replace_mask_OC_tests.h"
 #include "MacOsVersion_test.h"
+#include "MachoSymbolIndex_test.h"
+#include "KextPatchIndex_test.h"
+#include "MultiPatternPatcher_test.h"
+#include "PrelinkInfoIndex_test.h"
+#include "VolumeDirCache_test.h"
+#include "XImageKernels_test.h"
+#include "SVGShapeIndex_test.h"
+#include "XThemeCache_test.h"
+#include "SpdSnapshot_test.h"
+#include "DeviceIdIndex_test.h"
+#include "KextBundleCache_test.h"
 #include "xml_lite-test.h"
 #include "config-test.h"
 #include "XToolsCommon_test.h"
@@ -27,6 +39,9 @@
 
 #if defined(JIEF_DEBUG) && defined(CLOVER_BUILD)
   #include "printlib-test.h"
+  #include "SVGGlyphCache_test.h"
+  #include "DsdtEditor_test.h"
+  #include "GpuCardTables_test.h"
 #endif
 
 
@@ -124,6 +139,11 @@ if ( ret != 0 ) {
     printf("printlib_tests() failed at test %d\n", ret);
     all_ok = false;
   }
+  ret = fnv_hash_tests();
+  if ( ret != 0 ) {
+    printf("fnv_hash_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
   ret = XArray_tests();
   if ( ret != 0 ) {
     printf("XArray_tests() failed at test %d\n", ret);
@@ -174,6 +194,82 @@ if ( ret != 0 ) {
     printf("MacOsVersion_tests() failed at test %d\n", ret);
     all_ok = false;
   }
+  ret = MachoSymbolIndex_tests();
+  if ( ret != 0 ) {
+    printf("MachoSymbolIndex_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = KextPatchIndex_tests();
+  if ( ret != 0 ) {
+    printf("KextPatchIndex_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = MultiPatternPatcher_tests();
+  if ( ret != 0 ) {
+    printf("MultiPatternPatcher_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = PrelinkInfoIndex_tests();
+  if ( ret != 0 ) {
+    printf("PrelinkInfoIndex_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#if defined(CLOVER_BUILD)
+  ret = DsdtEditor_tests();
+  if ( ret != 0 ) {
+    printf("DsdtEditor_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#endif
+  ret = VolumeDirCache_tests();
+  if ( ret != 0 ) {
+    printf("VolumeDirCache_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = XImageKernels_tests();
+  if ( ret != 0 ) {
+    printf("XImageKernels_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = SVGShapeIndex_tests();
+  if ( ret != 0 ) {
+    printf("SVGShapeIndex_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#if defined(CLOVER_BUILD)
+  ret = SVGGlyphCache_tests();
+  if ( ret != 0 ) {
+    printf("SVGGlyphCache_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#endif
+  ret = XThemeCache_tests();
+  if ( ret != 0 ) {
+    printf("XThemeCache_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = SpdSnapshot_tests();
+  if ( ret != 0 ) {
+    printf("SpdSnapshot_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+  ret = DeviceIdIndex_tests();
+  if ( ret != 0 ) {
+    printf("DeviceIdIndex_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#if defined(CLOVER_BUILD)
+  ret = GpuCardTables_tests();
+  if ( ret != 0 ) {
+    printf("GpuCardTables_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
+#endif
+  ret = KextBundleCache_tests();
+  if ( ret != 0 ) {
+    printf("KextBundleCache_tests() failed at test %d\n", ret);
+    all_ok = false;
+  }
 
 #endif
 
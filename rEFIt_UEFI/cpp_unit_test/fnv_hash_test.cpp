@@ -0,0 +1,50 @@
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "fnv_hash_test.h"
+#include "../cpp_foundation/fnv_hash.h"
+
+// Values given with the reference implementation
+static int knownValuesTests()
+{
+  if ( fnv1a32("", 0) != 0x811c9dc5U || fnv1a64("", 0) != 0xcbf29ce484222325ULL ) return 1;
+  if ( fnv1a32("a", 1) != 0xe40c292cU || fnv1a64("a", 1) != 0xaf63dc4c8601ec8cULL ) return 2;
+  if ( fnv1a32("foobar", 6) != 0xbf9cf968U || fnv1a64("foobar", 6) != 0x85944171f73967e8ULL ) return 3;
+  return 0;
+}
+
+static int chainTests()
+{
+  const char* a = "theme.svg content";
+  size_t len = strlen(a);
+  UINT64 h1 = fnv1a64(a, len);
+  if ( h1 == fnv1a64(a, len - 1) ) return 10;
+  // chained in two parts is the same as at once
+  if ( h1 != fnv1a64(a + 5, len - 5, fnv1a64(a, 5)) ) return 11;
+  if ( fnv1a32(a, len) != fnv1a32(a + 5, len - 5, fnv1a32(a, 5)) ) return 12;
+  if ( fnv1a64(NULL, 0) != Fnv1a64Seed || fnv1a32(NULL, 0) != Fnv1a32Seed ) return 13;
+  // a byte at a time
+  UINT32 h32 = Fnv1a32Seed;
+  for ( size_t i = 0 ; i < len ; ++i ) h32 = fnv1a32Byte(h32, (UINT8)a[i]);
+  if ( h32 != fnv1a32(a, len) ) return 14;
+  return 0;
+}
+
+// The steps are computed by the compiler, as for strHashIC() of a literal
+static int constexprTests()
+{
+  constexpr uint32_t okHash = fnv1a32Byte(fnv1a32Byte(Fnv1a32Seed, 'o'), 'k');
+  constexpr uint64_t okHash64 = fnv1a64Byte(fnv1a64Byte(Fnv1a64Seed, 'o'), 'k');
+  if ( okHash != fnv1a32("ok", 2) || okHash64 != fnv1a64("ok", 2) ) return 20;
+  return 0;
+}
+
+int fnv_hash_tests()
+{
+  int ret;
+  ret = knownValuesTests();
+  if ( ret != 0 ) return ret;
+  ret = chainTests();
+  if ( ret != 0 ) return ret;
+  ret = constexprTests();
+  if ( ret != 0 ) return ret;
+  return 0;
+}
@@ -0,0 +1 @@
+int fnv_hash_tests();
@@ -3,6 +3,40 @@
 #include "../cpp_foundation/unicode_conversions.h"
 #include "../Platform/plist/plist.h"
 
+// more keys than TagDict::MinSizeForKeyIndex, so they are found by the hash index
+static int dictKeysTests()
+{
+  TagDict* dict = NULL;
+  {
+    XString8 plist = "<plist><dict>"_XS8;
+    for (int i = 0 ; i < 40 ; i++ ) plist += S8Printf("<key>Key%d</key><integer>%d</integer>", i, i);
+    plist += "<key>KEY5</key><integer>100</integer>"_XS8; // same key ignoring case : the first one is used
+    plist += "<key>Orphan</key><key>Next</key><string>next value</string>"_XS8; // a key followed by a key has no value
+    plist += "</dict></plist>"_XS8;
+    if ( ParseXML(plist.c_str(), &dict, plist.length()) != EFI_SUCCESS || dict == NULL ) return 101;
+  } // the tags must not point into the parsed text
+  const TagStruct* tag = dict->propertyForKey("key17");
+  if ( tag == NULL || !tag->isInt64() || tag->getInt64()->intValue() != 17 ) return 102;
+  tag = dict->propertyForKey("KEY39");
+  if ( tag == NULL || !tag->isInt64() || tag->getInt64()->intValue() != 39 ) return 103;
+  tag = dict->propertyForKey("Key5");
+  if ( tag == NULL || !tag->isInt64() || tag->getInt64()->intValue() != 5 ) return 104;
+  if ( dict->propertyForKey("Orphan") != NULL ) return 105;
+  tag = dict->propertyForKey("next");
+  if ( tag == NULL || !tag->isString() || tag->getString()->stringValue() != "next value"_XS8 ) return 106;
+  if ( dict->propertyForKey("Key40") != NULL  ||  dict->propertyForKey("Key") != NULL  ||  dict->propertyForKey("") != NULL ) return 107;
+  dict->FreeTag();
+
+  // the same TagDict comes back from the free list, without the index of the previous content
+  const char* small = "<plist><dict><key>Key17</key><string>small</string></dict></plist>";
+  if ( ParseXML(small, &dict, strlen(small)) != EFI_SUCCESS || dict == NULL ) return 110;
+  tag = dict->propertyForKey("Key17");
+  if ( tag == NULL || !tag->isString() || tag->getString()->stringValue() != "small"_XS8 ) return 111;
+  if ( dict->propertyForKey("Key5") != NULL ) return 112;
+  dict->FreeTag();
+  return 0;
+}
+
 #ifndef _MSC_VER
 static const char* config_all =
 "<?xml version=\"1.0\" encoding=\"UTF-8\"?> \
@@ -910,6 +944,9 @@ kk</string> \
 
 int ParseXML_tests()
 {
+  int ret = dictKeysTests();
+  if ( ret != 0 ) return ret;
+
   TagDict* dict = NULL;
   EFI_STATUS Status = ParseXML(config_all, &dict, (UINT32)strlen(config_all));
   if ( !EFI_ERROR(Status) ) {
@@ -932,7 +969,7 @@ int ParseXML_tests()
 int ParseXML_tests()
 {
 	// TODO with VS, I get a string too big.
-	return 0;
+	return dictKeysTests();
 }
 
 #endif
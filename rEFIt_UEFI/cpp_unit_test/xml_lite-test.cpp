@@ -882,6 +882,80 @@ gXmlLiteParserTest.printfErrorsAndWarnings();
     return 0;
 }
 
+int dict_key_hash_tests()
+{
+  bool b;
+
+  // usable as a constant : the names in the m_fields arrays are hashed by the compiler
+  constexpr uint32_t bootHash = strHashIC("Boot");
+  if ( bootHash != strnHashIC("bOOT", 4) ) return breakpoint(1);
+  if ( strHashIC("KeyNameForBool") != strnHashIC("keynameforboolXX", 14) ) return breakpoint(2);
+  if ( strHashIC("KeyNameForBool") == strnHashIC("KeyNameForBoo", 13) ) return breakpoint(3);
+  if ( strHashIC("") != strnHashIC("", 0) ) return breakpoint(4);
+
+  class SubDictClass : public XmlDict
+  {
+    public:
+      XmlBool aBool {};
+      XmlDictField m_fields[1] = {
+          {"Enabled", aBool},
+      };
+      virtual void getFields(XmlDictField** fields, size_t* nb) override { *fields = m_fields; *nb = sizeof(m_fields)/sizeof(m_fields[0]); };
+  };
+
+  class MyDictClass : public XmlDict
+  {
+    public:
+      XmlBool aBool {};
+      XmlInt32 anInt32 {};
+      XmlString8 aString {};
+      SubDictClass subDict {};
+
+      XmlDictField m_fields[4] = {
+          {"KeyNameForBool", aBool},
+          {"KeyNameForInt32", anInt32},
+          {"KeyNameForString", aString},
+          {"SubDict", subDict},
+      };
+      virtual void getFields(XmlDictField** fields, size_t* nb) override { *fields = m_fields; *nb = sizeof(m_fields)/sizeof(m_fields[0]); };
+  } MyDict = MyDictClass();
+
+  // keys in another case, an unknown key in the sub dict : same values and messages as when the names were compared one by one
+  const char* config_test = R"V0G0N(
+   <dict>
+       <key>keynameforint32</key>
+       <integer>13864</integer>
+       <key>KEYNAMEFORBOOL</key>
+       <true/>
+       <key>KeyNameForStrin</key>
+       <string>not this one</string>
+       <key>KeyNameForString</key>
+       <string>a string</string>
+       <key>SubDict</key>
+       <dict>
+           <key>Unknown</key>
+           <true/>
+           <key>enabled</key>
+           <false/>
+       </dict>
+   </dict>
+  )V0G0N";
+
+  gXmlLiteParserTest.init(config_test);
+  gXmlLiteParserTest.moveForwardUntilSignificant();
+  b = MyDict.parseFromXmlLite(&gXmlLiteParserTest, "/"_XS8, true);
+  if ( !b ) return breakpoint(10);
+  if ( !MyDict.anInt32.isDefined() || MyDict.anInt32.value() != 13864 ) return breakpoint(11);
+  if ( !MyDict.aBool.isDefined() || MyDict.aBool.value() != true ) return breakpoint(12);
+  if ( !MyDict.aString.isDefined() || MyDict.aString.value() != "a string"_XS8 ) return breakpoint(13);
+  if ( !MyDict.subDict.aBool.isDefined() || MyDict.subDict.aBool.value() != false ) return breakpoint(14);
+  if ( gXmlLiteParserTest.getErrorsAndWarnings().size() != 2 ) return breakpoint(15);
+  if ( gXmlLiteParserTest.getErrorsAndWarnings()[0].msg != "Unknown key '/KeyNameForStrin:7'. Skipped."_XS8 ) return breakpoint(16);
+  if ( gXmlLiteParserTest.getErrorsAndWarnings()[1].msg != "Unknown key '/SubDict/Unknown:13'. Skipped."_XS8 ) return breakpoint(17);
+
+  return 0;
+}
+
 int xml_lite_tests()
 {
 
@@ -921,6 +995,9 @@ int xml_lite_tests()
   ret = validate_dict_tests();
   if ( ret ) return ret;
 
+  ret = dict_key_hash_tests();
+  if ( ret ) return ret;
+
   
   ret = xml_integer_tests();
   if ( ret ) return ret;
@@ -1441,7 +1441,7 @@ LOADER_ENTRY* AddLoaderEntry(IN CONST XStringW& LoaderPath, IN CONST XString8Arr
 {
   LOADER_ENTRY *Entry;
 
-  if ((LoaderPath.isEmpty()) || (Volume == NULL) || (Volume->RootDir == NULL) || !FileExists(Volume->RootDir, LoaderPath)) {
+  if ((LoaderPath.isEmpty()) || (Volume == NULL) || (Volume->RootDir == NULL) || !Volume->DirCache.fileExists(Volume->RootDir, LoaderPath)) {
     return NULL;
   }
 
@@ -1524,7 +1524,7 @@ STATIC void LinuxScan(REFIT_VOLUME *Volume, UINT8 KernelScan, UINT8 Type, XStrin
       XStringW File = SWPrintf("EFI\\%ls\\grubx64.efi", DirEntry->FileName);
       XStringW OSName = XStringW().takeValueFrom(DirEntry->FileName); // this is folder name, for example "ubuntu"
       OSName.lowerAscii(); // lowercase for icon name and title (first letter in title will be capitalized later)
-      if (FileExists(Volume->RootDir, File)) {
+      if (Volume->DirCache.fileExists(Volume->RootDir, File)) {
         // check if nonstandard icon mapping is needed
         for (Index = 0; Index < LinuxIconMappingCount; ++Index) {
           if (StrCmp(OSName.wc_str(),LinuxIconMapping[Index].DirectoryName) == 0) {
@@ -1560,7 +1560,7 @@ STATIC void LinuxScan(REFIT_VOLUME *Volume, UINT8 KernelScan, UINT8 Type, XStrin
 
     // check for non-standard grub path
     for (Index = 0; Index < LinuxEntryDataCount; ++Index) {
-      if (FileExists(Volume->RootDir, LinuxEntryData[Index].Path)) {
+      if (Volume->DirCache.fileExists(Volume->RootDir, LinuxEntryData[Index].Path)) {
         XStringW OSIconName = XStringW().takeValueFrom(LinuxEntryData[Index].Icon);
         OSIconName = OSIconName.subString(0, OSIconName.indexOf(','));
         XIcon ImageX = ThemeX.GetIcon(L"os_"_XSW + OSIconName);
@@ -1741,9 +1741,9 @@ void AddPRSEntry(REFIT_VOLUME *Volume)
   //CONST INTN Rock = 2;
   //CONST INTN Scissor = 4;
 
-  WhatBoot |= FileExists(Volume->RootDir, RockBoot)?Rock:0;
-  WhatBoot |= FileExists(Volume->RootDir, PaperBoot)?Paper:0;
-  WhatBoot |= FileExists(Volume->RootDir, ScissorBoot)?Scissor:0;
+  WhatBoot |= Volume->DirCache.fileExists(Volume->RootDir, RockBoot)?Rock:0;
+  WhatBoot |= Volume->DirCache.fileExists(Volume->RootDir, PaperBoot)?Paper:0;
+  WhatBoot |= Volume->DirCache.fileExists(Volume->RootDir, ScissorBoot)?Scissor:0;
   switch (WhatBoot) {
     case Paper:
     case (Paper | Rock):
@@ -1848,7 +1848,12 @@ void ScanLoader(void)
 {
   //DBG("Scanning loaders...\n");
   DbgHeader("ScanLoader");
-   
+
+  // Well-known paths are checked on every volume. Read each directory once instead of opening each path.
+  for (UINTN VolumeIndex = 0; VolumeIndex < Volumes.size(); VolumeIndex++) {
+    Volumes[VolumeIndex].DirCache.enable(Volumes[VolumeIndex].RootDir);
+  }
+
   for (UINTN VolumeIndex = 0; VolumeIndex < Volumes.size(); VolumeIndex++)
   {
     REFIT_VOLUME* Volume = &Volumes[VolumeIndex];
@@ -1876,15 +1881,15 @@ void ScanLoader(void)
 
     // check for Mac OS X Install Data
     // 1st stage - createinstallmedia
-    if (FileExists(Volume->RootDir, L"\\.IABootFiles\\boot.efi")) {
-      if (FileExists(Volume->RootDir, L"\\Install OS X Mavericks.app") ||
-          FileExists(Volume->RootDir, L"\\Install OS X Yosemite.app") ||
-          FileExists(Volume->RootDir, L"\\Install OS X El Capitan.app")) {
+    if (Volume->DirCache.fileExists(Volume->RootDir, L"\\.IABootFiles\\boot.efi")) {
+      if (Volume->DirCache.fileExists(Volume->RootDir, L"\\Install OS X Mavericks.app") ||
+          Volume->DirCache.fileExists(Volume->RootDir, L"\\Install OS X Yosemite.app") ||
+          Volume->DirCache.fileExists(Volume->RootDir, L"\\Install OS X El Capitan.app")) {
         AddLoaderEntry(L"\\.IABootFiles\\boot.efi"_XSW, NullXString8Array, L""_XSW, L"OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.9 - 10.11
       } else {
         AddLoaderEntry(L"\\.IABootFiles\\boot.efi"_XSW, NullXString8Array, L""_XSW, L"macOS Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.12 - 10.13.3
       }
-    } else if (FileExists(Volume->RootDir, L"\\.IAPhysicalMedia") && FileExists(Volume->RootDir, MACOSX_LOADER_PATH)) {
+    } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\.IAPhysicalMedia") && Volume->DirCache.fileExists(Volume->RootDir, MACOSX_LOADER_PATH)) {
       AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"macOS Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.13.4+
     }
     // 2nd stage - InstallESD/AppStore/startosinstall/Fusion Drive
@@ -1904,26 +1909,26 @@ void ScanLoader(void)
     AddLoaderEntry(L"\\NetInstall macOS High Sierra.nbi\\i386\\booter"_XSW, NullXString8Array, L""_XSW, L"macOS Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0);
     // Use standard location for boot.efi, according to the install files is present
     // That file indentifies a DVD/ESD/BaseSystem/Fusion Drive Install Media, so when present, check standard path to avoid entry duplication
-    if (FileExists(Volume->RootDir, MACOSX_LOADER_PATH)) {
-      if (FileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\Mac OS X Installer.app")) {
+    if (Volume->DirCache.fileExists(Volume->RootDir, MACOSX_LOADER_PATH)) {
+      if (Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\Mac OS X Installer.app")) {
         // InstallDVD/BaseSystem
         AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"Mac OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.6/10.7
-      } else if (FileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\OS X Installer.app")) {
+      } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\OS X Installer.app")) {
         // BaseSystem
         AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.8 - 10.11
-      } else if (FileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\macOS Installer.app")) {
+      } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Installation\\CDIS\\macOS Installer.app")) {
         // BaseSystem
         AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"macOS Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.12+
-      } else if (FileExists(Volume->RootDir, L"\\BaseSystem.dmg") && FileExists(Volume->RootDir, L"\\mach_kernel")) {
+      } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\BaseSystem.dmg") && Volume->DirCache.fileExists(Volume->RootDir, L"\\mach_kernel")) {
         // InstallESD
-        if (FileExists(Volume->RootDir, L"\\MacOSX_Media_Background.png")) {
+        if (Volume->DirCache.fileExists(Volume->RootDir, L"\\MacOSX_Media_Background.png")) {
           AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"Mac OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.7
         } else {
           AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.8
         }
-      } else if (FileExists(Volume->RootDir, L"\\com.apple.boot.R\\System\\Library\\PrelinkedKernels\\prelinkedkernel") ||
-                 FileExists(Volume->RootDir, L"\\com.apple.boot.P\\System\\Library\\PrelinkedKernels\\prelinkedkernel") ||
-                 FileExists(Volume->RootDir, L"\\com.apple.boot.S\\System\\Library\\PrelinkedKernels\\prelinkedkernel")) {
+      } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\com.apple.boot.R\\System\\Library\\PrelinkedKernels\\prelinkedkernel") ||
+                 Volume->DirCache.fileExists(Volume->RootDir, L"\\com.apple.boot.P\\System\\Library\\PrelinkedKernels\\prelinkedkernel") ||
+                 Volume->DirCache.fileExists(Volume->RootDir, L"\\com.apple.boot.S\\System\\Library\\PrelinkedKernels\\prelinkedkernel")) {
         if (StriStr(Volume->VolName.wc_str(), L"Recovery") != NULL) {
           // FileVault of HFS+
           // TODO: need info for 10.11 and lower
@@ -1932,12 +1937,12 @@ void ScanLoader(void)
           // Fusion Drive
           AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"OS X Install"_XSW, Volume, NULL, OSTYPE_OSX_INSTALLER, 0); // 10.11
         }
-      } else if (!FileExists(Volume->RootDir, L"\\.IAPhysicalMedia")) {
+      } else if (!Volume->DirCache.fileExists(Volume->RootDir, L"\\.IAPhysicalMedia")) {
         // Installed
         if (EFI_ERROR(GetRootUUID(Volume)) || isFirstRootUUID(Volume)) {
-          if (!FileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\NotificationCenter.app") && !FileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\Siri.app")) {
+          if (!Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\NotificationCenter.app") && !Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\Siri.app")) {
             AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"Mac OS X"_XSW, Volume, NULL, OSTYPE_OSX, 0); // 10.6 - 10.7
-          } else if (FileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\NotificationCenter.app") && !FileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\Siri.app")) {
+          } else if (Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\NotificationCenter.app") && !Volume->DirCache.fileExists(Volume->RootDir, L"\\System\\Library\\CoreServices\\Siri.app")) {
             AddLoaderEntry(MACOSX_LOADER_PATH, NullXString8Array, L""_XSW, L"OS X"_XSW, Volume, NULL, OSTYPE_OSX, 0); // 10.8 - 10.11
           } else {
             MacOsVersion macOSVersion;
@@ -1979,10 +1984,10 @@ void ScanLoader(void)
       // check for Android loaders
       for (UINTN Index = 0; Index < AndroidEntryDataCount; ++Index) {
         UINTN aIndex, aFound;
-      if (FileExists(Volume->RootDir, AndroidEntryData[Index].Path)) {
+      if (Volume->DirCache.fileExists(Volume->RootDir, AndroidEntryData[Index].Path)) {
           aFound = 0;
           for (aIndex = 0; aIndex < ANDX86_FINDLEN; ++aIndex) {
-            if ((AndroidEntryData[Index].Find[aIndex].isEmpty()) || FileExists(Volume->RootDir, AndroidEntryData[Index].Find[aIndex])) ++aFound;
+            if ((AndroidEntryData[Index].Find[aIndex].isEmpty()) || Volume->DirCache.fileExists(Volume->RootDir, AndroidEntryData[Index].Find[aIndex])) ++aFound;
           }
           if (aFound && (aFound == aIndex)) {
             XIcon ImageX;
@@ -2078,7 +2083,7 @@ void ScanLoader(void)
             CHAR8*  fileBuffer;
             UINTN   fileLen = 0;
             targetNameFile.SWPrintf("%s\\System\\Library\\CoreServices\\.disk_label.contentDetails", ApfsTargetUUID.c_str());
-            if ( FileExists(bootVolume->RootDir, targetNameFile) ) {
+            if ( bootVolume->DirCache.fileExists(bootVolume->RootDir, targetNameFile) ) {
               EFI_STATUS Status = egLoadFile(bootVolume->RootDir, targetNameFile.wc_str(), (UINT8 **)&fileBuffer, &fileLen);
               if(!EFI_ERROR(Status)) {
                 FullTitle.SWPrintf("Boot Mac OS from %.*s", (int)fileLen, fileBuffer);
@@ -2119,7 +2124,7 @@ void ScanLoader(void)
         if ( macOSVersion.notEmpty() && macOSVersion < MacOsVersion("11"_XS8) )*/ FullTitleInstaller.SWCatf(" via %ls", Volume->getVolLabelOrOSXVolumeNameOrVolName().wc_str());
 
         XString8 installerPath = SWPrintf("\\%s\\com.apple.installer", Volume->ApfsTargetUUIDArray[i].c_str());
-        if ( FileExists(Volume->RootDir, installerPath) ) {
+        if ( Volume->DirCache.fileExists(Volume->RootDir, installerPath) ) {
           XString8 rootDmg = GetAuthRootDmg(*Volume->RootDir, installerPath);
           rootDmg.replaceAll("%20"_XS8, " "_XS8);
 //          while ( rootDmg.notEmpty()  &&  rootDmg.startWith('/') ) rootDmg.deleteCharsAtPos(0, 1);
@@ -2129,7 +2134,7 @@ void ScanLoader(void)
             EFI_FILE_PROTOCOL* TestFile;
             EFI_STATUS Status = targetInstallVolume->RootDir->Open(targetInstallVolume->RootDir, &TestFile, L"\\", EFI_FILE_MODE_READ, 0);
             if ( EFI_ERROR(Status) ) TestFile = NULL; // if the root of the volume can't be opened (most likely encrypted), add the installer anyway.
-            if ( rootDmg.isEmpty()  ||  EFI_ERROR(Status)  ||  FileExists(*targetInstallVolume->RootDir, rootDmg) ) { // rootDmg empty is accepted, to be compatible with previous code
+            if ( rootDmg.isEmpty()  ||  EFI_ERROR(Status)  ||  targetInstallVolume->DirCache.fileExists(targetInstallVolume->RootDir, rootDmg) ) { // rootDmg empty is accepted, to be compatible with previous code
               AddLoaderEntry(SWPrintf("\\%s\\com.apple.installer\\boot.efi", Volume->ApfsTargetUUIDArray[i].c_str()), NullXString8Array, FullTitleInstaller, LoaderTitleInstaller, Volume, NULL, OSTYPE_OSX_INSTALLER, 0);
             }else{
               DBG("    Dead installer entry found (installer dmg boot file not found : '%s')\n", rootDmg.c_str());
@@ -2143,6 +2148,10 @@ void ScanLoader(void)
     }
   }
 
+  for (UINTN VolumeIndex = 0; VolumeIndex < Volumes.size(); VolumeIndex++) {
+    Volumes[VolumeIndex].DirCache.setEmpty();
+  }
+
   DBG("Entries list before ordering\n");
   for (size_t idx = 0; idx < MainMenu.Entries.sizeIncludingHidden(); idx++) {
     if ( MainMenu.Entries.ElementAt(idx).getLOADER_ENTRY() ) {
@@ -212,7 +212,11 @@ void REFIT_MENU_SCREEN::DrawTextCorner(UINTN TextC, UINT8 Align)
   DrawTextXY(Text, Xpos, UGAHeight - (INTN)(ThemeX.TextHeight * 1.5f), Align);
 }
 
-void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry, BOOLEAN selected, INTN XPos, INTN YPos)
+/*
+ * Compose background, selection, icon and badge of Entry at XPos,YPos into Tile.
+ * MainIconP is the icon of the entry to show, maybe empty.
+ */
+static void ComposeMainMenuTile(REFIT_ABSTRACT_MENU_ENTRY *Entry, BOOLEAN selected, INTN XPos, INTN YPos, XIcon* MainIconP, bool Night, MainMenuTile* Tile)
 {
   INTN MainSize = ThemeX.MainEntriesSize;
 //  XImage MainImage(MainSize, MainSize);
@@ -220,14 +224,10 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
   XIcon MainIcon;  //it can be changed here
   XIcon* BadgeIcon = NULL;
 
-  if (Entry->Row == 0 && Entry->getDriveImage()  &&  !(ThemeX.HideBadges & HDBADGES_SWAP)) {
-    MainIcon = *Entry->getDriveImage();
-  } else {
-    MainIcon = Entry->Image; // XIcon*
-  }
   //this should be inited by the Theme
-  if (MainIcon.isEmpty()) {
+  if (MainIconP->isEmpty()) {
  //   DBG(" why MainImage is empty? Report to devs\n");
+    MainIcon = *MainIconP;
     if (!ThemeX.IsEmbeddedTheme()) {
       MainIcon = ThemeX.GetIcon("os_mac"_XS8);
     }
@@ -235,11 +235,12 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
       MainIcon.Image.DummyImage(MainSize);
       MainIcon.setFilled();
     }
+    MainIconP = &MainIcon;
   }
 
 //  const XImage& MainImage = (!ThemeX.Daylight && !MainIcon.ImageNight.isEmpty())? MainIcon.ImageNight : MainIcon.Image;
   bool free = false;
-  XImage *MainImage = MainIcon.GetBest(!Daylight, &free);
+  XImage *MainImage = MainIconP->GetBest(Night, &free);
 
   INTN CompWidth = (Entry->Row == 0) ? ThemeX.row0TileSize : ThemeX.row1TileSize;
   INTN CompHeight = CompWidth;
@@ -261,7 +262,8 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
     CompWidth = TopImage.GetWidth();
     CompHeight = CompWidth;
   }
-  XImage Back(CompWidth, CompHeight);
+  XImage& Back = Tile->Image;
+  Back = XImage(CompWidth, CompHeight);
   Back.CopyRect(ThemeX.Background, XPos, YPos);
 
   INTN OffsetX = (CompWidth - MainImage->GetWidth()) / 2;
@@ -284,11 +286,11 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
     Back.Compose(OffsetTX, OffsetTY, TopImage, false); //selection first
     Back.Compose(OffsetX, OffsetY, *MainImage, false, composeScale);
   }
-  
-  Entry->Place.XPos = XPos;
-  Entry->Place.YPos = YPos;
-  Entry->Place.Width = MainImage->GetWidth();
-  Entry->Place.Height = MainImage->GetHeight();
+
+  Tile->Place.XPos = XPos;
+  Tile->Place.YPos = YPos;
+  Tile->Place.Width = MainImage->GetWidth();
+  Tile->Place.Height = MainImage->GetHeight();
 
   if (free) {
     delete MainImage;
@@ -298,7 +300,7 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
   if ((Entry->Row == 0) && BadgeIcon && !BadgeIcon->isEmpty()) {
 //    const XImage& BadgeImage = (!ThemeX.Daylight && !BadgeIcon->ImageNight.isEmpty()) ? &BadgeIcon->ImageNight : BadgeImage = &BadgeIcon->Image;
     free = false;
-    XImage* BadgeImage = BadgeIcon->GetBest(!Daylight, &free);
+    XImage* BadgeImage = BadgeIcon->GetBest(Night, &free);
     INTN BadgeWidth = (INTN)(BadgeImage->GetWidth() * fBadgeScale);
     INTN BadgeHeight = (INTN)(BadgeImage->GetHeight() * fBadgeScale);
     
@@ -320,14 +322,37 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
       }
  //     DBG("  badge offset=[%lld,%lld]\n", OffsetX, OffsetY);
       Back.Compose(OffsetX, OffsetY, *BadgeImage, false, fBadgeScale);
-      if (free) delete BadgeImage;
     }
+    if (free) delete BadgeImage;
   }
 
   if(ThemeX.SelectionOnTop) {
     Back.Compose(OffsetTX, OffsetTY, TopImage, false); //selection at the top
   }
-  Back.DrawWithoutCompose(XPos, YPos);
+}
+
+void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry, BOOLEAN selected, INTN XPos, INTN YPos)
+{
+  XIcon* MainIconP;  //the entry's own, not copied
+
+  if (Entry->Row == 0 && Entry->getDriveImage()  &&  !(ThemeX.HideBadges & HDBADGES_SWAP)) {
+    MainIconP = Entry->getDriveImage();
+  } else {
+    MainIconP = &Entry->Image;
+  }
+
+  // moving the selection only draws again the two tiles composed before
+  MainMenuTile& Tile = Entry->Tiles[selected ? 1 : 0];
+  if (!Tile.isFor(ThemeX.BackgroundGeneration, XPos, YPos, !Daylight, MainIconP)) {
+    ComposeMainMenuTile(Entry, selected, XPos, YPos, MainIconP, !Daylight, &Tile);
+    Tile.Generation = ThemeX.BackgroundGeneration;
+    Tile.XPos = XPos;
+    Tile.YPos = YPos;
+    Tile.Night = !Daylight;
+    Tile.Icon = MainIconP;
+  }
+  Entry->Place = Tile.Place;
+  Tile.Image.DrawWithoutCompose(XPos, YPos);
 
 
   // draw BCS indicator
@@ -338,9 +363,9 @@ void REFIT_MAINMENU_SCREEN::DrawMainMenuEntry(REFIT_ABSTRACT_MENU_ENTRY *Entry,
       const XImage& SelImage = ThemeX.SelectionImages[4 + (selected ? 0 : 1)];
       XPos = XPos + (ThemeX.row0TileSize / 2) - (INTN)(INDICATOR_SIZE * 0.5f * ThemeX.Scale);
       YPos = row0PosY + ThemeX.row0TileSize + ThemeX.TextHeight + (INTN)((BCSMargin * 2) * ThemeX.Scale);
-      CompWidth = (INTN)(INDICATOR_SIZE * ThemeX.Scale);
-      CompHeight = (INTN)(INDICATOR_SIZE * ThemeX.Scale);
-      Back = XImage(CompWidth, CompHeight);
+      INTN CompWidth = (INTN)(INDICATOR_SIZE * ThemeX.Scale);
+      INTN CompHeight = (INTN)(INDICATOR_SIZE * ThemeX.Scale);
+      XImage Back(CompWidth, CompHeight);
       Back.CopyRect(ThemeX.Background, XPos, YPos);
       Back.Compose(0, 0, SelImage, false);
       Back.DrawWithoutCompose(XPos, YPos);
@@ -49,6 +49,7 @@
 //#include "screen.h"
 #include "../cpp_foundation/XString.h"
 #include "../libeg/XTheme.h"
+#include "../libeg/XScreenShadow.h"
 #include "../libeg/VectorGraphics.h" // for testSVG
 #include "shared_with_menu.h"
 #include "../refit/menu.h"  // for DrawTextXY. Must disappear soon.
@@ -768,6 +769,7 @@ UINTN REFIT_MENU_SCREEN::RunGenericMenu(IN OUT INTN *DefaultEntryIndex, OUT REFI
 
 
     // update the screen
+    ScreenShadow.beginUpdate();
     if (ScrollState.PaintAll) {
       call_MENU_FUNCTION_PAINT_ALL(NULL);
       ScrollState.PaintAll = FALSE;
@@ -780,6 +782,7 @@ UINTN REFIT_MENU_SCREEN::RunGenericMenu(IN OUT INTN *DefaultEntryIndex, OUT REFI
       XStringW TOMessage = SWPrintf("%ls in %lld seconds", TimeoutText.wc_str(), TimeoutCountdown);
       call_MENU_FUNCTION_PAINT_TIMEOUT(TOMessage.wc_str());
     }
+    ScreenShadow.endUpdate();
 
     if (gEvent) { //for now used at CD eject.
       MenuExit = MENU_EXIT_ESCAPE;
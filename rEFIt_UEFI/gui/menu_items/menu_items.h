@@ -37,6 +37,8 @@
 
 #include <Efi.h>
 #include "../../Platform/KERNEL_AND_KEXT_PATCHES.h"
+#include "../../Platform/MachoSymbolIndex.h"
+#include "../../Platform/KextPatchIndex.h"
 #include "../../Platform/plist/plist.h"
 #include "../../libeg/libeg.h"
 #include "../../libeg/XIcon.h"
@@ -91,6 +93,7 @@ class REFIT_MENU_ITEM_ABOUT;
 class REFIT_MENU_ITEM_OPTIONS;
 class REFIT_MENU_ITEM_ABSTRACT_ENTRY_LOADER;
 class LOADER_ENTRY;
+class MultiPatternPatcher;
 class LEGACY_ENTRY;
 class REFIT_MENU_ENTRY_OTHER;
 class REFIT_SIMPLE_MENU_ENTRY_TAG;
@@ -101,6 +104,25 @@ class SIDELOAD_KEXT;
 
 /**********************************************************  REFIT_ABSTRACT_MENU_ENTRY  *************************************************************/
 
+// The tile composed by DrawMainMenuEntry() (background, selection, icon and badge), drawn again as is
+// while the theme, the place, the icon and day/night are the same
+class MainMenuTile
+{
+public:
+  XImage       Image = XImage();
+  UINTN        Generation = 0; // ThemeX.BackgroundGeneration when composed, 0 if never
+  INTN         XPos = 0;
+  INTN         YPos = 0;
+  bool         Night = false;
+  const XIcon* Icon = NULL;
+  EG_RECT      Place = EG_RECT(); // Entry->Place set by the compose
+
+  bool isFor(UINTN aGeneration, INTN aXPos, INTN aYPos, bool aNight, const XIcon* aIcon) const
+  {
+    return Generation != 0 && Generation == aGeneration && XPos == aXPos && YPos == aYPos && Night == aNight && Icon == aIcon;
+  }
+};
+
 class REFIT_ABSTRACT_MENU_ENTRY
 {
   public:
@@ -116,6 +138,7 @@ class REFIT_ABSTRACT_MENU_ENTRY
   ACTION             AtRightClick = ActionNone;
   ACTION             AtMouseOver = ActionNone;
   REFIT_MENU_SCREEN *SubScreen = NULL;
+  MainMenuTile       Tiles[2]; // not selected, selected
 
   virtual XIcon* getDriveImage() { return nullptr; };
   virtual XIcon* getBadgeImage() { return nullptr; };
@@ -372,6 +395,9 @@ class REFIT_ABSTRACT_MENU_ENTRY
         UINT32            NamesTable;
         INT32             SegVAddr;
         INT32             shift;
+        MachoSymbolIndex  KernelSymbolIndex; // built on first searchProc()
+        MachoSymbolIndex  DriverSymbolIndex; // last kext searched by searchProcInDriver()
+        KextPatchIndex    KextPatchesIndex;  // KextPatches by kext name, built on first PatchKext()
         BOOLEAN           PatcherInited;
         BOOLEAN           gSNBEAICPUFixRequire; // SandyBridge-E AppleIntelCpuPowerManagement patch require or not
         BOOLEAN           gBDWEIOPCIFixRequire; // Broadwell-E IOPCIFamily fix require or not
@@ -405,7 +431,7 @@ class REFIT_ABSTRACT_MENU_ENTRY
 						: REFIT_MENU_ITEM_BOOTNUM(), APFSTargetUUID(), DisplayedVolName(), DevicePath(0), Flags(0), LoaderType(0), macOSVersion(), BuildVersion(),
               BootBgColor({0,0,0,0}),
               CustomBoot(0), CustomLogo(), KernelAndKextPatches(), Settings(), KernelData(0),
-              AddrVtable(0), SizeVtable(0), NamesTable(0), SegVAddr(0), shift(0),
+              AddrVtable(0), SizeVtable(0), NamesTable(0), SegVAddr(0), shift(0), KernelSymbolIndex(), DriverSymbolIndex(), KextPatchesIndex(),
               PatcherInited(false), gSNBEAICPUFixRequire(false), gBDWEIOPCIFixRequire(false), isKernelcache(false), is64BitKernel(false),
               KernelSlide(0), KernelOffset(0), PrelinkTextLoadCmdAddr(0), PrelinkTextAddr(0), PrelinkTextSize(0),
               PrelinkInfoLoadCmdAddr(0), PrelinkInfoAddr(0), PrelinkInfoSize(0),
@@ -462,6 +488,8 @@ class REFIT_ABSTRACT_MENU_ENTRY
         void      PatchLoadedKexts();
         void      PatchKext(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist, UINT32 InfoPlistSize);
         void      AnyKextPatch(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist, UINT32 InfoPlistSize, size_t N);
+        BOOLEAN   AddKextPatchToBatch(MultiPatternPatcher& Patcher, UINT8 *Driver, UINT32 DriverSize, size_t N);
+        void      ApplyKextPatchBatch(MultiPatternPatcher& Patcher, UINT8 *Driver, UINT32 DriverSize);
         void      ATIConnectorsPatchInit();
         void      ATIConnectorsPatch(UINT8 *Driver, UINT32 DriverSize, CHAR8 *InfoPlist, UINT32 InfoPlistSize);
         void      ATIConnectorsPatchRegisterKexts(void *FSInject_v, void *ForceLoadKexts_v);
@@ -488,9 +516,7 @@ class REFIT_ABSTRACT_MENU_ENTRY
         void DelegateKernelPatches();
         
         BOOLEAN checkOSBundleRequired(const TagDict* dict);
-        XStringW getKextPlist(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry, BOOLEAN* NoContents);
-        TagDict* getInfoPlist(const XStringW& infoPlistPath);
-        XString8 getKextExecPath(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry, TagDict* dict, BOOLEAN NoContents);
+        XString8 getKextExecPath(const XStringW& dirPath, const SIDELOAD_KEXT& KextEntry);
 			} ;
 
 
@@ -0,0 +1,216 @@
+/*
+ * SVGGlyphCache.cpp
+ *
+ * See SVGGlyphCache.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SVGGlyphCache.h"
+
+#ifndef DEBUG_ALL
+#define DEBUG_GLYPH 0
+#else
+#define DEBUG_GLYPH DEBUG_ALL
+#endif
+
+#if DEBUG_GLYPH == 0
+#define DBG(...)
+#else
+#define DBG(...) DebugLog(DEBUG_GLYPH, __VA_ARGS__)
+#endif
+
+// a glyph bigger than that is certainly a broken font
+#define MAX_GLYPH_SIZE 1024
+
+SVGGlyphCache GlyphCache;
+
+
+static INTN FloorToInt(float v)
+{
+  INTN i = (INTN)v;
+  return (v < (float)i) ? i - 1 : i;
+}
+
+// same as nanosvgrast
+static inline int div255(int x)
+{
+  return ((x+1) * 257) >> 16;
+}
+
+SVGGlyphCache::~SVGGlyphCache()
+{
+  if (Rast) {
+    nsvgDeleteRasterizer(Rast);
+  }
+}
+
+size_t SVGGlyphCache::hash(NSVGfont* Font, float Scale, UINT32 Color, CHAR16 Letter, int SubX)
+{
+  UINT32 ScaleBits;
+  CopyMem(&ScaleBits, &Scale, sizeof(ScaleBits));
+  size_t h = (size_t)(UINTN)Font >> 4;
+  h = h * 31 + ScaleBits;
+  h = h * 31 + Color;
+  h = h * 31 + (size_t)SubX;
+  // consecutive letters in consecutive slots
+  return h * 8 + Letter;
+}
+
+bool SVGGlyphCache::render(GlyphMask& Mask)
+{
+  NSVGfont* Font = Mask.Font;
+  float Scale = Mask.Scale;
+
+  Mask.Advance = 0.f;
+  Mask.Left = 0;
+  Mask.Top = 0;
+  Mask.Pixels.setEmpty();
+
+  // same choice as addLetter()
+  NSVGglyph* g = nsvg__findGlyph(Font, Mask.Letter);
+  if (!g) {
+    g = Font->missingGlyph;
+  }
+  if (!g) {
+    return true;
+  }
+  Mask.Advance = g->horizAdvX * Scale;
+  if (!g->path) {
+    return true;
+  }
+
+  // the curves stay inside their control points
+  float MinX = 0.f, MinY = 0.f, MaxX = 0.f, MaxY = 0.f;
+  bool Found = false;
+  for (NSVGpath* path = g->path; path; path = path->next) {
+    for (int i = 0; i < path->npts; i++) {
+      float px = path->pts[i*2];
+      float py = path->pts[i*2+1];
+      if (!Found) {
+        MinX = MaxX = px;
+        MinY = MaxY = py;
+        Found = true;
+      } else {
+        MinX = MIN(MinX, px);
+        MaxX = MAX(MaxX, px);
+        MinY = MIN(MinY, py);
+        MaxY = MAX(MaxY, py);
+      }
+    }
+  }
+  if (!Found) {
+    return true;
+  }
+
+  // glyph point gx,gy goes to pen + SubX/SubPixels + Scale*gx, posY + Scale*(bbox[3] - gy). Keep a pixel around for antialiasing
+  float SubXf = (float)Mask.SubX / SubPixels;
+  Mask.Left = FloorToInt(Scale * MinX + SubXf) - 1;
+  Mask.Top = FloorToInt(Scale * (Font->bbox[3] - MaxY)) - 1;
+  INTN Width = FloorToInt(Scale * MaxX + SubXf) + 2 - Mask.Left;
+  INTN Height = FloorToInt(Scale * (Font->bbox[3] - MinY)) + 2 - Mask.Top;
+  if (Width <= 0 || Height <= 0 || Width > MAX_GLYPH_SIZE || Height > MAX_GLYPH_SIZE) {
+    DBG("glyph %X has wrong size %lldx%lld\n", Mask.Letter, Width, Height);
+    Mask.Left = 0;
+    Mask.Top = 0;
+    return true;
+  }
+
+  if (!Rast) {
+    Rast = nsvgCreateRasterizer();
+    if (!Rast) {
+      return false;
+    }
+  }
+  NSVGparser* p = nsvg__createParser();
+  if (!p) {
+    return false;
+  }
+  NSVGtext* text = (NSVGtext*)AllocateZeroPool(sizeof(NSVGtext));
+  if (!text) {
+    nsvg__deleteParser(p);
+    return false;
+  }
+  text->font = Font;
+  text->fontColor = Mask.Color;
+  text->fontSize = Scale * (Font->bbox[3] - Font->bbox[1]);
+  nsvg__xformIdentity(text->xform);
+  p->text = text;
+  p->isText = TRUE;
+
+  // addLetter() at 0,0 puts the glyph origin at -bbox[0]*Scale, bbox[3]*Scale
+  addLetter(p, Mask.Letter, 0.f, 0.f, Scale, Mask.Color);
+  Mask.Pixels.setSizeInPixels(Width, Height);
+  Mask.Pixels.Fill();
+  nsvgRasterizePremultiplied(Rast, p->image, SubXf - (float)Mask.Left + Font->bbox[0] * Scale, -(float)Mask.Top, 1.f, 1.f,
+                             (UINT8*)Mask.Pixels.GetPixelPtr(0,0), (int)Width, (int)Height, (int)(Width*4));
+
+  p->text = NULL;
+  FreePool(text);
+  nsvg__deleteParser(p);
+  return true;
+}
+
+const SVGGlyphCache::GlyphMask* SVGGlyphCache::getGlyph(NSVGfont* Font, float Scale, UINT32 Color, CHAR16 Letter, int SubX)
+{
+  if (!Font || Scale == 0.f) {
+    return NULL;
+  }
+  GlyphMask& Mask = Slots[hash(Font, Scale, Color, Letter, SubX) & (NbSlots - 1)];
+  if (Mask.Used && Mask.Font == Font && Mask.Scale == Scale && Mask.Color == Color && Mask.Letter == Letter && Mask.SubX == SubX) {
+    return &Mask;
+  }
+  Mask.Font = Font;
+  Mask.Scale = Scale;
+  Mask.Color = Color;
+  Mask.Letter = Letter;
+  Mask.SubX = SubX;
+  Mask.Used = render(Mask);
+  return Mask.Used ? &Mask : NULL;
+}
+
+void SVGGlyphCache::blend(const GlyphMask& Mask, XImage& Buffer, INTN PenX, INTN PosY)
+{
+  INTN MaskWidth = Mask.Pixels.GetWidth();
+  INTN MaskHeight = Mask.Pixels.GetHeight();
+  if (MaskWidth == 0 || MaskHeight == 0) {
+    return;
+  }
+  INTN X = PenX + Mask.Left;
+  INTN Y = PosY + Mask.Top;
+  INTN FromX = MAX(0, -X);
+  INTN FromY = MAX(0, -Y);
+  INTN ToX = MIN(MaskWidth, (INTN)Buffer.GetWidth() - X);
+  INTN ToY = MIN(MaskHeight, (INTN)Buffer.GetHeight() - Y);
+  if (FromX >= ToX || FromY >= ToY) {
+    return; // outside of the buffer, the pixel pointers would be out of it too
+  }
+
+  for (INTN j = FromY; j < ToY; j++) {
+    const UINT8* src = (const UINT8*)Mask.Pixels.GetPixelPtr(FromX, j);
+    UINT8* dst = (UINT8*)Buffer.GetPixelPtr(X + FromX, Y + j);
+    for (INTN i = FromX; i < ToX; i++, src += 4, dst += 4) {
+      int ia = 255 - src[3];
+      if (ia == 255) {
+        continue; // premultiplied : nothing to add
+      }
+      // blend over, as nsvg__scanlineSolid
+      dst[0] = (UINT8)(src[0] + div255(ia * dst[0]));
+      dst[1] = (UINT8)(src[1] + div255(ia * dst[1]));
+      dst[2] = (UINT8)(src[2] + div255(ia * dst[2]));
+      dst[3] = (UINT8)(src[3] + div255(ia * dst[3]));
+    }
+  }
+}
+
+void SVGGlyphCache::setEmpty()
+{
+  for (size_t idx = 0; idx < NbSlots; ++idx) {
+    Slots[idx].Used = false;
+    Slots[idx].Font = NULL;
+    Slots[idx].Pixels.setEmpty();
+  }
+  if (Rast) {
+    nsvgDeleteRasterizer(Rast);
+    Rast = NULL;
+  }
+}
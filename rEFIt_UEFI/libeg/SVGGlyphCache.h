@@ -0,0 +1,74 @@
+/*
+ * SVGGlyphCache.h
+ *
+ * Glyphs of SVG fonts already rasterized by renderSVGtext().
+ * A glyph is rasterized once for a font, a size, a color and a horizontal position inside the pixel,
+ * and kept premultiplied with its advance. A string is then drawn by blending the masks in the text buffer,
+ * without a parser and a rasterizer for each string.
+ *
+ * The pen position is rounded to 1/SubPixels of a pixel, the rest is exactly what nsvgRasterize() did.
+ * The cache must be emptied when the fonts are freed : a new font may get the address of an old one.
+ */
+
+#ifndef LIBEG_SVGGLYPHCACHE_H_
+#define LIBEG_SVGGLYPHCACHE_H_
+
+#include "XImage.h"
+#include "nanosvg.h"
+
+
+class SVGGlyphCache
+{
+public:
+  static const size_t NbSlots = 512; // power of 2, one glyph by slot
+  static const int SubPixels = 4;
+
+  class GlyphMask
+  {
+  public:
+    NSVGfont* Font = NULL;
+    float     Scale = 0.f;
+    UINT32    Color = 0;
+    CHAR16    Letter = 0;
+    int       SubX = 0;
+    bool      Used = false;
+
+    float     Advance = 0.f; // pen move in pixels
+    INTN      Left = 0;      // Pixels position relative to the pen pixel and to posY of renderSVGtext()
+    INTN      Top = 0;
+    XImage    Pixels = XImage(); // premultiplied, empty for a glyph without path
+
+    GlyphMask() {}
+    GlyphMask(const GlyphMask&) = delete;
+    GlyphMask& operator=(const GlyphMask&) = delete;
+  };
+
+protected:
+  GlyphMask       Slots[NbSlots];
+  NSVGrasterizer* Rast = NULL;
+
+  static size_t hash(NSVGfont* Font, float Scale, UINT32 Color, CHAR16 Letter, int SubX);
+  bool render(GlyphMask& Mask);
+
+public:
+  SVGGlyphCache() {}
+  SVGGlyphCache(const SVGGlyphCache&) = delete;
+  SVGGlyphCache& operator=(const SVGGlyphCache&) = delete;
+  ~SVGGlyphCache();
+
+  /*
+   * The glyph of Letter drawn with pen at SubX/SubPixels of a pixel, in Font scaled by Scale (pixels by font unit).
+   * NULL if it cannot be rendered. Valid until the next call.
+   */
+  const GlyphMask* getGlyph(NSVGfont* Font, float Scale, UINT32 Color, CHAR16 Letter, int SubX);
+
+  // Blend Mask over the premultiplied Buffer, pen at PenX pixel, text top at PosY
+  static void blend(const GlyphMask& Mask, XImage& Buffer, INTN PenX, INTN PosY);
+
+  void setEmpty();
+};
+
+extern SVGGlyphCache GlyphCache;
+
+
+#endif /* LIBEG_SVGGLYPHCACHE_H_ */
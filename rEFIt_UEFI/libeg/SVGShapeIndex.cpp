@@ -0,0 +1,125 @@
+/*
+ * SVGShapeIndex.cpp
+ *
+ * See SVGShapeIndex.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "SVGShapeIndex.h"
+
+SVGShapeIndex ShapeIndex;
+
+size_t SVGShapeIndex::hash(const char* Id)
+{
+  // djb2
+  size_t h = 5381;
+  while (*Id) {
+    h = h * 33 + (unsigned char)*Id++;
+  }
+  return h;
+}
+
+size_t SVGShapeIndex::findSlot(const char* Id) const
+{
+  size_t Mask = HashTable.size() - 1;
+  size_t Slot = hash(Id) & Mask;
+  while (HashTable[Slot] != MAX_XSIZE && strcmp(Groups[HashTable[Slot]].Id, Id) != 0) {
+    Slot = (Slot + 1) & Mask;
+  }
+  return Slot;
+}
+
+SVGShapeIndex::GroupShapes* SVGShapeIndex::findGroup(const char* Id) const
+{
+  if (HashTable.size() == 0) return NULL;
+  size_t Slot = findSlot(Id);
+  if (HashTable[Slot] == MAX_XSIZE) return NULL;
+  return const_cast<GroupShapes*>(&Groups[HashTable[Slot]]);
+}
+
+void SVGShapeIndex::setEmpty()
+{
+  Image = NULL;
+  Shapes.setEmpty();
+  PrevAlive.setEmpty();
+  NextAlive.setEmpty();
+  Taken.setEmpty();
+  FirstAlive = MAX_XSIZE;
+  Groups.setEmpty();
+  HashTable.setEmpty();
+}
+
+void SVGShapeIndex::build(NSVGimage* aImage)
+{
+  setEmpty();
+  Image = aImage;
+
+  size_t NbGroupIds = 0;
+  for (NSVGshape* shape = aImage->shapes; shape; shape = shape->next) {
+    Shapes.Add(shape);
+    for (NSVGgroup* group = shape->group; group; group = group->next) {
+      NbGroupIds++;
+    }
+  }
+  for (size_t idx = 0; idx < Shapes.size(); ++idx) {
+    PrevAlive.Add(idx == 0 ? MAX_XSIZE : idx - 1);
+    NextAlive.Add(idx + 1 == Shapes.size() ? MAX_XSIZE : idx + 1);
+    Taken.Add(false);
+  }
+  if (Shapes.size() > 0) FirstAlive = 0;
+
+  // at most NbGroupIds different ids, keep the table half empty
+  size_t TableSize = 16;
+  while (TableSize < NbGroupIds * 2) TableSize *= 2;
+  HashTable.Add(MAX_XSIZE, TableSize);
+
+  // group->next is the enclosing group : a shape belongs to its group and to all the groups around
+  for (size_t idx = 0; idx < Shapes.size(); ++idx) {
+    for (NSVGgroup* group = Shapes[idx]->group; group; group = group->next) {
+      if (group->id[0] == 0) continue;
+      size_t Slot = findSlot(group->id);
+      if (HashTable[Slot] == MAX_XSIZE) {
+        GroupShapes* NewGroup = new GroupShapes;
+        NewGroup->Id = group->id;
+        HashTable[Slot] = Groups.size();
+        Groups.AddReference(NewGroup, true);
+      }
+      XArray<size_t>& ShapeIdx = Groups[HashTable[Slot]].ShapeIdx;
+      // a group id can be found twice in the chain
+      if (ShapeIdx.size() == 0 || ShapeIdx[ShapeIdx.size() - 1] != idx) {
+        ShapeIdx.Add(idx);
+      }
+    }
+  }
+}
+
+void SVGShapeIndex::getShapes(const char* Id, XArray<size_t>* Result) const
+{
+  Result->setEmpty();
+  const GroupShapes* Group = findGroup(Id);
+  if (Group == NULL) return;
+  for (size_t i = 0; i < Group->ShapeIdx.size(); ++i) {
+    if (!Taken[Group->ShapeIdx[i]]) {
+      Result->Add(Group->ShapeIdx[i]);
+    }
+  }
+}
+
+void SVGShapeIndex::take(NSVGimage* aImage, size_t Idx)
+{
+  if (Taken[Idx]) return;
+  Taken[Idx] = true;
+  size_t Prev = PrevAlive[Idx];
+  size_t Next = NextAlive[Idx];
+  NSVGshape* NextShape = (Next == MAX_XSIZE) ? NULL : Shapes[Next];
+  if (Prev == MAX_XSIZE) {
+    aImage->shapes = NextShape;
+    FirstAlive = Next;
+  } else {
+    Shapes[Prev]->next = NextShape;
+    NextAlive[Prev] = Next;
+  }
+  if (Next != MAX_XSIZE) {
+    PrevAlive[Next] = Prev;
+  }
+}
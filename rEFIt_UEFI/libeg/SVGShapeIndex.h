@@ -0,0 +1,72 @@
+/*
+ * SVGShapeIndex.h
+ *
+ * Index of the shapes of a parsed theme.svg by the id of their groups.
+ * ParseSVGXIcon() takes the shapes of a group (or of any group containing it) out of the theme image.
+ * It used to walk all the shapes of the theme for each icon. With the index, it only visits
+ * the shapes of this icon, in the same order as before.
+ */
+
+#ifndef LIBEG_SVGSHAPEINDEX_H_
+#define LIBEG_SVGSHAPEINDEX_H_
+
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XObjArray.h"
+#include "nanosvg.h"
+
+
+class SVGShapeIndex
+{
+protected:
+  class GroupShapes
+  {
+  public:
+    const char*    Id = NULL; // points into the NSVGgroup
+    XArray<size_t> ShapeIdx = XArray<size_t>(); // positions in Shapes, ascending
+  };
+
+  const NSVGimage*       Image = NULL;
+  XArray<NSVGshape*>     Shapes = XArray<NSVGshape*>(); // the shapes of Image when build() was called
+  XArray<size_t>         PrevAlive = XArray<size_t>(); // neighbours still in Image->shapes, MAX_XSIZE if none
+  XArray<size_t>         NextAlive = XArray<size_t>();
+  XArray<bool>           Taken = XArray<bool>();
+  size_t                 FirstAlive = MAX_XSIZE; // the shape Image->shapes must point to
+  XObjArray<GroupShapes> Groups;
+  XArray<size_t>         HashTable = XArray<size_t>(); // index in Groups, MAX_XSIZE if empty. Size is a power of 2
+
+  static size_t hash(const char* Id);
+  size_t findSlot(const char* Id) const;
+  GroupShapes* findGroup(const char* Id) const;
+
+public:
+  SVGShapeIndex() {}
+  SVGShapeIndex(const SVGShapeIndex&) = delete;
+  SVGShapeIndex& operator=(const SVGShapeIndex&) = delete;
+
+  /*
+   * The index was built for aImage, and its shapes were only taken out by take() since.
+   * Another image can be allocated where a freed one was : call setEmpty() when the image is freed.
+   */
+  bool isFor(const NSVGimage* aImage) const
+    { return Image == aImage && aImage->shapes == (FirstAlive == MAX_XSIZE ? NULL : Shapes[FirstAlive]); }
+
+  // Index the shapes currently in aImage->shapes
+  void build(NSVGimage* aImage);
+
+  /*
+   * Shapes of group Id, or of a group inside it, not taken yet. In the order of aImage->shapes.
+   * Fill Result with their positions, to be given to getShape() and take().
+   */
+  void getShapes(const char* Id, XArray<size_t>* Result) const;
+  NSVGshape* getShape(size_t Idx) const { return Shapes[Idx]; }
+
+  // Remove the shape from Image->shapes, like the list walk did. Its next pointer is left to the caller.
+  void take(NSVGimage* aImage, size_t Idx);
+
+  void setEmpty();
+};
+
+extern SVGShapeIndex ShapeIndex;
+
+
+#endif /* LIBEG_SVGSHAPEINDEX_H_ */
@@ -17,6 +17,9 @@
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 
 #include "nanosvg.h"
+#include "SVGShapeIndex.h"
+#include "SVGGlyphCache.h"
+#include "XThemeCache.h"
 #include "FloatLib.h"
 #include "lodepng.h"
 #include "../refit/screen.h"
@@ -60,28 +63,23 @@ EFI_STATUS XTheme::ParseSVGXIcon(INTN Id, const XString8& IconNameX, OUT XImage*
   EFI_STATUS      Status = EFI_NOT_FOUND;
   NSVGimage       *SVGimage;
   NSVGparser *p = (NSVGparser *)SVGParser;
-  NSVGrasterizer* rast = nsvgCreateRasterizer();
   SVGimage = p->image;
   NSVGshape   *shape;
   NSVGgroup   *group;
   NSVGimage   *IconImage;
-  NSVGshape   *shapeNext, *shapesTail = NULL, *shapePrev;
+  NSVGshape   *shapesTail = NULL;
 
   NSVGparser* p2 = nsvg__createParser();
   IconImage = p2->image;
-  shape = SVGimage->shapes;
-  shapePrev = NULL;
-  while (shape) {
-    group = shape->group;
-    shapeNext = shape->next;
-    while (group) {
-      if (strcmp(group->id, IconNameX.c_str()) == 0) {
-        break;
-      }
-      group = group->next;
-    }
-    if (group) { //the shape is in the group
-      // keep this sample for debug purpose
+  if (!ShapeIndex.isFor(SVGimage)) {
+    ShapeIndex.build(SVGimage);
+  }
+  // shapes of the group IconNameX or of a group inside it, in the order of SVGimage->shapes
+  XArray<size_t> IconShapes;
+  ShapeIndex.getShapes(IconNameX.c_str(), &IconShapes);
+  for (size_t i = 0; i < IconShapes.size(); ++i) {
+    shape = ShapeIndex.getShape(IconShapes[i]);
+    // keep this sample for debug purpose
 /*    DBG("found shape %s", shape->id);
       DBG(" from group %s\n", group->id);
       if ((Id == BUILTIN_SELECTION_BIG) ||
@@ -92,62 +90,47 @@ EFI_STATUS XTheme::ParseSVGXIcon(INTN Id, const XString8& IconNameX, OUT XImage*
 //      if (BootCampStyle && (strstr(IconName, "selection_big") != NULL)) {
 //        shape->opacity = 0.f;
 //      }
-      if (BootCampStyle && IconNameX.contains("selection_big")) {
-        shape->opacity = 0.f;
-      }
+    if (BootCampStyle && IconNameX.contains("selection_big")) {
+      shape->opacity = 0.f;
+    }
+    // the shape is removed from SVGimage->shapes in both cases
+    ShapeIndex.take(SVGimage, IconShapes[i]);
 //      if (strstr(shape->id, "BoundingRect") != NULL) {
-      if (XString8().takeValueFrom(shape->id).contains("BoundingRect")) {
-        //there is bounds after nsvgParse()
-        IconImage->width = shape->bounds[2] - shape->bounds[0];
-        IconImage->height = shape->bounds[3] - shape->bounds[1];
-  //      DBG("parsed bounds: %f, %f\n", IconImage->width, IconImage->height);
-        if ( IconImage->height < 1.f ) {
-          IconImage->height = 200.f;
-        }
-        if (IconNameX.contains("selection_big") && (!SelectionOnTop)) {
-          MainEntriesSize = (int)(IconImage->width * Scale); //xxx
-          row0TileSize = MainEntriesSize + (int)(16.f * Scale);
-  //        DBG("main entry size = %lld\n", MainEntriesSize);
-        }
-        if (IconNameX.contains("selection_small") && (!SelectionOnTop)) {
-          row1TileSize = (int)(IconImage->width * Scale);
-        }
-
-        // not exclude BoundingRect from IconImage?
-        shape->flags = 0;  //invisible
-        if (shapePrev) {
-          shapePrev->next = shapeNext;
-        }
-        else {
-          SVGimage->shapes = shapeNext;
-        }
-        shape = shapeNext;
-        continue; //while(shape) it is BoundingRect shape
-
-//        shape->opacity = 0.3f;
+    if (XString8().takeValueFrom(shape->id).contains("BoundingRect")) {
+      //there is bounds after nsvgParse()
+      IconImage->width = shape->bounds[2] - shape->bounds[0];
+      IconImage->height = shape->bounds[3] - shape->bounds[1];
+//      DBG("parsed bounds: %f, %f\n", IconImage->width, IconImage->height);
+      if ( IconImage->height < 1.f ) {
+        IconImage->height = 200.f;
       }
-      shape->flags = NSVG_VIS_VISIBLE;
-      // Add to tail
-//      ClipCount += shape->clip.count;
-      if (IconImage->shapes == NULL)
-        IconImage->shapes = shape;
-      else
-        shapesTail->next = shape;
-      shapesTail = shape;
-      if (shapePrev) {
-        shapePrev->next = shapeNext;
+      if (IconNameX.contains("selection_big") && (!SelectionOnTop)) {
+        MainEntriesSize = (int)(IconImage->width * Scale); //xxx
+        row0TileSize = MainEntriesSize + (int)(16.f * Scale);
+//        DBG("main entry size = %lld\n", MainEntriesSize);
       }
-      else {
-        SVGimage->shapes = shapeNext;
+      if (IconNameX.contains("selection_small") && (!SelectionOnTop)) {
+        row1TileSize = (int)(IconImage->width * Scale);
       }
-      shapePrev->next = shapeNext;
-    } //the shape in the group
-    else {
-      shapePrev = shape;
+
+      // not exclude BoundingRect from IconImage?
+      shape->flags = 0;  //invisible
+      continue; //it is BoundingRect shape
+
+//        shape->opacity = 0.3f;
     }
-    shape = shapeNext;
-  } //while shape
-  shapesTail->next = NULL;
+    shape->flags = NSVG_VIS_VISIBLE;
+    // Add to tail
+//      ClipCount += shape->clip.count;
+    if (IconImage->shapes == NULL)
+      IconImage->shapes = shape;
+    else
+      shapesTail->next = shape;
+    shapesTail = shape;
+  } //for shapes of the icon
+  if (shapesTail) {
+    shapesTail->next = NULL;
+  }
   //add clipPaths  //xxx
   NSVGclipPath* clipPaths = SVGimage->clipPaths;
   NSVGclipPath* clipNext = NULL;
@@ -216,10 +199,19 @@ EFI_STATUS XTheme::ParseSVGXIcon(INTN Id, const XString8& IconNameX, OUT XImage*
     ty = (Height - realHeight) * 0.5f;
   }
 
-  nsvgRasterize(rast, IconImage, tx, ty, Scale, Scale, (UINT8*)NewImage.GetPixelPtr(0,0), iWidth, iHeight, iWidth*4);
-  //  DBG("%s rastered, blt\n", IconImage);
-
-  nsvgDeleteRasterizer(rast);
+  // the shapes are taken out of the theme above in any case, only the rasterization can be skipped
+  const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* CachedPixels = NULL;
+  UINTN CachedWidth = 0, CachedHeight = 0;
+  if (ThemeCache.find(IconNameX, &CachedPixels, &CachedWidth, &CachedHeight) && CachedPixels != NULL &&
+      CachedWidth == (UINTN)iWidth && CachedHeight == (UINTN)iHeight) {
+    CopyMem(NewImage.GetPixelPtr(0,0), CachedPixels, CachedWidth * CachedHeight * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  } else {
+    NSVGrasterizer* rast = nsvgCreateRasterizer();
+    nsvgRasterize(rast, IconImage, tx, ty, Scale, Scale, (UINT8*)NewImage.GetPixelPtr(0,0), iWidth, iHeight, iWidth*4);
+    //  DBG("%s rastered, blt\n", IconImage);
+    nsvgDeleteRasterizer(rast);
+    ThemeCache.add(IconNameX, NewImage.GetPixelPtr(0,0), iWidth, iHeight);
+  }
   //  nsvg__deleteParser(p2);
   //  nsvgDelete(p2->image); //somehow we can't delete them producing memory leaks
   // well, we will use them later
@@ -245,6 +237,7 @@ EFI_STATUS XTheme::ParseSVGXTheme(CONST CHAR8* buffer)
  //   DBG("Theme not parsed!\n");
     return EFI_NOT_STARTED;
   }
+  ShapeIndex.build(SVGimage);
 
   // --- Get scale as theme design height vs screen height
 
@@ -263,6 +256,7 @@ EFI_STATUS XTheme::ParseSVGXTheme(CONST CHAR8* buffer)
   CentreShift = (vbx * Scale - (float)UGAWidth) * 0.5f;
 
   Background = XImage(UGAWidth, UGAHeight);
+  BackgroundGeneration++;
   if (!BigBack.isEmpty()) {
     BigBack.setEmpty();
   }
@@ -430,6 +424,7 @@ EFI_STATUS XTheme::ParseSVGXTheme(CONST CHAR8* buffer)
     row1TileSize = (INTN)(64.f * Scale);
     MainEntriesSize = (INTN)(128.f * Scale);
   }
+  ShapeIndex.setEmpty(); //built again from the shapes left if an anime frame is parsed later
  // DBG("parsing svg theme finished\n");
 
   return EFI_SUCCESS;
@@ -459,8 +454,6 @@ INTN renderSVGtext(XImage* TextBufferXY_ptr, INTN posX, INTN posY, INTN textType
   INTN Width;
 //  UINTN i;
 //  UINTN len;
-  NSVGparser* p;
-  NSVGrasterizer* rast;
   if (!textFace[textType].valid) {
     for (decltype(textType) i=0; i<4; i++) {
       if (textFace[i].valid) {
@@ -477,24 +470,11 @@ INTN renderSVGtext(XImage* TextBufferXY_ptr, INTN posX, INTN posY, INTN textType
   UINT32 color = textFace[textType].color;
   INTN Height = (INTN)(textFace[textType].size * ThemeX.Scale);
   float Scale, sy;
-  float x, y;
+  float x;
   if (!fontSVG) {
     DBG("no font for renderSVGtext\n");
     return 0;
   }
-  p = nsvg__createParser();
-  if (!p) {
-    return 0;
-  }
-  NSVGtext* text = (NSVGtext*)AllocateZeroPool(sizeof(NSVGtext));
-  if (!text) {
-    return 0;
-  }
-  text->font = fontSVG;
-  text->fontColor = color;
-  text->fontSize = (float)Height;
-  nsvg__xformIdentity(text->xform);
-  p->text = text;
 
   Width = TextBufferXY.GetWidth();
   if ( fontSVG->unitsPerEm < 1.f ) {
@@ -509,8 +489,9 @@ INTN renderSVGtext(XImage* TextBufferXY_ptr, INTN posX, INTN posY, INTN textType
   sy = (float)Height / fH; //(float)fontSVG->unitsPerEm; // 260./1250.
   Scale = sy;
   x = (float)posX; //0.f;
-  y = (float)posY + fontSVG->bbox[1] * Scale;
-  p->isText = TRUE;
+  // The glyphs are blended from GlyphCache in place of addLetter() for each letter and nsvgRasterize() of the string.
+  // Then a letter at x was shifted by -bbox[0]*Scale twice : in its xform and by realBounds[0]
+  float PenShift = - 2.f * fontSVG->bbox[0] * Scale;
   size_t len = string.length();
   for (size_t i=0; i < len; i++) {
     CHAR16 letter = string.char16At(i);
@@ -518,24 +499,34 @@ INTN renderSVGtext(XImage* TextBufferXY_ptr, INTN posX, INTN posY, INTN textType
       break;
     }
  //       DBG("add letter 0x%X\n", letter);
+    float Pen = x + PenShift;
+    INTN PenX = (INTN)Pen;
+    if (Pen < (float)PenX) {
+      PenX--;
+    }
+    int SubX = (int)((Pen - (float)PenX) * SVGGlyphCache::SubPixels + 0.5f);
+    if (SubX == SVGGlyphCache::SubPixels) {
+      PenX++;
+      SubX = 0;
+    }
+    const SVGGlyphCache::GlyphMask* Glyph;
     if (i == Cursor) {
-      addLetter(p, 0x5F, x, y, sy, color);
+      Glyph = GlyphCache.getGlyph(fontSVG, sy, color, 0x5F, SubX);
+      if (Glyph) {
+        SVGGlyphCache::blend(*Glyph, TextBufferXY, PenX, posY);
+      }
+    }
+    Glyph = GlyphCache.getGlyph(fontSVG, sy, color, letter, SubX);
+    if (Glyph) {
+      SVGGlyphCache::blend(*Glyph, TextBufferXY, PenX, posY);
+      x += Glyph->Advance;
     }
-    x = addLetter(p, letter, x, y, sy, color);
   } //end of string
 
-  p->image->realBounds[0] = fontSVG->bbox[0] * Scale;
-  p->image->realBounds[1] = fontSVG->bbox[1] * Scale;
-  p->image->realBounds[2] = fontSVG->bbox[2] * Scale + x; //last bound
-  p->image->realBounds[3] = fontSVG->bbox[3] * Scale;
-  rast = nsvgCreateRasterizer();
-  nsvgRasterize(rast, p->image, 0, 0, 1.f, 1.f, (UINT8*)TextBufferXY.GetPixelPtr(0,0),
-                (int)TextBufferXY.GetWidth(), (int)TextBufferXY.GetHeight(), (int)(Width*4));
-  float RealWidth = p->image->realBounds[2] - p->image->realBounds[0];
-
-  nsvgDeleteRasterizer(rast);
-  //  nsvg__deleteParser(p);
-  nsvgDelete(p->image);
+  // the glyphs are premultiplied
+  nsvgUnpremultiplyAlpha((UINT8*)TextBufferXY.GetPixelPtr(0,0),
+                         (int)TextBufferXY.GetWidth(), (int)TextBufferXY.GetHeight(), (int)(Width*4));
+  float RealWidth = fontSVG->bbox[2] * Scale + x - fontSVG->bbox[0] * Scale;
   return (INTN)RealWidth; //x;
 }
 
@@ -45,20 +45,37 @@ void XCinema::AddFilm(FILM* NewFilm)
 }
 
 static XImage NullImage;
-const XImage& FILM::GetImage(INTN Index) const
+
+void FILM::LoadFrame(INTN Index)
+{
+  if (Index < 0 || (size_t)Index >= Frames.size()) return;
+  FilmFrame& Frame = Frames[Index];
+  if (!Frame.Exists || !Frame.Image.isEmpty() || Theme == nullptr) return;
+  EFI_STATUS Status;
+  if (Theme->TypeSVG) {
+    Status = Theme->LoadSvgFrame(Index, &Frame.Image);
+  } else {
+    XStringW Name = SWPrintf("%ls\\%ls_%03lld.png", Path.wc_str(), Path.wc_str(), Index);
+    Status = Frame.Image.LoadXImage(&Theme->getThemeDir(), Name);
+  }
+  DBG("decode frame #%lld status=%s\n", Index, efiStrError(Status));
+  if (EFI_ERROR(Status)) {
+    Frame.Image.setEmpty();
+  }
+}
+
+const XImage& FILM::GetImage(INTN Index)
 {
   DBG("ask for frame #%lld from total of %zu\n", Index, Frames.size());
-  for (size_t i = 0; i < Frames.size(); ++i) {
-    if (Frames[i].getIndex() == Index) {
-      DBG("...found\n");
-      return Frames[i].getImage();
-    }
+  if (Index < 0 || (size_t)Index >= Frames.size() || !Frames[Index].Exists) {
+    DBG("...not found\n");
+    return NullImage;
   }
-  DBG("...not found\n");
-  return NullImage;
+  LoadFrame(Index);
+  return Frames[Index].Image;
 }
 
-const XImage& FILM::GetImage(bool *free) const
+const XImage& FILM::GetImage(bool *free)
 {
   /*
    * for SVG anime we have to generate new XImage using CurrentFrame as an argument
@@ -69,21 +86,26 @@ const XImage& FILM::GetImage(bool *free) const
    return frame;
    *
    */
-  for (size_t i = 0; i < Frames.size(); ++i) {
-    if (Frames[i].getIndex() == CurrentFrame) {
-      if (free) *free = false;
-      return Frames[i].getImage();
-    }
-  }
   if (free) *free = false;
-  return NullImage;
+  // frames are drawn in sequence, decode the next ones now rather than all at theme load
+  for (INTN i = 0; i < FramesAhead; ++i) {
+    LoadFrame((CurrentFrame + i) % (LastIndex + 1));
+  }
+  // a film played once will be decoded again if the screen is entered again
+  if (RunOnce && Theme != nullptr && !Theme->TypeSVG && CurrentFrame > 0 && (size_t)CurrentFrame <= Frames.size()) {
+    Frames[CurrentFrame - 1].Image.setEmpty();
+  }
+  return GetImage(CurrentFrame);
 }
 
 void FILM::AddFrame(XImage* Frame, INTN Index)
 {
-  IndexedImage* NewFrame = new IndexedImage(Index);
-  NewFrame->setImage(*Frame);
-  Frames.AddReference(NewFrame, true);
+  if (Index < 0) return;
+  while (Frames.size() <= (size_t)Index) {
+    Frames.AddReference(new FilmFrame, true);
+  }
+  Frames[Index].Exists = true;
+  Frames[Index].Image = *Frame;
   DBG("index=%lld last=%lld\n", Index, LastIndex);
   if (Index > LastIndex) {
     LastIndex = Index;
@@ -94,25 +116,25 @@ void FILM::AddFrame(XImage* Frame, INTN Index)
 void FILM::GetFrames(XTheme& TheTheme /*, const XStringW& Path*/) // Path already exist as a member. Is it the same ?
 {
   const EFI_FILE *ThemeDir = &TheTheme.getThemeDir();
-  EFI_STATUS Status;
+  Theme = &TheTheme;
+  Frames.setEmpty();
   LastIndex = 0;
   for (INTN Index = 0; Index < NumFrames; Index++) {
-    XImage NewImage;
-    Status = EFI_NOT_FOUND;
+    FilmFrame* NewFrame = new FilmFrame;
+    Frames.AddReference(NewFrame, true);
     if (TheTheme.TypeSVG) {
-      Status = TheTheme.LoadSvgFrame(Index, &NewImage);
+      // rendered from the theme svg while it is loaded, as before
+      NewFrame->Exists = !EFI_ERROR(TheTheme.LoadSvgFrame(Index, &NewFrame->Image));
     } else {
       XStringW Name = SWPrintf("%ls\\%ls_%03lld.png", Path.wc_str(), Path.wc_str(), Index);
  //     DBG("try to load %ls\n", Name.wc_str()); //fine
-      if (FileExists(ThemeDir, Name)) {
-        Status = NewImage.LoadXImage(ThemeDir, Name);
-      }
-//      DBG("  read status=%s\n", efiStrError(Status));
+      NewFrame->Exists = FileExists(ThemeDir, Name);
     }
-    if (!EFI_ERROR(Status)) {
-      AddFrame(&NewImage, Index);
+    if (NewFrame->Exists) {
+      LastIndex = Index;
     }
   }
+  for (INTN Index = 0; Index < FramesAhead; Index++) {
+    LoadFrame(Index);
+  }
 }
-
-
@@ -37,33 +37,46 @@ public:
   BOOLEAN   AnimeRun;
   UINT64    LastDraw;
 
+  // Frames decoded in advance. A film of 100+ frames is not decoded at once when the theme is loaded
+  static const INTN FramesAhead = 4;
+
 protected:
-  XObjArray<IndexedImage> Frames; //Frames can be not sorted
-  INTN      LastIndex; // it is not Frames.size(), it is last index inclusive, so frames 0,1,2,5,8 be LastIndex = 8
+  class FilmFrame
+  {
+  public:
+    bool   Exists = false; // the file was found, the image may not be decoded yet
+    XImage Image = XImage();
+  };
+
+  XTheme*   Theme; // to decode the frames when needed
+  XObjArray<FilmFrame> Frames; //Frames[i] is frame number i, so frames 0,1,2,5,8 have 9 elements
+  INTN      LastIndex; // last existing index inclusive, so frames 0,1,2,5,8 be LastIndex = 8
   INTN      CurrentFrame; // must be unique for each film
 
+  void LoadFrame(INTN Index);
+
 public:
   EG_RECT FilmPlace;  // Screen has several Films each in own place
 
 public:
   FILM() : Id(0), RunOnce(0), NumFrames(0), FrameTime(0), FilmX(0), FilmY(0), ScreenEdgeHorizontal(0), ScreenEdgeVertical(0),
-           NudgeX(0), NudgeY(0), Path(), AnimeRun(0), LastDraw(0), Frames(), LastIndex(0), CurrentFrame(0), FilmPlace()
+           NudgeX(0), NudgeY(0), Path(), AnimeRun(0), LastDraw(0), Theme(nullptr), Frames(), LastIndex(0), CurrentFrame(0), FilmPlace()
          {}
   FILM(INTN Id) : Id(Id), RunOnce(0), NumFrames(0), FrameTime(0), FilmX(0), FilmY(0), ScreenEdgeHorizontal(0), ScreenEdgeVertical(0),
-           NudgeX(0), NudgeY(0), Path(), AnimeRun(0), LastDraw(0), Frames(), LastIndex(0), CurrentFrame(0), FilmPlace()
+           NudgeX(0), NudgeY(0), Path(), AnimeRun(0), LastDraw(0), Theme(nullptr), Frames(), LastIndex(0), CurrentFrame(0), FilmPlace()
          {}
   ~FILM() {}
 
   INTN GetIndex() { return  Id; }
   void SetIndex(INTN Index) { Id = Index; }
 
-  const XImage& GetImage(INTN Index) const;
-  const XImage& GetImage(bool *free = nullptr) const;
+  const XImage& GetImage(INTN Index); //decode it if needed
+  const XImage& GetImage(bool *free = nullptr); //current frame. Decode the next ones, free the previous one if RunOnce
   void AddFrame(XImage* Frame, INTN Index); //IndexedImage will be created
   size_t Size() { return Frames.size(); }
   INTN LastFrameID() { return LastIndex; }
   bool Finished() { return CurrentFrame == 0; }
-  void GetFrames(XTheme& TheTheme/*, const XStringW& Path*/); //read image sequence from Theme/Path/
+  void GetFrames(XTheme& TheTheme/*, const XStringW& Path*/); //find image sequence in Theme/Path/, decode the first frames
   void SetPlace(const EG_RECT& Rect) { FilmPlace = Rect; }
   void Advance() { ++CurrentFrame %= (LastIndex + 1); }
   void Reset() { CurrentFrame = 0; }
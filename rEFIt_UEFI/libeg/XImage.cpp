@@ -1,5 +1,7 @@
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 #include "XImage.h"
+#include "XImageKernels.h"
+#include "XScreenShadow.h"
 #include "lodepng.h"
 #include "nanosvg.h"
 #include "libegint.h"  //for egDecodeIcns
@@ -193,12 +195,6 @@ void XImage::FillArea(const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Color, EG_RECT& Rect)
 }
 
 
-UINT8 XImage::Smooth(const UINT8* p, int a01, int a10, int a21, int a12,  float dx, float dy, float scale)
-{
-  return (UINT8)((*(p + a01) * (scale - dx) * 3.f + *(p + a10) * (scale - dy) * 3.f + *(p + a21) * dx * 3.f +
-                  *(p + a12) * dy * 3.f + *(p) * 2.f *scale) / (scale * 8.f));
-}
-
 /* Place Top image over this image at PosX,PosY
  * Lowest means final image is opaque
  * else transparency will be multiplied
@@ -209,35 +205,26 @@ void XImage::Copy(XImage* Image)
 }
 
 //sizes remain as were assumed input image is large enough?
+//bilinear interpolation, 16.16 fixed point coordinates and 7 bits weights
 void XImage::CopyScaled(const XImage& Image, float scale)
 {
-  int SrcWidth = (int)Image.GetWidth(); //because Source[] requires int argument, why not long long int?
-
-  int Pixel = sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
-  int Row = SrcWidth * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
-  int W = (int)GetWidth();
-  int H = (int)GetHeight();
-
-  const XArray<EFI_GRAPHICS_OUTPUT_BLT_PIXEL>& Source = Image.GetData();
+  UINTN SrcWidth = (UINTN)Image.GetWidth();
+  UINTN SrcHeight = (UINTN)Image.GetHeight();
+  if (SrcWidth == 0 || SrcHeight == 0 || isEmpty()) {
+    return;
+  }
+  if (scale <= 0.f) {
+    scale = 1.f;
+  }
+  UINT32 Step = (UINT32)(65536.f / scale + 0.5f); //source distance between two destination pixels
 
-  for (INTN y = 0; y < H; y++) //destination coordinates
+  for (UINTN y = 0; y < Height; y++) //destination coordinates
   {
-    int ly = (int)(y / scale); //integer part of src coord
-    float dy = y - ly * scale; //fractional part
-    for (INTN x = 0; x < W; x++)
-    {
-      int lx = (int)(x / scale);
-      float dx = x - lx * scale;
-      int a01 = (lx == 0) ? 0 : -Pixel;
-      int a10 = (ly == 0) ? 0 : -Row;
-      int a21 = (lx == W - 1) ? 0 : Pixel;
-      int a12 = (ly == H - 1) ? 0 : Row;
-      EFI_GRAPHICS_OUTPUT_BLT_PIXEL& dst = *GetPixelPtr(x, y);
-      dst.Blue = Smooth(&Source[lx + ly * SrcWidth].Blue, a01, a10, a21, a12, dx, dy, scale);
-      dst.Green = Smooth(&Source[lx + ly * SrcWidth].Green, a01, a10, a21, a12, dx, dy, scale);
-      dst.Red = Smooth(&Source[lx + ly * SrcWidth].Red, a01, a10, a21, a12, dx, dy, scale);
-      dst.Reserved = Source[lx + ly * SrcWidth].Reserved;
-    }
+    UINT64 Sy = (UINT64)y * Step;
+    UINTN ly = (UINTN)(Sy >> 16); //integer part of src coord
+    if (ly >= SrcHeight) ly = SrcHeight - 1;
+    UINTN ly1 = (ly + 1 < SrcHeight) ? ly + 1 : ly;
+    XImageScaleRow(GetPixelPtr(0, y), Width, Image.GetPixelPtr(0, ly), Image.GetPixelPtr(0, ly1), SrcWidth, Step, (UINT32)(Sy >> 9) & 0x7F);
   }
 }
 
@@ -318,45 +305,12 @@ void XImage::Compose(const EG_RECT& OutPlace, const EG_RECT& InPlace, const XIma
     HArea = GetHeight() - OutPlace.YPos;
   }
 //change only affected pixels
+  INTN Count = MIN(WArea, Top.GetWidth() - PosX);
+  if (Count <= 0) {
+    return;
+  }
   for (INTN y = 0; y < HArea && (y + PosY) < Top.GetHeight(); ++y) {
- //   EFI_GRAPHICS_OUTPUT_BLT_PIXEL& CompPtr = *GetPixelPtr(PosX, y); // I assign a ref to avoid the operator ->. Compiler will produce the same anyway.
-    EFI_GRAPHICS_OUTPUT_BLT_PIXEL* CompPtr = GetPixelPtr(OutPlace.XPos, OutPlace.YPos + y);
-    for (INTN x = 0; x < WArea && (x + PosX) < Top.GetWidth(); ++x) {
-      //------
-      // test compAlpha = 255; TopAlpha = 0 -> only Comp, TopAplha = 255 -> only Top
-      UINT32 TopAlpha = Top.GetPixel(x + PosX, y + PosY).Reserved & 0xFF; //0, 255
-      UINT32 CompAlpha = CompPtr->Reserved & 0xFF; //255
-      UINT32 RevAlpha = 255 - TopAlpha; //2<<8; 255, 0
-      UINT32 TempAlpha = CompAlpha * RevAlpha; //2<<16; 255*255, 0
-      TopAlpha *= 255; //2<<16; 0, 255*255
-      UINT32 FinalAlpha = TopAlpha + TempAlpha; //2<<16; 255*255, 255*255
-//final alpha =(1-(1-x)*(1-y)) =(255*255-(255-topA)*(255-compA))/255 = topA+compA*(1-topA)
-
-      if (FinalAlpha != 0) {
-        UINT32 Temp = (CompPtr->Blue * TempAlpha) + (Top.GetPixel(x + PosX, y + PosY).Blue * TopAlpha);
-        CompPtr->Blue = (UINT8)(Temp / FinalAlpha);
-
-        Temp = (CompPtr->Green * TempAlpha) + (Top.GetPixel(x + PosX, y + PosY).Green * TopAlpha);
-        CompPtr->Green = (UINT8)(Temp / FinalAlpha);
-
-        Temp = (CompPtr->Red * TempAlpha) + (Top.GetPixel(x + PosX, y + PosY).Red * TopAlpha);
-        CompPtr->Red = (UINT8)(Temp / FinalAlpha);
-      
-        if (gray && (TopAlpha != 0)) {
-          Temp = ((UINT32)CompPtr->Blue + 2 * (UINT32)CompPtr->Red + 4 * (UINT32)CompPtr->Green) / 7;
-          CompPtr->Blue = (UINT8)Temp;
-          CompPtr->Red = (UINT8)Temp;
-          CompPtr->Green = (UINT8)Temp;
-        }
-      }
-
-      if (Lowest) {
-        CompPtr->Reserved = 255;
-      } else {
-        CompPtr->Reserved = (UINT8)(FinalAlpha / 255);
-      }
-      CompPtr++; //faster way to move to next pixel
-    }
+    XImageComposeRow(GetPixelPtr(OutPlace.XPos, OutPlace.YPos + y), Top.GetPixelPtr(PosX, y + PosY), (UINTN)Count, Lowest, gray);
   }
 }
 
@@ -370,15 +324,10 @@ void XImage::Compose(const EG_RECT& OutPlace, const EG_RECT& InPlace, const XIma
 
 void XImage::FlipRB()
 {
-  UINTN ImageSize = (Width * Height);
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixel = GetPixelPtr(0,0);
-  for (UINTN i = 0; i < ImageSize; ++i) {
-    UINT8 Temp = Pixel->Blue;
-    Pixel->Blue = Pixel->Red;
-    Pixel->Red = Temp;
-//    if (!WantAlpha) Pixel->Reserved = 0xFF;
-    Pixel++;
+  if (isEmpty()) {
+    return;
   }
+  XImageFlipRB(GetPixelPtr(0,0), Width * Height);
 }
 
 /*
@@ -483,20 +432,6 @@ void XImage::GetArea(const EG_RECT& Rect)
 
 void XImage::GetArea(INTN x, INTN y, UINTN W, UINTN H)
 {
-  EFI_STATUS Status;
-  EFI_GUID UgaDrawProtocolGuid = EFI_UGA_DRAW_PROTOCOL_GUID;
-  EFI_UGA_DRAW_PROTOCOL *UgaDraw = NULL;
-  EFI_GUID GraphicsOutputProtocolGuid = EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID;
-  EFI_GRAPHICS_OUTPUT_PROTOCOL *GraphicsOutput = NULL;
-
-  Status = EfiLibLocateProtocol(&GraphicsOutputProtocolGuid, (void **)&GraphicsOutput);
-  if (EFI_ERROR(Status)) {
-    GraphicsOutput = NULL;
-    Status = EfiLibLocateProtocol(&UgaDrawProtocolGuid, (void **)&UgaDraw);
-    if (EFI_ERROR(Status))
-      UgaDraw = NULL;
-  }
-
   if (W == 0) W = Width;
   if (H == 0) H = Height;
 
@@ -512,18 +447,11 @@ void XImage::GetArea(INTN x, INTN y, UINTN W, UINTN H)
  *  }
  *
  */
-  if (GraphicsOutput != NULL) {
-    GraphicsOutput->Blt(GraphicsOutput,
-      &PixelData[0],
-      EfiBltVideoToBltBuffer,
+  if (!ScreenShadow.getArea(*this, x, y, Width, Height)) {
+    // no shadow, read the video memory. It is slow
+    egScreenBlt(&PixelData[0], EfiBltVideoToBltBuffer,
       x, y, 0, 0, Width, Height, 0); // Width*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
   }
-  else if (UgaDraw != NULL) {
-    UgaDraw->Blt(UgaDraw,
-      (EFI_UGA_PIXEL *)GetPixelPtr(0,0),
-      EfiUgaVideoToBltBuffer,
-      x, y, 0, 0, Width, Height, 0); //Width*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-  }
   //fix alpha
   UINTN ImageSize = (Width * Height);
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixel = GetPixelPtr(0,0);
@@ -544,30 +472,12 @@ void XImage::DrawWithoutCompose(INTN x, INTN y, UINTN width, UINTN height)
   UINTN AreaHeight = (y + height > (UINTN)UGAHeight) ? (y > UGAHeight ? 0 : UGAHeight - y) : height;
 
 //  DBG("area=%d,%d\n", AreaWidth, AreaHeight);
-  // prepare protocols
-  EFI_STATUS Status;
-  EFI_GUID UgaDrawProtocolGuid = EFI_UGA_DRAW_PROTOCOL_GUID;
-  EFI_UGA_DRAW_PROTOCOL *UgaDraw = NULL;
-  EFI_GUID GraphicsOutputProtocolGuid = EFI_GRAPHICS_OUTPUT_PROTOCOL_GUID;
-  EFI_GRAPHICS_OUTPUT_PROTOCOL *GraphicsOutput = NULL;
-
-  Status = EfiLibLocateProtocol(&GraphicsOutputProtocolGuid, (void **)&GraphicsOutput);
-  if (EFI_ERROR(Status)) {
-    GraphicsOutput = NULL;
-    Status = EfiLibLocateProtocol(&UgaDrawProtocolGuid, (void **)&UgaDraw);
-    if (EFI_ERROR(Status))
-      UgaDraw = NULL;
+  if (ScreenShadow.put(*this, x, y, AreaWidth, AreaHeight)) {
+    return; // will be sent to the video with the other rectangles of the update
   }
   //output combined image
-  if (GraphicsOutput != NULL) {
-    GraphicsOutput->Blt(GraphicsOutput, (*this).GetPixelPtr(0, 0),
-      EfiBltBufferToVideo,
-      0, 0, x, y, AreaWidth, AreaHeight, GetWidth()*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-  }
-  else if (UgaDraw != NULL) {
-    UgaDraw->Blt(UgaDraw, (EFI_UGA_PIXEL *)(*this).GetPixelPtr(0, 0), EfiUgaBltBufferToVideo,
-      0, 0, x, y, AreaWidth, AreaHeight, GetWidth()*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
-  }
+  egScreenBlt((*this).GetPixelPtr(0, 0), EfiBltBufferToVideo,
+    0, 0, x, y, AreaWidth, AreaHeight, GetWidth()*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
 }
 
 void XImage::Draw(INTN x, INTN y)
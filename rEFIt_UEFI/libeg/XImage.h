@@ -79,7 +79,6 @@ public:
   void Fill(const EG_PIXEL* Color);
   void FillArea(const EG_PIXEL* Color, EG_RECT& Rect);
   void FillArea(const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Color, EG_RECT& Rect);
-  UINT8 Smooth(const UINT8* p, int a01, int a10, int a21, int a12,  float dx, float dy, float scale);
   void Copy(XImage* Image);
   void CopyScaled(const XImage& Image, float scale = 0.f);
   void CopyRect(const XImage& Image, INTN X, INTN Y);
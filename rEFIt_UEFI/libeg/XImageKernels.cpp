@@ -0,0 +1,208 @@
+/*
+ * XImageKernels.cpp
+ *
+ * See XImageKernels.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "XImageKernels.h"
+
+
+static inline UINT32 Raw(const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Pixel) { return ((const EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION&)Pixel).Raw; }
+
+// x/255 rounded, for x <= 65535
+static inline UINT32 Div255(UINT32 x) { return ((x + 128) * 257) >> 16; }
+
+//--------------------------------------------------------------------------------------------------------
+// Compose
+//--------------------------------------------------------------------------------------------------------
+
+static inline void ComposePixel(EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Top, bool Lowest, bool Gray)
+{
+  UINT32 TopAlpha = Top.Reserved;
+  UINT32 CompWeight = Div255(Comp.Reserved * (255 - TopAlpha)); // what is still visible of Comp under Top
+  UINT32 FinalAlpha = TopAlpha + CompWeight; // 0..255
+  if (FinalAlpha == 255) {
+    Comp.Blue = (UINT8)Div255(Comp.Blue * CompWeight + Top.Blue * TopAlpha);
+    Comp.Green = (UINT8)Div255(Comp.Green * CompWeight + Top.Green * TopAlpha);
+    Comp.Red = (UINT8)Div255(Comp.Red * CompWeight + Top.Red * TopAlpha);
+  } else if (FinalAlpha != 0) {
+    UINT32 Half = FinalAlpha / 2;
+    Comp.Blue = (UINT8)((Comp.Blue * CompWeight + Top.Blue * TopAlpha + Half) / FinalAlpha);
+    Comp.Green = (UINT8)((Comp.Green * CompWeight + Top.Green * TopAlpha + Half) / FinalAlpha);
+    Comp.Red = (UINT8)((Comp.Red * CompWeight + Top.Red * TopAlpha + Half) / FinalAlpha);
+  }
+  if (Gray && TopAlpha != 0) {
+    UINT8 Temp = (UINT8)(((UINT32)Comp.Blue + 2 * (UINT32)Comp.Red + 4 * (UINT32)Comp.Green) / 7);
+    Comp.Blue = Temp;
+    Comp.Red = Temp;
+    Comp.Green = Temp;
+  }
+  Comp.Reserved = Lowest ? 255 : (UINT8)FinalAlpha;
+}
+
+void XImageComposeRowScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Top, UINTN Count, bool Lowest, bool Gray)
+{
+  for (UINTN i = 0; i < Count; ++i) {
+    ComposePixel(Comp[i], Top[i], Lowest, Gray);
+  }
+}
+
+#if XIMAGE_KERNELS_SSE2
+
+typedef UINT16 V8u16 __attribute__((vector_size(16)));
+typedef UINT32 V4u32 __attribute__((vector_size(16)));
+typedef UINT32 V4u32Unaligned __attribute__((vector_size(16), aligned(4), may_alias));
+
+/*
+ * 4 pixels over an opaque Comp. The result is opaque and
+ *   color = (Comp * (255 - TopAlpha) + Top * TopAlpha) / 255
+ * computed on the even (blue, red) and odd (green, alpha) bytes in 16 bits lanes.
+ */
+static inline V4u32 ComposeOpaque4(V4u32 Comp, V4u32 Top, bool Gray)
+{
+  V4u32 Alpha = Top >> 24;
+  V8u16 Alpha16 = (V8u16)(Alpha | (Alpha << 16));
+  V8u16 RevAlpha16 = 255 - Alpha16;
+  V8u16 Comp16 = (V8u16)Comp;
+  V8u16 Top16 = (V8u16)Top;
+
+  V8u16 Even = (Comp16 & 0xFF) * RevAlpha16 + (Top16 & 0xFF) * Alpha16; // <= 255*255
+  V8u16 Odd = (Comp16 >> 8) * RevAlpha16 + (Top16 >> 8) * Alpha16;
+  Even += 128;
+  Even = (Even + (Even >> 8)) >> 8;
+  Odd += 128;
+  Odd = (Odd + (Odd >> 8)) >> 8;
+  V4u32 Result = (V4u32)(Even | (Odd << 8));
+
+  if (Gray) {
+    // (Blue + 2*Red + 4*Green) / 7. Sum is <= 1785, for which *9363 >> 16 is the same as /7
+    V4u32 Sum = (Result & 0xFF) + ((Result >> 15) & 0x1FE) + ((Result >> 6) & 0x3FC);
+    V4u32 Gray8 = (Sum * 9363) >> 16;
+    V4u32 GrayPixel = Gray8 | (Gray8 << 8) | (Gray8 << 16);
+    V4u32 Mask = (V4u32)(Alpha != 0);
+    Result = (GrayPixel & Mask) | (Result & ~Mask);
+  }
+  return Result | 0xFF000000;
+}
+
+void XImageComposeRow(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Top, UINTN Count, bool Lowest, bool Gray)
+{
+  UINTN i = 0;
+  for (; i + 4 <= Count; i += 4) {
+    if ((Comp[i].Reserved & Comp[i+1].Reserved & Comp[i+2].Reserved & Comp[i+3].Reserved) == 255) {
+      // the usual case : compose on an opaque background
+      *(V4u32Unaligned*)&Comp[i] = ComposeOpaque4(*(const V4u32Unaligned*)&Comp[i], *(const V4u32Unaligned*)&Top[i], Gray);
+    } else {
+      XImageComposeRowScalar(Comp + i, Top + i, 4, Lowest, Gray);
+    }
+  }
+  XImageComposeRowScalar(Comp + i, Top + i, Count - i, Lowest, Gray);
+}
+
+#else
+
+void XImageComposeRow(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Top, UINTN Count, bool Lowest, bool Gray)
+{
+  XImageComposeRowScalar(Comp, Top, Count, Lowest, Gray);
+}
+
+#endif
+
+//--------------------------------------------------------------------------------------------------------
+// Scale
+//--------------------------------------------------------------------------------------------------------
+
+void XImageScaleRowScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Dst, UINTN DstWidth,
+                          const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow0, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow1, UINTN SrcWidth,
+                          UINT32 StepX, UINT32 Fy)
+{
+  for (UINTN x = 0; x < DstWidth; ++x) {
+    UINT64 Sx = (UINT64)x * StepX;
+    UINTN Lx = (UINTN)(Sx >> 16);
+    if (Lx >= SrcWidth) Lx = SrcWidth - 1;
+    UINTN Lx1 = (Lx + 1 < SrcWidth) ? Lx + 1 : Lx;
+    UINT32 Fx = (UINT32)(Sx >> 9) & 0x7F;
+    const UINT8* P00 = (const UINT8*)&SrcRow0[Lx];
+    const UINT8* P01 = (const UINT8*)&SrcRow0[Lx1];
+    const UINT8* P10 = (const UINT8*)&SrcRow1[Lx];
+    const UINT8* P11 = (const UINT8*)&SrcRow1[Lx1];
+    UINT8* D = (UINT8*)&Dst[x];
+    for (UINTN c = 0; c < sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL); ++c) {
+      UINT32 H0 = P00[c] * (128 - Fx) + P01[c] * Fx;
+      UINT32 H1 = P10[c] * (128 - Fx) + P11[c] * Fx;
+      D[c] = (UINT8)((H0 * (128 - Fy) + H1 * Fy + 8192) >> 14);
+    }
+  }
+}
+
+// Bytes 0 and 2 of Pixel in bits 0-7 and 32-39
+static inline UINT64 Spread(UINT32 Pixel)
+{
+  UINT64 Even = Pixel & 0x00FF00FF;
+  return (Even | (Even << 16)) & 0x000000FF000000FFull;
+}
+
+/*
+ * Same arithmetic as XImageScaleRowScalar, two channels per multiply. Each channel has its own 32 bits,
+ * and the largest intermediate value is 255*128*128.
+ */
+void XImageScaleRow(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Dst, UINTN DstWidth,
+                    const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow0, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow1, UINTN SrcWidth,
+                    UINT32 StepX, UINT32 Fy)
+{
+  UINT64 RevFy = 128 - Fy;
+  for (UINTN x = 0; x < DstWidth; ++x) {
+    UINT64 Sx = (UINT64)x * StepX;
+    UINTN Lx = (UINTN)(Sx >> 16);
+    if (Lx >= SrcWidth) Lx = SrcWidth - 1;
+    UINTN Lx1 = (Lx + 1 < SrcWidth) ? Lx + 1 : Lx;
+    UINT64 Fx = (Sx >> 9) & 0x7F;
+    UINT64 RevFx = 128 - Fx;
+    UINT32 P00 = Raw(SrcRow0[Lx]);
+    UINT32 P01 = Raw(SrcRow0[Lx1]);
+    UINT32 P10 = Raw(SrcRow1[Lx]);
+    UINT32 P11 = Raw(SrcRow1[Lx1]);
+
+    UINT64 H0 = Spread(P00) * RevFx + Spread(P01) * Fx;
+    UINT64 H1 = Spread(P10) * RevFx + Spread(P11) * Fx;
+    UINT64 Even = ((H0 * RevFy + H1 * Fy + 0x0000200000002000ull) >> 14) & 0x000000FF000000FFull;
+
+    H0 = Spread(P00 >> 8) * RevFx + Spread(P01 >> 8) * Fx;
+    H1 = Spread(P10 >> 8) * RevFx + Spread(P11 >> 8) * Fx;
+    UINT64 Odd = ((H0 * RevFy + H1 * Fy + 0x0000200000002000ull) >> 14) & 0x000000FF000000FFull;
+
+    ((EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION*)&Dst[x])->Raw = (UINT32)(Even | (Even >> 16)) | ((UINT32)(Odd | (Odd >> 16)) << 8);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------------
+// FlipRB
+//--------------------------------------------------------------------------------------------------------
+
+void XImageFlipRBScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Count)
+{
+  for (UINTN i = 0; i < Count; ++i) {
+    UINT8 Temp = Pixels[i].Blue;
+    Pixels[i].Blue = Pixels[i].Red;
+    Pixels[i].Red = Temp;
+  }
+}
+
+void XImageFlipRB(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Count)
+{
+  UINTN i = 0;
+#if XIMAGE_KERNELS_SSE2
+  // blue and red are 16 bits apart : rotating each pixel by 16 bits swaps them, green and alpha are masked out
+  for (; i + 4 <= Count; i += 4) {
+    V4u32 Pixel4 = *(const V4u32Unaligned*)&Pixels[i];
+    V4u32 RB = Pixel4 & 0x00FF00FF;
+    *(V4u32Unaligned*)&Pixels[i] = (Pixel4 & 0xFF00FF00) | (RB << 16) | (RB >> 16);
+  }
+#endif
+  for (; i < Count; ++i) {
+    UINT32 Pixel = Raw(Pixels[i]);
+    UINT32 RB = Pixel & 0x00FF00FF;
+    ((EFI_GRAPHICS_OUTPUT_BLT_PIXEL_UNION*)&Pixels[i])->Raw = (Pixel & 0xFF00FF00) | (RB << 16) | (RB >> 16);
+  }
+}
@@ -0,0 +1,51 @@
+/*
+ * XImageKernels.h
+ *
+ * Pixel loops used by XImage : alpha blending, bilinear scaling and red/blue swap.
+ * On X64 with gcc or clang, compose and flip process 4 pixels per operation with SSE2 vector extensions
+ * (intrinsics headers are not available, we compile with -nostdinc). Scaling works on 2 channels per
+ * 64 bits multiply on every platform.
+ * The ...Scalar() versions are the portable reference. Both give the same result, bit for bit.
+ */
+
+#ifndef LIBEG_XIMAGEKERNELS_H_
+#define LIBEG_XIMAGEKERNELS_H_
+
+extern "C" {
+#include <Protocol/GraphicsOutput.h>
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(MDE_CPU_X64))
+#define XIMAGE_KERNELS_SSE2 1
+#else
+#define XIMAGE_KERNELS_SSE2 0
+#endif
+
+/*
+ * Blend Count pixels of Top over Comp.
+ * Lowest means the result is opaque, else alpha of the result is Top alpha + Comp alpha * (1 - Top alpha).
+ * Gray turns the pixels where Top isn't fully transparent into gray.
+ */
+void XImageComposeRow(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Top, UINTN Count, bool Lowest, bool Gray);
+void XImageComposeRowScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Comp, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Top, UINTN Count, bool Lowest, bool Gray);
+
+/*
+ * Fill the DstWidth pixels of Dst by bilinear interpolation between source rows SrcRow0 and SrcRow1.
+ * StepX is the source distance between two destination pixels, 16.16 fixed point.
+ * Fy is the weight of SrcRow1, from 0 to 127 (7 bits).
+ */
+void XImageScaleRow(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Dst, UINTN DstWidth,
+                    const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow0, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow1, UINTN SrcWidth,
+                    UINT32 StepX, UINT32 Fy);
+void XImageScaleRowScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Dst, UINTN DstWidth,
+                          const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow0, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* SrcRow1, UINTN SrcWidth,
+                          UINT32 StepX, UINT32 Fy);
+
+/*
+ * Swap Red and Blue of Count pixels.
+ */
+void XImageFlipRB(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Count);
+void XImageFlipRBScalar(EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Count);
+
+
+#endif /* LIBEG_XIMAGEKERNELS_H_ */
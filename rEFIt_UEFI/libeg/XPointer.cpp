@@ -9,6 +9,7 @@
 #include "../refit/screen.h"
 #include "../Platform/Settings.h"
 #include "../libeg/XTheme.h"
+#include "XScreenShadow.h"
 
 #ifndef DEBUG_ALL
 #define DEBUG_MOUSE 0
@@ -182,8 +183,11 @@ void XPointer::UpdatePointer(bool isDaylight) // cannot be called daylight becau
     if (newPlace.YPos > UGAHeight - 1) newPlace.YPos = UGAHeight - 1;
 
     if ( oldPlace != newPlace ) {
+      // old and new places usually overlap, send them in one Blt
+      ScreenShadow.beginUpdate();
       Hide();
       Draw();
+      ScreenShadow.endUpdate();
     }
   }
 }
@@ -0,0 +1,135 @@
+/*
+ * XScreenShadow.cpp
+ *
+ * See XScreenShadow.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "XScreenShadow.h"
+#include "libegint.h"
+#include "../refit/lib.h"
+
+XScreenShadow ScreenShadow;
+
+
+static bool RectsTouch(const EG_RECT& A, const EG_RECT& B)
+{
+  return A.XPos <= B.XPos + B.Width && B.XPos <= A.XPos + A.Width &&
+         A.YPos <= B.YPos + B.Height && B.YPos <= A.YPos + A.Height;
+}
+
+static EG_RECT RectsUnion(const EG_RECT& A, const EG_RECT& B)
+{
+  INTN Left = MIN(A.XPos, B.XPos);
+  INTN Top = MIN(A.YPos, B.YPos);
+  INTN Right = MAX(A.XPos + A.Width, B.XPos + B.Width);
+  INTN Bottom = MAX(A.YPos + A.Height, B.YPos + B.Height);
+  return EG_RECT(Left, Top, Right - Left, Bottom - Top);
+}
+
+bool XScreenShadow::isUpToDate() const
+{
+  return Valid && UGAWidth > 0 && UGAHeight > 0 && Pixels.GetWidth() == UGAWidth && Pixels.GetHeight() == UGAHeight;
+}
+
+void XScreenShadow::bltToVideo(const XImage& Image, const EG_RECT& Rect)
+{
+  egScreenBlt(const_cast<EFI_GRAPHICS_OUTPUT_BLT_PIXEL*>(Image.GetPixelPtr(0, 0)), EfiBltBufferToVideo,
+    Rect.XPos, Rect.YPos, Rect.XPos, Rect.YPos, Rect.Width, Rect.Height, Image.GetWidth()*sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+}
+
+void XScreenShadow::flush()
+{
+  for (size_t idx = 0; idx < DirtyRects.size(); ++idx) {
+    bltToVideo(Pixels, DirtyRects[idx]);
+  }
+  DirtyRects.setEmpty();
+}
+
+/*
+ * A rectangle touching a pending one is merged with it : moving the pointer or redrawing a menu entry
+ * then costs one Blt instead of two or more.
+ */
+void XScreenShadow::addDirtyRect(const EG_RECT& Rect)
+{
+  EG_RECT NewRect = Rect;
+  size_t idx = 0;
+  while (idx < DirtyRects.size()) {
+    if (RectsTouch(DirtyRects[idx], NewRect)) {
+      NewRect = RectsUnion(DirtyRects[idx], NewRect);
+      DirtyRects.RemoveAtIndex(idx);
+      idx = 0; // the union may touch a rectangle already checked
+    } else {
+      idx++;
+    }
+  }
+  DirtyRects.Add(NewRect);
+  if (DirtyRects.size() >= MaxDirtyRects) flush();
+}
+
+void XScreenShadow::invalidate()
+{
+  flush();
+  Valid = false;
+}
+
+void XScreenShadow::fill(const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Color)
+{
+  DirtyRects.setEmpty(); // all covered by the fill
+  if (UGAWidth <= 0 || UGAHeight <= 0) {
+    Valid = false;
+    return;
+  }
+  if (Pixels.GetWidth() != UGAWidth || Pixels.GetHeight() != UGAHeight) {
+    Pixels.setSizeInPixels(UGAWidth, UGAHeight);
+  }
+  Pixels.Fill(Color);
+  Valid = true;
+}
+
+bool XScreenShadow::getArea(XImage& Image, INTN x, INTN y, UINTN W, UINTN H) const
+{
+  if (!isUpToDate()) return false;
+  for (UINTN Row = 0; Row < H; ++Row) {
+    CopyMem(Image.GetPixelPtr(0, Row), Pixels.GetPixelPtr(x, y + Row), W * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  }
+  return true;
+}
+
+bool XScreenShadow::put(const XImage& Image, INTN x, INTN y, UINTN W, UINTN H)
+{
+  if (W == 0 || H == 0) return false;
+  if (x < 0 || y < 0 || x + W > (UINTN)UGAWidth || y + H > (UINTN)UGAHeight || W > (UINTN)Image.GetWidth() || H > (UINTN)Image.GetHeight()) {
+    invalidate();
+    return false;
+  }
+  if (!isUpToDate()) {
+    if (x != 0 || y != 0 || W != (UINTN)UGAWidth || H != (UINTN)UGAHeight) {
+      // only part of the screen is known
+      Valid = false;
+      return false;
+    }
+    DirtyRects.setEmpty();
+    if (Pixels.GetWidth() != UGAWidth || Pixels.GetHeight() != UGAHeight) {
+      Pixels.setSizeInPixels(UGAWidth, UGAHeight);
+    }
+    Valid = true;
+  }
+  for (UINTN Row = 0; Row < H; ++Row) {
+    CopyMem(Pixels.GetPixelPtr(x, y + Row), Image.GetPixelPtr(0, Row), W * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+  }
+  if (UpdateDepth == 0) return false;
+  addDirtyRect(EG_RECT(x, y, W, H));
+  return true;
+}
+
+void XScreenShadow::beginUpdate()
+{
+  UpdateDepth++;
+}
+
+void XScreenShadow::endUpdate()
+{
+  if (UpdateDepth == 0) return;
+  if (--UpdateDepth == 0) flush();
+}
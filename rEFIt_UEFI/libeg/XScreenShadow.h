@@ -0,0 +1,69 @@
+/*
+ * XScreenShadow.h
+ *
+ * A copy in memory of what Clover has drawn on the screen.
+ * Reading back the framebuffer (Blt VideoToBltBuffer) is very slow on many GPUs, and XImage::Draw()
+ * does it for every compose. With the shadow, the background is taken from memory and only the
+ * drawn rectangles are sent to the video.
+ *
+ * The shadow becomes valid when the whole screen is drawn or filled, and is invalidated each time
+ * something else than XImage may write on the screen (mode change, text mode, external tools).
+ * Between beginUpdate() and endUpdate(), rectangles are not sent one by one but merged and sent at the end.
+ */
+
+#ifndef LIBEG_XSCREENSHADOW_H_
+#define LIBEG_XSCREENSHADOW_H_
+
+#include "XImage.h"
+
+
+class XScreenShadow
+{
+public:
+  // More rectangles in one update are sent without waiting endUpdate()
+  static const size_t MaxDirtyRects = 16;
+
+protected:
+  XImage          Pixels = XImage();
+  bool            Valid = false;
+  size_t          UpdateDepth = 0;
+  XArray<EG_RECT> DirtyRects = XArray<EG_RECT>();
+
+  bool isUpToDate() const;
+  void addDirtyRect(const EG_RECT& Rect);
+  void flush();
+  static void bltToVideo(const XImage& Image, const EG_RECT& Rect);
+
+public:
+  XScreenShadow() {}
+  XScreenShadow(const XScreenShadow&) = delete;
+  XScreenShadow& operator=(const XScreenShadow&) = delete;
+
+  bool isValid() const { return isUpToDate(); }
+
+  // The screen may have been modified without XImage. Pending rectangles are sent before.
+  void invalidate();
+
+  // The whole screen has been filled with Color
+  void fill(const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& Color);
+
+  /*
+   * Copy the area x,y,W,H of the screen into Image, already clipped and sized by the caller.
+   * Return false if the shadow is not valid : the caller must read the video.
+   */
+  bool getArea(XImage& Image, INTN x, INTN y, UINTN W, UINTN H) const;
+
+  /*
+   * Image, from 0,0, was drawn at x,y,W,H (already clipped).
+   * Return true if the video update is deferred to endUpdate() : the caller must not Blt.
+   */
+  bool put(const XImage& Image, INTN x, INTN y, UINTN W, UINTN H);
+
+  void beginUpdate();
+  void endUpdate();
+};
+
+extern XScreenShadow ScreenShadow;
+
+
+#endif /* LIBEG_XSCREENSHADOW_H_ */
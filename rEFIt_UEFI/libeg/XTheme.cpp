@@ -18,6 +18,10 @@ extern "C" {
 
 #include "XTheme.h"
 #include "nanosvg.h"
+#include "SVGGlyphCache.h"
+#include "SVGShapeIndex.h"
+#include "XThemeCache.h"
+#include "../cpp_foundation/fnv_hash.h"
 
 #ifndef DEBUG_ALL
 #define DEBUG_XTHEME 1
@@ -69,6 +73,8 @@ InitTheme(const CHAR8* ChosenTheme)
     textFace[i].valid = FALSE;
   }
 
+  GlyphCache.setEmpty(); //rendered with the fonts freed below
+  ShapeIndex.setEmpty(); //shapes of the previous theme.svg
   NSVGfontChain *fontChain = fontsDB;
   while (fontChain) {
     NSVGfont *font = fontChain->font;
@@ -92,6 +98,7 @@ InitTheme(const CHAR8* ChosenTheme)
    }
    */
   ThemeX.FontImage.setEmpty();
+  ThemeX.FontEmptyLeft.setEmpty();
 
   Rnd = (ThemeNameArray.size() != 0) ? Now.Second % ThemeNameArray.size() : 0;
 
@@ -233,6 +240,7 @@ finish:
   if (!ThemeX.TypeSVG) {
     ThemeX.PrepareFont();
   }
+  ThemeX.CloseImageCache(!ThemeX.embedded);
 
   //ThemeX.ClearScreen();
   return Status;
@@ -252,8 +260,8 @@ XTheme::XTheme() : Icons(), ThemeDir(0), HideBadges(0), HideUIFlags(0), Font(FON
                    MainEntriesSize(0), TileXSpace(0), TileYSpace(0), Proportional(0), embedded(0), DarkEmbedded(0), TypeSVG(0), Scale(0), CentreShift(0),
                    row0TileSize(0), row1TileSize(0), BanHeight(0), LayoutHeight(0), LayoutBannerOffset(0), LayoutButtonOffset(0), LayoutTextOffset(0),
                    LayoutAnimMoveForMenuX(0), ScrollWidth(0), ScrollButtonsHeight(0), ScrollBarDecorationsHeight(0), ScrollScrollDecorationsHeight(0),
-                   FontWidth(0), FontHeight(0), TextHeight(0), Daylight(0), Background(), BigBack(), Banner(), SelectionImages(), Buttons(), ScrollbarBackgroundImage(), BarStartImage(), BarEndImage(),
-                   ScrollbarImage(), ScrollStartImage(), ScrollEndImage(), UpButtonImage(), DownButtonImage(), FontImage(), BannerPlace(), Cinema(), SVGParser(0)
+                   FontWidth(0), FontHeight(0), TextHeight(0), Daylight(0), Background(), BackgroundGeneration(0), BigBack(), Banner(), SelectionImages(), Buttons(), ScrollbarBackgroundImage(), BarStartImage(), BarEndImage(),
+                   ScrollbarImage(), ScrollStartImage(), ScrollEndImage(), UpButtonImage(), DownButtonImage(), FontImage(), FontEmptyLeft(), BannerPlace(), Cinema(), SVGParser(0)
 {
   Init();
 }
@@ -264,6 +272,7 @@ XTheme::~XTheme() {
 
 void XTheme::Init()
 {
+  BackgroundGeneration++;
 //  DisableFlags = 0;             
   HideBadges = 0; 
   HideUIFlags = 0; 
@@ -332,6 +341,96 @@ void XTheme::Init()
   Cinema.setEmpty();
 }
 
+/*
+ * The order of the entries doesn't matter, only what they are.
+ */
+static UINT64 HashDirListing(const EFI_FILE* Dir, const CHAR16* SubDir, UINT64 Hash)
+{
+  REFIT_DIR_ITER  DirIter;
+  EFI_FILE_INFO   *DirEntry;
+  UINT64          Sum = 0;
+
+  DirIterOpen(Dir, SubDir, &DirIter);
+  while (DirIterNext(&DirIter, 2, NULL, &DirEntry)) {
+    UINT64 EntryHash = fnv1a64(DirEntry->FileName, StrSize(DirEntry->FileName));
+    EntryHash = fnv1a64(&DirEntry->FileSize, sizeof(DirEntry->FileSize), EntryHash);
+    EntryHash = fnv1a64(&DirEntry->ModificationTime, sizeof(DirEntry->ModificationTime), EntryHash);
+    Sum += EntryHash;
+  }
+  DirIterClose(&DirIter);
+  return fnv1a64(&Sum, sizeof(Sum), Hash);
+}
+
+/*
+ * Key of the image cache : the theme file and the screen size. The scale of a vector theme is computed from both.
+ * The images of a PNG theme are not read to compute it, their names, sizes and dates are used instead.
+ */
+static UINT64 ThemeImageCacheKey(const EFI_FILE* ThemeDir, const CHAR8* ThemeFile, UINTN Size, bool ListImages)
+{
+  UINT64 Key = fnv1a64(ThemeFile, Size);
+  Key = fnv1a64(&UGAWidth, sizeof(UGAWidth), Key);
+  Key = fnv1a64(&UGAHeight, sizeof(UGAHeight), Key);
+  if (ListImages) {
+    Key = HashDirListing(ThemeDir, NULL, Key);
+    Key = HashDirListing(ThemeDir, L"icons", Key);
+  }
+  return Key;
+}
+
+void XTheme::OpenImageCache(UINT64 Key)
+{
+  UINT8 *FileData = NULL;
+  UINTN FileDataLength = 0;
+
+  if (EFI_ERROR(egLoadFile(&self.getCloverDir(), THEME_IMAGE_CACHE, &FileData, &FileDataLength))) {
+    FileData = NULL;
+    FileDataLength = 0;
+  }
+  if (ThemeCache.load(FileData, FileDataLength, Key)) {
+    DBG("%llu theme images from %ls\n", (UINT64)ThemeCache.getNbImages(), THEME_IMAGE_CACHE);
+  } else {
+    DBG("%ls is not for this theme and screen, it will be rebuilt\n", THEME_IMAGE_CACHE);
+  }
+}
+
+void XTheme::CloseImageCache(bool Save)
+{
+  if (Save && ThemeCache.isModified()) {
+    if (EFI_ERROR(egSaveFile(&self.getCloverDir(), THEME_IMAGE_CACHE, ThemeCache.getData().data(), ThemeCache.getData().size()))) {
+      DBG("%ls not saved\n", THEME_IMAGE_CACHE);
+    }
+  }
+  ThemeCache.setEmpty();
+}
+
+EFI_STATUS XTheme::LoadThemeImage(XImage* Image, const char* Name)
+{
+  return LoadThemeImage(Image, XStringW().takeValueFrom(Name));
+}
+
+EFI_STATUS XTheme::LoadThemeImage(XImage* Image, const XStringW& Name)
+{
+  XString8 CacheName = XString8().takeValueFrom(Name);
+  const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels = NULL;
+  UINTN Width = 0, Height = 0;
+
+  if (ThemeCache.find(CacheName, &Pixels, &Width, &Height)) {
+    if (Pixels == NULL || Width == 0 || Height == 0) {
+      return EFI_NOT_FOUND; // Image unchanged, as LoadXImage() does when there is no file
+    }
+    Image->setSizeInPixels(Width, Height);
+    CopyMem(Image->GetPixelPtr(0,0), Pixels, Width * Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL));
+    return EFI_SUCCESS;
+  }
+  EFI_STATUS Status = Image->LoadXImage(ThemeDir, Name);
+  if (EFI_ERROR(Status)) {
+    ThemeCache.add(CacheName, NULL, 0, 0);
+  } else if (!Image->isEmpty()) {
+    ThemeCache.add(CacheName, Image->GetPixelPtr(0,0), Image->GetWidth(), Image->GetHeight());
+  }
+  return Status;
+}
+
 TagDict* XTheme::LoadTheme(const XStringW& TestTheme)
 {
   EFI_STATUS Status    = EFI_UNSUPPORTED;
@@ -360,6 +459,7 @@ TagDict* XTheme::LoadTheme(const XStringW& TestTheme)
   if (!EFI_ERROR(Status)) {
     Status = egLoadFile(ThemeDir, CONFIG_THEME_SVG, (UINT8**)&ThemePtr, &Size);
     if (!EFI_ERROR(Status) && (ThemePtr != NULL) && (Size != 0)) {
+      OpenImageCache(ThemeImageCacheKey(ThemeDir, ThemePtr, Size, false));
       Status = ParseSVGXTheme(ThemePtr);
       if (EFI_ERROR(Status)) {
         ThemeDict = NULL;
@@ -374,6 +474,7 @@ TagDict* XTheme::LoadTheme(const XStringW& TestTheme)
     } else {
       Status = egLoadFile(ThemeDir, CONFIG_THEME_FILENAME, (UINT8**)&ThemePtr, &Size);
       if (!EFI_ERROR(Status) && (ThemePtr != NULL) && (Size != 0)) {
+        OpenImageCache(ThemeImageCacheKey(ThemeDir, ThemePtr, Size, true));
         Status = ParseXML(ThemePtr, &ThemeDict, 0);
         if (EFI_ERROR(Status)) {
           ThemeDict = NULL;
@@ -957,6 +1058,7 @@ void XTheme::FillByEmbedded()
 
   BigBack.setEmpty();
   Background = XImage(UGAWidth, UGAHeight);
+  BackgroundGeneration++;
 
   if (Daylight) {
     Banner.FromPNG(ACCESS_EMB_DATA(emb_logo), emb_logo_size);
@@ -1107,6 +1209,7 @@ void XTheme::ClearScreen() //and restore background and banner
   if (!Banner.isEmpty()) {
     Background.Compose(BannerPlace.XPos, BannerPlace.YPos, Banner, true);
   }
+  BackgroundGeneration++;
   Background.DrawWithoutCompose(0, 0, UGAWidth, UGAHeight);
 }
 
@@ -1121,19 +1224,19 @@ void XTheme::FillByDir() //assume ThemeDir is defined by InitTheme() procedure
     XIcon* NewIcon = new XIcon(i); //initialize without embedded
     switch (i) {
       case BUILTIN_SELECTION_SMALL:
-        Status = NewIcon->Image.LoadXImage(ThemeDir, SelectionSmallFileName);
+        Status = LoadThemeImage(&NewIcon->Image, SelectionSmallFileName);
         break;
       case BUILTIN_SELECTION_BIG:
-        Status = NewIcon->Image.LoadXImage(ThemeDir, SelectionBigFileName);
+        Status = LoadThemeImage(&NewIcon->Image, SelectionBigFileName);
         break;
     }
     if (EFI_ERROR(Status)) {
-      Status = NewIcon->Image.LoadXImage(ThemeDir, IconsNames[i]);
+      Status = LoadThemeImage(&NewIcon->Image, IconsNames[i]);
     }
     NewIcon->Native = !EFI_ERROR(Status);
     if (!EFI_ERROR(Status)) {
       NewIcon->setFilled();
-      NewIcon->ImageNight.LoadXImage(ThemeDir, SWPrintf("%s_night", IconsNames[i]));
+      LoadThemeImage(&NewIcon->ImageNight, SWPrintf("%s_night", IconsNames[i]));
     }
     Icons.AddReference(NewIcon, true);
     if (EFI_ERROR(Status)) {
@@ -1148,9 +1251,9 @@ void XTheme::FillByDir() //assume ThemeDir is defined by InitTheme() procedure
   if (BootCampStyle) {
     XIcon *NewIcon = new XIcon(BUILTIN_ICON_SELECTION);
     // load indicator selection image
-    Status = NewIcon->Image.LoadXImage(ThemeDir, SelectionIndicatorName);
+    Status = LoadThemeImage(&NewIcon->Image, SelectionIndicatorName);
     if (EFI_ERROR(Status)) {
-      Status = NewIcon->Image.LoadXImage(ThemeDir, "selection_indicator");
+      Status = LoadThemeImage(&NewIcon->Image, "selection_indicator");
     }
     Icons.AddReference(NewIcon, true);
   }
@@ -1173,8 +1276,8 @@ void XTheme::FillByDir() //assume ThemeDir is defined by InitTheme() procedure
   Buttons[3] = *GetIconP(BUILTIN_CHECKBOX_CHECKED)->GetBest(!Daylight);
 
   //load banner and background
-  Banner.LoadXImage(ThemeDir, BannerFileName); 
-  Status = BigBack.LoadXImage(ThemeDir, BackgroundName);
+  LoadThemeImage(&Banner, BannerFileName);
+  Status = LoadThemeImage(&BigBack, BackgroundName);
   if (EFI_ERROR(Status) && !Banner.isEmpty()) {
     //take first pixel from banner
     const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& firstPixel = Banner.GetPixel(0,0);
@@ -16,6 +16,7 @@ class TagStruct;
 #define INDICATOR_SIZE (52)
 #define CONFIG_THEME_FILENAME L"theme.plist"
 #define CONFIG_THEME_SVG L"theme.svg"
+#define THEME_IMAGE_CACHE L"misc\\theme_cache.bin"
 #define HEIGHT_2K 1100
 
 
@@ -126,6 +127,7 @@ public:
   BOOLEAN     Daylight;
 
   XImage  Background; //Background and Banner will not be in array as they live own life
+  UINTN   BackgroundGeneration; //changes when the theme or the background are made again : images composed on them are obsolete
   XImage  BigBack; //it size is not equal to screen size will be scaled or cropped
   XImage  Banner; //same as logo in the array, make a link?
   XImage  SelectionImages[6];
@@ -140,6 +142,7 @@ public:
   XImage  DownButtonImage;
 
   XImage  FontImage;
+  XArray<INTN> FontEmptyLeft; //for proportional fonts, empty columns before each char of FontImage
 
   EG_RECT  BannerPlace;
 
@@ -171,6 +174,7 @@ public:
   void LoadFontImage(IN BOOLEAN UseEmbedded, IN INTN Rows, IN INTN Cols);
   void PrepareFont();
   INTN GetEmpty(const XImage& Buffer, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL& FirstPixel, INTN MaxWidth, INTN Start, INTN Step);
+  INTN GetFontEmptyLeft(UINT16 c);
   INTN RenderText(IN const XStringW& Text, OUT XImage* CompImage_ptr,
                     IN INTN PosX, IN INTN PosY, IN UINTN Cursor, INTN textType, float textScale = 0.f);
   //overload for UTF8 text
@@ -182,6 +186,10 @@ public:
 //  void AddIcon(XIcon& NewIcon);  //return EFI_STATUS?
   void FillByEmbedded();
   void FillByDir();
+  EFI_STATUS LoadThemeImage(XImage* Image, const XStringW& Name); // LoadXImage() from ThemeDir, through the image cache
+  EFI_STATUS LoadThemeImage(XImage* Image, const char* Name);
+  void OpenImageCache(UINT64 Key);
+  void CloseImageCache(bool Save);
   EFI_STATUS GetThemeTagSettings(const TagDict* DictPointer);
   void parseTheme(void* p, char** dict); //in nano project
   EFI_STATUS ParseSVGXTheme(const CHAR8* buffer); // in VectorTheme
@@ -0,0 +1,154 @@
+/*
+ * XThemeCache.cpp
+ *
+ * See XThemeCache.h
+ */
+
+#include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
+#include "XThemeCache.h"
+
+#define THEME_CACHE_MAGIC "CLTHEMEC"
+#define HEADER_SIZE 24
+#define IMAGE_HEADER_SIZE 16
+
+XThemeCache ThemeCache;
+
+
+static UINT32 GetUint32(const UINT8* p)
+{
+  UINT32 v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static void SetUint32(UINT8* p, UINT32 v)
+{
+  memcpy(p, &v, sizeof(v));
+}
+
+void XThemeCache::setEmpty()
+{
+  Data.stealValueFrom((UINT8*)NULL, (size_t)0); // free it, setEmpty() would keep the memory
+  Images.setEmpty();
+  Modified = false;
+}
+
+void XThemeCache::start(UINT64 Key)
+{
+  setEmpty();
+  UINT8 Header[HEADER_SIZE];
+  memcpy(Header, THEME_CACHE_MAGIC, 8);
+  SetUint32(Header + 8, Version);
+  SetUint32(Header + 12, 0);
+  memcpy(Header + 16, &Key, sizeof(Key));
+  Data.ncat(Header, sizeof(Header));
+}
+
+UINT64 XThemeCache::getKey() const
+{
+  UINT64 Key = 0;
+  if (isOpen()) {
+    memcpy(&Key, Data.data() + 16, sizeof(Key));
+  }
+  return Key;
+}
+
+// Check the whole file and find where the images are
+bool XThemeCache::index()
+{
+  const UINT8* p = Data.data();
+  size_t Size = Data.size();
+  if (Size < HEADER_SIZE || memcmp(p, THEME_CACHE_MAGIC, 8) != 0 || GetUint32(p + 8) != Version) {
+    return false;
+  }
+  UINT32 NbImages = GetUint32(p + 12);
+  size_t Offset = HEADER_SIZE;
+  for (UINT32 i = 0; i < NbImages; ++i) {
+    if (Size - Offset < IMAGE_HEADER_SIZE) return false;
+    UINT32 NameLength = GetUint32(p + Offset);
+    UINT32 Width = GetUint32(p + Offset + 4);
+    UINT32 Height = GetUint32(p + Offset + 8);
+    if (NameLength > MaxImageSize || Width > MaxImageSize || Height > MaxImageSize) return false;
+    size_t ImageSize = IMAGE_HEADER_SIZE + nameSize(NameLength) + (size_t)Width * Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+    if (Size - Offset < ImageSize || p[Offset + IMAGE_HEADER_SIZE + NameLength] != 0) return false;
+    Images.Add(Offset);
+    Offset += ImageSize;
+  }
+  return Offset == Size;
+}
+
+bool XThemeCache::load(UINT8* FileData, size_t FileSize, UINT64 Key)
+{
+  setEmpty();
+  if (FileData == NULL) {
+    start(Key);
+    return false;
+  }
+  Data.stealValueFrom(FileData, FileSize);
+  if (!index() || getKey() != Key) {
+    start(Key);
+    return false;
+  }
+  return true;
+}
+
+size_t XThemeCache::findImage(const XString8& Name) const
+{
+  for (size_t idx = 0; idx < Images.size(); ++idx) {
+    if (GetUint32(Data.data() + Images[idx]) == Name.length() &&
+        memcmp(nameAt(Images[idx]), Name.c_str(), Name.length()) == 0) {
+      return idx;
+    }
+  }
+  return MAX_XSIZE;
+}
+
+void XThemeCache::add(const XString8& Name, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Width, UINTN Height)
+{
+  if (!isOpen() || Name.length() > MaxImageSize || Width > MaxImageSize || Height > MaxImageSize || findImage(Name) != MAX_XSIZE) {
+    return;
+  }
+  if (Pixels == NULL) {
+    Width = 0;
+    Height = 0;
+  }
+  size_t NameLength = Name.length();
+  size_t PixelsSize = Width * Height * sizeof(EFI_GRAPHICS_OUTPUT_BLT_PIXEL);
+  size_t Offset = Data.size();
+  // grow by doubling, the background alone can be several megabytes
+  Data.CheckAllocatedSize(Offset + IMAGE_HEADER_SIZE + nameSize((UINT32)NameLength) + PixelsSize, Offset);
+
+  UINT8 Header[IMAGE_HEADER_SIZE];
+  SetUint32(Header, (UINT32)NameLength);
+  SetUint32(Header + 4, (UINT32)Width);
+  SetUint32(Header + 8, (UINT32)Height);
+  SetUint32(Header + 12, Pixels ? FlagPresent : 0);
+  Data.ncat(Header, sizeof(Header));
+  Data.ncat(Name.c_str(), NameLength);
+  static const UINT8 Zeros[4] = {0, 0, 0, 0};
+  Data.ncat(Zeros, nameSize((UINT32)NameLength) - NameLength);
+  if (PixelsSize != 0) {
+    Data.ncat(Pixels, PixelsSize);
+  }
+  Images.Add(Offset);
+  SetUint32(Data.data() + 12, (UINT32)Images.size());
+  Modified = true;
+}
+
+bool XThemeCache::find(const XString8& Name, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL** Pixels, UINTN* Width, UINTN* Height) const
+{
+  size_t idx = findImage(Name);
+  if (idx == MAX_XSIZE) {
+    return false;
+  }
+  const UINT8* p = Data.data() + Images[idx];
+  UINT32 NameLength = GetUint32(p);
+  *Width = GetUint32(p + 4);
+  *Height = GetUint32(p + 8);
+  if ((GetUint32(p + 12) & FlagPresent) == 0) {
+    *Pixels = NULL;
+  } else {
+    *Pixels = (const EFI_GRAPHICS_OUTPUT_BLT_PIXEL*)(p + IMAGE_HEADER_SIZE + nameSize(NameLength));
+  }
+  return true;
+}
@@ -0,0 +1,83 @@
+/*
+ * XThemeCache.h
+ *
+ * Theme images as they are after decoding the PNG or rasterizing theme.svg, kept in a file on the ESP.
+ * Decoding and rasterizing give the same pixels at each boot for the same theme files and the same screen,
+ * so the next boot reads them back instead, in one file read.
+ *
+ * The cache is identified by a Key, a hash of the theme files, of the resolution and of the scale.
+ * A file made for another key is not used : the cache starts empty and is filled again.
+ *
+ * File format, little endian, the memory image is the file itself :
+ *   header : Magic[8] "CLTHEMEC", UINT32 Version, UINT32 NbImages, UINT64 Key
+ *   NbImages times : UINT32 NameLength, UINT32 Width, UINT32 Height, UINT32 Flags,
+ *                    Name with a terminating 0 padded to a multiple of 4, Width*Height BGRA pixels
+ * An image asked for but not found in the theme is kept too, without the Present flag.
+ */
+
+#ifndef LIBEG_XTHEMECACHE_H_
+#define LIBEG_XTHEMECACHE_H_
+
+extern "C" {
+#include <Protocol/GraphicsOutput.h>
+}
+#include "../cpp_foundation/XArray.h"
+#include "../cpp_foundation/XBuffer.h"
+#include "../cpp_foundation/XString.h"
+
+
+class XThemeCache
+{
+public:
+  static const UINT32 Version = 1;
+  static const UINT32 MaxImageSize = 16384; // width or height, anything bigger is a broken file
+
+protected:
+  static const UINT32 FlagPresent = 1;
+
+  XBuffer<UINT8> Data;                      // header then images, as in the file. Empty if the cache is not open
+  XArray<size_t> Images = XArray<size_t>(); // offset in Data of each image
+  bool           Modified = false;
+
+  const char* nameAt(size_t Offset) const { return (const char*)Data.data() + Offset + 16; }
+  static size_t nameSize(UINT32 NameLength) { return (NameLength + 4) & ~(size_t)3; }
+  size_t findImage(const XString8& Name) const;
+  bool index();
+
+public:
+  XThemeCache() : Data() {}
+  XThemeCache(const XThemeCache&) = delete;
+  XThemeCache& operator=(const XThemeCache&) = delete;
+
+  // Open an empty cache for Key
+  void start(UINT64 Key);
+  /*
+   * Open the cache read from a file. FileData is taken, it must be allocated by AllocatePool or malloc.
+   * Returns false if it is not a valid cache for Key : the cache is then open and empty for Key.
+   */
+  bool load(UINT8* FileData, size_t FileSize, UINT64 Key);
+  void setEmpty();
+
+  bool isOpen() const { return Data.size() != 0; }
+  bool isModified() const { return Modified; }
+  UINT64 getKey() const;
+  size_t getNbImages() const { return Images.size(); }
+  // the file to save
+  const XBuffer<UINT8>& getData() const { return Data; }
+
+  /*
+   * Keep the image Name. Pixels is NULL if the image doesn't exist in the theme.
+   * Nothing is done if the cache is not open or already has Name.
+   */
+  void add(const XString8& Name, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL* Pixels, UINTN Width, UINTN Height);
+  /*
+   * false if Name is not in the cache. Otherwise *Pixels is NULL for an image not found in the theme.
+   * Pixels stay valid until the next add(), load() or setEmpty().
+   */
+  bool find(const XString8& Name, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL** Pixels, UINTN* Width, UINTN* Height) const;
+};
+
+extern XThemeCache ThemeCache;
+
+
+#endif /* LIBEG_XTHEMECACHE_H_ */
@@ -250,6 +250,10 @@ EFI_STATUS egMkDir(const EFI_FILE* BaseDir OPTIONAL, IN CONST CHAR16 *DirName);
 EFI_STATUS egFindESP(OUT EFI_FILE** RootDir);
 
 void egClearScreen(IN const void *Color);
+// Blt with the GOP (or UGA) found by egInitScreen(). Same parameters as GraphicsOutput->Blt
+EFI_STATUS egScreenBlt(IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer, IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
+                       IN UINTN SourceX, IN UINTN SourceY, IN UINTN DestinationX, IN UINTN DestinationY,
+                       IN UINTN Width, IN UINTN Height, IN UINTN Delta);
 
 EFI_STATUS egScreenShot(void);
 
@@ -39,6 +39,7 @@
 #include "lodepng.h"
 #include "../Platform/Settings.h"
 #include "../Settings/Self.h"
+#include "XScreenShadow.h"
 
 
 // Console defines and variables
@@ -361,6 +362,8 @@ void egInitScreen(IN BOOLEAN SetMaxResolution)
     UINT32 Width, Height, Depth, RefreshRate;
 //    CHAR16 *Resolution;
 
+    ScreenShadow.invalidate();
+
     // get protocols
     Status = EfiLibLocateProtocol(&ConsoleControlProtocolGuid, (void **) &ConsoleControl);
     if (EFI_ERROR(Status))
@@ -471,6 +474,9 @@ void egSetGraphicsModeEnabled(IN BOOLEAN Enable)
     EFI_CONSOLE_CONTROL_SCREEN_MODE CurrentMode;
     EFI_CONSOLE_CONTROL_SCREEN_MODE NewMode;
 
+    // the firmware may clear or write on the screen
+    ScreenShadow.invalidate();
+
     if (ConsoleControl != NULL) {   
         // Some UEFI bioses may cause resolution switch when switching to Text Mode via the ConsoleControl->SetMode command
         // EFI applications wishing to use text, call the ConsoleControl->GetMode() command, and depending on its result may call ConsoleControl->SetMode().
@@ -508,21 +514,36 @@ void egSetGraphicsModeEnabled(IN BOOLEAN Enable)
 // Drawing to the screen
 //
 
+/*
+ * The protocols are located once by egInitScreen(), instead of at each draw. GraphicsOutput->Mode
+ * always describes the current mode, and LockBootScreen() patches the interface in place.
+ */
+EFI_STATUS egScreenBlt(IN EFI_GRAPHICS_OUTPUT_BLT_PIXEL *BltBuffer, IN EFI_GRAPHICS_OUTPUT_BLT_OPERATION BltOperation,
+                       IN UINTN SourceX, IN UINTN SourceY, IN UINTN DestinationX, IN UINTN DestinationY,
+                       IN UINTN Width, IN UINTN Height, IN UINTN Delta)
+{
+  if (GraphicsOutput != NULL) {
+    return GraphicsOutput->Blt(GraphicsOutput, BltBuffer, BltOperation,
+                               SourceX, SourceY, DestinationX, DestinationY, Width, Height, Delta);
+  }
+  if (UgaDraw != NULL) {
+    // EFI_GRAPHICS_OUTPUT_BLT_PIXEL and EFI_UGA_PIXEL have the same
+    // layout, and the header from TianoCore actually defines them
+    // to be the same type. Same for the operations.
+    return UgaDraw->Blt(UgaDraw, (EFI_UGA_PIXEL*)BltBuffer, (EFI_UGA_BLT_OPERATION)BltOperation,
+                        SourceX, SourceY, DestinationX, DestinationY, Width, Height, Delta);
+  }
+  return EFI_UNSUPPORTED;
+}
+
 void egClearScreen(IN const void *Color)
 {
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL  FillColor = *(EFI_GRAPHICS_OUTPUT_BLT_PIXEL *)Color;
   if (!egHasGraphics)
     return;
 
-  if (GraphicsOutput != NULL) {
-    // EFI_GRAPHICS_OUTPUT_BLT_PIXEL and EFI_UGA_PIXEL have the same
-    // layout, and the header from TianoCore actually defines them
-    // to be the same type.
-    GraphicsOutput->Blt(GraphicsOutput, &FillColor, EfiBltVideoFill,
-                        0, 0, 0, 0, egScreenWidth, egScreenHeight, 0);
-  } else if (UgaDraw != NULL) {
-    UgaDraw->Blt(UgaDraw, (EFI_UGA_PIXEL*)&FillColor, EfiUgaVideoFill,
-                 0, 0, 0, 0, egScreenWidth, egScreenHeight, 0);
+  if (!EFI_ERROR(egScreenBlt(&FillColor, EfiBltVideoFill, 0, 0, 0, 0, egScreenWidth, egScreenHeight, 0))) {
+    ScreenShadow.fill(FillColor);
   }
 }
 
@@ -581,6 +602,7 @@ static EFI_STATUS GopSetModeAndReconnectTextOut(IN UINT32 ModeNumber)
         return EFI_UNSUPPORTED;
     }
 
+    ScreenShadow.invalidate();
     Status = GraphicsOutput->SetMode(GraphicsOutput, ModeNumber);
     MsgLog("Video mode change to mode #%d: %s\n", ModeNumber, efiStrError(Status));
 
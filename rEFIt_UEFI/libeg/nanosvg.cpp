@@ -552,12 +552,22 @@ static void nsvg__deletePaths(NSVGpath* path)
   }
 }
 
+static void nsvg__deleteGlyphIndex(NSVGfont* font)
+{
+  if (font->glyphIndex) {
+    FreePool(font->glyphIndex);
+    font->glyphIndex = NULL;
+  }
+  font->glyphIndexSize = 0;
+}
+
 void nsvg__deleteFont(NSVGfont* font)
 {
   NSVGglyph *glyphs, *next;
   if (!font) {
     return;
   }
+  nsvg__deleteGlyphIndex(font);
   if (font->missingGlyph) {
 //    DBG("missing glyph=%s\n", font->missingGlyph->name);
     nsvg__deletePaths(font->missingGlyph->path);
@@ -3893,6 +3903,7 @@ static void nsvg__parseGlyph(NSVGparser* p, char** dict, BOOLEAN missing)
       }
       glyph->next = p->font->glyphs;
       p->font->glyphs = glyph;
+      nsvg__deleteGlyphIndex(p->font); //rebuilt at next search
     }
   }
   //  DBG("glyph %X parsed\n", glyph->unicode);
@@ -4070,6 +4081,54 @@ static void nsvg__endElement(void* ud, const char* el)
   }
 }
 
+// open addressing by unicode, the first glyph of the chain wins as with the list walk
+NSVGglyph* nsvg__findGlyph(NSVGfont* font, CHAR16 letter)
+{
+  NSVGglyph* g;
+  int mask;
+  int i;
+  if (!font) {
+    return NULL;
+  }
+  if (!font->glyphIndex) {
+    int count = 0;
+    for (g = font->glyphs; g; g = g->next) {
+      count++;
+    }
+    font->glyphIndexSize = 16;
+    while (font->glyphIndexSize < count * 2) {
+      font->glyphIndexSize *= 2;
+    }
+    font->glyphIndex = (NSVGglyph**)AllocateZeroPool(font->glyphIndexSize * sizeof(NSVGglyph*));
+    if (!font->glyphIndex) {
+      font->glyphIndexSize = 0;
+      for (g = font->glyphs; g; g = g->next) {
+        if (g->unicode == letter) return g;
+      }
+      return NULL;
+    }
+    mask = font->glyphIndexSize - 1;
+    for (g = font->glyphs; g; g = g->next) {
+      i = g->unicode & mask;
+      while (font->glyphIndex[i] && font->glyphIndex[i]->unicode != g->unicode) {
+        i = (i + 1) & mask;
+      }
+      if (!font->glyphIndex[i]) {
+        font->glyphIndex[i] = g;
+      }
+    }
+  }
+  mask = font->glyphIndexSize - 1;
+  i = letter & mask;
+  while (font->glyphIndex[i]) {
+    if (font->glyphIndex[i]->unicode == letter) {
+      return font->glyphIndex[i];
+    }
+    i = (i + 1) & mask;
+  }
+  return NULL;
+}
+
 float addLetter(NSVGparser* p, CHAR16 letter, float x, float y, float scale, UINT32 color)
 {
   float x1 = x; //initial position
@@ -4088,23 +4147,10 @@ float addLetter(NSVGparser* p, CHAR16 letter, float x, float y, float scale, UIN
   shape = (NSVGshape*)AllocateZeroPool(sizeof(NSVGshape));
   if (shape == NULL) return x;
 
-  g = p->text->font->glyphs;
-  while (g) {
-    if (g->unicode == letter) {
-      shape->paths = g->path;
-      /*
-      if (shape->paths) {
-        if (letter == L'C') {
-          DBG("Found glyph %X, point[0]=(%d,%d) points=%d\n", letter,
-              (int)shape->paths->pts[0], (int)shape->paths->pts[1], shape->paths->npts);
-          shape->debug = TRUE;
-        }
-      } */
-      break;
-    }
-    g = g->next;
-  }
-  if (!g) {
+  g = nsvg__findGlyph(p->text->font, letter);
+  if (g) {
+    shape->paths = g->path;
+  } else {
     //missing glyph
     g = p->text->font->missingGlyph;
     shape->paths = g->path;
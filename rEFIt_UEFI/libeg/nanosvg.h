@@ -346,6 +346,8 @@ typedef struct NSVGfont {
   // -- glyphs
   NSVGglyph* missingGlyph;
   NSVGglyph* glyphs; // a chain
+  NSVGglyph** glyphIndex; // glyphs by unicode, built by nsvg__findGlyph(). Size is a power of 2
+  int glyphIndexSize;
 //  struct NSVGfont* next;
 } NSVGfont;
 
@@ -457,6 +459,7 @@ void nsvg__xformSetScale(float* t, float sx, float sy);
 void nsvg__xformPremultiply(float* t, float* s);
 void nsvg__xformMultiply(float* t, float* s);
 void nsvg__deleteFont(NSVGfont* font);
+NSVGglyph* nsvg__findGlyph(NSVGfont* font, CHAR16 letter);
 void nsvg__imageBounds(NSVGimage* image, float* bounds);
 float addLetter(NSVGparser* p, CHAR16 letter, float x, float y, float scale, UINT32 color);
 void RenderSVGfont(NSVGfont  *fontSVG, UINT32 color);
@@ -482,6 +485,13 @@ void nsvgRasterize(NSVGrasterizer* r,
                    NSVGimage* image, float tx, float ty, float scalex, float scaley,
                    unsigned char* dst, int w, int h, int stride);
 
+// Same as nsvgRasterize() but dst is left premultiplied, for several renders blended before
+// one final nsvgUnpremultiplyAlpha()
+void nsvgRasterizePremultiplied(NSVGrasterizer* r,
+                   NSVGimage* image, float tx, float ty, float scalex, float scaley,
+                   unsigned char* dst, int w, int h, int stride);
+void nsvgUnpremultiplyAlpha(unsigned char* dst, int w, int h, int stride);
+
 // Deletes rasterizer context.
 void nsvgDeleteRasterizer(NSVGrasterizer*);
 
@@ -1768,7 +1768,7 @@ void nsvg__rasterizeClipPaths(
   }
 }
 
-void nsvgRasterize(NSVGrasterizer* r,
+void nsvgRasterizePremultiplied(NSVGrasterizer* r,
                    NSVGimage* image, float tx, float ty, float scalex, float scaley,
                    unsigned char* dst, int w, int h, int stride)
 {
@@ -1786,7 +1786,18 @@ void nsvgRasterize(NSVGrasterizer* r,
 
   nsvg__rasterizeShapes(r, image->shapes, tx, ty, scalex, scaley,
                         dst, w, h, stride, nsvg__scanlineSolid);
+}
+
+void nsvgUnpremultiplyAlpha(unsigned char* dst, int w, int h, int stride)
+{
+  nsvg__unpremultiplyAlpha(dst, w, h, stride);
+}
 
+void nsvgRasterize(NSVGrasterizer* r,
+                   NSVGimage* image, float tx, float ty, float scalex, float scaley,
+                   unsigned char* dst, int w, int h, int stride)
+{
+  nsvgRasterizePremultiplied(r, image, tx, ty, scalex, scaley, dst, w, h, stride);
   nsvg__unpremultiplyAlpha(dst, w, h, stride);
 }
 
@@ -141,6 +141,7 @@ void XTheme::LoadFontImage(IN BOOLEAN UseEmbedded, IN INTN Rows, IN INTN Cols)
   PixelPtr = NewImage.GetPixelPtr(0,0);
 
   FontImage.setSizeInPixels(ImageWidth * Rows, ImageHeight / Rows);
+  FontEmptyLeft.setEmpty();
   FontPtr = FontImage.GetPixelPtr(0,0);
 
   FontWidth = ImageWidth / Cols;
@@ -200,6 +201,7 @@ void XTheme::PrepareFont()
       }
  //     FontImage.Draw(0, 300, 0.6f); //for debug purpose
     }
+    FontEmptyLeft.setEmpty(); //pixels changed
     DBG("Font %d prepared WxH=%lldx%lld CharWidth=%lld\n", Font, FontWidth, FontHeight, CharWidth);
 
   } else {
@@ -252,6 +254,22 @@ INTN XTheme::GetEmpty(const XImage& Buffer, const EFI_GRAPHICS_OUTPUT_BLT_PIXEL&
   return m;
 }
 
+//GetEmpty() from the left of char c in FontImage, computed once for all the chars
+INTN XTheme::GetFontEmptyLeft(UINT16 c)
+{
+  INTN NbChars = (FontWidth > 0) ? FontImage.GetWidth() / FontWidth : 0;
+  if (FontEmptyLeft.size() == 0 && NbChars > 0) {
+    EFI_GRAPHICS_OUTPUT_BLT_PIXEL FontPixel = FontImage.GetPixel(0,0);
+    for (INTN i = 0; i < NbChars; i++) {
+      FontEmptyLeft.Add(GetEmpty(FontImage, FontPixel, FontWidth, i * FontWidth, 1));
+    }
+  }
+  if (c < FontEmptyLeft.size()) {
+    return FontEmptyLeft[c];
+  }
+  return GetEmpty(FontImage, FontImage.GetPixel(0,0), FontWidth, c * FontWidth, 1);
+}
+
 INTN XTheme::RenderText(IN const XString8& Text, OUT XImage* CompImage_ptr,
                         IN INTN PosX, IN INTN PosY, IN UINTN Cursor, INTN textType, float textScale)
 {
@@ -264,7 +282,6 @@ INTN XTheme::RenderText(IN const XStringW& Text, OUT XImage* CompImage_ptr,
 {
   XImage& CompImage = *CompImage_ptr;
 
-  EFI_GRAPHICS_OUTPUT_BLT_PIXEL    FontPixel;
   EFI_GRAPHICS_OUTPUT_BLT_PIXEL    FirstPixel;
   UINTN           TextLength;
   UINTN          Cho = 0, Jong = 0, Joong = 0;
@@ -288,7 +305,6 @@ INTN XTheme::RenderText(IN const XStringW& Text, OUT XImage* CompImage_ptr,
 
   DBG("TextLength =%lld PosX=%lld PosY=%lld\n", TextLength, PosX, PosY);
   FirstPixel = CompImage.GetPixel(0,0);
-  FontPixel  = FontImage.GetPixel(0,0);
   UINT16 c0 = 0x20;
   INTN RealWidth = CharScaledWidth;
   INTN Shift = INTN((FontWidth - CharWidth) * textScale / 2); // cast to INTN to avoid warning
@@ -328,7 +344,7 @@ INTN XTheme::RenderText(IN const XStringW& Text, OUT XImage* CompImage_ptr,
           RightSpace = 1;
           RealWidth = (CharScaledWidth >> 1) + 1;
         } else {
-          RightSpace = GetEmpty(FontImage, FontPixel, FontWidth, c * FontWidth, 1); //not scaled yet
+          RightSpace = GetFontEmptyLeft(c); //not scaled yet
           if (RightSpace >= FontWidth) {
             RightSpace = 0; //empty place for invisible characters
           }
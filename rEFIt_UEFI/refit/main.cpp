@@ -43,6 +43,7 @@
 
 #include "../entry_scan/entry_scan.h"
 #include "../libeg/nanosvg.h"
+#include "../libeg/SVGGlyphCache.h"
 #include "../gui/menu_items/menu_globals.h"
 #include "menu.h"
 #include "../Platform/Settings.h"
@@ -806,6 +807,7 @@ void LOADER_ENTRY::StartLoader()
   // mainParser
   // BuiltinIcons
   // OSIcons
+  GlyphCache.setEmpty();
   NSVGfontChain *fontChain = fontsDB;
   while (fontChain) {
     font = fontChain->font;
@@ -1122,15 +1124,11 @@ void LOADER_ENTRY::StartLoader()
         DBG("Cannot find kext bundlePath at '%s'\n", bundlePath.c_str());
       }
   #if 1
-      //CFBundleExecutable
-      BOOLEAN   NoContents = FALSE;
-      XStringW  infoPlistPath = getKextPlist(dirPath, KextEntry, &NoContents); //it will be fullPath, including dir
-      TagDict*  dict = getInfoPlist(infoPlistPath);
-  //    BOOLEAN inject = checkOSBundleRequired(dict);
+      //CFBundleExecutable, read by InitKextList
       BOOLEAN inject = true;
       if (inject) {
-        if ( infoPlistPath.notEmpty()) {
-          if (NoContents) {
+        if ( KextEntry.InfoPlistFound ) {
+          if (KextEntry.NoContents) {
             OC_STRING_ASSIGN(mOpenCoreConfiguration.Kernel.Add.Values[kextIdx]->PlistPath, "Info.plist");
           } else {
             OC_STRING_ASSIGN(mOpenCoreConfiguration.Kernel.Add.Values[kextIdx]->PlistPath, "Contents/Info.plist");
@@ -1138,7 +1136,7 @@ void LOADER_ENTRY::StartLoader()
         }else{
           DBG("Cannot find kext info.plist at '%ls'\n", KextEntry.FileName.wc_str());
         }
-        XString8 execpath = getKextExecPath(dirPath, KextEntry, dict, NoContents);
+        XString8 execpath = getKextExecPath(dirPath, KextEntry);
         if (execpath.notEmpty()) {
           OC_STRING_ASSIGN(mOpenCoreConfiguration.Kernel.Add.Values[kextIdx]->ExecutablePath, execpath.c_str());
           DBG("assign executable as '%s'\n", execpath.c_str());
@@ -1656,6 +1654,9 @@ void LOADER_ENTRY::StartLoader()
 //    }
   }
 
+  // Boot services will be exited : no more timer to flush the log.
+  unbufferDebugLog();
+
 #ifdef JIEF_DEBUG
     //Status = EFI_NOT_FOUND;
     Status = gBS->StartImage (ImageHandle, 0, NULL); // point to OcStartImage from OC
@@ -1684,6 +1685,8 @@ void LOADER_ENTRY::StartLoader()
 
       return;
     }
+    // The loader returned, boot services are still there : the timer can flush the log again.
+    bufferDebugLog();
 
 }else{
 //  DBG("StartEFIImage\n");
@@ -2535,16 +2538,46 @@ GetListOfACPI()
   DirIterClose(&DirIter);
 }
 
+/*
+ * Only the beginning of the theme file is read : it must be XML, or directly the root tag.
+ * The theme is parsed when it is chosen, there may be a lot of themes and only one is used.
+ */
+static BOOLEAN
+ThemeFileLooksValid (EFI_FILE *ThemeDir, CONST CHAR16 *FileName, CONST CHAR8 *RootTag)
+{
+  EFI_STATUS Status;
+  EFI_FILE   *File = NULL;
+  CHAR8      Header[64];
+  UINTN      Size = sizeof(Header) - 1;
+  UINTN      i = 0;
+
+  Status = ThemeDir->Open(ThemeDir, &File, FileName, EFI_FILE_MODE_READ, 0);
+  if (EFI_ERROR(Status)) {
+    return FALSE;
+  }
+  Status = File->Read(File, &Size, Header);
+  File->Close(File);
+  if (EFI_ERROR(Status) || Size == 0) {
+    return FALSE;
+  }
+  Header[Size] = '\0';
+  if (Size >= 3 && (UINT8)Header[0] == 0xEF && (UINT8)Header[1] == 0xBB && (UINT8)Header[2] == 0xBF) {
+    i = 3; // UTF-8 BOM
+  }
+  while (Header[i] == ' ' || Header[i] == '\t' || Header[i] == '\r' || Header[i] == '\n') {
+    i++;
+  }
+  return strncmp(&Header[i], "<?xml", 5) == 0 || strncmp(&Header[i], "<!", 2) == 0 ||
+         strncmp(&Header[i], RootTag, strlen(RootTag)) == 0;
+}
+
 void
 GetListOfThemes ()
 {
   EFI_STATUS     Status          = EFI_NOT_FOUND;
   REFIT_DIR_ITER DirIter;
   EFI_FILE_INFO  *DirEntry;
-  XStringW        ThemeTestPath;
   EFI_FILE       *ThemeTestDir   = NULL;
-  CHAR8          *ThemePtr       = NULL;
-  UINTN          Size = 0;
 
   DbgHeader("GetListOfThemes");
 
@@ -2563,28 +2596,22 @@ GetListOfThemes ()
     DBG("- [%02zu]: %ls", ThemeNameArray.size(), DirEntry->FileName);
     Status = self.getThemesDir().Open(&self.getThemesDir(), &ThemeTestDir, DirEntry->FileName, EFI_FILE_MODE_READ, 0);
     if (!EFI_ERROR(Status)) {
-      Status = egLoadFile(ThemeTestDir, CONFIG_THEME_FILENAME, (UINT8**)&ThemePtr, &Size);
-      if (EFI_ERROR(Status) || (ThemePtr == NULL) || (Size == 0)) {
-        Status = egLoadFile(ThemeTestDir, CONFIG_THEME_SVG, (UINT8**)&ThemePtr, &Size);
-        if (EFI_ERROR(Status)) {
-          Status = EFI_NOT_FOUND;
-          DBG(" - bad theme because %ls nor %ls can't be load", CONFIG_THEME_FILENAME, CONFIG_THEME_SVG);
-        }
+      if (!ThemeFileLooksValid(ThemeTestDir, CONFIG_THEME_FILENAME, "<plist") &&
+          !ThemeFileLooksValid(ThemeTestDir, CONFIG_THEME_SVG, "<svg")) {
+        Status = EFI_NOT_FOUND;
+        DBG(" - bad theme because %ls nor %ls can't be load", CONFIG_THEME_FILENAME, CONFIG_THEME_SVG);
       }
+      ThemeTestDir->Close(ThemeTestDir);
+      ThemeTestDir = NULL;
       if (!EFI_ERROR(Status)) {
         //we found a theme
-        if ((StriCmp(DirEntry->FileName, L"embedded") == 0) ||
-            (StriCmp(DirEntry->FileName, L"random") == 0)) {
-          ThemePtr = NULL;
-        } else {
+        if ((StriCmp(DirEntry->FileName, L"embedded") != 0) &&
+            (StriCmp(DirEntry->FileName, L"random") != 0)) {
           ThemeNameArray.Add(DirEntry->FileName);
         }
       }
     }
     DBG("\n");
-    if (ThemePtr) {
-      FreePool(ThemePtr);
-    }
   }
   DirIterClose(&DirIter);
 }
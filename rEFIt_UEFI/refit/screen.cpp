@@ -38,6 +38,7 @@
 #include <Platform.h> // Only use angled for Platform, else, xcode project won't compile
 #include "../libeg/libegint.h"
 #include "../libeg/XTheme.h"
+#include "../libeg/XScreenShadow.h"
 #include "../Platform/BasicIO.h"
 #include "menu.h"
 #include "../gui/REFIT_MENU_SCREEN.h"
@@ -179,6 +180,8 @@ void BeginExternalScreen(IN BOOLEAN UseGraphicsMode/*, IN CONST CHAR16 *Title*/)
 	if (!AllowGraphicsMode) {
         UseGraphicsMode = FALSE;
 	}
+    // the tool may draw on the screen
+    ScreenShadow.invalidate();
     
     if (UseGraphicsMode) {
         SwitchToGraphics();
@@ -200,6 +203,7 @@ void FinishExternalScreen(void)
 {
     // make sure we clean up later
     GraphicsScreenDirty = TRUE;
+    ScreenShadow.invalidate();
     
     if (haveError) {
         // leave error messages on screen in case of error,